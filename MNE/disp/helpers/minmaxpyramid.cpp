@@ -0,0 +1,207 @@
+//=============================================================================================================
+/**
+* @file     minmaxpyramid.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Definition of the MinMaxPyramid Class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "minmaxpyramid.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <limits>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISPLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MinMaxPyramid::MinMaxPyramid()
+: m_iNumRows(0)
+, m_iNumSamples(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void MinMaxPyramid::resize(qint32 iNumRows, qint32 iNumSamples)
+{
+    m_iNumRows = iNumRows > 0 ? iNumRows : 0;
+    m_iNumSamples = iNumSamples > 0 ? iNumSamples : 0;
+
+    m_qVecMin.clear();
+    m_qVecMax.clear();
+
+    for(qint32 l = 1; l < 31 && (m_iNumSamples >> l) > 0; ++l) {
+        m_qVecMin.append(MatrixXfR::Zero(m_iNumRows, m_iNumSamples >> l));
+        m_qVecMax.append(MatrixXfR::Zero(m_iNumRows, m_iNumSamples >> l));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MinMaxPyramid::build(const double* pData, qint32 iNumRows, qint32 iNumSamples)
+{
+    resize(iNumRows, iNumSamples);
+    update(pData, 0, m_iNumSamples);
+}
+
+
+//*************************************************************************************************************
+
+void MinMaxPyramid::update(const double* pData, qint32 iFrom, qint32 iTo)
+{
+    for(qint32 r = 0; r < m_iNumRows; ++r)
+        updateRow(r, pData + static_cast<qint64>(r) * m_iNumSamples, iFrom, iTo);
+}
+
+
+//*************************************************************************************************************
+
+void MinMaxPyramid::updateRow(qint32 iRow, const double* pRowData, qint32 iFrom, qint32 iTo)
+{
+    if(iRow < 0 || iRow >= m_iNumRows)
+        return;
+
+    //Sample range of the level below which has to be propagated, the samples are level -1
+    qint32 iFirst = qMax(iFrom, 0);
+    qint32 iLast = qMin(iTo, m_iNumSamples);
+
+    for(qint32 l = 0; l < m_qVecMin.size() && iFirst < iLast; ++l) {
+        MatrixXfR& matMin = m_qVecMin[l];
+        MatrixXfR& matMax = m_qVecMax[l];
+
+        qint32 iBinFirst = iFirst >> 1;
+        qint32 iBinLast = qMin((iLast + 1) >> 1, static_cast<qint32>(matMin.cols()));
+
+        for(qint32 j = iBinFirst; j < iBinLast; ++j) {
+            if(l == 0) {
+                double a = pRowData[2*j];
+                double b = pRowData[2*j+1];
+                matMin(iRow, j) = static_cast<float>(qMin(a, b));
+                matMax(iRow, j) = static_cast<float>(qMax(a, b));
+            } else {
+                matMin(iRow, j) = qMin(m_qVecMin[l-1](iRow, 2*j), m_qVecMin[l-1](iRow, 2*j+1));
+                matMax(iRow, j) = qMax(m_qVecMax[l-1](iRow, 2*j), m_qVecMax[l-1](iRow, 2*j+1));
+            }
+        }
+
+        iFirst = iBinFirst;
+        iLast = iBinLast;
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool MinMaxPyramid::minMax(qint32 iRow, const double* pRowData, qint32 iFrom, qint32 iTo, double& dMin, double& dMax) const
+{
+    iFrom = qMax(iFrom, 0);
+    iTo = qMin(iTo, m_iNumSamples);
+
+    if(iRow < 0 || iRow >= m_iNumRows || iFrom >= iTo)
+        return false;
+
+    dMin = std::numeric_limits<double>::max();
+    dMax = -std::numeric_limits<double>::max();
+
+    //Walk from iFrom to iTo with the largest aligned bin which fits - k = 0 are the samples, k > 0 level k-1
+    qint32 iNumLevels = m_qVecMin.size();
+    qint32 i = iFrom;
+    qint32 k = 0;
+
+    while(i < iTo) {
+        while(k < iNumLevels && (i & ((2 << k) - 1)) == 0 && i + (2 << k) <= iTo)
+            ++k;
+        while(k > 0 && i + (1 << k) > iTo)
+            --k;
+
+        if(k == 0) {
+            dMin = qMin(dMin, pRowData[i]);
+            dMax = qMax(dMax, pRowData[i]);
+        } else {
+            dMin = qMin(dMin, static_cast<double>(m_qVecMin[k-1](iRow, i >> k)));
+            dMax = qMax(dMax, static_cast<double>(m_qVecMax[k-1](iRow, i >> k)));
+        }
+
+        i += 1 << k;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void MinMaxPyramid::envelope(qint32 iRow, const double* pRowData, qint32 iFrom, qint32 iTo, qint32 iNumColumns, QVector<double>& vecMin, QVector<double>& vecMax) const
+{
+    iNumColumns = qMax(iNumColumns, 0);
+
+    vecMin.resize(iNumColumns);
+    vecMax.resize(iNumColumns);
+
+    qint64 iLength = iTo - iFrom;
+
+    for(qint32 c = 0; c < iNumColumns; ++c) {
+        qint32 iStart = iFrom + static_cast<qint32>(iLength * c / iNumColumns);
+        qint32 iEnd = iFrom + static_cast<qint32>(iLength * (c + 1) / iNumColumns);
+
+        //Columns narrower than a sample repeat the sample
+        if(iEnd <= iStart)
+            iEnd = iStart + 1;
+
+        if(!minMax(iRow, pRowData, iStart, iEnd, vecMin[c], vecMax[c])) {
+            vecMin[c] = 0.0;
+            vecMax[c] = 0.0;
+        }
+    }
+}
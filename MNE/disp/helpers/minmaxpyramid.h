@@ -0,0 +1,229 @@
+//=============================================================================================================
+/**
+* @file     minmaxpyramid.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     MinMaxPyramid class declaration.
+*
+*/
+
+#ifndef MINMAXPYRAMID_H
+#define MINMAXPYRAMID_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../disp_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE DISPLIB
+//=============================================================================================================
+
+namespace DISPLIB
+{
+
+
+//=============================================================================================================
+/**
+* Decimation pyramid of a row-major data matrix (channels x samples). Level l holds the minimum and maximum of
+* consecutive bins of 2^(l+1) samples of each channel. The pyramid is updated incrementally for the samples which
+* changed, and the minimum and maximum of an arbitrary sample range are assembled from O(log n) bins. This way a
+* trace can be drawn with two points per pixel column, independent of the number of samples in the window.
+*
+* The level 0 samples are not copied - the queries take the row of the data matrix the pyramid was built from.
+*
+* @brief Per-channel min/max decimation pyramid for trace rendering
+*/
+class DISPSHARED_EXPORT MinMaxPyramid
+{
+public:
+    typedef QSharedPointer<MinMaxPyramid> SPtr;            /**< Shared pointer type for MinMaxPyramid. */
+    typedef QSharedPointer<const MinMaxPyramid> ConstSPtr; /**< Const shared pointer type for MinMaxPyramid. */
+
+    //=========================================================================================================
+    /**
+    * Constructs an empty MinMaxPyramid.
+    */
+    MinMaxPyramid();
+
+    //=========================================================================================================
+    /**
+    * Resizes the pyramid to the given data dimensions. The bins have to be updated afterwards.
+    *
+    * @param[in] iNumRows       Number of channels
+    * @param[in] iNumSamples    Number of samples per channel
+    */
+    void resize(qint32 iNumRows, qint32 iNumSamples);
+
+    //=========================================================================================================
+    /**
+    * Resizes the pyramid to the data dimensions and builds all bins.
+    *
+    * @param[in] pData          Row-major data matrix of size iNumRows x iNumSamples
+    * @param[in] iNumRows       Number of channels
+    * @param[in] iNumSamples    Number of samples per channel
+    */
+    void build(const double* pData, qint32 iNumRows, qint32 iNumSamples);
+
+    //=========================================================================================================
+    /**
+    * Updates the bins of all channels which cover the changed samples [iFrom, iTo).
+    *
+    * @param[in] pData      Row-major data matrix of size rows() x samples()
+    * @param[in] iFrom      First changed sample
+    * @param[in] iTo        One past the last changed sample
+    */
+    void update(const double* pData, qint32 iFrom, qint32 iTo);
+
+    //=========================================================================================================
+    /**
+    * Updates the bins of one channel which cover the changed samples [iFrom, iTo).
+    *
+    * @param[in] iRow       The channel
+    * @param[in] pRowData   The samples of the channel
+    * @param[in] iFrom      First changed sample
+    * @param[in] iTo        One past the last changed sample
+    */
+    void updateRow(qint32 iRow, const double* pRowData, qint32 iFrom, qint32 iTo);
+
+    //=========================================================================================================
+    /**
+    * Computes the minimum and maximum of the samples [iFrom, iTo) of one channel.
+    *
+    * @param[in] iRow       The channel
+    * @param[in] pRowData   The samples of the channel the pyramid was built from
+    * @param[in] iFrom      First sample
+    * @param[in] iTo        One past the last sample
+    * @param[out] dMin      The minimum
+    * @param[out] dMax      The maximum
+    *
+    * @return false if the range is empty, true otherwise
+    */
+    bool minMax(qint32 iRow, const double* pRowData, qint32 iFrom, qint32 iTo, double& dMin, double& dMax) const;
+
+    //=========================================================================================================
+    /**
+    * Splits the samples [iFrom, iTo) of one channel into iNumColumns equally sized parts, i.e. pixel columns,
+    * and computes the minimum and maximum of each part.
+    *
+    * @param[in] iRow           The channel
+    * @param[in] pRowData       The samples of the channel the pyramid was built from
+    * @param[in] iFrom          First sample
+    * @param[in] iTo            One past the last sample
+    * @param[in] iNumColumns    Number of parts
+    * @param[out] vecMin        The minimum of each part
+    * @param[out] vecMax        The maximum of each part
+    */
+    void envelope(qint32 iRow, const double* pRowData, qint32 iFrom, qint32 iTo, qint32 iNumColumns, QVector<double>& vecMin, QVector<double>& vecMax) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of channels.
+    *
+    * @return the number of channels
+    */
+    inline qint32 rows() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples per channel.
+    *
+    * @return the number of samples
+    */
+    inline qint32 samples() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of levels above the samples.
+    *
+    * @return the number of levels
+    */
+    inline qint32 numLevels() const;
+
+private:
+    typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatrixXfR;
+
+    qint32              m_iNumRows;     /**< Number of channels. */
+    qint32              m_iNumSamples;  /**< Number of samples per channel. */
+
+    QVector<MatrixXfR>  m_qVecMin;      /**< Bin minima per level, level l has bins of 2^(l+1) samples. */
+    QVector<MatrixXfR>  m_qVecMax;      /**< Bin maxima per level, level l has bins of 2^(l+1) samples. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline qint32 MinMaxPyramid::rows() const
+{
+    return m_iNumRows;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 MinMaxPyramid::samples() const
+{
+    return m_iNumSamples;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 MinMaxPyramid::numLevels() const
+{
+    return m_qVecMin.size();
+}
+
+} // NAMESPACE
+
+#endif // MINMAXPYRAMID_H
@@ -57,6 +57,9 @@
 #include <QColor>
 #include <QStandardItem>
 #include <QStandardItemModel>
+#include <QTimer>
+#include <QGuiApplication>
+#include <QScreen>
 
 
 //*************************************************************************************************************
@@ -86,9 +89,15 @@ BrainRTSourceLocDataTreeItem::BrainRTSourceLocDataTreeItem(int iType, const QStr
 : AbstractTreeItem(iType, text)
 , m_bIsInit(false)
 , m_pSourceLocRtDataWorker(new RtSourceLocDataWorker(this))
+, m_pDisplayFrameTimer(new QTimer(this))
 {
-    connect(m_pSourceLocRtDataWorker, &RtSourceLocDataWorker::newRtData,
-            this, &BrainRTSourceLocDataTreeItem::onNewRtData);
+    //Pace the color updates by the display instead of the worker, so that slow rendering never queues up old samples
+    qreal dRefreshRate = QGuiApplication::primaryScreen() ? QGuiApplication::primaryScreen()->refreshRate() : 60.0;
+    m_pDisplayFrameTimer->setTimerType(Qt::PreciseTimer);
+    m_pDisplayFrameTimer->setInterval(qMax(1, qRound(1000.0 / (dRefreshRate > 0 ? dRefreshRate : 60.0))));
+
+    connect(m_pDisplayFrameTimer, &QTimer::timeout,
+            this, &BrainRTSourceLocDataTreeItem::onDisplayFrame);
 
     this->setEditable(false);
     this->setToolTip("Real time source localization data");
@@ -261,12 +270,27 @@ bool BrainRTSourceLocDataTreeItem::init(const MNEForwardSolution& tForwardSoluti
     data.setValue(1);
     pItemAveragedStreaming->setData(data, MetaTreeItemRoles::RTDataNumberAverages);
 
+    MetaTreeItem *pItemAverageSkippedSamples = new MetaTreeItem(MetaTreeItemTypes::RTDataAverageSkippedSamples, "Average skipped samples on/off");
+    connect(pItemAverageSkippedSamples, &MetaTreeItem::checkStateChanged,
+            this, &BrainRTSourceLocDataTreeItem::onCheckStateAverageSkippedSamplesChanged);
+    pItemAverageSkippedSamples->setCheckable(true);
+    pItemAverageSkippedSamples->setCheckState(Qt::Unchecked);
+    list.clear();
+    list << pItemAverageSkippedSamples;
+    list << new QStandardItem(pItemAverageSkippedSamples->toolTip());
+    this->appendRow(list);
+
     //set rt data corresponding to the hemisphere
     m_pSourceLocRtDataWorker->setSurfaceData(arraySurfaceVertColorLeftHemi,
                                              arraySurfaceVertColorRightHemi,
                                              this->data(Data3DTreeModelItemRoles::RTVertNoLeftHemi).value<VectorXi>(),
                                              this->data(Data3DTreeModelItemRoles::RTVertNoRightHemi).value<VectorXi>());
 
+    m_pSourceLocRtDataWorker->setInterpolationInfo(tForwardSolution.src[0].rr,
+                                                   tForwardSolution.src[1].rr,
+                                                   tForwardSolution.src[0].neighbor_vert,
+                                                   tForwardSolution.src[1].neighbor_vert);
+
     m_pSourceLocRtDataWorker->setAnnotationData(vecLabelIdsLeftHemi,
                                                 vecLabelIdsRightHemi,
                                                 lLabelsLeftHemi,
@@ -367,6 +391,23 @@ void BrainRTSourceLocDataTreeItem::setNumberAverages(int iNumberAverages)
 }
 
 
+//*************************************************************************************************************
+
+void BrainRTSourceLocDataTreeItem::setAverageSkippedSamples(bool state)
+{
+    QList<QStandardItem*> lItems = this->findChildren(MetaTreeItemTypes::RTDataAverageSkippedSamples);
+
+    for(int i = 0; i < lItems.size(); i++) {
+        if(MetaTreeItem* pAbstractItem = dynamic_cast<MetaTreeItem*>(lItems.at(i))) {
+            pAbstractItem->setCheckState(state == true ? Qt::Checked : Qt::Unchecked);
+            QVariant data;
+            data.setValue(state);
+            pAbstractItem->setData(data, MetaTreeItemRoles::RTDataAverageSkippedSamples);
+        }
+    }
+}
+
+
 //*************************************************************************************************************
 
 void BrainRTSourceLocDataTreeItem::setColortable(const QString& sColortable)
@@ -439,18 +480,24 @@ void BrainRTSourceLocDataTreeItem::onCheckStateWorkerChanged(const Qt::CheckStat
     if(checkState == Qt::Checked) {
         qDebug() << "Start stc worker";
         m_pSourceLocRtDataWorker->start();
+        m_pDisplayFrameTimer->start();
     } else if(checkState == Qt::Unchecked) {
         qDebug() << "Stop stc worker";
         m_pSourceLocRtDataWorker->stop();
+        m_pDisplayFrameTimer->stop();
     }    
 }
 
 
 //*************************************************************************************************************
 
-void BrainRTSourceLocDataTreeItem::onNewRtData(const QPair<QByteArray, QByteArray>& sourceColorSamples)
+void BrainRTSourceLocDataTreeItem::onDisplayFrame()
 {
-    emit rtVertColorChanged(sourceColorSamples);
+    QPair<QByteArray, QByteArray> sourceColorSamples;
+
+    if(m_pSourceLocRtDataWorker->fetchFrame(sourceColorSamples)) {
+        emit rtVertColorChanged(sourceColorSamples);
+    }
 }
 
 
@@ -517,3 +564,15 @@ void BrainRTSourceLocDataTreeItem::onNumberAveragesChanged(int iNumAvr)
     m_pSourceLocRtDataWorker->setNumberAverages(iNumAvr);
 }
 
+
+//*************************************************************************************************************
+
+void BrainRTSourceLocDataTreeItem::onCheckStateAverageSkippedSamplesChanged(const Qt::CheckState& checkState)
+{
+    if(checkState == Qt::Checked) {
+        m_pSourceLocRtDataWorker->setAverageSkippedSamples(true);
+    } else if(checkState == Qt::Unchecked) {
+        m_pSourceLocRtDataWorker->setAverageSkippedSamples(false);
+    }
+}
+
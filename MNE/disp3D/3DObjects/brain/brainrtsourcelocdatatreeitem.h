@@ -69,6 +69,8 @@ namespace MNELIB {
     class MNESourceEstimate;
 }
 
+class QTimer;
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -194,6 +196,14 @@ public:
     */
     void setNumberAverages(int iNumberAverages);
 
+    //=========================================================================================================
+    /**
+    * This function sets whether the samples of frames, which the display skipped, are averaged into the next frame.
+    *
+    * @param[in] state     Whether to average the skipped samples or not.
+    */
+    void setAverageSkippedSamples(bool state);
+
     //=========================================================================================================
     /**
     * This function sets the colortable type.
@@ -238,11 +248,10 @@ private:
 
     //=========================================================================================================
     /**
-    * This function gets called whenever this item receives new color values for each estimated source.
-    *
-    * @param[in] sourceColorSamples     The color values for each estimated source for left and right hemisphere.
+    * This function gets called once per display frame and passes the latest colors produced by the worker on, if any.
+    * Colors produced in between two display frames are dropped.
     */
-    void onNewRtData(const QPair<QByteArray, QByteArray> &sourceColorSamples);
+    void onDisplayFrame();
 
     //=========================================================================================================
     /**
@@ -292,9 +301,18 @@ private:
     */
     void onNumberAveragesChanged(int iNumAvr);
 
+    //=========================================================================================================
+    /**
+    * This function gets called whenever the check state of the skipped samples averaging changed.
+    *
+    * @param[in] checkState     The check state of the skipped samples averaging.
+    */
+    void onCheckStateAverageSkippedSamplesChanged(const Qt::CheckState& checkState);
+
     bool                        m_bIsInit;                      /**< The init flag. */
 
     RtSourceLocDataWorker*      m_pSourceLocRtDataWorker;       /**< The source data worker. This worker streams the rt data to this item.*/
+    QTimer*                     m_pDisplayFrameTimer;           /**< Picks up the latest worker colors at the refresh rate of the screen. */
 
 signals:
     //=========================================================================================================
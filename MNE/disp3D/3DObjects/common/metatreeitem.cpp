@@ -115,6 +115,9 @@ MetaTreeItem::MetaTreeItem(int iType, const QString& text)
         case MetaTreeItemTypes::RTDataNumberAverages:
             sToolTip = "The number of samples averaged together (downsampling)";
             break;
+        case MetaTreeItemTypes::RTDataAverageSkippedSamples:
+            sToolTip = "Turn averaging the samples of skipped frames into the next frame on/off";
+            break;
         case MetaTreeItemTypes::RTDataNormalizationValue:
             sToolTip = "The value to normalize the source localization result";
             break;
@@ -47,6 +47,7 @@
 #include "../helpers/renderable3Dentity.h"
 
 #include <mne/mne_bem.h>
+#include <mne/mne_forwardsolution.h>
 #include <fs/surfaceset.h>
 #include <fs/annotationset.h>
 #include <fiff/fiff_dig_point_set.h>
@@ -58,6 +59,9 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 
 #include <Qt3DCore/QEntity>
 
@@ -86,6 +90,7 @@ using namespace DISP3DLIB;
 Data3DTreeModel::Data3DTreeModel(QObject* parent, Qt3DCore::QEntity* parentEntity)
 : QStandardItemModel(parent)
 , m_pParentEntity(parentEntity)
+, m_iNextLoadJobId(0)
 {
     m_pRootItem = this->invisibleRootItem();
     m_pRootItem->setText("Loaded 3D Data");
@@ -96,6 +101,9 @@ Data3DTreeModel::Data3DTreeModel(QObject* parent, Qt3DCore::QEntity* parentEntit
 
 Data3DTreeModel::~Data3DTreeModel()
 {
+    //Running load tasks skip their remaining reads, their watchers are deleted together with this model
+    cancelLoading();
+
     //delete m_pRootItem;
 }
 
@@ -435,3 +443,208 @@ bool Data3DTreeModel::addData(const QString& subject, const QString& set, const
     return state;
 }
 
+
+//*************************************************************************************************************
+
+int Data3DTreeModel::loadBrainData(const QString& subject, const QString& set, const QString& subject_id, const QString& subjects_dir, const QString& surf, const QString& atlas)
+{
+    typedef QPair<Surface, Annotation> HemiData;
+
+    int iJobId = createLoadJob(2);
+    QSharedPointer<QAtomicInt> pCanceled = m_qMapLoadJobs[iJobId].pCanceled;
+
+    //The set is added once both hemispheres are read, since inflated surfaces are offset against each other
+    QSharedPointer<QMap<int, HemiData> > pHemiData(new QMap<int, HemiData>());
+
+    for(int hemi = 0; hemi < 2; ++hemi) {
+        QFutureWatcher<HemiData>* pWatcher = new QFutureWatcher<HemiData>(this);
+
+        connect(pWatcher, &QFutureWatcher<HemiData>::finished, this, [=]() {
+            HemiData data = pWatcher->result();
+            pWatcher->deleteLater();
+
+            pHemiData->insert(hemi, data);
+            bool bSuccess = !data.first.isEmpty() && (atlas.isEmpty() || !data.second.isEmpty());
+
+            //The set is only added if both hemispheres could be read
+            if(pHemiData->size() == 2 && !isLoadJobCanceled(iJobId)) {
+                bool bComplete = true;
+                for(int i = 0; i < 2; ++i) {
+                    if(pHemiData->value(i).first.isEmpty() || (!atlas.isEmpty() && pHemiData->value(i).second.isEmpty())) {
+                        bComplete = false;
+                    }
+                }
+
+                if(bComplete) {
+                    SurfaceSet tSurfaceSet(pHemiData->value(0).first, pHemiData->value(1).first);
+                    AnnotationSet tAnnotationSet = atlas.isEmpty() ? AnnotationSet() : AnnotationSet(pHemiData->value(0).second, pHemiData->value(1).second);
+
+                    bSuccess = addData(subject, set, tSurfaceSet, tAnnotationSet) && bSuccess;
+                }
+            }
+
+            finishLoadTask(iJobId, bSuccess);
+        });
+
+        pWatcher->setFuture(QtConcurrent::run([=]() -> HemiData {
+            HemiData data;
+
+            if(pCanceled->load() == 0) {
+                Surface::read(subject_id, hemi, surf, subjects_dir, data.first);
+            }
+
+            if(pCanceled->load() == 0 && !atlas.isEmpty()) {
+                Annotation::read(subject_id, hemi, atlas, subjects_dir, data.second);
+            }
+
+            return data;
+        }));
+    }
+
+    return iJobId;
+}
+
+
+//*************************************************************************************************************
+
+int Data3DTreeModel::loadBemData(const QString& subject, const QString& set, const QString& sBemFile)
+{
+    int iJobId = createLoadJob(1);
+    QSharedPointer<QAtomicInt> pCanceled = m_qMapLoadJobs[iJobId].pCanceled;
+
+    QFutureWatcher<MNEBem>* pWatcher = new QFutureWatcher<MNEBem>(this);
+
+    connect(pWatcher, &QFutureWatcher<MNEBem>::finished, this, [=]() {
+        MNEBem tBem = pWatcher->result();
+        pWatcher->deleteLater();
+
+        bool bSuccess = !tBem.isEmpty();
+
+        if(bSuccess && !isLoadJobCanceled(iJobId)) {
+            bSuccess = addData(subject, set, tBem);
+        }
+
+        finishLoadTask(iJobId, bSuccess);
+    });
+
+    pWatcher->setFuture(QtConcurrent::run([=]() -> MNEBem {
+        if(pCanceled->load() != 0) {
+            return MNEBem();
+        }
+
+        QFile t_File(sBemFile);
+        return MNEBem(t_File);
+    }));
+
+    return iJobId;
+}
+
+
+//*************************************************************************************************************
+
+int Data3DTreeModel::loadSourceSpaceData(const QString& subject, const QString& set, const QString& sFwdFile)
+{
+    int iJobId = createLoadJob(1);
+    QSharedPointer<QAtomicInt> pCanceled = m_qMapLoadJobs[iJobId].pCanceled;
+
+    QFutureWatcher<MNESourceSpace>* pWatcher = new QFutureWatcher<MNESourceSpace>(this);
+
+    connect(pWatcher, &QFutureWatcher<MNESourceSpace>::finished, this, [=]() {
+        MNESourceSpace tSourceSpace = pWatcher->result();
+        pWatcher->deleteLater();
+
+        bool bSuccess = !tSourceSpace.isEmpty();
+
+        if(bSuccess && !isLoadJobCanceled(iJobId)) {
+            bSuccess = addData(subject, set, tSourceSpace);
+        }
+
+        finishLoadTask(iJobId, bSuccess);
+    });
+
+    pWatcher->setFuture(QtConcurrent::run([=]() -> MNESourceSpace {
+        MNEForwardSolution t_Fwd;
+
+        if(pCanceled->load() == 0) {
+            QFile t_File(sFwdFile);
+            MNEForwardSolution::read(t_File, t_Fwd);
+        }
+
+        return t_Fwd.src;
+    }));
+
+    return iJobId;
+}
+
+
+//*************************************************************************************************************
+
+void Data3DTreeModel::cancelLoading(int iJobId)
+{
+    QMap<int, Data3DLoadJob>::iterator it = m_qMapLoadJobs.begin();
+
+    for(; it != m_qMapLoadJobs.end(); ++it) {
+        if(iJobId == -1 || it.key() == iJobId) {
+            it.value().pCanceled->store(1);
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool Data3DTreeModel::isLoading() const
+{
+    return !m_qMapLoadJobs.isEmpty();
+}
+
+
+//*************************************************************************************************************
+
+int Data3DTreeModel::createLoadJob(int iNumTasks)
+{
+    Data3DLoadJob job;
+    job.pCanceled = QSharedPointer<QAtomicInt>(new QAtomicInt(0));
+    job.iNumTasks = iNumTasks;
+    job.iNumFinished = 0;
+    job.bSuccess = true;
+
+    int iJobId = m_iNextLoadJobId++;
+    m_qMapLoadJobs.insert(iJobId, job);
+
+    return iJobId;
+}
+
+
+//*************************************************************************************************************
+
+bool Data3DTreeModel::isLoadJobCanceled(int iJobId) const
+{
+    QMap<int, Data3DLoadJob>::const_iterator it = m_qMapLoadJobs.constFind(iJobId);
+
+    return it == m_qMapLoadJobs.constEnd() || it.value().pCanceled->load() != 0;
+}
+
+
+//*************************************************************************************************************
+
+void Data3DTreeModel::finishLoadTask(int iJobId, bool bSuccess)
+{
+    QMap<int, Data3DLoadJob>::iterator it = m_qMapLoadJobs.find(iJobId);
+    if(it == m_qMapLoadJobs.end()) {
+        return;
+    }
+
+    Data3DLoadJob& job = it.value();
+    job.iNumFinished++;
+    job.bSuccess = job.bSuccess && bSuccess;
+
+    emit loadingProgress(iJobId, job.iNumFinished, job.iNumTasks);
+
+    if(job.iNumFinished >= job.iNumTasks) {
+        bool bJobSuccess = job.bSuccess && job.pCanceled->load() == 0;
+        m_qMapLoadJobs.erase(it);
+
+        emit loadingFinished(iJobId, bJobSuccess);
+    }
+}
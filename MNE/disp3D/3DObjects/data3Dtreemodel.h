@@ -52,6 +52,9 @@
 //=============================================================================================================
 
 #include <QStandardItemModel>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QMap>
 
 
 //*************************************************************************************************************
@@ -104,6 +107,19 @@ namespace DISP3DLIB
 class BrainRTSourceLocDataTreeItem;
 
 
+//=============================================================================================================
+/**
+* Bookkeeping of one asynchronous loading job of the Data3DTreeModel.
+*/
+struct Data3DLoadJob
+{
+    QSharedPointer<QAtomicInt>  pCanceled;      /**< Set to 1 once the job was canceled, shared with the worker threads. */
+    int                         iNumTasks;      /**< Number of worker tasks of this job. */
+    int                         iNumFinished;   /**< Number of worker tasks which finished so far. */
+    bool                        bSuccess;       /**< False as soon as one task failed. */
+};
+
+
 //=============================================================================================================
 /**
 * Data3DTreeModel provides a tree based data model to hold all information about data which was added to the View 3D.
@@ -217,9 +233,118 @@ public:
     */
     bool addData(const QString& subject, const QString& set, const FIFFLIB::FiffDigPointSet &tDigitizer);
 
+    //=========================================================================================================
+    /**
+    * Loads FreeSurfer brain data on worker threads and adds it to the model once it is read. Both hemispheres
+    * are read in parallel and the set is only added if both could be read. This function returns immediately.
+    *
+    * @param[in] subject            The name of the subject.
+    * @param[in] set                The name of the surface set to which the data is to be added.
+    * @param[in] subject_id         The FreeSurfer subject id.
+    * @param[in] subjects_dir       The FreeSurfer subjects directory.
+    * @param[in] surf               The surface type, e.g. "orig", "white" or "inflated".
+    * @param[in] atlas              The annotation atlas, e.g. "aparc.a2009s". No annotation is loaded if empty.
+    *
+    * @return                       The id of the loading job.
+    */
+    int loadBrainData(const QString& subject, const QString& set, const QString& subject_id, const QString& subjects_dir, const QString& surf, const QString& atlas = QString());
+
+    //=========================================================================================================
+    /**
+    * Loads BEM data on a worker thread and adds it to the model once it is read. This function returns immediately.
+    *
+    * @param[in] subject            The name of the subject.
+    * @param[in] set                The name of the bem set to which the data is to be added.
+    * @param[in] sBemFile           The BEM fiff file.
+    *
+    * @return                       The id of the loading job.
+    */
+    int loadBemData(const QString& subject, const QString& set, const QString& sBemFile);
+
+    //=========================================================================================================
+    /**
+    * Loads the source spaces of a forward solution on a worker thread and adds them to the model once they are
+    * read. This function returns immediately.
+    *
+    * @param[in] subject            The name of the subject.
+    * @param[in] set                The name of the surface set to which the data is to be added.
+    * @param[in] sFwdFile           The forward solution fiff file.
+    *
+    * @return                       The id of the loading job.
+    */
+    int loadSourceSpaceData(const QString& subject, const QString& set, const QString& sFwdFile);
+
+    //=========================================================================================================
+    /**
+    * Cancels loading jobs. Worker tasks which already run are finished, but their data is not added to the model.
+    *
+    * @param[in] iJobId             The id of the job to cancel, -1 cancels all jobs.
+    */
+    void cancelLoading(int iJobId = -1);
+
+    //=========================================================================================================
+    /**
+    * Returns whether any loading job is still running.
+    *
+    * @return                       True if data is being loaded.
+    */
+    bool isLoading() const;
+
 protected:
+    //=========================================================================================================
+    /**
+    * Registers a new loading job.
+    *
+    * @param[in] iNumTasks          The number of worker tasks of the job.
+    *
+    * @return                       The id of the new job.
+    */
+    int createLoadJob(int iNumTasks);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the loading job was canceled or does not exist anymore.
+    *
+    * @param[in] iJobId             The id of the job.
+    *
+    * @return                       True if the results of the job are to be discarded.
+    */
+    bool isLoadJobCanceled(int iJobId) const;
+
+    //=========================================================================================================
+    /**
+    * Counts a finished worker task of a loading job and emits the progress.
+    *
+    * @param[in] iJobId             The id of the job.
+    * @param[in] bSuccess           Whether the task succeeded.
+    */
+    void finishLoadTask(int iJobId, bool bSuccess);
+
     QStandardItem*          m_pRootItem;            /**< The root item of the tree model. */
     Qt3DCore::QEntity*      m_pParentEntity;        /**< The parent 3D entity. */
+
+    QMap<int, Data3DLoadJob>    m_qMapLoadJobs;     /**< The running loading jobs. */
+    int                         m_iNextLoadJobId;   /**< The id of the next loading job. */
+
+signals:
+    //=========================================================================================================
+    /**
+    * Emitted whenever a worker task of a loading job finished and its data was added to the model.
+    *
+    * @param[in] iJobId             The id of the job.
+    * @param[in] iNumFinished       The number of finished tasks.
+    * @param[in] iNumTasks          The number of tasks of the job.
+    */
+    void loadingProgress(int iJobId, int iNumFinished, int iNumTasks);
+
+    //=========================================================================================================
+    /**
+    * Emitted once all worker tasks of a loading job finished.
+    *
+    * @param[in] iJobId             The id of the job.
+    * @param[in] bSuccess           False if the job was canceled or any data could not be read.
+    */
+    void loadingFinished(int iJobId, bool bSuccess);
 };
 
 } // NAMESPACE
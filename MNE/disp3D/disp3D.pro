@@ -37,7 +37,7 @@ include(../../mne-cpp.pri)
 
 TEMPLATE = lib
 
-QT       += widgets 3dcore 3drender 3dinput 3dextras charts
+QT       += widgets 3dcore 3drender 3dinput 3dextras charts concurrent
 
 DEFINES += DISP3DNEW_LIBRARY
 
@@ -111,6 +111,8 @@ SOURCES += \
     helpers/abstracttreeitem.cpp \
     helpers/renderable3Dentity.cpp \
     helpers/custommesh.cpp \
+    helpers/meshsimplification.cpp \
+    helpers/surfaceinterpolation.cpp \
     control/control3dwidget.cpp \
     rt/rtSourceLoc/rtsourcelocdataworker.cpp \
     3DObjects/brain/brainsourcespacetreeitem.cpp \
@@ -135,6 +137,9 @@ HEADERS += \
     helpers/abstracttreeitem.h \
     helpers/renderable3Dentity.h \
     helpers/custommesh.h \
+    helpers/meshsimplification.h \
+    helpers/surfaceinterpolation.h \
+    helpers/triplebuffer.h \
     helpers/types.h \
     control/control3dwidget.h \
     disp3D_global.h \
@@ -39,6 +39,7 @@
 //=============================================================================================================
 
 #include "custommesh.h"
+#include "meshsimplification.h"
 
 
 //*************************************************************************************************************
@@ -52,6 +53,15 @@
 #include <Qt3DRender/QGeometry>
 #include <Qt3DRender/QAttribute>
 #include <Qt3DRender/QBuffer>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cstring>
 
 
 //*************************************************************************************************************
@@ -69,6 +79,18 @@ using namespace DISP3DLIB;
 using namespace Eigen;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define COLOR_UPDATE_BLOCK_VERTS    64      /**< Number of vertices which are compared and uploaded as one block. */
+#define COLOR_UPDATE_MAX_RANGES     32      /**< Maximal number of partial uploads before the whole buffer is replaced. */
+#define LOD_NUM_LEVELS              3       /**< Maximal number of coarser levels of detail. */
+#define LOD_REDUCTION               0.25    /**< Triangle ratio of two successive levels of detail. */
+#define LOD_MIN_TRIS                2000    /**< Minimal number of triangles of a level of detail. */
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -81,8 +103,13 @@ CustomMesh::CustomMesh()
 , m_pColorDataBuffer(QSharedPointer<Qt3DRender::QBuffer>(new Qt3DRender::QBuffer(Qt3DRender::QBuffer::VertexBuffer)))
 , m_pIndexDataBuffer(QSharedPointer<Qt3DRender::QBuffer>(new Qt3DRender::QBuffer(Qt3DRender::QBuffer::IndexBuffer)))
 , m_iNumVert(0)
+, m_pIndexAttribute(Q_NULLPTR)
+, m_iLevelOfDetail(0)
+, m_fScreenSize(-1.0f)
+, m_fBoundingRadius(0.0f)
 {
-
+    connect(&m_lodWatcher, &QFutureWatcher<QVector<QByteArray> >::finished,
+            this, &CustomMesh::onLevelsOfDetailFinished);
 }
 
 
@@ -91,7 +118,14 @@ CustomMesh::CustomMesh()
 CustomMesh::CustomMesh(const MatrixX3f& tMatVert, const MatrixX3f& tMatNorm, const MatrixX3i& tMatTris, const QByteArray& tArrayColors)
 : Qt3DRender::QGeometryRenderer()
 , m_iNumVert(tMatVert.rows())
+, m_pIndexAttribute(Q_NULLPTR)
+, m_iLevelOfDetail(0)
+, m_fScreenSize(-1.0f)
+, m_fBoundingRadius(0.0f)
 {
+    connect(&m_lodWatcher, &QFutureWatcher<QVector<QByteArray> >::finished,
+            this, &CustomMesh::onLevelsOfDetailFinished);
+
     this->createCustomMesh(tMatVert, tMatNorm, tMatTris, tArrayColors);
 }
 
@@ -113,6 +147,50 @@ bool CustomMesh::setVertColor(const QByteArray& tArrayColors)
         return false;
     }
 
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    //Only upload the blocks which changed, most real-time frames leave large parts of the surface untouched
+    const QByteArray arrayOldColors = m_pColorDataBuffer->data();
+
+    if(arrayOldColors.size() == tArrayColors.size()) {
+        const int iBlockSize = COLOR_UPDATE_BLOCK_VERTS * 3 * (int)sizeof(float);
+        const int iSize = tArrayColors.size();
+        const char* pOld = arrayOldColors.constData();
+        const char* pNew = tArrayColors.constData();
+
+        QVector<QPair<int, int> > qVecRanges;
+        int iDirtyBytes = 0;
+
+        for(int iOffset = 0; iOffset < iSize; iOffset += iBlockSize) {
+            int iLength = qMin(iBlockSize, iSize - iOffset);
+
+            if(std::memcmp(pOld + iOffset, pNew + iOffset, iLength) == 0) {
+                continue;
+            }
+
+            //Merge adjacent dirty blocks into one range
+            if(!qVecRanges.isEmpty() && qVecRanges.last().first + qVecRanges.last().second == iOffset) {
+                qVecRanges.last().second += iLength;
+            } else {
+                qVecRanges.append(qMakePair(iOffset, iLength));
+            }
+
+            iDirtyBytes += iLength;
+        }
+
+        if(qVecRanges.isEmpty()) {
+            return true;
+        }
+
+        if(qVecRanges.size() <= COLOR_UPDATE_MAX_RANGES && iDirtyBytes < iSize / 2) {
+            for(int i = 0; i < qVecRanges.size(); ++i) {
+                m_pColorDataBuffer->updateData(qVecRanges[i].first, tArrayColors.mid(qVecRanges[i].first, qVecRanges[i].second));
+            }
+
+            return true;
+        }
+    }
+#endif
+
     //Update color
     m_pColorDataBuffer->setData(tArrayColors);
 
@@ -129,6 +207,103 @@ bool CustomMesh::setMeshData(const MatrixX3f& tMatVert, const MatrixX3f& tMatNor
     return createCustomMesh(tMatVert, tMatNorm, tMatTris, tArrayColors);
 }
 
+
+//*************************************************************************************************************
+
+int CustomMesh::levelOfDetailCount() const
+{
+    return m_qVecLodIndexData.size();
+}
+
+
+//*************************************************************************************************************
+
+void CustomMesh::setLevelOfDetail(int iLevel)
+{
+    if(iLevel < 0 || iLevel >= m_qVecLodIndexData.size() || iLevel == m_iLevelOfDetail || !m_pIndexAttribute) {
+        return;
+    }
+
+    //All levels reference the original vertices, so only the index buffer needs to be exchanged
+    const int iNumTris = m_qVecLodIndexData[iLevel].size() / (3 * (int)sizeof(uint));
+
+    m_pIndexDataBuffer->setData(m_qVecLodIndexData[iLevel]);
+    m_pIndexAttribute->setCount(iNumTris);
+    this->setVertexCount(iNumTris*3);
+
+    m_iLevelOfDetail = iLevel;
+}
+
+
+//*************************************************************************************************************
+
+void CustomMesh::selectLevelOfDetail(float fScreenSize)
+{
+    m_fScreenSize = fScreenSize;
+
+    const double dNumDesiredTris = (double)fScreenSize * (double)fScreenSize;
+    int iLevel = 0;
+
+    for(int i = 1; i < m_qVecLodIndexData.size(); ++i) {
+        if(m_qVecLodIndexData[i].size() / (3 * (int)sizeof(uint)) < dNumDesiredTris) {
+            break;
+        }
+        iLevel = i;
+    }
+
+    setLevelOfDetail(iLevel);
+}
+
+
+//*************************************************************************************************************
+
+float CustomMesh::boundingRadius() const
+{
+    return m_fBoundingRadius;
+}
+
+
+//*************************************************************************************************************
+
+void CustomMesh::onLevelsOfDetailFinished()
+{
+    m_qVecLodIndexData.resize(1);
+    m_qVecLodIndexData += m_lodWatcher.result();
+
+    if(m_fScreenSize >= 0.0f) {
+        selectLevelOfDetail(m_fScreenSize);
+    }
+}
+
+
+//*************************************************************************************************************
+
+QVector<QByteArray> CustomMesh::createLevelsOfDetail(const MatrixX3f& tMatVert, const MatrixX3i& tMatTris)
+{
+    QList<MatrixX3i> lLevelTris = MeshSimplification::createLevelsOfDetail(tMatVert, tMatTris, LOD_NUM_LEVELS, LOD_REDUCTION, LOD_MIN_TRIS);
+
+    QVector<QByteArray> qVecIndexData;
+
+    for(int i = 0; i < lLevelTris.size(); ++i) {
+        const MatrixX3i& matTris = lLevelTris.at(i);
+
+        QByteArray indexBufferData;
+        indexBufferData.resize(matTris.rows() * 3 * (int)sizeof(uint));
+        uint *rawIndexArray = reinterpret_cast<uint *>(indexBufferData.data());
+        int idxTris = 0;
+
+        for(int j = 0; j < matTris.rows(); ++j) {
+            rawIndexArray[idxTris++] = matTris(j,0);
+            rawIndexArray[idxTris++] = matTris(j,1);
+            rawIndexArray[idxTris++] = matTris(j,2);
+        }
+
+        qVecIndexData.append(indexBufferData);
+    }
+
+    return qVecIndexData;
+}
+
 //*************************************************************************************************************
 
 bool CustomMesh::createCustomMesh(const MatrixX3f& tMatVert, const MatrixX3f& tMatNorm, const MatrixX3i& tMatTris, const QByteArray& tArrayColors)
@@ -252,6 +427,16 @@ bool CustomMesh::createCustomMesh(const MatrixX3f& tMatVert, const MatrixX3f& tM
     customGeometry->addAttribute(colorAttribute);
     customGeometry->addAttribute(indexAttribute);
 
+    //Start over with the full resolution, the coarser levels are created in the background
+    m_pIndexAttribute = indexAttribute;
+    m_qVecLodIndexData.clear();
+    m_qVecLodIndexData.append(indexBufferData);
+    m_iLevelOfDetail = 0;
+
+    m_fBoundingRadius = tMatVert.rows() > 0 ? 0.5f * (tMatVert.colwise().maxCoeff() - tMatVert.colwise().minCoeff()).norm() : 0.0f;
+
+    m_lodWatcher.setFuture(QtConcurrent::run(&CustomMesh::createLevelsOfDetail, tMatVert, tMatTris));
+
     this->setInstanceCount(1);
     this->setIndexOffset(0);
     //this->setFirstVertex(0);
@@ -50,6 +50,9 @@
 //=============================================================================================================
 
 #include <Qt3DRender/QGeometryRenderer>
+#include <QFutureWatcher>
+#include <QVector>
+#include <QByteArray>
 
 
 //*************************************************************************************************************
@@ -67,6 +70,7 @@
 
 namespace Qt3DRender {
     class QBuffer;
+    class QAttribute;
 }
 
 
@@ -125,7 +129,8 @@ public:
 
     //=========================================================================================================
     /**
-    * Update the vertices colors of the mesh.
+    * Update the vertices colors of the mesh. Only the blocks of vertices whose colors changed are uploaded, as
+    * long as they make up a small part of the buffer.
     *
     * @param[in] tArrayColors     New color information for the vertices.
     */
@@ -145,7 +150,58 @@ public:
     */
     bool setMeshData(const Eigen::MatrixX3f& tMatVert, const Eigen::MatrixX3f& tMatNorm, const Eigen::MatrixX3i& tMatTris, const QByteArray &tArrayColors = QByteArray());
 
+    //=========================================================================================================
+    /**
+    * Returns the number of available levels of detail, including the full resolution mesh. The coarser levels are
+    * created in the background after the mesh data was set.
+    *
+    * @return the number of levels of detail.
+    */
+    int levelOfDetailCount() const;
+
+    //=========================================================================================================
+    /**
+    * Draws the mesh with the given level of detail. Level 0 is the full resolution mesh.
+    *
+    * @param[in] iLevel         The level of detail.
+    */
+    void setLevelOfDetail(int iLevel);
+
+    //=========================================================================================================
+    /**
+    * Selects the coarsest level of detail which still has about one triangle per pixel of the mesh on screen. The
+    * size is remembered, so that the selection is repeated once the levels of detail were created.
+    *
+    * @param[in] fScreenSize    The size of the mesh's bounding sphere on screen in pixels.
+    */
+    void selectLevelOfDetail(float fScreenSize);
+
+    //=========================================================================================================
+    /**
+    * Returns the radius of the bounding sphere of the mesh.
+    *
+    * @return the bounding radius.
+    */
+    float boundingRadius() const;
+
 protected:
+    //=========================================================================================================
+    /**
+    * Takes over the levels of detail once the background computation finished.
+    */
+    void onLevelsOfDetailFinished();
+
+    //=========================================================================================================
+    /**
+    * Creates the index data of the coarser levels of detail.
+    *
+    * @param[in] tMatVert       Vertices in form of a matrix.
+    * @param[in] tMatTris       Tris/Faces in form of a matrix.
+    *
+    * @return the index data of each level, ordered from fine to coarse.
+    */
+    static QVector<QByteArray> createLevelsOfDetail(const Eigen::MatrixX3f& tMatVert, const Eigen::MatrixX3i& tMatTris);
+
     //=========================================================================================================
     /**
     * Creates the actual mesh from the set vertex, normals, tris and offset members.
@@ -165,6 +221,13 @@ protected:
     QSharedPointer<Qt3DRender::QBuffer>    m_pIndexDataBuffer;     /**< The index buffer. */
 
     int                     m_iNumVert;             /**< The total number of set vertices. */
+
+    Qt3DRender::QAttribute*                 m_pIndexAttribute;          /**< The index attribute, its count changes with the level of detail. */
+    QVector<QByteArray>                     m_qVecLodIndexData;         /**< The index data of each level of detail, level 0 is the full resolution. */
+    QFutureWatcher<QVector<QByteArray> >    m_lodWatcher;               /**< Watches the background creation of the levels of detail. */
+    int                                     m_iLevelOfDetail;           /**< The currently drawn level of detail. */
+    float                                   m_fScreenSize;              /**< The last requested screen size in pixels, negative if none was requested. */
+    float                                   m_fBoundingRadius;          /**< The radius of the bounding sphere of the mesh. */
 };
 
 } // NAMESPACE
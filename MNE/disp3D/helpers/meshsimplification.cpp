@@ -0,0 +1,346 @@
+//=============================================================================================================
+/**
+* @file     meshsimplification.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     MeshSimplification class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "meshsimplification.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Geometry>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <queue>
+#include <vector>
+#include <algorithm>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISP3DLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE LOCAL TYPES
+//=============================================================================================================
+
+/**
+* Collapse of vertex iFrom onto vertex iTo. The stamps are the vertex stamps at the time the candidate was queued,
+* candidates of vertices which changed since then are outdated.
+*/
+struct CollapseCandidate
+{
+    double  dCost;
+    int     iFrom;
+    int     iTo;
+    int     iStampFrom;
+    int     iStampTo;
+
+    bool operator<(const CollapseCandidate& other) const
+    {
+        //Inverted, so that the priority queue returns the cheapest collapse first
+        return dCost > other.dCost;
+    }
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+QList<MatrixX3i> MeshSimplification::createLevelsOfDetail(const MatrixX3f& matVert,
+                                                          const MatrixX3i& matTris,
+                                                          int iNumLevels,
+                                                          double dReduction,
+                                                          int iMinNumTris)
+{
+    QList<MatrixX3i> lLevels;
+
+    const int iNumVert = matVert.rows();
+    const int iNumTris = matTris.rows();
+
+    if(iNumLevels < 1 || dReduction <= 0.0 || dReduction >= 1.0 || iNumTris * dReduction < iMinNumTris) {
+        return lLevels;
+    }
+
+    if(matTris.size() > 0 && (matTris.minCoeff() < 0 || matTris.maxCoeff() >= iNumVert)) {
+        qDebug() << "MeshSimplification::createLevelsOfDetail - Triangles reference vertices which do not exist. Returning ...";
+        return lLevels;
+    }
+
+    MatrixX3i matCurTris = matTris;
+    std::vector<bool> vecTriAlive(iNumTris, true);
+    std::vector<std::vector<int> > vecVertTris(iNumVert);
+
+    //Each vertex gets the area weighted sum of the plane quadrics of its triangles
+    Matrix<double, Dynamic, 10> matQuadrics = Matrix<double, Dynamic, 10>::Zero(iNumVert, 10);
+
+    for(int t = 0; t < iNumTris; ++t) {
+        const Vector3d p0 = matVert.row(matTris(t,0)).transpose().cast<double>();
+        const Vector3d p1 = matVert.row(matTris(t,1)).transpose().cast<double>();
+        const Vector3d p2 = matVert.row(matTris(t,2)).transpose().cast<double>();
+
+        Vector3d n = (p1 - p0).cross(p2 - p0);
+        const double dArea2 = n.norm();
+
+        if(dArea2 > 0.0) {
+            n /= dArea2;
+            const double d = -n.dot(p0);
+
+            Matrix<double, 1, 10> vecQuadric;
+            vecQuadric << n(0)*n(0), n(0)*n(1), n(0)*n(2), n(0)*d, n(1)*n(1), n(1)*n(2), n(1)*d, n(2)*n(2), n(2)*d, d*d;
+            vecQuadric *= 0.5 * dArea2;
+
+            for(int j = 0; j < 3; ++j) {
+                matQuadrics.row(matTris(t,j)) += vecQuadric;
+            }
+        }
+
+        for(int j = 0; j < 3; ++j) {
+            vecVertTris[matTris(t,j)].push_back(t);
+        }
+    }
+
+    //-1 marks removed vertices
+    std::vector<int> vecStamp(iNumVert, 0);
+
+    std::priority_queue<CollapseCandidate> queue;
+
+    //Collects the neighbors of a vertex from its remaining triangles
+    std::vector<int> vecNeighbors, vecNeighborsOther;
+    auto collectNeighbors = [&](int v, std::vector<int>& vecOut) {
+        vecOut.clear();
+        for(size_t k = 0; k < vecVertTris[v].size(); ++k) {
+            const int t = vecVertTris[v][k];
+            if(!vecTriAlive[t]) {
+                continue;
+            }
+            for(int j = 0; j < 3; ++j) {
+                if(matCurTris(t,j) != v) {
+                    vecOut.push_back(matCurTris(t,j));
+                }
+            }
+        }
+        std::sort(vecOut.begin(), vecOut.end());
+        vecOut.erase(std::unique(vecOut.begin(), vecOut.end()), vecOut.end());
+    };
+
+    auto pushCandidate = [&](int iFrom, int iTo) {
+        CollapseCandidate candidate;
+        candidate.dCost = quadricError(matQuadrics.row(iFrom) + matQuadrics.row(iTo), matVert.row(iTo).transpose().cast<double>());
+        candidate.iFrom = iFrom;
+        candidate.iTo = iTo;
+        candidate.iStampFrom = vecStamp[iFrom];
+        candidate.iStampTo = vecStamp[iTo];
+        queue.push(candidate);
+    };
+
+    //Every edge of a closed, consistently oriented mesh appears once with ascending vertex order
+    for(int t = 0; t < iNumTris; ++t) {
+        for(int j = 0; j < 3; ++j) {
+            const int a = matTris(t,j);
+            const int b = matTris(t,(j+1)%3);
+            if(a < b) {
+                pushCandidate(a, b);
+                pushCandidate(b, a);
+            }
+        }
+    }
+
+    int iNumAlive = iNumTris;
+    int iNumLastLevel = iNumTris;
+
+    for(int iLevel = 0; iLevel < iNumLevels; ++iLevel) {
+        const int iTarget = (int)(iNumLastLevel * dReduction);
+        if(iTarget < iMinNumTris) {
+            break;
+        }
+
+        while(iNumAlive > iTarget && !queue.empty()) {
+            const CollapseCandidate candidate = queue.top();
+            queue.pop();
+
+            const int u = candidate.iFrom;
+            const int v = candidate.iTo;
+
+            if(vecStamp[u] != candidate.iStampFrom || vecStamp[v] != candidate.iStampTo) {
+                continue;
+            }
+
+            //Link condition: the edge must only be shared by the triangles adjacent to it, otherwise the collapse
+            //would produce a non-manifold mesh
+            collectNeighbors(u, vecNeighbors);
+            collectNeighbors(v, vecNeighborsOther);
+
+            std::vector<int> vecCommon;
+            std::set_intersection(vecNeighbors.begin(), vecNeighbors.end(),
+                                  vecNeighborsOther.begin(), vecNeighborsOther.end(),
+                                  std::back_inserter(vecCommon));
+
+            int iNumShared = 0;
+            bool bValid = true;
+            const Vector3d pTo = matVert.row(v).transpose().cast<double>();
+
+            for(size_t k = 0; k < vecVertTris[u].size() && bValid; ++k) {
+                const int t = vecVertTris[u][k];
+                if(!vecTriAlive[t]) {
+                    continue;
+                }
+
+                if(matCurTris(t,0) == v || matCurTris(t,1) == v || matCurTris(t,2) == v) {
+                    ++iNumShared;
+                    continue;
+                }
+
+                //Reject collapses which fold over or strongly tilt a remaining triangle
+                Vector3d p[3], pNew[3];
+                for(int j = 0; j < 3; ++j) {
+                    p[j] = matVert.row(matCurTris(t,j)).transpose().cast<double>();
+                    pNew[j] = matCurTris(t,j) == u ? pTo : p[j];
+                }
+
+                const Vector3d nOld = (p[1] - p[0]).cross(p[2] - p[0]);
+                const Vector3d nNew = (pNew[1] - pNew[0]).cross(pNew[2] - pNew[0]);
+
+                if(nNew.squaredNorm() == 0.0 || nOld.dot(nNew) < 0.2 * nOld.norm() * nNew.norm()) {
+                    bValid = false;
+                }
+            }
+
+            if(!bValid || iNumShared == 0 || (int)vecCommon.size() != iNumShared) {
+                continue;
+            }
+
+            //Collapse u onto v
+            for(size_t k = 0; k < vecVertTris[u].size(); ++k) {
+                const int t = vecVertTris[u][k];
+                if(!vecTriAlive[t]) {
+                    continue;
+                }
+
+                if(matCurTris(t,0) == v || matCurTris(t,1) == v || matCurTris(t,2) == v) {
+                    vecTriAlive[t] = false;
+                    --iNumAlive;
+                } else {
+                    for(int j = 0; j < 3; ++j) {
+                        if(matCurTris(t,j) == u) {
+                            matCurTris(t,j) = v;
+                        }
+                    }
+                    vecVertTris[v].push_back(t);
+                }
+            }
+
+            matQuadrics.row(v) += matQuadrics.row(u);
+            std::vector<int>().swap(vecVertTris[u]);
+            vecStamp[u] = -1;
+            ++vecStamp[v];
+
+            std::vector<int>& vecTrisV = vecVertTris[v];
+            vecTrisV.erase(std::remove_if(vecTrisV.begin(), vecTrisV.end(),
+                                          [&](int t) { return !vecTriAlive[t]; }), vecTrisV.end());
+
+            //The costs of all edges of v changed
+            collectNeighbors(v, vecNeighbors);
+            for(size_t k = 0; k < vecNeighbors.size(); ++k) {
+                pushCandidate(vecNeighbors[k], v);
+                pushCandidate(v, vecNeighbors[k]);
+            }
+        }
+
+        if(iNumAlive >= iNumLastLevel) {
+            break;
+        }
+
+        MatrixX3i matLevelTris(iNumAlive, 3);
+        int iRow = 0;
+        for(int t = 0; t < iNumTris; ++t) {
+            if(vecTriAlive[t]) {
+                matLevelTris.row(iRow++) = matCurTris.row(t);
+            }
+        }
+
+        lLevels.append(matLevelTris);
+        iNumLastLevel = iNumAlive;
+
+        if(queue.empty()) {
+            break;
+        }
+    }
+
+    return lLevels;
+}
+
+
+//*************************************************************************************************************
+
+double MeshSimplification::quadricError(const Matrix<double, 1, 10>& vecQuadric, const Vector3d& vecPos)
+{
+    const double x = vecPos(0);
+    const double y = vecPos(1);
+    const double z = vecPos(2);
+
+    return vecQuadric(0)*x*x + 2.0*vecQuadric(1)*x*y + 2.0*vecQuadric(2)*x*z + 2.0*vecQuadric(3)*x
+         + vecQuadric(4)*y*y + 2.0*vecQuadric(5)*y*z + 2.0*vecQuadric(6)*y
+         + vecQuadric(7)*z*z + 2.0*vecQuadric(8)*z
+         + vecQuadric(9);
+}
@@ -0,0 +1,115 @@
+//=============================================================================================================
+/**
+* @file     meshsimplification.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     MeshSimplification class declaration.
+*
+*/
+
+#ifndef MESHSIMPLIFICATION_H
+#define MESHSIMPLIFICATION_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../disp3D_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE DISP3DLIB
+//=============================================================================================================
+
+namespace DISP3DLIB
+{
+
+//=============================================================================================================
+/**
+* Simplifies triangle meshes by quadric error edge collapses. Each edge collapse moves one vertex onto its neighbor,
+* so the simplified triangulations only reference vertices of the original mesh. Thereby all levels of detail can be
+* drawn with the original vertex, normal and color buffers, only the index buffer is exchanged.
+*
+* @brief Quadric edge collapse mesh simplification.
+*/
+class DISP3DNEWSHARED_EXPORT MeshSimplification
+{
+public:
+    //=========================================================================================================
+    /**
+    * Creates successively coarser triangulations of a mesh.
+    *
+    * @param[in] matVert        The vertex positions.
+    * @param[in] matTris        The triangles of the full resolution mesh.
+    * @param[in] iNumLevels     The maximal number of levels to create.
+    * @param[in] dReduction     The ratio of the number of triangles of two successive levels.
+    * @param[in] iMinNumTris    No level with less triangles than this is created.
+    *
+    * @return the triangulations ordered from fine to coarse, the full resolution mesh is not part of the list.
+    */
+    static QList<Eigen::MatrixX3i> createLevelsOfDetail(const Eigen::MatrixX3f& matVert,
+                                                        const Eigen::MatrixX3i& matTris,
+                                                        int iNumLevels = 3,
+                                                        double dReduction = 0.25,
+                                                        int iMinNumTris = 2000);
+
+private:
+    //=========================================================================================================
+    /**
+    * Evaluates the quadric error of a vertex position.
+    *
+    * @param[in] vecQuadric     The quadric in the form (a², ab, ac, ad, b², bc, bd, c², cd, d²).
+    * @param[in] vecPos         The vertex position.
+    *
+    * @return the quadric error.
+    */
+    static double quadricError(const Eigen::Matrix<double, 1, 10>& vecQuadric, const Eigen::Vector3d& vecPos);
+};
+
+} // NAMESPACE DISP3DLIB
+
+#endif // MESHSIMPLIFICATION_H
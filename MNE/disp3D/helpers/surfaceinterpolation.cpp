@@ -0,0 +1,345 @@
+//=============================================================================================================
+/**
+* @file     surfaceinterpolation.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     SurfaceInterpolation class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "surfaceinterpolation.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <queue>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISP3DLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define INTERPOLATION_FILE_MAGIC    0x494d4154  //"IMAT"
+#define INTERPOLATION_FILE_VERSION  1
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+SparseMatrix<double> SurfaceInterpolation::createInterpolationMat(const MatrixX3f& matVertPos,
+                                                                  const QList<QPair<int, QVector<int> > >& lNeighborVert,
+                                                                  const VectorXi& vecSourceVertNo,
+                                                                  double dCancelDist)
+{
+    const int iNumVert = matVertPos.rows();
+    const int iNumSources = vecSourceVertNo.rows();
+
+    SparseMatrix<double> matOperator(iNumVert, iNumSources);
+
+    if(lNeighborVert.size() != iNumVert) {
+        qDebug() << "SurfaceInterpolation::createInterpolationMat - Neighbor information does not match the number of vertices. Returning ...";
+        return matOperator;
+    }
+
+    //Source index of each vertex, -1 for vertices without a source
+    VectorXi vecSourceIdx = VectorXi::Constant(iNumVert, -1);
+    for(int j = 0; j < iNumSources; ++j) {
+        if(vecSourceVertNo(j) >= 0 && vecSourceVertNo(j) < iNumVert) {
+            vecSourceIdx(vecSourceVertNo(j)) = j;
+        }
+    }
+
+    typedef Triplet<double> T;
+    std::vector<T> tripletList;
+    tripletList.reserve(iNumVert * 8);
+
+    //Distances are kept between the runs, only the visited vertices are reset
+    std::vector<float> vecDist(iNumVert, std::numeric_limits<float>::max());
+    std::vector<int> vecVisited;
+
+    typedef std::pair<float, int> DistVert;
+    std::priority_queue<DistVert, std::vector<DistVert>, std::greater<DistVert> > queue;
+
+    //Bounded Dijkstra from each source
+    for(int j = 0; j < iNumSources; ++j) {
+        const int iSourceVert = vecSourceVertNo(j);
+        if(iSourceVert < 0 || iSourceVert >= iNumVert || vecSourceIdx(iSourceVert) != j) {
+            continue;
+        }
+
+        vecDist[iSourceVert] = 0.0f;
+        vecVisited.push_back(iSourceVert);
+        queue.push(DistVert(0.0f, iSourceVert));
+
+        while(!queue.empty()) {
+            DistVert current = queue.top();
+            queue.pop();
+
+            const int v = current.second;
+            if(current.first > vecDist[v]) {
+                continue;
+            }
+
+            if(v == iSourceVert) {
+                //Vertices with a source of their own show exactly that source
+                tripletList.push_back(T(v, j, 1.0));
+            } else if(vecSourceIdx(v) < 0) {
+                //All other vertices are weighted by the inverse distance to the reachable sources
+                tripletList.push_back(T(v, j, 1.0 / qMax(current.first, 1e-6f)));
+            }
+
+            const QVector<int>& vecNeighbors = lNeighborVert.at(v).second;
+            for(int k = 0; k < vecNeighbors.size(); ++k) {
+                const int n = vecNeighbors[k];
+                float fDist = current.first + (matVertPos.row(n) - matVertPos.row(v)).norm();
+
+                if(fDist <= dCancelDist && fDist < vecDist[n]) {
+                    if(vecDist[n] == std::numeric_limits<float>::max()) {
+                        vecVisited.push_back(n);
+                    }
+                    vecDist[n] = fDist;
+                    queue.push(DistVert(fDist, n));
+                }
+            }
+        }
+
+        for(size_t k = 0; k < vecVisited.size(); ++k) {
+            vecDist[vecVisited[k]] = std::numeric_limits<float>::max();
+        }
+        vecVisited.clear();
+    }
+
+    matOperator.setFromTriplets(tripletList.begin(), tripletList.end());
+
+    //Normalize the weights of each vertex to one
+    VectorXd vecRowSum = matOperator * VectorXd::Ones(iNumSources);
+    for(int i = 0; i < iNumVert; ++i) {
+        if(vecRowSum(i) > 0.0) {
+            vecRowSum(i) = 1.0 / vecRowSum(i);
+        }
+    }
+
+    matOperator = vecRowSum.asDiagonal() * matOperator;
+    matOperator.makeCompressed();
+
+    return matOperator;
+}
+
+
+//*************************************************************************************************************
+
+SparseMatrix<double> SurfaceInterpolation::cachedInterpolationMat(const MatrixX3f& matVertPos,
+                                                                  const QList<QPair<int, QVector<int> > >& lNeighborVert,
+                                                                  const VectorXi& vecSourceVertNo,
+                                                                  double dCancelDist)
+{
+    QString sFileName = cacheFileName(matVertPos, lNeighborVert, vecSourceVertNo, dCancelDist);
+
+    SparseMatrix<double> matOperator;
+    if(readFromFile(sFileName, matOperator, matVertPos.rows(), vecSourceVertNo.rows())) {
+        return matOperator;
+    }
+
+    matOperator = createInterpolationMat(matVertPos, lNeighborVert, vecSourceVertNo, dCancelDist);
+
+    if(matOperator.nonZeros() > 0 && !writeToFile(sFileName, matOperator)) {
+        qDebug() << "SurfaceInterpolation::cachedInterpolationMat - Could not write" << sFileName;
+    }
+
+    return matOperator;
+}
+
+
+//*************************************************************************************************************
+
+bool SurfaceInterpolation::writeToFile(const QString& sFileName, const SparseMatrix<double>& matOperator)
+{
+    QDir().mkpath(QFileInfo(sFileName).absolutePath());
+
+    //Write to a temporary file first so that an interrupted write never leaves a corrupt cache entry behind
+    QFile file(sFileName + ".part");
+    if(!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    SparseMatrix<double> matCompressed = matOperator;
+    matCompressed.makeCompressed();
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << (quint32)INTERPOLATION_FILE_MAGIC << (qint32)INTERPOLATION_FILE_VERSION;
+    stream << (qint32)matCompressed.rows() << (qint32)matCompressed.cols() << (qint32)matCompressed.nonZeros();
+
+    stream.writeRawData(reinterpret_cast<const char*>(matCompressed.outerIndexPtr()), (matCompressed.outerSize() + 1) * sizeof(int));
+    stream.writeRawData(reinterpret_cast<const char*>(matCompressed.innerIndexPtr()), matCompressed.nonZeros() * sizeof(int));
+    stream.writeRawData(reinterpret_cast<const char*>(matCompressed.valuePtr()), matCompressed.nonZeros() * sizeof(double));
+
+    file.close();
+
+    if(stream.status() != QDataStream::Ok) {
+        file.remove();
+        return false;
+    }
+
+    QFile::remove(sFileName);
+    return file.rename(sFileName);
+}
+
+
+//*************************************************************************************************************
+
+bool SurfaceInterpolation::readFromFile(const QString& sFileName, SparseMatrix<double>& matOperator, int iNumVert, int iNumSources)
+{
+    QFile file(sFileName);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 uMagic;
+    qint32 iVersion, iRows, iCols, iNonZeros;
+    stream >> uMagic >> iVersion >> iRows >> iCols >> iNonZeros;
+
+    if(stream.status() != QDataStream::Ok || uMagic != INTERPOLATION_FILE_MAGIC || iVersion != INTERPOLATION_FILE_VERSION
+            || iRows != iNumVert || iCols != iNumSources || iNonZeros < 0) {
+        return false;
+    }
+
+    //The operator is column major, hence there are iCols + 1 outer indices
+    qint64 iExpectedSize = 5 * (qint64)sizeof(qint32) + (iCols + 1) * (qint64)sizeof(int) + iNonZeros * (qint64)(sizeof(int) + sizeof(double));
+    if(file.size() != iExpectedSize) {
+        qDebug() << "SurfaceInterpolation::readFromFile - Unexpected file size of" << sFileName;
+        return false;
+    }
+
+    std::vector<int> vecOuter(iCols + 1);
+    std::vector<int> vecInner(iNonZeros);
+    std::vector<double> vecValues(iNonZeros);
+
+    stream.readRawData(reinterpret_cast<char*>(vecOuter.data()), (iCols + 1) * sizeof(int));
+    stream.readRawData(reinterpret_cast<char*>(vecInner.data()), iNonZeros * sizeof(int));
+    stream.readRawData(reinterpret_cast<char*>(vecValues.data()), iNonZeros * sizeof(double));
+
+    if(stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    //Validate the stored indices before they are handed to Eigen, a corrupt file must not lead to out of bound accesses
+    if(vecOuter[0] != 0 || vecOuter[iCols] != iNonZeros) {
+        qDebug() << "SurfaceInterpolation::readFromFile - Invalid column indices in" << sFileName;
+        return false;
+    }
+
+    for(int j = 0; j < iCols; ++j) {
+        if(vecOuter[j] > vecOuter[j+1]) {
+            qDebug() << "SurfaceInterpolation::readFromFile - Invalid column indices in" << sFileName;
+            return false;
+        }
+
+        //The row indices of each column are strictly increasing and within the vertex count
+        for(int k = vecOuter[j]; k < vecOuter[j+1]; ++k) {
+            if(vecInner[k] < 0 || vecInner[k] >= iRows || (k > vecOuter[j] && vecInner[k] <= vecInner[k-1])) {
+                qDebug() << "SurfaceInterpolation::readFromFile - Invalid row indices in" << sFileName;
+                return false;
+            }
+        }
+    }
+
+    SparseMatrix<double> matRead(iRows, iCols);
+    matRead.resizeNonZeros(iNonZeros);
+
+    std::copy(vecOuter.begin(), vecOuter.end(), matRead.outerIndexPtr());
+    std::copy(vecInner.begin(), vecInner.end(), matRead.innerIndexPtr());
+    std::copy(vecValues.begin(), vecValues.end(), matRead.valuePtr());
+
+    matOperator = matRead;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+QString SurfaceInterpolation::cacheFileName(const MatrixX3f& matVertPos,
+                                            const QList<QPair<int, QVector<int> > >& lNeighborVert,
+                                            const VectorXi& vecSourceVertNo,
+                                            double dCancelDist)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    hash.addData(reinterpret_cast<const char*>(&dCancelDist), sizeof(double));
+    hash.addData(reinterpret_cast<const char*>(matVertPos.data()), matVertPos.size() * sizeof(float));
+    hash.addData(reinterpret_cast<const char*>(vecSourceVertNo.data()), vecSourceVertNo.size() * sizeof(int));
+
+    for(int i = 0; i < lNeighborVert.size(); ++i) {
+        hash.addData(reinterpret_cast<const char*>(lNeighborVert.at(i).second.constData()), lNeighborVert.at(i).second.size() * sizeof(int));
+    }
+
+    return QString("%1/interpolation/%2.imat").arg(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).arg(QString(hash.result().toHex()));
+}
@@ -0,0 +1,158 @@
+//=============================================================================================================
+/**
+* @file     surfaceinterpolation.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     SurfaceInterpolation class declaration.
+*
+*/
+
+#ifndef SURFACEINTERPOLATION_H
+#define SURFACEINTERPOLATION_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../disp3D_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QList>
+#include <QPair>
+#include <QVector>
+#include <QString>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE DISP3DLIB
+//=============================================================================================================
+
+namespace DISP3DLIB
+{
+
+//=============================================================================================================
+/**
+* Creates the sparse operator which spreads source activity to all vertices of a surface. Every surface vertex gets
+* the inverse geodesic distance weighted mean of all sources within a cancel distance. Geodesic distances are
+* approximated by the shortest path along the edges of the triangulation (MNEHemisphere::neighbor_vert).
+* Since building the operator takes a while for high resolution surfaces, it is cached on disk per source space.
+*
+* @brief Sparse interpolation operator from source activity to surface vertices.
+*/
+class DISP3DNEWSHARED_EXPORT SurfaceInterpolation
+{
+public:
+    //=========================================================================================================
+    /**
+    * Creates the interpolation operator.
+    *
+    * @param[in] matVertPos         The positions of all surface vertices.
+    * @param[in] lNeighborVert      The neighboring vertices of each surface vertex.
+    * @param[in] vecSourceVertNo    The surface vertex of each source.
+    * @param[in] dCancelDist        Sources further away than this (in m) do not contribute to a vertex.
+    *
+    * @return the operator of size n_vertices x n_sources, rows of vertices without sources in reach are empty.
+    */
+    static Eigen::SparseMatrix<double> createInterpolationMat(const Eigen::MatrixX3f& matVertPos,
+                                                              const QList<QPair<int, QVector<int> > >& lNeighborVert,
+                                                              const Eigen::VectorXi& vecSourceVertNo,
+                                                              double dCancelDist = 0.01);
+
+    //=========================================================================================================
+    /**
+    * Returns the interpolation operator from the disk cache. If it is not cached yet, it is created and written
+    * to the cache.
+    *
+    * @param[in] matVertPos         The positions of all surface vertices.
+    * @param[in] lNeighborVert      The neighboring vertices of each surface vertex.
+    * @param[in] vecSourceVertNo    The surface vertex of each source.
+    * @param[in] dCancelDist        Sources further away than this (in m) do not contribute to a vertex.
+    *
+    * @return the operator of size n_vertices x n_sources.
+    */
+    static Eigen::SparseMatrix<double> cachedInterpolationMat(const Eigen::MatrixX3f& matVertPos,
+                                                              const QList<QPair<int, QVector<int> > >& lNeighborVert,
+                                                              const Eigen::VectorXi& vecSourceVertNo,
+                                                              double dCancelDist = 0.01);
+
+    //=========================================================================================================
+    /**
+    * Writes an interpolation operator to a binary file.
+    *
+    * @param[in] sFileName      The file name.
+    * @param[in] matOperator    The operator.
+    *
+    * @return true if successful.
+    */
+    static bool writeToFile(const QString& sFileName, const Eigen::SparseMatrix<double>& matOperator);
+
+    //=========================================================================================================
+    /**
+    * Reads an interpolation operator from a binary file written by writeToFile. The file is rejected if its
+    * dimensions do not match or its indices are out of range.
+    *
+    * @param[in] sFileName      The file name.
+    * @param[out] matOperator   The operator.
+    * @param[in] iNumVert       The expected number of vertices, i.e. rows of the operator.
+    * @param[in] iNumSources    The expected number of sources, i.e. columns of the operator.
+    *
+    * @return true if successful.
+    */
+    static bool readFromFile(const QString& sFileName, Eigen::SparseMatrix<double>& matOperator, int iNumVert, int iNumSources);
+
+private:
+    //=========================================================================================================
+    /**
+    * Returns the cache file of an operator. The name is a hash of everything the operator depends on.
+    */
+    static QString cacheFileName(const Eigen::MatrixX3f& matVertPos,
+                                 const QList<QPair<int, QVector<int> > >& lNeighborVert,
+                                 const Eigen::VectorXi& vecSourceVertNo,
+                                 double dCancelDist);
+};
+
+} // NAMESPACE DISP3DLIB
+
+#endif // SURFACEINTERPOLATION_H
@@ -0,0 +1,156 @@
+//=============================================================================================================
+/**
+* @file     triplebuffer.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     TripleBuffer class declaration.
+*
+*/
+
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QAtomicInt>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE DISP3DLIB
+//=============================================================================================================
+
+namespace DISP3DLIB
+{
+
+//=============================================================================================================
+/**
+* Lock-free triple buffer between one producer and one consumer thread. The producer fills the back buffer and
+* publishes it, the consumer picks up the latest published buffer whenever it is ready for a new frame. Frames
+* published in between are dropped, so neither side ever waits for or queues up behind the other.
+*
+* @brief Lock-free latest-value exchange between a producer and a consumer thread
+*/
+template<typename T>
+class TripleBuffer
+{
+public:
+    //=========================================================================================================
+    /**
+    * Creates the triple buffer.
+    */
+    TripleBuffer()
+    : m_qVecSlots(3)
+    , m_iBack(0)
+    , m_iMiddle(1)
+    , m_iFront(2)
+    {
+    }
+
+    //=========================================================================================================
+    /**
+    * Producer: returns the buffer to fill. It is owned by the producer until publish is called.
+    *
+    * @return the back buffer
+    */
+    inline T& backBuffer()
+    {
+        return m_qVecSlots[m_iBack];
+    }
+
+    //=========================================================================================================
+    /**
+    * Producer: publishes the back buffer and takes over the buffer which was published before.
+    *
+    * @return true if the previously published buffer was never fetched, i.e. it was dropped
+    */
+    inline bool publish()
+    {
+        int iOld = m_iMiddle.fetchAndStoreAcqRel(m_iBack | FreshBit);
+        m_iBack = iOld & IndexMask;
+        return iOld & FreshBit;
+    }
+
+    //=========================================================================================================
+    /**
+    * Returns whether a published buffer is waiting to be fetched, only a snapshot if the other thread is active.
+    *
+    * @return true if the consumer did not fetch the latest published buffer yet
+    */
+    inline bool isPending() const
+    {
+        return m_iMiddle.loadAcquire() & FreshBit;
+    }
+
+    //=========================================================================================================
+    /**
+    * Consumer: makes the latest published buffer the front buffer.
+    *
+    * @return false if nothing was published since the last fetch
+    */
+    inline bool fetch()
+    {
+        if(!(m_iMiddle.loadAcquire() & FreshBit))
+            return false;
+
+        int iOld = m_iMiddle.fetchAndStoreAcqRel(m_iFront);
+        m_iFront = iOld & IndexMask;
+        return true;
+    }
+
+    //=========================================================================================================
+    /**
+    * Consumer: returns the buffer fetched last. It is owned by the consumer until the next fetch.
+    *
+    * @return the front buffer
+    */
+    inline T& frontBuffer()
+    {
+        return m_qVecSlots[m_iFront];
+    }
+
+private:
+    enum {
+        IndexMask = 0x3,        /**< Bits of m_iMiddle holding the slot index. */
+        FreshBit = 0x4          /**< Set in m_iMiddle while the middle slot holds an unfetched buffer. */
+    };
+
+    QVector<T>  m_qVecSlots;    /**< The three buffers. */
+    int         m_iBack;        /**< Slot the producer writes to, only accessed by the producer. */
+    QAtomicInt  m_iMiddle;      /**< Slot exchanged between producer and consumer, plus FreshBit. */
+    int         m_iFront;       /**< Slot the consumer reads from, only accessed by the consumer. */
+};
+
+} // NAMESPACE DISP3DLIB
+
+#endif // TRIPLEBUFFER_H
@@ -117,7 +117,8 @@ namespace MetaTreeItemTypes
                     SurfaceTranslateX = QStandardItem::UserType + 117,
                     SurfaceTranslateY = QStandardItem::UserType + 118,
                     SurfaceTranslateZ = QStandardItem::UserType + 119,
-                    PointColor = QStandardItem::UserType + 120};
+                    PointColor = QStandardItem::UserType + 120,
+                    RTDataAverageSkippedSamples = QStandardItem::UserType + 121};
 }
 
 // Model item roles
@@ -178,7 +179,8 @@ namespace MetaTreeItemRoles
                     SurfaceTranslateX = Qt::UserRole + 18,
                     SurfaceTranslateY = Qt::UserRole + 19,
                     SurfaceTranslateZ = Qt::UserRole + 20,
-                    PointColor = Qt::UserRole + 21};
+                    PointColor = Qt::UserRole + 21,
+                    RTDataAverageSkippedSamples = Qt::UserRole + 22};
 }
 
 } //NAMESPACE DISP3DLIB
@@ -40,6 +40,7 @@
 
 #include "rtsourcelocdataworker.h"
 #include "../../helpers/types.h"
+#include "../../helpers/surfaceinterpolation.h"
 
 #include <disp/helpers/colormap.h>
 #include <fs/label.h>
@@ -77,6 +78,14 @@ using namespace DISPLIB;
 using namespace FSLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define COLOR_LUT_SIZE 1024     //Number of entries of the colormap lookup table
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -86,6 +95,7 @@ RtSourceLocDataWorker::RtSourceLocDataWorker(QObject* parent)
 : QThread(parent)
 , m_bIsRunning(false)
 , m_bIsLooping(true)
+, m_bAverageSkippedSamples(false)
 , m_iAverageSamples(1)
 , m_iCurrentSample(0)
 , m_iVisualizationType(Data3DTreeModelItemRoles::VertexBased)
@@ -95,7 +105,9 @@ RtSourceLocDataWorker::RtSourceLocDataWorker(QObject* parent)
 , m_dNormalizationMax(10.0)
 , m_bSurfaceDataIsInit(false)
 , m_bAnnotationDataIsInit(false)
+, m_bInterpolationInfoIsInit(false)
 {
+    updateColorLUT();
 }
 
 
@@ -146,6 +158,13 @@ void RtSourceLocDataWorker::setSurfaceData(const QByteArray& arraySurfaceVertCol
         return;
     }
 
+    //The interpolation operators depend on the source vertices
+    if(m_vecVertNoLeftHemi.rows() != vecVertNoLeftHemi.rows() || m_vecVertNoLeftHemi != vecVertNoLeftHemi
+            || m_vecVertNoRightHemi.rows() != vecVertNoRightHemi.rows() || m_vecVertNoRightHemi != vecVertNoRightHemi) {
+        m_matInterpolationLeftHemi = SparseMatrix<double>();
+        m_matInterpolationRightHemi = SparseMatrix<double>();
+    }
+
     m_arraySurfaceVertColorLeftHemi = arraySurfaceVertColorLeftHemi;
     m_vecVertNoLeftHemi = vecVertNoLeftHemi;
 
@@ -186,6 +205,36 @@ void RtSourceLocDataWorker::setAnnotationData(const Eigen::VectorXi& vecLabelIds
 }
 
 
+//*************************************************************************************************************
+
+void RtSourceLocDataWorker::setInterpolationInfo(const MatrixX3f& matVertPosLeftHemi,
+                                                 const MatrixX3f& matVertPosRightHemi,
+                                                 const QList<QPair<int, QVector<int> > >& lNeighborVertLeftHemi,
+                                                 const QList<QPair<int, QVector<int> > >& lNeighborVertRightHemi)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    if(matVertPosLeftHemi.rows() != lNeighborVertLeftHemi.size() || matVertPosRightHemi.rows() != lNeighborVertRightHemi.size()
+            || lNeighborVertLeftHemi.isEmpty() || lNeighborVertRightHemi.isEmpty()) {
+        qDebug() << "RtSourceLocDataWorker::setInterpolationInfo - Neighbor information is missing or does not match the surface. Returning ...";
+        return;
+    }
+
+    m_matVertPosLeftHemi = matVertPosLeftHemi;
+    m_matVertPosRightHemi = matVertPosRightHemi;
+    m_lNeighborVertLeftHemi = lNeighborVertLeftHemi;
+    m_lNeighborVertRightHemi = lNeighborVertRightHemi;
+
+    m_vecAllVertNoLeftHemi = VectorXi::LinSpaced(matVertPosLeftHemi.rows(), 0, matVertPosLeftHemi.rows() - 1);
+    m_vecAllVertNoRightHemi = VectorXi::LinSpaced(matVertPosRightHemi.rows(), 0, matVertPosRightHemi.rows() - 1);
+
+    m_matInterpolationLeftHemi = SparseMatrix<double>();
+    m_matInterpolationRightHemi = SparseMatrix<double>();
+
+    m_bInterpolationInfoIsInit = true;
+}
+
+
 //*************************************************************************************************************
 
 void RtSourceLocDataWorker::setNumberAverages(const int &iNumAvr)
@@ -219,6 +268,8 @@ void RtSourceLocDataWorker::setColormapType(const QString& sColormapType)
 {
     QMutexLocker locker(&m_qMutex);
     m_sColormap = sColormapType;
+
+    updateColorLUT();
 }
 
 
@@ -233,6 +284,28 @@ void RtSourceLocDataWorker::setNormalization(const QVector3D& vecThresholds)
 }
 
 
+//*************************************************************************************************************
+
+void RtSourceLocDataWorker::setAverageSkippedSamples(bool bAverage)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_bAverageSkippedSamples = bAverage;
+}
+
+
+//*************************************************************************************************************
+
+bool RtSourceLocDataWorker::fetchFrame(QPair<QByteArray, QByteArray>& colorPair)
+{
+    if(!m_frameBuffer.fetch())
+        return false;
+
+    colorPair = m_frameBuffer.frontBuffer();
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 void RtSourceLocDataWorker::setLoop(bool looping)
@@ -271,6 +344,9 @@ void RtSourceLocDataWorker::stop()
 void RtSourceLocDataWorker::run()
 {
     VectorXd t_vecAverage(0,0);
+    VectorXd t_vecFrameSum(0,0);
+    int iNumFrameSamples = 0;
+    bool bAverageSkippedSamples = false;
 
     m_bIsRunning = true;
 
@@ -285,11 +361,23 @@ void RtSourceLocDataWorker::run()
         }
 
         bool doProcessing = false;
+        bool doCreateInterpolation = false;
 
         {
             QMutexLocker locker(&m_qMutex);
             if(!m_lData.isEmpty() && m_lData.size() > 0)
                 doProcessing = true;
+
+            doCreateInterpolation = m_iVisualizationType == Data3DTreeModelItemRoles::SmoothingBased
+                                    && m_bInterpolationInfoIsInit
+                                    && m_bSurfaceDataIsInit
+                                    && m_matInterpolationLeftHemi.rows() == 0;
+
+            bAverageSkippedSamples = m_bAverageSkippedSamples;
+        }
+
+        if(doCreateInterpolation) {
+            createInterpolationMats();
         }
 
         if(doProcessing) {
@@ -325,7 +413,16 @@ void RtSourceLocDataWorker::run()
             if((m_iCurrentSample/1)%m_iAverageSamples == 0) {
                 t_vecAverage /= (double)m_iAverageSamples;
 
-                emit newRtData(performVisualizationTypeCalculation(t_vecAverage));
+                //Average in the samples of the last frame if the display dropped it
+                if(bAverageSkippedSamples && m_frameBuffer.isPending() && t_vecFrameSum.rows() == t_vecAverage.rows()) {
+                    t_vecFrameSum += t_vecAverage;
+                    ++iNumFrameSamples;
+                } else {
+                    t_vecFrameSum = t_vecAverage;
+                    iNumFrameSamples = 1;
+                }
+
+                publishFrame(performVisualizationTypeCalculation(t_vecFrameSum / (double)iNumFrameSamples));
                 t_vecAverage = VectorXd::Zero(t_vecAverage.rows());
             }
 
@@ -352,59 +449,33 @@ QPair<QByteArray, QByteArray> RtSourceLocDataWorker::performVisualizationTypeCal
         return colorPair;
     }
 
-    //Cut out left and right hemisphere from source data
-    VectorXd sourceColorSamplesLeftHemi = sourceColorSamples.segment(0,m_vecVertNoLeftHemi.rows());
-    VectorXd sourceColorSamplesRightHemi = sourceColorSamples.segment(m_vecVertNoLeftHemi.rows()+1,m_vecVertNoRightHemi.rows());
+    //Show the plain source vertices until the interpolation operators are available
+    int iVisualizationType = m_iVisualizationType;
+    if(iVisualizationType == Data3DTreeModelItemRoles::SmoothingBased && m_matInterpolationLeftHemi.rows() == 0) {
+        iVisualizationType = Data3DTreeModelItemRoles::VertexBased;
+    }
 
     //Generate color data for vertices
-    switch(m_iVisualizationType) {
+    switch(iVisualizationType) {
         case Data3DTreeModelItemRoles::VertexBased: {
             if(!m_bSurfaceDataIsInit) {
                 qDebug() << "RtSourceLocDataWorker::performVisualizationTypeCalculation - Surface data was not initialized. Returning ...";
                 return colorPair;
             }
 
-            //Left hemisphere
-            QByteArray arrayCurrentVertColorLeftHemi = m_arraySurfaceVertColorLeftHemi;
-            float *rawArrayCurrentVertColorLeftHemi = reinterpret_cast<float *>(arrayCurrentVertColorLeftHemi.data());
+            //Start from the anatomical colors and overwrite the colors of all active sources in one pass per hemisphere
+            resetVertColors(m_arrayCurrentVertColorLeftHemi, m_arraySurfaceVertColorLeftHemi);
+            transformDataToColor(sourceColorSamples.segment(0, m_vecVertNoLeftHemi.rows()),
+                                 m_vecVertNoLeftHemi,
+                                 m_arrayCurrentVertColorLeftHemi);
 
-            //Create final QByteArray with colors based on the current anatomical information
-            for(int i = 0; i < m_vecVertNoLeftHemi.rows(); ++i) {
-                VectorXd vecActivationLeftHemi(1);
-                vecActivationLeftHemi(0) = sourceColorSamplesLeftHemi(i);
+            resetVertColors(m_arrayCurrentVertColorRightHemi, m_arraySurfaceVertColorRightHemi);
+            transformDataToColor(sourceColorSamples.segment(m_vecVertNoLeftHemi.rows(), m_vecVertNoRightHemi.rows()),
+                                 m_vecVertNoRightHemi,
+                                 m_arrayCurrentVertColorRightHemi);
 
-                if(vecActivationLeftHemi(0) >= m_vecThresholds.x()) {
-                    QByteArray sourceColorSamplesColorLeftHemi = transformDataToColor(vecActivationLeftHemi);
-                    const float *rawSourceColorSamplesColorLeftHemi = reinterpret_cast<const float *>(sourceColorSamplesColorLeftHemi.data());
-
-                    rawArrayCurrentVertColorLeftHemi[m_vecVertNoLeftHemi(i)*3+0] = rawSourceColorSamplesColorLeftHemi[0];
-                    rawArrayCurrentVertColorLeftHemi[m_vecVertNoLeftHemi(i)*3+1] = rawSourceColorSamplesColorLeftHemi[1];
-                    rawArrayCurrentVertColorLeftHemi[m_vecVertNoLeftHemi(i)*3+2] = rawSourceColorSamplesColorLeftHemi[2];
-                }
-            }
-
-            colorPair.first = arrayCurrentVertColorLeftHemi;
-
-            //Right hemisphere
-            QByteArray arrayCurrentVertColorRightHemi = m_arraySurfaceVertColorRightHemi;
-            float *rawArrayCurrentVertColorRightHemi = reinterpret_cast<float *>(arrayCurrentVertColorRightHemi.data());
-
-            //Create final QByteArray with colors based on the current anatomical information
-            for(int i = 0; i < m_vecVertNoRightHemi.rows(); ++i) {
-                VectorXd vecActivationRightHemi(1);
-                vecActivationRightHemi(0) = sourceColorSamplesRightHemi(i);
-
-                if(vecActivationRightHemi(0) >= m_vecThresholds.x()) {
-                    QByteArray sourceColorSamplesColorRightHemi = transformDataToColor(vecActivationRightHemi);
-                    const float *rawSourceColorSamplesColorRightHemi = reinterpret_cast<const float *>(sourceColorSamplesColorRightHemi.data());
-
-                    rawArrayCurrentVertColorRightHemi[m_vecVertNoRightHemi(i)*3+0] = rawSourceColorSamplesColorRightHemi[0];
-                    rawArrayCurrentVertColorRightHemi[m_vecVertNoRightHemi(i)*3+1] = rawSourceColorSamplesColorRightHemi[1];
-                    rawArrayCurrentVertColorRightHemi[m_vecVertNoRightHemi(i)*3+2] = rawSourceColorSamplesColorRightHemi[2];
-                }
-            }
-
-            colorPair.second = arrayCurrentVertColorRightHemi;
+            colorPair.first = m_arrayCurrentVertColorLeftHemi;
+            colorPair.second = m_arrayCurrentVertColorRightHemi;
 
             return colorPair;
         }
@@ -416,6 +487,10 @@ QPair<QByteArray, QByteArray> RtSourceLocDataWorker::performVisualizationTypeCal
                 return colorPair;
             }
 
+            //Cut out left and right hemisphere from source data
+            VectorXd sourceColorSamplesLeftHemi = sourceColorSamples.segment(0,m_vecVertNoLeftHemi.rows());
+            VectorXd sourceColorSamplesRightHemi = sourceColorSamples.segment(m_vecVertNoLeftHemi.rows(),m_vecVertNoRightHemi.rows());
+
             //Find maximum actiavtion for each label
             QMap<qint32, double> vecLabelActivationLeftHemi;
 
@@ -438,69 +513,72 @@ QPair<QByteArray, QByteArray> RtSourceLocDataWorker::performVisualizationTypeCal
 
             //Color all labels respectivley to their activation
             //Left hemisphere
-            QByteArray arrayCurrentVertColorLeftHemi;
-            //arrayCurrentVertColor.resize(m_arraySurfaceVertColor.size());
-            arrayCurrentVertColorLeftHemi = m_arraySurfaceVertColorLeftHemi;
-
-            float *rawArrayCurrentVertColorLeftHemi = reinterpret_cast<float *>(arrayCurrentVertColorLeftHemi.data());
+            resetVertColors(m_arrayCurrentVertColorLeftHemi, m_arraySurfaceVertColorLeftHemi);
+            float *rawArrayCurrentVertColorLeftHemi = reinterpret_cast<float *>(m_arrayCurrentVertColorLeftHemi.data());
 
             for(int i = 0; i<m_lLabelsLeftHemi.size(); i++) {
-                FSLIB::Label labelLeftHemi = m_lLabelsLeftHemi.at(i);
-
-                //Transform label activations to rgb colors
-                VectorXd vecActivationLeftHemi(1);
-                vecActivationLeftHemi(0) = vecLabelActivationLeftHemi[labelLeftHemi.label_id];
+                const FSLIB::Label& labelLeftHemi = m_lLabelsLeftHemi.at(i);
 
                 //Check if value is bigger than lower threshold. If not, don't plot activation
-                if(vecActivationLeftHemi(0) >= m_vecThresholds.x()) {
-                    QByteArray arrayLabelColorsLeftHemi = transformDataToColor(vecActivationLeftHemi);
-                    float *rawArrayLabelColorsLeftHemi = reinterpret_cast<float *>(arrayLabelColorsLeftHemi.data());
+                const float *rawLabelColorLeftHemi = colorForValue(vecLabelActivationLeftHemi[labelLeftHemi.label_id]);
 
+                if(rawLabelColorLeftHemi) {
                     for(int j = 0; j<labelLeftHemi.vertices.rows(); j++) {
-                        rawArrayCurrentVertColorLeftHemi[labelLeftHemi.vertices(j)*3+0] = rawArrayLabelColorsLeftHemi[0];
-                        rawArrayCurrentVertColorLeftHemi[labelLeftHemi.vertices(j)*3+1] = rawArrayLabelColorsLeftHemi[1];
-                        rawArrayCurrentVertColorLeftHemi[labelLeftHemi.vertices(j)*3+2] = rawArrayLabelColorsLeftHemi[2];
+                        rawArrayCurrentVertColorLeftHemi[labelLeftHemi.vertices(j)*3+0] = rawLabelColorLeftHemi[0];
+                        rawArrayCurrentVertColorLeftHemi[labelLeftHemi.vertices(j)*3+1] = rawLabelColorLeftHemi[1];
+                        rawArrayCurrentVertColorLeftHemi[labelLeftHemi.vertices(j)*3+2] = rawLabelColorLeftHemi[2];
                     }
                 }
             }
 
-            colorPair.first = arrayCurrentVertColorLeftHemi;
+            colorPair.first = m_arrayCurrentVertColorLeftHemi;
 
             //Right hemisphere
-            QByteArray arrayCurrentVertColorRightHemi;
-            //arrayCurrentVertColor.resize(m_arraySurfaceVertColor.size());
-            arrayCurrentVertColorRightHemi = m_arraySurfaceVertColorRightHemi;
-
-            float *rawArrayCurrentVertColorRightHemi = reinterpret_cast<float *>(arrayCurrentVertColorRightHemi.data());
+            resetVertColors(m_arrayCurrentVertColorRightHemi, m_arraySurfaceVertColorRightHemi);
+            float *rawArrayCurrentVertColorRightHemi = reinterpret_cast<float *>(m_arrayCurrentVertColorRightHemi.data());
 
             for(int i = 0; i<m_lLabelsRightHemi.size(); i++) {
-                FSLIB::Label labelRightHemi = m_lLabelsRightHemi.at(i);
-
-                //Transform label activations to rgb colors
-                VectorXd vecActivationRightHemi(1);
-                vecActivationRightHemi(0) = vecLabelActivationRightHemi[labelRightHemi.label_id];
+                const FSLIB::Label& labelRightHemi = m_lLabelsRightHemi.at(i);
 
                 //Check if value is bigger than lower threshold. If not, don't plot activation
-                if(vecActivationRightHemi(0) >= m_vecThresholds.x()) {
-                    QByteArray arrayLabelColorsRightHemi = transformDataToColor(vecActivationRightHemi);
-                    float *rawArrayLabelColorsRightHemi = reinterpret_cast<float *>(arrayLabelColorsRightHemi.data());
+                const float *rawLabelColorRightHemi = colorForValue(vecLabelActivationRightHemi[labelRightHemi.label_id]);
 
+                if(rawLabelColorRightHemi) {
                     for(int j = 0; j<labelRightHemi.vertices.rows(); j++) {
-                        rawArrayCurrentVertColorRightHemi[labelRightHemi.vertices(j)*3+0] = rawArrayLabelColorsRightHemi[0];
-                        rawArrayCurrentVertColorRightHemi[labelRightHemi.vertices(j)*3+1] = rawArrayLabelColorsRightHemi[1];
-                        rawArrayCurrentVertColorRightHemi[labelRightHemi.vertices(j)*3+2] = rawArrayLabelColorsRightHemi[2];
+                        rawArrayCurrentVertColorRightHemi[labelRightHemi.vertices(j)*3+0] = rawLabelColorRightHemi[0];
+                        rawArrayCurrentVertColorRightHemi[labelRightHemi.vertices(j)*3+1] = rawLabelColorRightHemi[1];
+                        rawArrayCurrentVertColorRightHemi[labelRightHemi.vertices(j)*3+2] = rawLabelColorRightHemi[2];
                     }
                 }
             }
 
-            colorPair.second = arrayCurrentVertColorRightHemi;
+            colorPair.second = m_arrayCurrentVertColorRightHemi;
 
             return colorPair;
         }        
 
         case Data3DTreeModelItemRoles::SmoothingBased: {
-            //TODO: Smooth here!
-            break;
+            //Spread the sources to all surface vertices with one sparse matrix vector product per hemisphere
+            if(m_matInterpolationLeftHemi.rows() * 3 * (int)sizeof(float) != m_arraySurfaceVertColorLeftHemi.size()
+                    || m_matInterpolationRightHemi.rows() * 3 * (int)sizeof(float) != m_arraySurfaceVertColorRightHemi.size()) {
+                qDebug() << "RtSourceLocDataWorker::performVisualizationTypeCalculation - Interpolation operator does not match the surface. Returning ...";
+                return colorPair;
+            }
+
+            resetVertColors(m_arrayCurrentVertColorLeftHemi, m_arraySurfaceVertColorLeftHemi);
+            transformDataToColor(m_matInterpolationLeftHemi * sourceColorSamples.segment(0, m_vecVertNoLeftHemi.rows()),
+                                 m_vecAllVertNoLeftHemi,
+                                 m_arrayCurrentVertColorLeftHemi);
+
+            resetVertColors(m_arrayCurrentVertColorRightHemi, m_arraySurfaceVertColorRightHemi);
+            transformDataToColor(m_matInterpolationRightHemi * sourceColorSamples.segment(m_vecVertNoLeftHemi.rows(), m_vecVertNoRightHemi.rows()),
+                                 m_vecAllVertNoRightHemi,
+                                 m_arrayCurrentVertColorRightHemi);
+
+            colorPair.first = m_arrayCurrentVertColorLeftHemi;
+            colorPair.second = m_arrayCurrentVertColorRightHemi;
+
+            return colorPair;
         }
     }
 
@@ -510,99 +588,144 @@ QPair<QByteArray, QByteArray> RtSourceLocDataWorker::performVisualizationTypeCal
 
 //*************************************************************************************************************
 
-QByteArray RtSourceLocDataWorker::transformDataToColor(const VectorXd& data)
+void RtSourceLocDataWorker::transformDataToColor(const VectorXd& data, const VectorXi& vecVertNo, QByteArray& arrayVertColor) const
 {
     //Note: This function needs to be implemented extremley efficient
-    QByteArray arrayColor;
-    int idxColor = 0;
-
-    if(m_sColormap == "Hot Negative 1") {
-        arrayColor.resize(data.rows() * 3 * (int)sizeof(float));
-        float *rawArrayColors = reinterpret_cast<float *>(arrayColor.data());
+    if(m_vecColorLUT.isEmpty())
+        return;
 
-        for(int r = 0; r < data.rows(); ++r) {
-            float dSample = data(r);
+    //Threshold and normalize all samples to LUT indices in one vectorized pass
+    const float fLower = m_vecThresholds.x();
+    const float fUpper = m_vecThresholds.z();
+    const float fScale = fUpper > fLower ? (COLOR_LUT_SIZE - 1) / (fUpper - fLower) : 0.0f;
 
-            //Check lower and upper thresholds and normalize to one
-            if(dSample > m_vecThresholds.z()) {
-                dSample = 1.0;
-            } else if(dSample < m_vecThresholds.x()) {
-                dSample = 0.0;
-            } else {
-                dSample = (dSample - m_vecThresholds.x()) / (m_vecThresholds.z() - m_vecThresholds.x());
-            }
+    ArrayXf vecNormalized = data.array().cast<float>();
+    ArrayXi vecLUTIdx = ((vecNormalized - fLower) * fScale).max(0.0f).min(float(COLOR_LUT_SIZE - 1)).cast<int>();
 
-//            qDebug() << "dSample" << dSample;
-//            qDebug() << "data(r)" << data(r);
-//            qDebug() << "m_vecThresholds" << m_vecThresholds;
+    //Only sources above the lower threshold are colored, all others keep their anatomical color
+    const float *rawLUT = m_vecColorLUT.constData();
+    float *rawArrayVertColor = reinterpret_cast<float *>(arrayVertColor.data());
 
-            QRgb qRgb;
-            qRgb = ColorMap::valueToHotNegative1(dSample);
+    for(int i = 0; i < vecNormalized.rows(); ++i) {
+        if(vecNormalized(i) >= fLower) {
+            const float *rawColor = rawLUT + vecLUTIdx(i)*3;
+            float *rawVertColor = rawArrayVertColor + vecVertNo(i)*3;
 
-            QColor colSample(qRgb);
-            rawArrayColors[idxColor++] = colSample.redF();
-            rawArrayColors[idxColor++] = colSample.greenF();
-            rawArrayColors[idxColor++] = colSample.blueF();
+            rawVertColor[0] = rawColor[0];
+            rawVertColor[1] = rawColor[1];
+            rawVertColor[2] = rawColor[2];
         }
-
-        return arrayColor;
     }
+}
 
-    if(m_sColormap == "Hot Negative 2") {
-        arrayColor.resize(data.rows() * 3 * (int)sizeof(float));
-        float *rawArrayColors = reinterpret_cast<float *>(arrayColor.data());
 
-        for(int r = 0; r < data.rows(); ++r) {
-            float dSample = data(r);
+//*************************************************************************************************************
 
-            //Check lower and upper thresholds and normalize to one
-            if(dSample > m_vecThresholds.z()) {
-                dSample = 1.0;
-            } else if(dSample < m_vecThresholds.x()) {
-                dSample = 0.0;
-            } else {
-                dSample = (dSample - m_vecThresholds.x()) / (m_vecThresholds.z() - m_vecThresholds.x());
-            }
+const float* RtSourceLocDataWorker::colorForValue(double dValue) const
+{
+    const float fLower = m_vecThresholds.x();
+    const float fUpper = m_vecThresholds.z();
 
-            QRgb qRgb;
-            qRgb = ColorMap::valueToHotNegative2(dSample);
+    if(m_vecColorLUT.isEmpty() || dValue < fLower)
+        return Q_NULLPTR;
 
-            QColor colSample(qRgb);
-            rawArrayColors[idxColor++] = colSample.redF();
-            rawArrayColors[idxColor++] = colSample.greenF();
-            rawArrayColors[idxColor++] = colSample.blueF();
-        }
+    int iIdx = COLOR_LUT_SIZE - 1;
+    if(fUpper > fLower && dValue < fUpper)
+        iIdx = int((dValue - fLower) / (fUpper - fLower) * (COLOR_LUT_SIZE - 1));
+
+    return m_vecColorLUT.constData() + iIdx*3;
+}
+
+
+//*************************************************************************************************************
+
+void RtSourceLocDataWorker::publishFrame(const QPair<QByteArray, QByteArray>& colorPair)
+{
+    //Copy instead of sharing, so that the worker's color buffers stay detached and are reused for the next frame
+    QPair<QByteArray, QByteArray>& frame = m_frameBuffer.backBuffer();
+    resetVertColors(frame.first, colorPair.first);
+    resetVertColors(frame.second, colorPair.second);
+
+    m_frameBuffer.publish();
+}
 
-        return arrayColor;
+
+//*************************************************************************************************************
+
+void RtSourceLocDataWorker::resetVertColors(QByteArray& arrayVertColor, const QByteArray& arraySurfaceVertColor) const
+{
+    //Reuse the buffer of the last sample if nobody holds a reference to it anymore, otherwise this detaches once
+    if(arrayVertColor.size() != arraySurfaceVertColor.size())
+        arrayVertColor.resize(arraySurfaceVertColor.size());
+
+    memcpy(arrayVertColor.data(), arraySurfaceVertColor.constData(), arraySurfaceVertColor.size());
+}
+
+
+//*************************************************************************************************************
+
+void RtSourceLocDataWorker::updateColorLUT()
+{
+    QRgb (*valueToColor)(double) = Q_NULLPTR;
+
+    if(m_sColormap == "Hot Negative 1") {
+        valueToColor = &ColorMap::valueToHotNegative1;
+    } else if(m_sColormap == "Hot Negative 2") {
+        valueToColor = &ColorMap::valueToHotNegative2;
+    } else if(m_sColormap == "Hot") {
+        valueToColor = &ColorMap::valueToHot;
     }
 
-    if(m_sColormap == "Hot") {
-        arrayColor.resize(data.rows() * 3 * (int)sizeof(float));
-        float *rawArrayColors = reinterpret_cast<float *>(arrayColor.data());
+    if(!valueToColor) {
+        qDebug() << "RtSourceLocDataWorker::updateColorLUT - Unknown colormap" << m_sColormap;
+        m_vecColorLUT.clear();
+        return;
+    }
 
-        for(int r = 0; r < data.rows(); ++r) {
-            float dSample = data(r);
+    m_vecColorLUT.resize(COLOR_LUT_SIZE * 3);
 
-            //Check lower and upper thresholds and normalize to one
-            if(dSample > m_vecThresholds.z()) {
-                dSample = 1.0;
-            } else if(dSample < m_vecThresholds.x()) {
-                dSample = 0.0;
-            } else {
-                dSample = (dSample - m_vecThresholds.x()) / (m_vecThresholds.z() - m_vecThresholds.x());
-            }
+    for(int i = 0; i < COLOR_LUT_SIZE; ++i) {
+        QColor colSample(valueToColor(double(i) / (COLOR_LUT_SIZE - 1)));
+        m_vecColorLUT[i*3+0] = colSample.redF();
+        m_vecColorLUT[i*3+1] = colSample.greenF();
+        m_vecColorLUT[i*3+2] = colSample.blueF();
+    }
+}
 
-            QRgb qRgb;
-            qRgb = ColorMap::valueToHot(dSample);
 
-            QColor colSample(qRgb);
-            rawArrayColors[idxColor++] = colSample.redF();
-            rawArrayColors[idxColor++] = colSample.greenF();
-            rawArrayColors[idxColor++] = colSample.blueF();
-        }
+//*************************************************************************************************************
 
-        return arrayColor;
+void RtSourceLocDataWorker::createInterpolationMats()
+{
+    m_qMutex.lock();
+    MatrixX3f matVertPosLeftHemi = m_matVertPosLeftHemi;
+    MatrixX3f matVertPosRightHemi = m_matVertPosRightHemi;
+    QList<QPair<int, QVector<int> > > lNeighborVertLeftHemi = m_lNeighborVertLeftHemi;
+    QList<QPair<int, QVector<int> > > lNeighborVertRightHemi = m_lNeighborVertRightHemi;
+    VectorXi vecVertNoLeftHemi = m_vecVertNoLeftHemi;
+    VectorXi vecVertNoRightHemi = m_vecVertNoRightHemi;
+    m_qMutex.unlock();
+
+    QTime timer;
+    timer.start();
+
+    SparseMatrix<double> matInterpolationLeftHemi = SurfaceInterpolation::cachedInterpolationMat(matVertPosLeftHemi,
+                                                                                                 lNeighborVertLeftHemi,
+                                                                                                 vecVertNoLeftHemi);
+    SparseMatrix<double> matInterpolationRightHemi = SurfaceInterpolation::cachedInterpolationMat(matVertPosRightHemi,
+                                                                                                  lNeighborVertRightHemi,
+                                                                                                  vecVertNoRightHemi);
+
+    qDebug() << "RtSourceLocDataWorker::createInterpolationMats - Interpolation operators ready after" << timer.elapsed() << "msecs";
+
+    QMutexLocker locker(&m_qMutex);
+
+    //Drop the result if the source vertices changed in the meantime
+    if(vecVertNoLeftHemi.rows() != m_vecVertNoLeftHemi.rows() || vecVertNoLeftHemi != m_vecVertNoLeftHemi
+            || vecVertNoRightHemi.rows() != m_vecVertNoRightHemi.rows() || vecVertNoRightHemi != m_vecVertNoRightHemi) {
+        return;
     }
 
-    return arrayColor;
+    m_matInterpolationLeftHemi = matInterpolationLeftHemi;
+    m_matInterpolationRightHemi = matInterpolationRightHemi;
 }
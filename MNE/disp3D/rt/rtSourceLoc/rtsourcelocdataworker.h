@@ -43,6 +43,7 @@
 
 #include "../../disp3D_global.h"
 #include "../../helpers/types.h"
+#include "../../helpers/triplebuffer.h"
 
 
 //*************************************************************************************************************
@@ -53,6 +54,9 @@
 #include <QThread>
 #include <QMutex>
 #include <QVector3D>
+#include <QVector>
+#include <QList>
+#include <QPair>
 
 
 //*************************************************************************************************************
@@ -60,6 +64,8 @@
 // Eigen INCLUDES
 //=============================================================================================================
 
+#include <Eigen/SparseCore>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -151,6 +157,21 @@ public:
                            const QList<FSLIB::Label>& lLabelsLeftHemi,
                            const QList<FSLIB::Label>& lLabelsRightHemi);
 
+    //=========================================================================================================
+    /**
+    * Set the surface geometry which is needed for the smoothing based visualization. The interpolation operators are
+    * created (or read from the disk cache) by the worker thread the first time they are needed.
+    *
+    * @param[in] matVertPosLeftHemi         The vertex positions of the left hemisphere surface.
+    * @param[in] matVertPosRightHemi        The vertex positions of the right hemisphere surface.
+    * @param[in] lNeighborVertLeftHemi      The neighboring vertices of each left hemisphere surface vertex.
+    * @param[in] lNeighborVertRightHemi     The neighboring vertices of each right hemisphere surface vertex.
+    */
+    void setInterpolationInfo(const Eigen::MatrixX3f& matVertPosLeftHemi,
+                              const Eigen::MatrixX3f& matVertPosRightHemi,
+                              const QList<QPair<int, QVector<int> > >& lNeighborVertLeftHemi,
+                              const QList<QPair<int, QVector<int> > >& lNeighborVertRightHemi);
+
     //=========================================================================================================
     /**
     * Set the number of average to take after emitting the data to the listening threads.
@@ -191,6 +212,26 @@ public:
     */
     void setNormalization(const QVector3D &vecThresholds);
 
+    //=========================================================================================================
+    /**
+    * Set whether the samples of frames which were dropped, because the display did not pick them up in time,
+    * are averaged into the next frame.
+    *
+    * @param[in] bAverage               The new averaging state.
+    */
+    void setAverageSkippedSamples(bool bAverage);
+
+    //=========================================================================================================
+    /**
+    * Fetches the latest frame produced by the worker. This is lock-free and meant to be called by the display once
+    * per rendered frame. Frames which were produced since the last call are dropped.
+    *
+    * @param[out] colorPair             The rgb colors as QByteArray for the left and right hemisphere.
+    *
+    * @return false if no new frame was produced since the last call.
+    */
+    bool fetchFrame(QPair<QByteArray, QByteArray>& colorPair);
+
     //=========================================================================================================
     /**
     * Set the loop functionality on or off.
@@ -226,27 +267,80 @@ private:
 
     //=========================================================================================================
     /**
-    * Transform the data sample values to color values.
+    * Transform the data sample values to color values. All samples are thresholded, normalized and looked up in the
+    * colormap LUT in one pass. Vertices of samples below the lower threshold keep their color.
     *
     * @param[in] data               The data which is to be transformed.
+    * @param[in] vecVertNo          The vertex index of each sample.
+    * @param[in, out] arrayVertColor    The vertex colors (3 floats per vertex) the colors are written to.
+    */
+    void transformDataToColor(const Eigen::VectorXd& data, const Eigen::VectorXi& vecVertNo, QByteArray& arrayVertColor) const;
+
+    //=========================================================================================================
+    /**
+    * Looks up the color of a single value in the colormap LUT.
     *
-    * @return                       Returns the colors in form of a QByteArray.
+    * @param[in] dValue             The value.
+    *
+    * @return                       Pointer to the rgb floats of the LUT entry, NULL if the value is below the lower threshold.
     */
-    QByteArray transformDataToColor(const Eigen::VectorXd& data);
+    const float* colorForValue(double dValue) const;
+
+    //=========================================================================================================
+    /**
+    * Copies a frame into the back buffer of the frame exchange and publishes it to the display.
+    *
+    * @param[in] colorPair          The rgb colors as QByteArray for the left and right hemisphere.
+    */
+    void publishFrame(const QPair<QByteArray, QByteArray>& colorPair);
+
+    //=========================================================================================================
+    /**
+    * Copies the anatomical surface colors into the vertex color buffer, reusing its memory where possible.
+    *
+    * @param[out] arrayVertColor        The vertex color buffer.
+    * @param[in] arraySurfaceVertColor  The anatomical surface colors.
+    */
+    void resetVertColors(QByteArray& arrayVertColor, const QByteArray& arraySurfaceVertColor) const;
+
+    //=========================================================================================================
+    /**
+    * Samples the current colormap into the colormap LUT.
+    */
+    void updateColorLUT();
+
+    //=========================================================================================================
+    /**
+    * Creates the interpolation operators of both hemispheres. The heavy lifting is done without holding the mutex.
+    */
+    void createInterpolationMats();
 
     QMutex                  m_qMutex;                           /**< The thread's mutex. */
 
     QByteArray              m_arraySurfaceVertColorLeftHemi;    /**< The vertex colors for the left hemisphere surface where the data is to be plotted on. */
     QByteArray              m_arraySurfaceVertColorRightHemi;   /**< The vertex colors for the left hemisphere surface where the data is to be plotted on. */
+    QByteArray              m_arrayCurrentVertColorLeftHemi;    /**< The vertex color buffer of the current sample for the left hemisphere. */
+    QByteArray              m_arrayCurrentVertColorRightHemi;   /**< The vertex color buffer of the current sample for the right hemisphere. */
     VectorXi                m_vecVertNoLeftHemi;                /**< Vector with the source vertx indexes for the left hemisphere. */
     VectorXi                m_vecVertNoRightHemi;               /**< Vector with the source vertx indexes for the right hemisphere. */
 
+    Eigen::MatrixX3f                    m_matVertPosLeftHemi;       /**< The vertex positions of the left hemisphere surface. */
+    Eigen::MatrixX3f                    m_matVertPosRightHemi;      /**< The vertex positions of the right hemisphere surface. */
+    QList<QPair<int, QVector<int> > >   m_lNeighborVertLeftHemi;    /**< The neighboring vertices of each left hemisphere surface vertex. */
+    QList<QPair<int, QVector<int> > >   m_lNeighborVertRightHemi;   /**< The neighboring vertices of each right hemisphere surface vertex. */
+    Eigen::SparseMatrix<double>         m_matInterpolationLeftHemi; /**< Spreads the left hemisphere sources to all surface vertices. Empty until created. */
+    Eigen::SparseMatrix<double>         m_matInterpolationRightHemi;/**< Spreads the right hemisphere sources to all surface vertices. Empty until created. */
+    Eigen::VectorXi                     m_vecAllVertNoLeftHemi;     /**< Indices of all left hemisphere surface vertices. */
+    Eigen::VectorXi                     m_vecAllVertNoRightHemi;    /**< Indices of all right hemisphere surface vertices. */
+
     QList<Eigen::VectorXd>  m_lData;                            /**< List that holds the fiff matrix data <n_channels x n_samples>. */
 
     bool                    m_bIsRunning;                       /**< Flag if this thread is running. */
     bool                    m_bIsLooping;                       /**< Flag if this thread should repeat sending the same data over and over again. */
+    bool                    m_bAverageSkippedSamples;           /**< Flag if the samples of dropped frames are averaged into the next frame. */
     bool                    m_bSurfaceDataIsInit;               /**< Flag if this thread's surface data was initialized. This flag is used to decide whether specific visualization types can be computed. */
     bool                    m_bAnnotationDataIsInit;            /**< Flag if this thread's annotation data was initialized. This flag is used to decide whether specific visualization types can be computed. */
+    bool                    m_bInterpolationInfoIsInit;         /**< Flag if this thread's interpolation info was initialized. This flag is used to decide whether specific visualization types can be computed. */
 
     int                     m_iAverageSamples;                  /**< Number of average to compute. */
     int                     m_iCurrentSample;                   /**< Number of the current sample which is/was streamed. */
@@ -257,6 +351,7 @@ private:
     double                  m_dNormalizationMax;                /**< Value to normalize to. */
 
     QString                 m_sColormap;                        /**< The type of colormap ("Hot", "Hot Negative 1", etc.). */
+    QVector<float>          m_vecColorLUT;                      /**< The current colormap sampled at equidistant values in [0,1], 3 floats (rgb) per entry. */
 
     QVector3D               m_vecThresholds;                    /**< The threshold values used for normalizing the data. */
 
@@ -265,14 +360,7 @@ private:
     QMap<qint32, qint32>    m_mapLabelIdSourcesLeftHemi;        /**< The sources mapped to their corresponding labels for the left hemisphere. */
     QMap<qint32, qint32>    m_mapLabelIdSourcesRightHemi;       /**< The sources mapped to their corresponding labels for the right hemisphere. */
 
-signals:
-    //=========================================================================================================
-    /**
-    * Emit this signal whenever this item should send a new sample to its listening threads.
-    *
-    * @param[in] colorPair     The samples data in form of a QPair rgb colors as QByteArray.
-    */
-    void newRtData(QPair<QByteArray, QByteArray> colorPair);
+    TripleBuffer<QPair<QByteArray, QByteArray> >    m_frameBuffer;  /**< Hands the latest frame over to the display without locking. */
 };
 
 } // NAMESPACE
@@ -40,6 +40,7 @@
 
 #include "view3D.h"
 #include "helpers/renderable3Dentity.h"
+#include "helpers/custommesh.h"
 #include "helpers/types.h"
 
 #include <mne/mne_sourceestimate.h>
@@ -54,6 +55,8 @@
 #include <QDebug>
 #include <QPropertyAnimation>
 #include <QKeyEvent>
+#include <QResizeEvent>
+#include <QtMath>
 
 #include <Qt3DCore/QAspectEngine>
 #include <Qt3DRender/QCamera>
@@ -162,6 +165,10 @@ void View3D::init()
     this->setRootEntity(m_pRootEntity);
 
     createCoordSystem(m_pRootEntity);
+
+    //Asynchronously loaded data adds new meshes whenever a load task finishes
+    connect(m_pData3DTreeModel.data(), &Data3DTreeModel::loadingProgress,
+            this, &View3D::updateLevelOfDetail);
 }
 
 
@@ -179,7 +186,11 @@ void View3D::initTransformations()
 
 bool View3D::addBrainData(const QString& subject, const QString& set, const SurfaceSet& tSurfaceSet, const AnnotationSet& tAnnotationSet)
 {
-    return m_pData3DTreeModel->addData(subject, set, tSurfaceSet, tAnnotationSet);
+    bool bResult = m_pData3DTreeModel->addData(subject, set, tSurfaceSet, tAnnotationSet);
+
+    updateLevelOfDetail();
+
+    return bResult;
 }
 
 
@@ -187,7 +198,11 @@ bool View3D::addBrainData(const QString& subject, const QString& set, const Surf
 
 bool View3D::addBrainData(const QString& subject, const QString& set, const Surface& tSurface, const Annotation& tAnnotation)
 {
-    return m_pData3DTreeModel->addData(subject, set, tSurface, tAnnotation);
+    bool bResult = m_pData3DTreeModel->addData(subject, set, tSurface, tAnnotation);
+
+    updateLevelOfDetail();
+
+    return bResult;
 }
 
 
@@ -195,7 +210,11 @@ bool View3D::addBrainData(const QString& subject, const QString& set, const Surf
 
 bool View3D::addBrainData(const QString& subject, const QString& set, const MNESourceSpace& tSourceSpace)
 {
-    return m_pData3DTreeModel->addData(subject, set, tSourceSpace);
+    bool bResult = m_pData3DTreeModel->addData(subject, set, tSourceSpace);
+
+    updateLevelOfDetail();
+
+    return bResult;
 }
 
 
@@ -203,7 +222,11 @@ bool View3D::addBrainData(const QString& subject, const QString& set, const MNES
 
 bool View3D::addBrainData(const QString& subject, const QString& set, const MNEForwardSolution& tForwardSolution)
 {
-    return m_pData3DTreeModel->addData(subject, set, tForwardSolution.src);
+    bool bResult = m_pData3DTreeModel->addData(subject, set, tForwardSolution.src);
+
+    updateLevelOfDetail();
+
+    return bResult;
 }
 
 
@@ -219,7 +242,11 @@ QList<BrainRTSourceLocDataTreeItem*> View3D::addRtBrainData(const QString& subje
 
 bool View3D::addBemData(const QString& subject, const QString& set, const MNELIB::MNEBem& tBem)
 {
-    return m_pData3DTreeModel->addData(subject, set, tBem);
+    bool bResult = m_pData3DTreeModel->addData(subject, set, tBem);
+
+    updateLevelOfDetail();
+
+    return bResult;
 }
 
 
@@ -353,10 +380,38 @@ void View3D::wheelEvent(QWheelEvent* e)
     // Transform
     m_pCameraTransform->setTranslation(m_vecCameraTrans);
 
+    updateLevelOfDetail();
+
     Qt3DWindow::wheelEvent(e);
 }
 
 
+//*************************************************************************************************************
+
+void View3D::resizeEvent(QResizeEvent* e)
+{
+    Qt3DWindow::resizeEvent(e);
+
+    updateLevelOfDetail();
+}
+
+
+//*************************************************************************************************************
+
+void View3D::updateLevelOfDetail()
+{
+    //The meshes are centered around the origin the camera looks at, their distance is the camera distance
+    const float fDistance = qMax(m_vecCameraTrans.length(), 0.001f);
+    const float fPixelsPerMeter = this->height() / (2.0f * fDistance * qTan(qDegreesToRadians(m_pCameraEntity->lens()->fieldOfView() * 0.5f)));
+
+    QList<CustomMesh*> lMeshes = m_pRootEntity->findChildren<CustomMesh*>();
+
+    for(int i = 0; i < lMeshes.size(); ++i) {
+        lMeshes.at(i)->selectLevelOfDetail(2.0f * lMeshes.at(i)->boundingRadius() * fPixelsPerMeter);
+    }
+}
+
+
 //*************************************************************************************************************
 
 void View3D::mouseReleaseEvent(QMouseEvent* e)
@@ -281,6 +281,13 @@ protected:
     void wheelEvent(QWheelEvent* e);
     void mouseReleaseEvent(QMouseEvent* e);
     void mouseMoveEvent(QMouseEvent* e);
+    void resizeEvent(QResizeEvent* e);
+
+    //=========================================================================================================
+    /**
+    * Selects the level of detail of all meshes depending on their size on screen.
+    */
+    void updateLevelOfDetail();
 
     //=========================================================================================================
     /**
@@ -617,6 +617,7 @@ namespace FIFFLIB
 //
 #define FIFF_MNE_RT_COMMAND         3700              /**< Fiff Real-Time Command */
 #define FIFF_MNE_RT_CLIENT_ID       3701              /**< Fiff Real-Time mne_t_server client id */
+#define FIFF_MNE_RT_DATA_BUFFER     3702              /**< Fiff Real-Time data buffer encoded according to the client stream profile */
 
 //
 // 3710... Real-Time Blocks
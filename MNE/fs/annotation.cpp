@@ -42,6 +42,7 @@
 #include "annotation.h"
 #include "label.h"
 #include "surface.h"
+#include "fscache.h"
 
 
 //*************************************************************************************************************
@@ -61,6 +62,8 @@
 #include <QFile>
 #include <QDataStream>
 #include <QFileInfo>
+#include <QHash>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -182,6 +185,12 @@ bool Annotation::read(const QString& p_sFileName, Annotation &p_Annotation)
         return false;
     }
 
+    if(FsCache::readAnnotation(p_sFileName, p_Annotation))
+    {
+        printf("\tRead from cache\n[done]\n");
+        return true;
+    }
+
     QDataStream t_Stream(&t_File);
     t_Stream.setByteOrder(QDataStream::BigEndian);
 
@@ -308,6 +317,8 @@ bool Annotation::read(const QString& p_sFileName, Annotation &p_Annotation)
 
     t_File.close();
 
+    FsCache::writeAnnotation(p_sFileName, p_Annotation);
+
     return true;
 }
 
@@ -345,6 +356,11 @@ bool Annotation::toLabels(const Surface &p_surf, QList<Label> &p_qListLabels, QL
 
 //    std::cout << label_ids;
 
+    // map the label ids to their vertices in a single pass over the vertices
+    QHash<qint32, QVector<qint32> > label_vertices;
+    for(qint32 j = 0; j < m_LabelIds.size(); ++j)
+        label_vertices[m_LabelIds[j]].append(j);
+
     qint32 label_id, count;
     RowVector4i label_rgba;
     VectorXi vertices;
@@ -355,21 +371,16 @@ bool Annotation::toLabels(const Surface &p_surf, QList<Label> &p_qListLabels, QL
     {
         label_id = label_ids[i];
         label_rgba = label_rgbas.row(i);
-        count = 0;
-        vertices.resize(m_LabelIds.size());
-        //Where
-        for(qint32 j = 0; j < m_LabelIds.size(); ++j)
-        {
-            if(m_LabelIds[j] == label_id)
-            {
-                vertices[count] = j;
-                ++count;
-            }
-        }
+
         // check if label is part of cortical surface
-        if(count == 0)
+        QHash<qint32, QVector<qint32> >::const_iterator it = label_vertices.constFind(label_id);
+        if(it == label_vertices.constEnd())
             continue;
-        vertices.conservativeResize(count);
+
+        count = it.value().size();
+        vertices.resize(count);
+        for(qint32 j = 0; j < count; ++j)
+            vertices[j] = it.value()[j];
 
         pos.resize(count, 3);
         for(qint32 j = 0; j < count; ++j)
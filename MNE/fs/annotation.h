@@ -86,6 +86,7 @@ using namespace Eigen;
 
 class Label;
 class Surface;
+class FsCache;
 
 
 //=============================================================================================================
@@ -96,6 +97,8 @@ class Surface;
 */
 class FSSHARED_EXPORT Annotation
 {
+    friend class FsCache;
+
 
 public:
     typedef QSharedPointer<Annotation> SPtr;            /**< Shared pointer type for Annotation. */
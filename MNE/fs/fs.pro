@@ -38,6 +38,7 @@ include(../../mne-cpp.pri)
 TEMPLATE = lib
 
 QT       -= gui
+QT       += concurrent
 
 DEFINES += FS_LIBRARY
 
@@ -83,7 +84,8 @@ SOURCES += \
     label.cpp \
     surface.cpp \
     annotationset.cpp \
-    surfaceset.cpp
+    surfaceset.cpp \
+    fscache.cpp
 
 HEADERS += \
     annotation.h\
@@ -92,7 +94,8 @@ HEADERS += \
     label.h \
     surface.h \
     annotationset.h \
-    surfaceset.h
+    surfaceset.h \
+    fscache.h
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
 INCLUDEPATH += $${MNE_INCLUDE_DIR}
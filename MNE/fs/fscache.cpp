@@ -0,0 +1,409 @@
+//=============================================================================================================
+/**
+* @file     fscache.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     FsCache class implementation.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fscache.h"
+#include "surface.h"
+#include "annotation.h"
+#include "label.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define FS_CACHE_MAGIC          0x4d465343  //"MFSC"
+#define FS_CACHE_VERSION        1
+
+#define FS_CACHE_SURFACE        1
+#define FS_CACHE_ANNOTATION     2
+#define FS_CACHE_LABEL          3
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC MEMBERS
+//=============================================================================================================
+
+bool FsCache::s_bEnabled = qgetenv("MNE_FS_CACHE") != "0";
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// LOCAL FUNCTIONS
+//=============================================================================================================
+
+//Matrices are stored as dimensions followed by the raw column major data in native byte order
+template<typename T>
+static void writeMatrix(QDataStream &p_Stream, const T &p_Mat)
+{
+    p_Stream << (qint32)p_Mat.rows() << (qint32)p_Mat.cols();
+    p_Stream.writeRawData(reinterpret_cast<const char*>(p_Mat.data()), p_Mat.size() * sizeof(typename T::Scalar));
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+static bool readMatrix(QDataStream &p_Stream, T &p_Mat)
+{
+    qint32 rows, cols;
+    p_Stream >> rows >> cols;
+
+    if(p_Stream.status() != QDataStream::Ok || rows < 0 || cols < 0
+            || (T::ColsAtCompileTime != Dynamic && cols != T::ColsAtCompileTime)
+            || (T::RowsAtCompileTime != Dynamic && rows != T::RowsAtCompileTime)
+            || (qint64)rows * cols * (qint64)sizeof(typename T::Scalar) > p_Stream.device()->bytesAvailable())
+        return false;
+
+    p_Mat.resize(rows, cols);
+    qint64 bytes = (qint64)p_Mat.size() * sizeof(typename T::Scalar);
+
+    return p_Stream.readRawData(reinterpret_cast<char*>(p_Mat.data()), bytes) == bytes;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+bool FsCache::readSurface(const QString &p_sFileName, bool p_bLoadCurvature, Surface &p_Surface)
+{
+    QFile t_File;
+    QByteArray payload = readCache(p_sFileName, FS_CACHE_SURFACE, t_File);
+    if(payload.isEmpty())
+        return false;
+
+    QDataStream t_Stream(payload);
+
+    qint32 hemi;
+    QString surf;
+    QByteArray curvStamp;
+    MatrixX3f rr, nn;
+    MatrixX3i tris;
+    VectorXf curv;
+
+    t_Stream >> hemi >> surf >> curvStamp;
+
+    if(!readMatrix(t_Stream, rr) || !readMatrix(t_Stream, tris) || !readMatrix(t_Stream, nn))
+        return false;
+
+    if(p_bLoadCurvature)
+    {
+        //The curvature is stored in its own file, which has to be up to date as well
+        QString t_sCurvatureFile = QString("%1%2.curv").arg(p_Surface.m_sFilePath).arg(hemi == 0 ? "lh" : "rh");
+        if(curvStamp.isEmpty() || curvStamp != sourceStamp(t_sCurvatureFile) || !readMatrix(t_Stream, curv))
+            return false;
+    }
+
+    p_Surface.m_iHemi = hemi;
+    p_Surface.m_sSurf = surf;
+    p_Surface.m_matRR = rr;
+    p_Surface.m_matTris = tris;
+    p_Surface.m_matNN = nn;
+    p_Surface.m_vecCurv = curv;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FsCache::writeSurface(const QString &p_sFileName, const Surface &p_Surface)
+{
+    QByteArray curvStamp;
+    if(p_Surface.m_vecCurv.size() > 0)
+        curvStamp = sourceStamp(QString("%1%2.curv").arg(p_Surface.m_sFilePath).arg(p_Surface.m_iHemi == 0 ? "lh" : "rh"));
+
+    QByteArray payload;
+    QDataStream t_Stream(&payload, QIODevice::WriteOnly);
+
+    t_Stream << p_Surface.m_iHemi << p_Surface.m_sSurf << curvStamp;
+    writeMatrix(t_Stream, p_Surface.m_matRR);
+    writeMatrix(t_Stream, p_Surface.m_matTris);
+    writeMatrix(t_Stream, p_Surface.m_matNN);
+    writeMatrix(t_Stream, p_Surface.m_vecCurv);
+
+    return writeCache(p_sFileName, FS_CACHE_SURFACE, payload);
+}
+
+
+//*************************************************************************************************************
+
+bool FsCache::readAnnotation(const QString &p_sFileName, Annotation &p_Annotation)
+{
+    QFile t_File;
+    QByteArray payload = readCache(p_sFileName, FS_CACHE_ANNOTATION, t_File);
+    if(payload.isEmpty())
+        return false;
+
+    QDataStream t_Stream(payload);
+
+    qint32 hemi;
+    VectorXi vertices, labelIds;
+    Colortable colortable;
+
+    t_Stream >> hemi;
+
+    if(!readMatrix(t_Stream, vertices) || !readMatrix(t_Stream, labelIds))
+        return false;
+
+    t_Stream >> colortable.orig_tab >> colortable.numEntries >> colortable.struct_names;
+
+    if(!readMatrix(t_Stream, colortable.table) || t_Stream.status() != QDataStream::Ok)
+        return false;
+
+    p_Annotation.m_iHemi = hemi;
+    p_Annotation.m_Vertices = vertices;
+    p_Annotation.m_LabelIds = labelIds;
+    p_Annotation.m_Colortable = colortable;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FsCache::writeAnnotation(const QString &p_sFileName, const Annotation &p_Annotation)
+{
+    QByteArray payload;
+    QDataStream t_Stream(&payload, QIODevice::WriteOnly);
+
+    t_Stream << p_Annotation.m_iHemi;
+    writeMatrix(t_Stream, p_Annotation.m_Vertices);
+    writeMatrix(t_Stream, p_Annotation.m_LabelIds);
+
+    const Colortable &colortable = p_Annotation.m_Colortable;
+    t_Stream << colortable.orig_tab << colortable.numEntries << colortable.struct_names;
+    writeMatrix(t_Stream, colortable.table);
+
+    return writeCache(p_sFileName, FS_CACHE_ANNOTATION, payload);
+}
+
+
+//*************************************************************************************************************
+
+bool FsCache::readLabel(const QString &p_sFileName, Label &p_Label)
+{
+    QFile t_File;
+    QByteArray payload = readCache(p_sFileName, FS_CACHE_LABEL, t_File);
+    if(payload.isEmpty())
+        return false;
+
+    QDataStream t_Stream(payload);
+
+    Label t_Label;
+    t_Stream >> t_Label.comment >> t_Label.hemi >> t_Label.name >> t_Label.label_id;
+
+    if(!readMatrix(t_Stream, t_Label.vertices) || !readMatrix(t_Stream, t_Label.pos) || !readMatrix(t_Stream, t_Label.values))
+        return false;
+
+    p_Label = t_Label;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FsCache::writeLabel(const QString &p_sFileName, const Label &p_Label)
+{
+    QByteArray payload;
+    QDataStream t_Stream(&payload, QIODevice::WriteOnly);
+
+    t_Stream << p_Label.comment << p_Label.hemi << p_Label.name << p_Label.label_id;
+    writeMatrix(t_Stream, p_Label.vertices);
+    writeMatrix(t_Stream, p_Label.pos);
+    writeMatrix(t_Stream, p_Label.values);
+
+    return writeCache(p_sFileName, FS_CACHE_LABEL, payload);
+}
+
+
+//*************************************************************************************************************
+
+void FsCache::setEnabled(bool p_bEnabled)
+{
+    s_bEnabled = p_bEnabled;
+}
+
+
+//*************************************************************************************************************
+
+bool FsCache::isEnabled()
+{
+    return s_bEnabled;
+}
+
+
+//*************************************************************************************************************
+
+QString FsCache::cacheDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/fs";
+}
+
+
+//*************************************************************************************************************
+
+QString FsCache::cacheFileName(const QString &p_sFileName)
+{
+    QByteArray hash = QCryptographicHash::hash(QFileInfo(p_sFileName).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1);
+
+    return QString("%1/%2.fsc").arg(cacheDir()).arg(QString(hash.toHex()));
+}
+
+
+//*************************************************************************************************************
+
+QByteArray FsCache::sourceStamp(const QString &p_sFileName)
+{
+    QFileInfo t_FileInfo(p_sFileName);
+    if(!t_FileInfo.exists())
+        return QByteArray();
+
+    QByteArray stamp;
+    QDataStream t_Stream(&stamp, QIODevice::WriteOnly);
+    t_Stream << t_FileInfo.absoluteFilePath() << (qint64)t_FileInfo.size() << (qint64)t_FileInfo.lastModified().toMSecsSinceEpoch();
+
+    return stamp;
+}
+
+
+//*************************************************************************************************************
+
+QByteArray FsCache::readCache(const QString &p_sFileName, quint32 p_iKind, QFile &p_File)
+{
+    if(!s_bEnabled)
+        return QByteArray();
+
+    QByteArray stamp = sourceStamp(p_sFileName);
+    if(stamp.isEmpty())
+        return QByteArray();
+
+    p_File.setFileName(cacheFileName(p_sFileName));
+    if(!p_File.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    qint64 size = p_File.size();
+    const char* data = reinterpret_cast<const char*>(p_File.map(0, size));
+    if(!data)
+        return QByteArray();
+
+    QByteArray content = QByteArray::fromRawData(data, size);
+    QDataStream t_Stream(content);
+
+    quint32 magic, version, kind;
+    quint8 littleEndian;
+    QByteArray cachedStamp;
+    t_Stream >> magic >> version >> kind >> littleEndian >> cachedStamp;
+
+    //Matrices are stored in native byte order
+    if(t_Stream.status() != QDataStream::Ok
+            || magic != FS_CACHE_MAGIC
+            || version != FS_CACHE_VERSION
+            || kind != p_iKind
+            || littleEndian != (Q_BYTE_ORDER == Q_LITTLE_ENDIAN ? 1 : 0)
+            || cachedStamp != stamp)
+        return QByteArray();
+
+    qint64 offset = t_Stream.device()->pos();
+
+    return QByteArray::fromRawData(data + offset, size - offset);
+}
+
+
+//*************************************************************************************************************
+
+bool FsCache::writeCache(const QString &p_sFileName, quint32 p_iKind, const QByteArray &p_arrayPayload)
+{
+    if(!s_bEnabled)
+        return false;
+
+    QByteArray stamp = sourceStamp(p_sFileName);
+    if(stamp.isEmpty() || !QDir().mkpath(cacheDir()))
+        return false;
+
+    //Write to a temporary file first, so that concurrent readers never see a partially written cache file
+    QString t_sCacheFile = cacheFileName(p_sFileName);
+    QFile t_File(t_sCacheFile + ".part");
+    if(!t_File.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream t_Stream(&t_File);
+    t_Stream << (quint32)FS_CACHE_MAGIC << (quint32)FS_CACHE_VERSION << p_iKind << (quint8)(Q_BYTE_ORDER == Q_LITTLE_ENDIAN ? 1 : 0) << stamp;
+    t_Stream.writeRawData(p_arrayPayload.constData(), p_arrayPayload.size());
+
+    t_File.close();
+
+    if(t_Stream.status() != QDataStream::Ok)
+    {
+        t_File.remove();
+        return false;
+    }
+
+    QFile::remove(t_sCacheFile);
+
+    return t_File.rename(t_sCacheFile);
+}
@@ -0,0 +1,230 @@
+//=============================================================================================================
+/**
+* @file     fscache.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     FsCache class declaration.
+*
+*/
+
+#ifndef FSCACHE_H
+#define FSCACHE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fs_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QFile>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FSLIB
+//=============================================================================================================
+
+namespace FSLIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class Surface;
+class Annotation;
+class Label;
+
+
+//=============================================================================================================
+/**
+* Binary cache of parsed FreeSurfer files. The first time a surface, annotation or label file is read, the parsed
+* result (including the computed surface normals) is written to a compact binary file in the cache location. Later
+* reads memory map this file instead of parsing the original one. A cache file is only used as long as size and
+* modification time of its source files did not change.
+*
+* @brief Binary cache for FreeSurfer surfaces, annotations and labels
+*/
+class FSSHARED_EXPORT FsCache
+{
+public:
+    //=========================================================================================================
+    /**
+    * Reads a surface from the cache.
+    *
+    * @param[in] p_sFileName        The FreeSurfer surface file.
+    * @param[in] p_bLoadCurvature   If true, the cache is only used when it also holds the current curvature.
+    * @param[out] p_Surface         The surface.
+    *
+    * @return true if a valid cache entry was found.
+    */
+    static bool readSurface(const QString &p_sFileName, bool p_bLoadCurvature, Surface &p_Surface);
+
+    //=========================================================================================================
+    /**
+    * Writes a surface to the cache. The curvature is cached as well, if it was loaded.
+    *
+    * @param[in] p_sFileName        The FreeSurfer surface file the surface was read from.
+    * @param[in] p_Surface          The surface.
+    *
+    * @return true if successful.
+    */
+    static bool writeSurface(const QString &p_sFileName, const Surface &p_Surface);
+
+    //=========================================================================================================
+    /**
+    * Reads an annotation from the cache.
+    *
+    * @param[in] p_sFileName        The FreeSurfer annotation file.
+    * @param[out] p_Annotation      The annotation.
+    *
+    * @return true if a valid cache entry was found.
+    */
+    static bool readAnnotation(const QString &p_sFileName, Annotation &p_Annotation);
+
+    //=========================================================================================================
+    /**
+    * Writes an annotation to the cache.
+    *
+    * @param[in] p_sFileName        The FreeSurfer annotation file the annotation was read from.
+    * @param[in] p_Annotation       The annotation.
+    *
+    * @return true if successful.
+    */
+    static bool writeAnnotation(const QString &p_sFileName, const Annotation &p_Annotation);
+
+    //=========================================================================================================
+    /**
+    * Reads a label from the cache.
+    *
+    * @param[in] p_sFileName        The FreeSurfer label file.
+    * @param[out] p_Label           The label.
+    *
+    * @return true if a valid cache entry was found.
+    */
+    static bool readLabel(const QString &p_sFileName, Label &p_Label);
+
+    //=========================================================================================================
+    /**
+    * Writes a label to the cache.
+    *
+    * @param[in] p_sFileName        The FreeSurfer label file the label was read from.
+    * @param[in] p_Label            The label.
+    *
+    * @return true if successful.
+    */
+    static bool writeLabel(const QString &p_sFileName, const Label &p_Label);
+
+    //=========================================================================================================
+    /**
+    * Enables or disables the cache. The cache is enabled by default, unless the environment variable
+    * MNE_FS_CACHE is set to 0.
+    *
+    * @param[in] p_bEnabled         The new state.
+    */
+    static void setEnabled(bool p_bEnabled);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the cache is enabled.
+    *
+    * @return true if the cache is enabled.
+    */
+    static bool isEnabled();
+
+    //=========================================================================================================
+    /**
+    * Returns the directory the cache files are stored in.
+    *
+    * @return the cache directory.
+    */
+    static QString cacheDir();
+
+private:
+    //=========================================================================================================
+    /**
+    * Returns the cache file of a source file.
+    *
+    * @param[in] p_sFileName        The source file.
+    *
+    * @return the cache file name.
+    */
+    static QString cacheFileName(const QString &p_sFileName);
+
+    //=========================================================================================================
+    /**
+    * Returns a stamp of a source file, which changes whenever the file is modified.
+    *
+    * @param[in] p_sFileName        The source file.
+    *
+    * @return the stamp, empty if the file does not exist.
+    */
+    static QByteArray sourceStamp(const QString &p_sFileName);
+
+    //=========================================================================================================
+    /**
+    * Memory maps the cache file of a source file and checks its header.
+    *
+    * @param[in] p_sFileName        The source file.
+    * @param[in] p_iKind            The kind of data which is expected in the cache file.
+    * @param[out] p_File            The opened cache file, the mapping lives as long as the file is open.
+    *
+    * @return the payload of the cache file without copy, empty if there is no valid cache entry.
+    */
+    static QByteArray readCache(const QString &p_sFileName, quint32 p_iKind, QFile &p_File);
+
+    //=========================================================================================================
+    /**
+    * Writes the cache file of a source file.
+    *
+    * @param[in] p_sFileName        The source file.
+    * @param[in] p_iKind            The kind of data.
+    * @param[in] p_arrayPayload     The payload.
+    *
+    * @return true if successful.
+    */
+    static bool writeCache(const QString &p_sFileName, quint32 p_iKind, const QByteArray &p_arrayPayload);
+
+    static bool s_bEnabled;     /**< Whether the cache is enabled. */
+};
+
+} // NAMESPACE
+
+#endif // FSCACHE_H
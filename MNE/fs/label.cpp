@@ -40,6 +40,7 @@
 
 #include "label.h"
 #include "surface.h"
+#include "fscache.h"
 
 
 //*************************************************************************************************************
@@ -202,6 +203,12 @@ bool Label::read(const QString& p_sFileName, Label &p_Label)
         return false;
     }
 
+    if(FsCache::readLabel(p_sFileName, p_Label))
+    {
+        printf("[done]\n");
+        return true;
+    }
+
     QTextStream t_TextStream(&t_File);
 
     QString comment = t_TextStream.readLine();
@@ -255,5 +262,7 @@ bool Label::read(const QString& p_sFileName, Label &p_Label)
 
     t_File.close();
 
+    FsCache::writeLabel(p_sFileName, p_Label);
+
     return true;
 }
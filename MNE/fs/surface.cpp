@@ -39,6 +39,7 @@
 //=============================================================================================================
 
 #include "surface.h"
+#include "fscache.h"
 #include <utils/ioutils.h>
 
 #include <iostream>
@@ -52,6 +53,16 @@
 #include <QFile>
 #include <QDataStream>
 #include <QTextStream>
+#include <QThread>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Geometry>
 
 
 //*************************************************************************************************************
@@ -144,48 +155,53 @@ void Surface::clear()
 MatrixX3f Surface::compute_normals(const MatrixX3f& rr, const MatrixX3i& tris)
 {
     printf("\tcomputing normals\n");
-    // first, compute triangle normals
-    MatrixX3f r1(tris.rows(),3); MatrixX3f r2(tris.rows(),3); MatrixX3f r3(tris.rows(),3);
 
-    for(qint32 i = 0; i < tris.rows(); ++i)
-    {
-        r1.row(i) = rr.row(tris(i, 0));
-        r2.row(i) = rr.row(tris(i, 1));
-        r3.row(i) = rr.row(tris(i, 2));
-    }
+    //Sum of the normals of all triangles a vertex belongs to, for the triangles iStart to iEnd - 1
+    auto accumulateNormals = [&rr, &tris](qint32 iStart, qint32 iEnd) -> MatrixX3f {
+        MatrixX3f nn = MatrixX3f::Zero(rr.rows(), 3);
 
-    MatrixX3f x = r2 - r1;
-    MatrixX3f y = r3 - r1;
-    MatrixX3f tri_nn(x.rows(),y.cols());
-    tri_nn.col(0) = x.col(1).cwiseProduct(y.col(2)) - x.col(2).cwiseProduct(y.col(1));
-    tri_nn.col(1) = x.col(2).cwiseProduct(y.col(0)) - x.col(0).cwiseProduct(y.col(2));
-    tri_nn.col(2) = x.col(0).cwiseProduct(y.col(1)) - x.col(1).cwiseProduct(y.col(0));
+        for(qint32 p = iStart; p < iEnd; ++p)
+        {
+            // triangle normal
+            Vector3f r1 = rr.row(tris(p, 0)).transpose();
+            Vector3f x = rr.row(tris(p, 1)).transpose() - r1;
+            Vector3f y = rr.row(tris(p, 2)).transpose() - r1;
+            Vector3f tri_nn = x.cross(y);
 
-    //   Triangle normals and areas
-    MatrixX3f tmp = tri_nn.cwiseProduct(tri_nn);
-    VectorXf normSize = tmp.rowwise().sum();
-    normSize = normSize.cwiseSqrt();
+            float normSize = tri_nn.norm();
+            if(normSize != 0)
+                tri_nn /= normSize;
 
-    for(qint32 i = 0; i < normSize.size(); ++i)
-        if(normSize(i) != 0)
-            tri_nn.row(i) /= normSize(i);
+            for(qint32 j = 0; j < 3; ++j)
+                nn.row(tris(p, j)) += tri_nn.transpose();
+        }
+
+        return nn;
+    };
 
-    MatrixX3f nn = MatrixX3f::Zero(rr.rows(), 3);
+    //Split the triangles into one block per thread, small surfaces are not worth the overhead
+    qint32 nBlocks = qBound(1, (qint32)(tris.rows() / 20000), qMax(1, QThread::idealThreadCount()));
+    qint32 blockSize = (tris.rows() + nBlocks - 1) / nBlocks;
 
-    for(qint32 p = 0; p < tris.rows(); ++p)
+    QList<QFuture<MatrixX3f> > futures;
+    for(qint32 b = 1; b < nBlocks; ++b)
     {
-        Vector3i verts = tris.row(p);
-        for(qint32 j = 0; j < verts.size(); ++j)
-            nn.row(verts(j)) = tri_nn.row(p);
+        qint32 iStart = b * blockSize;
+        qint32 iEnd = qMin((qint32)tris.rows(), iStart + blockSize);
+        futures.append(QtConcurrent::run([accumulateNormals, iStart, iEnd]() { return accumulateNormals(iStart, iEnd); }));
     }
 
-    tmp = nn.cwiseProduct(nn);
-    normSize = tmp.rowwise().sum();
-    normSize = normSize.cwiseSqrt();
+    MatrixX3f nn = accumulateNormals(0, qMin((qint32)tris.rows(), blockSize));
+
+    for(qint32 b = 0; b < futures.size(); ++b)
+        nn += futures[b].result();
 
-    for(qint32 i = 0; i < normSize.size(); ++i)
-        if(normSize(i) != 0)
-            nn.row(i) /= normSize(i);
+    for(qint32 i = 0; i < nn.rows(); ++i)
+    {
+        float normSize = nn.row(i).norm();
+        if(normSize != 0)
+            nn.row(i) /= normSize;
+    }
 
     return nn;
 }
@@ -245,6 +261,12 @@ bool Surface::read(const QString &p_sFile, Surface &p_Surface, bool p_bLoadCurva
     p_Surface.m_sFilePath = p_sFile.mid(0,t_NameIdx);
     p_Surface.m_sFileName = p_sFile.mid(t_NameIdx,p_sFile.size()-t_NameIdx);
 
+    if(FsCache::readSurface(p_sFile, p_bLoadCurvature, p_Surface))
+    {
+        printf("\tRead a surface with %d vertices from the cache of %s\n[done]\n", (int)p_Surface.m_matRR.rows(), p_sFile.toLatin1().constData());
+        return true;
+    }
+
     QDataStream t_DataStream(&t_File);
     t_DataStream.setByteOrder(QDataStream::BigEndian);
 
@@ -416,6 +438,8 @@ bool Surface::read(const QString &p_sFile, Surface &p_Surface, bool p_bLoadCurva
     t_File.close();
     printf("\tRead a surface with %d vertices from %s\n[done]\n",nvert,p_sFile.toLatin1().constData());
 
+    FsCache::writeSurface(p_sFile, p_Surface);
+
     return true;
 }
 
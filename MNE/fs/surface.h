@@ -81,6 +81,8 @@ using namespace Eigen;
 // FORWARD DECLARATIONS
 //=============================================================================================================
 
+class FsCache;
+
 
 //=============================================================================================================
 /**
@@ -90,6 +92,8 @@ using namespace Eigen;
 */
 class FSSHARED_EXPORT Surface
 {
+    friend class FsCache;
+
 public:
     typedef QSharedPointer<Surface> SPtr;            /**< Shared pointer type for Surface class. */
     typedef QSharedPointer<const Surface> ConstSPtr; /**< Const shared pointer type for Surface class. */
@@ -224,7 +228,8 @@ public:
 
     //=========================================================================================================
     /**
-    * Efficiently compute vertex normals for triangulated surface
+    * Efficiently compute vertex normals for triangulated surface. Each vertex normal is the normalized sum of the
+    * normals of its triangles. Large surfaces are processed in parallel.
     *
     * @param[in] rr     Vertex coordinates in meters
     * @param[out] tris  The triangle descriptions
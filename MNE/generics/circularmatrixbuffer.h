@@ -147,6 +147,12 @@ public:
     */
     inline quint32 size() const;
 
+    //=========================================================================================================
+    /**
+    * Number of matrices which are currently stored in the buffer and are waiting to be popped.
+    */
+    inline quint32 numMatrices() const;
+
     //=========================================================================================================
     /**
     * Rows of the stored matrices of the buffer.
@@ -314,6 +320,16 @@ inline quint32 CircularMatrixBuffer<_Tp>::size() const
 }
 
 
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline quint32 CircularMatrixBuffer<_Tp>::numMatrices() const
+{
+    quint32 t_size = m_uiRows*m_uiCols;
+    return t_size > 0 ? m_pUsedElements->available() / t_size : 0;
+}
+
+
 //*************************************************************************************************************
 
 template<typename _Tp>
@@ -87,14 +87,21 @@ else {
 
 SOURCES += \
     rtclient.cpp \
+    rtasyncdataclient.cpp \
     rtdataclient.cpp \
-    rtcmdclient.cpp
+    rtcmdclient.cpp \
+    rtshmring.cpp \
+    rtstreamcodec.cpp
 
 HEADERS +=  \
     rtclient_global.h \
     rtclient.h \
+    rtasyncdataclient.h \
+    rtspscqueue.h \
     rtcmdclient.h \
-    rtdataclient.h
+    rtdataclient.h \
+    rtshmring.h \
+    rtstreamcodec.h
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
 INCLUDEPATH += $${MNE_INCLUDE_DIR}
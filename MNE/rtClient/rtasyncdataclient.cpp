@@ -0,0 +1,321 @@
+//=============================================================================================================
+/**
+* @file     rtasyncdataclient.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Implementation of the RtAsyncDataClient Class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtasyncdataclient.h"
+#include "rtcmdclient.h"
+#include "rtdataclient.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QElapsedTimer>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTCLIENTLIB;
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RtAsyncDataClient::RtAsyncDataClient(const QString& p_sRtServerHostname, const QString& p_sClientAlias, qint32 p_iPoolSize, QObject *parent)
+: QThread(parent)
+, m_sRtServerHostName(p_sRtServerHostname)
+, m_sClientAlias(p_sClientAlias)
+, m_bUseSharedMemory(false)
+, m_bIsRunning(false)
+, m_dLatencySumSq(0.0)
+, m_dMinOffsetSec(0.0)
+, m_qVecPool(qMax(p_iPoolSize, 1))
+, m_queueFree(qMax(p_iPoolSize, 1))
+, m_queueFilled(qMax(p_iPoolSize, 1))
+, m_pSpareBuffer(0)
+{
+    for(qint32 i = 0; i < m_qVecPool.size(); ++i)
+        m_queueFree.push(&m_qVecPool[i]);
+
+    m_statistics.iNumBuffers = 0;
+    m_statistics.iNumDropped = 0;
+    m_statistics.dMeanLatencySec = 0.0;
+    m_statistics.dMaxLatencySec = 0.0;
+    m_statistics.dJitterSec = 0.0;
+    m_statistics.dMeanParseSec = 0.0;
+}
+
+
+//*************************************************************************************************************
+
+RtAsyncDataClient::~RtAsyncDataClient()
+{
+    stop();
+}
+
+
+//*************************************************************************************************************
+
+FiffInfo::SPtr RtAsyncDataClient::getFiffInfo()
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_pFiffInfo;
+}
+
+
+//*************************************************************************************************************
+
+RtRawBuffer* RtAsyncDataClient::tryPop()
+{
+    RtRawBuffer* t_pBuffer = 0;
+    if(m_queueFilled.pop(t_pBuffer))
+        return t_pBuffer;
+
+    return 0;
+}
+
+
+//*************************************************************************************************************
+
+void RtAsyncDataClient::release(RtRawBuffer* p_pBuffer)
+{
+    if(p_pBuffer)
+        m_queueFree.push(p_pBuffer);
+}
+
+
+//*************************************************************************************************************
+
+RtStreamStatistics RtAsyncDataClient::getStatistics()
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_statistics;
+}
+
+
+//*************************************************************************************************************
+
+bool RtAsyncDataClient::stop()
+{
+    m_bIsRunning = false;
+    QThread::wait();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void RtAsyncDataClient::updateStatistics(RtRawBuffer& p_buffer)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    if(!m_pFiffInfo || m_pFiffInfo->sfreq <= 0)
+        return;
+
+    double t_dSampleSec = (p_buffer.iFirstSample + p_buffer.matData.cols()) / m_pFiffInfo->sfreq;
+    double t_dOffsetSec = p_buffer.dArrivalSec - t_dSampleSec;
+
+    if(m_statistics.iNumBuffers == 0 || t_dOffsetSec < m_dMinOffsetSec)
+        m_dMinOffsetSec = t_dOffsetSec;
+
+    p_buffer.dLatencySec = t_dOffsetSec - m_dMinOffsetSec;
+
+    qint64 n = ++m_statistics.iNumBuffers;
+    m_statistics.dMeanLatencySec += (p_buffer.dLatencySec - m_statistics.dMeanLatencySec) / n;
+    m_statistics.dMeanParseSec += (p_buffer.dParseSec - m_statistics.dMeanParseSec) / n;
+    m_statistics.dMaxLatencySec = qMax(m_statistics.dMaxLatencySec, p_buffer.dLatencySec);
+
+    m_dLatencySumSq += p_buffer.dLatencySec * p_buffer.dLatencySec;
+    m_statistics.dJitterSec = std::sqrt(qMax(0.0, m_dLatencySumSq / n - m_statistics.dMeanLatencySec * m_statistics.dMeanLatencySec));
+}
+
+
+//*************************************************************************************************************
+
+void RtAsyncDataClient::run()
+{
+    m_bIsRunning = true;
+
+    //
+    // Connect Clients
+    //
+    RtCmdClient t_cmdClient;
+    t_cmdClient.connectToHost(m_sRtServerHostName);
+    t_cmdClient.waitForConnected(1000);
+
+    while(t_cmdClient.state() != QTcpSocket::ConnectedState && m_bIsRunning)
+    {
+        msleep(100);
+        t_cmdClient.connectToHost(m_sRtServerHostName);
+        t_cmdClient.waitForConnected(1000);
+    }
+
+    if(!m_bIsRunning)
+        return;
+
+    RtDataClient t_dataClient;
+    t_dataClient.connectToHost(m_sRtServerHostName);
+    t_dataClient.waitForConnected();
+
+    if(m_bUseSharedMemory && !t_dataClient.connectToSharedMemory())
+        qWarning() << "RtAsyncDataClient::run - Shared memory ring not available, reading from the socket.";
+
+    emit connectionChanged(true);
+
+    qint32 clientId = t_dataClient.getClientId();
+
+    t_cmdClient.requestCommands();
+
+    t_dataClient.setClientAlias(m_sClientAlias);
+
+    //
+    // Read meas info
+    //
+    t_cmdClient["measinfo"].pValues()[0].setValue(clientId);
+    t_cmdClient["measinfo"].send();
+
+    FiffInfo::SPtr t_pFiffInfo = t_dataClient.readInfo();
+    {
+        QMutexLocker locker(&m_qMutex);
+        m_pFiffInfo = t_pFiffInfo;
+    }
+    emit fiffInfoAvailable();
+
+    //
+    // Start measurement
+    //
+    //With the shared memory ring only the connector is started - an id which matches no client keeps the server from
+    //queueing the raw buffers for the socket as well
+    bool t_bUseSharedMemory = t_dataClient.isSharedMemoryConnected();
+    t_cmdClient["start"].pValues()[0].setValue(t_bUseSharedMemory ? -1 : clientId);
+    t_cmdClient["start"].send();
+
+    MatrixXf t_matDropped;
+    fiff_int_t kind;
+    qint64 t_iFirstSample = 0;
+    QElapsedTimer t_timer;
+
+    while(m_bIsRunning)
+    {
+        if(t_bUseSharedMemory)
+        {
+            //Discard what the server sends via the socket (e.g. the measurement info), it is read from the ring
+            if(t_dataClient.bytesAvailable() > 0 || t_dataClient.waitForReadyRead(0))
+                t_dataClient.readAll();
+        }
+        //Wait for the next tag without blocking the stop request
+        else if(t_dataClient.bytesAvailable() < (int)sizeof(qint32)*4)
+        {
+            t_dataClient.waitForReadyRead(10);
+            continue;
+        }
+
+        qint64 t_iParseStartNs = t_timer.isValid() ? t_timer.nsecsElapsed() : 0;
+
+        //Fill a pooled buffer, the matrices keep their allocation when the dimensions do not change. A buffer which
+        //is not filled is kept for the next iteration - only the consumer returns buffers to the free queue.
+        if(!m_pSpareBuffer)
+            m_queueFree.pop(m_pSpareBuffer);
+        RtRawBuffer* t_pBuffer = m_pSpareBuffer;
+        bool t_bHasBuffer = t_pBuffer != 0;
+
+        MatrixXf& t_matTarget = t_bHasBuffer ? t_pBuffer->matData : t_matDropped;
+        t_dataClient.readRawBuffer(t_pFiffInfo->nchan, t_matTarget, kind);
+
+        if(kind != FIFF_DATA_BUFFER)
+        {
+            if(kind == FIFF_BLOCK_END)
+                m_bIsRunning = false;
+            continue;
+        }
+
+        if(!t_timer.isValid())
+            t_timer.start();
+
+        if(!t_bHasBuffer)
+        {
+            QMutexLocker locker(&m_qMutex);
+            ++m_statistics.iNumDropped;
+            t_iFirstSample += t_matDropped.cols();
+            continue;
+        }
+
+        t_pBuffer->iFirstSample = t_iFirstSample;
+        t_pBuffer->dArrivalSec = t_timer.nsecsElapsed() * 1e-9;
+        t_pBuffer->dParseSec = t_pBuffer->dArrivalSec - t_iParseStartNs * 1e-9;
+        t_iFirstSample += t_pBuffer->matData.cols();
+
+        updateStatistics(*t_pBuffer);
+
+        m_queueFilled.push(t_pBuffer);
+        m_pSpareBuffer = 0;
+
+        //Signal every buffer - checking for an empty queue before the push races with the consumer draining it
+        emit rawBufferAvailable();
+    }
+
+    //
+    // Disconnect Stuff
+    //
+    t_cmdClient.disconnectFromHost();
+    t_dataClient.disconnectFromHost();
+
+    emit connectionChanged(false);
+}
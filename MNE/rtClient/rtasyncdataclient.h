@@ -0,0 +1,271 @@
+//=============================================================================================================
+/**
+* @file     rtasyncdataclient.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     RtAsyncDataClient class declaration.
+*
+*/
+
+#ifndef RTASYNCDATACLIENT_H
+#define RTASYNCDATACLIENT_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtclient_global.h"
+#include "rtspscqueue.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FIFF INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff_info.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QThread>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RTCLIENTLIB
+//=============================================================================================================
+
+namespace RTCLIENTLIB
+{
+
+
+//=============================================================================================================
+/**
+* One received raw buffer together with its timing. The instances belong to the pool of the RtAsyncDataClient and
+* have to be handed back with RtAsyncDataClient::release.
+*
+* @brief Pooled raw buffer of the RtAsyncDataClient
+*/
+struct RTCLIENTSHARED_EXPORT RtRawBuffer
+{
+    Eigen::MatrixXf matData;        /**< The samples (channels x samples). */
+    qint64          iFirstSample;   /**< Index of the first sample since the start of the stream. */
+    double          dArrivalSec;    /**< Time the buffer was completely received, relative to the first buffer. */
+    double          dLatencySec;    /**< Arrival time minus the time of the last sample, relative to the minimum seen so far. */
+    double          dParseSec;      /**< Time spent to read and parse the buffer. */
+};
+
+
+//=============================================================================================================
+/**
+* Timing statistics over all raw buffers received so far.
+*
+* @brief Statistics of the RtAsyncDataClient
+*/
+struct RTCLIENTSHARED_EXPORT RtStreamStatistics
+{
+    qint64  iNumBuffers;        /**< Number of received raw buffers. */
+    qint64  iNumDropped;        /**< Number of raw buffers dropped because no pooled buffer was free. */
+    double  dMeanLatencySec;    /**< Mean of the relative latency. */
+    double  dMaxLatencySec;     /**< Maximum of the relative latency. */
+    double  dJitterSec;         /**< Standard deviation of the relative latency. */
+    double  dMeanParseSec;      /**< Mean time to read and parse a raw buffer. */
+};
+
+
+//=============================================================================================================
+/**
+* Asynchronous real-time data client. A dedicated I/O thread connects to mne_rt_server, reads and parses the raw
+* buffers into a fixed pool of preallocated matrices and hands them to the consumer via a lock-free queue. The
+* consumer polls with tryPop (or reacts on rawBufferAvailable) and hands the buffer back with release, so no memory
+* is allocated per buffer once the pool is warm. If the consumer holds all pooled buffers, new buffers are dropped
+* and counted instead of growing the queue.
+*
+* @brief Asynchronous pipelined real-time data client
+*/
+class RTCLIENTSHARED_EXPORT RtAsyncDataClient : public QThread
+{
+    Q_OBJECT
+public:
+    typedef QSharedPointer<RtAsyncDataClient> SPtr;               /**< Shared pointer type for RtAsyncDataClient. */
+    typedef QSharedPointer<const RtAsyncDataClient> ConstSPtr;    /**< Const shared pointer type for RtAsyncDataClient. */
+
+    //=========================================================================================================
+    /**
+    * Creates the asynchronous data client.
+    *
+    * @param[in] p_sRtServerHostname    The IP address of the mne_rt_server
+    * @param[in] p_sClientAlias         The client alias of the data client
+    * @param[in] p_iPoolSize            Number of pooled raw buffers
+    * @param[in] parent                 Parent QObject (optional)
+    */
+    explicit RtAsyncDataClient(const QString& p_sRtServerHostname, const QString& p_sClientAlias = "rtasyncclient", qint32 p_iPoolSize = 32, QObject *parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Stops the I/O thread and destroys the client.
+    */
+    ~RtAsyncDataClient();
+
+    //=========================================================================================================
+    /**
+    * Reads the raw buffers from the shared memory ring of mne_rt_server instead of the socket. Has to be set
+    * before start.
+    *
+    * @param[in] p_bUseSharedMemory     Whether to use the shared memory ring
+    */
+    inline void setUseSharedMemory(bool p_bUseSharedMemory);
+
+    //=========================================================================================================
+    /**
+    * Returns the measurement info, valid after fiffInfoAvailable was emitted.
+    *
+    * @return the measurement info
+    */
+    FIFFLIB::FiffInfo::SPtr getFiffInfo();
+
+    //=========================================================================================================
+    /**
+    * Consumer: returns the next received raw buffer without blocking.
+    *
+    * @return the raw buffer or NULL if none is available
+    */
+    RtRawBuffer* tryPop();
+
+    //=========================================================================================================
+    /**
+    * Consumer: hands a raw buffer back to the pool.
+    *
+    * @param[in] p_pBuffer  The raw buffer returned by tryPop
+    */
+    void release(RtRawBuffer* p_pBuffer);
+
+    //=========================================================================================================
+    /**
+    * Returns the timing statistics.
+    *
+    * @return the statistics
+    */
+    RtStreamStatistics getStatistics();
+
+    //=========================================================================================================
+    /**
+    * Stops the I/O thread.
+    *
+    * @return true if succeeded
+    */
+    virtual bool stop();
+
+signals:
+    //=========================================================================================================
+    /**
+    * Emitted once the measurement info was received.
+    */
+    void fiffInfoAvailable();
+
+    //=========================================================================================================
+    /**
+    * Emitted whenever a raw buffer was queued. A consumer which reacts on this signal should drain the queue with
+    * tryPop until it is empty, since queued signals may cover several buffers.
+    */
+    void rawBufferAvailable();
+
+    //=========================================================================================================
+    /**
+    * Emitted when connection status changed
+    *
+    * @param[in] p_bStatus  connection status
+    */
+    void connectionChanged(bool p_bStatus);
+
+protected:
+    //=========================================================================================================
+    /**
+    * The I/O thread: connects, requests the measurement info, starts the measurement and reads the raw buffers.
+    */
+    virtual void run();
+
+private:
+    //=========================================================================================================
+    /**
+    * Updates the timing of a received buffer and the statistics.
+    *
+    * @param[in, out] p_buffer  The received buffer, its first sample and arrival time have to be set
+    */
+    void updateStatistics(RtRawBuffer& p_buffer);
+
+    QString                 m_sRtServerHostName;    /**< The IP address of mne_rt_server. */
+    QString                 m_sClientAlias;         /**< The client alias of the data client. */
+    bool                    m_bUseSharedMemory;     /**< Whether to read from the shared memory ring. */
+    volatile bool           m_bIsRunning;           /**< Holds whether the I/O thread is running. */
+
+    QMutex                  m_qMutex;               /**< Guards the measurement info and the statistics. */
+    FIFFLIB::FiffInfo::SPtr m_pFiffInfo;            /**< The measurement info. */
+    RtStreamStatistics      m_statistics;           /**< The timing statistics. */
+    double                  m_dLatencySumSq;        /**< Sum of the squared latencies for the jitter. */
+    double                  m_dMinOffsetSec;        /**< Minimal arrival minus sample time, the latency reference. */
+
+    QVector<RtRawBuffer>        m_qVecPool;         /**< The pooled raw buffers. */
+    RtSpscQueue<RtRawBuffer*>   m_queueFree;        /**< Buffers which can be filled by the I/O thread. */
+    RtSpscQueue<RtRawBuffer*>   m_queueFilled;      /**< Buffers which wait for the consumer. */
+    RtRawBuffer*                m_pSpareBuffer;     /**< I/O thread: free buffer which was popped but not filled, only the consumer pushes to m_queueFree. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline void RtAsyncDataClient::setUseSharedMemory(bool p_bUseSharedMemory)
+{
+    m_bUseSharedMemory = p_bUseSharedMemory;
+}
+
+} // NAMESPACE
+
+#endif // RTASYNCDATACLIENT_H
@@ -72,12 +72,28 @@ void RtDataClient::connectToHost(const QString& p_sRtServerHostName)
 }
 
 
+//*************************************************************************************************************
+
+bool RtDataClient::connectToSharedMemory(const QString& p_sKey)
+{
+    m_pShmRing = RtShmRing::SPtr(new RtShmRing(p_sKey));
+
+    if(!m_pShmRing->attach()) {
+        m_pShmRing.clear();
+        return false;
+    }
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 void RtDataClient::disconnectFromHost()
 {
     QTcpSocket::disconnectFromHost();
     m_clientID = -1;
+    m_pShmRing.clear();
 }
 
 
@@ -109,13 +125,35 @@ qint32 RtDataClient::getClientId()
 //*************************************************************************************************************
 
 FiffInfo::SPtr RtDataClient::readInfo()
+{
+    if(isSharedMemoryConnected())
+    {
+        //The shared memory holds the same serialized info block as sent via the socket
+        QByteArray t_measInfoPacket;
+        if(!m_pShmRing->readInfo(t_measInfoPacket))
+        {
+            printf("No measurement info available in the shared memory\n");
+            return FiffInfo::SPtr(new FiffInfo());
+        }
+
+        FiffStream t_fiffStream(&t_measInfoPacket, QIODevice::ReadOnly);
+        return parseInfo(t_fiffStream);
+    }
+
+    FiffStream t_fiffStream(this);
+    return parseInfo(t_fiffStream);
+}
+
+
+//*************************************************************************************************************
+
+FiffInfo::SPtr RtDataClient::parseInfo(FiffStream& t_fiffStream)
 {
     FiffInfo::SPtr p_pFiffInfo(new FiffInfo());
     bool t_bReadMeasBlockStart = false;
     bool t_bReadMeasBlockEnd = false;
     QString col_names, row_names;
 
-    FiffStream t_fiffStream(this);
     //
     // Find the start
     //
@@ -362,6 +400,14 @@ void RtDataClient::readRawBuffer(qint32 p_nChannels, MatrixXf& data, fiff_int_t&
 {
 //        data = [];
 
+    if(isSharedMemoryConnected())
+    {
+        //Samples are copied straight from the ring, no tag parsing needed. On timeout FIFF_NOP is returned, so that
+        //the caller gets the chance to check whether it should stop.
+        kind = m_pShmRing->readRawBuffer(data) ? FIFF_DATA_BUFFER : FIFF_NOP;
+        return;
+    }
+
     FiffStream t_fiffStream(this);
     //
     // Find the start
@@ -375,7 +421,14 @@ void RtDataClient::readRawBuffer(qint32 p_nChannels, MatrixXf& data, fiff_int_t&
     if(kind == FIFF_DATA_BUFFER)
     {
         qint32 nSamples = (t_pTag->size()/4)/p_nChannels;
-        data = MatrixXf(Map< MatrixXf >(t_pTag->toFloat(), p_nChannels, nSamples));
+        //Assign without a temporary, so that a reused matrix keeps its allocation
+        data = Map< MatrixXf >(t_pTag->toFloat(), p_nChannels, nSamples);
+    }
+    else if(kind == FIFF_MNE_RT_DATA_BUFFER)
+    {
+        //Profiled stream - the dimensions are part of the encoded buffer
+        if(RtStreamCodec::decode(t_pTag, data))
+            kind = FIFF_DATA_BUFFER;
     }
 //        else
 //            data = tag.data;
@@ -390,3 +443,13 @@ void RtDataClient::setClientAlias(const QString &p_sAlias)
     t_fiffStream.write_rt_command(2, p_sAlias);//MNE_RT.MNE_RT_SET_CLIENT_ALIAS, alias);
     this->flush();
 }
+
+
+//*************************************************************************************************************
+
+void RtDataClient::setClientQueue(qint32 p_iMaxBuffers, const QString &p_sPolicy)
+{
+    FiffStream t_fiffStream(this);
+    t_fiffStream.write_rt_command(3, QString("%1 %2").arg(p_iMaxBuffers).arg(p_sPolicy));//MNE_RT.MNE_RT_SET_CLIENT_QUEUE, settings);
+    this->flush();
+}
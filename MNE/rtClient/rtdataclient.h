@@ -44,6 +44,8 @@
 //=============================================================================================================
 
 #include "rtclient_global.h"
+#include "rtshmring.h"
+#include "rtstreamcodec.h"
 
 
 //*************************************************************************************************************
@@ -86,6 +88,8 @@ using namespace FIFFLIB;
 //=============================================================================================================
 /**
 * The real-time data client class provides an interface to communicate with the data port 4218 of a running mne_rt_server.
+* Clients on the acquisition host can alternatively read the measurement info and the raw buffers from the shared
+* memory ring of mne_rt_server, see connectToSharedMemory.
 *
 * @brief Real-time data client
 */
@@ -112,6 +116,25 @@ public:
     */
     void connectToHost(const QString& p_sRtServerHostName);
 
+    //=========================================================================================================
+    /**
+    * Connects to the shared memory ring of a mne_rt_server running on the same host. readInfo and readRawBuffer
+    * then read from the shared memory instead of the socket. The command connection is not affected.
+    *
+    * @param[in] p_sKey     The key of the shared memory ring
+    *
+    * @return true if the shared memory ring was found and could be attached
+    */
+    bool connectToSharedMemory(const QString& p_sKey = QString(RTSHM_DEFAULT_KEY));
+
+    //=========================================================================================================
+    /**
+    * Returns whether the client reads from the shared memory ring.
+    *
+    * @return true if connected to the shared memory ring
+    */
+    inline bool isSharedMemoryConnected() const;
+
     //=========================================================================================================
     /**
     * Attempts to close the socket. If there is pending data waiting to be written, QAbstractSocket will enter
@@ -138,11 +161,12 @@ public:
 
     //=========================================================================================================
     /**
-    * Reads fiff measurement information of a data the connection
+    * Reads the next raw buffer of the data connection. Buffers which are encoded according to a stream profile
+    * (FIFF_MNE_RT_DATA_BUFFER) are decoded and returned as FIFF_DATA_BUFFER.
     *
     * @param[in] p_nChannels    Number of channels to reshape the received data
     * @param[out] data          The read data - ToDo change this to raw buffer data object
-    * @param[out] kind          Data kind
+    * @param[out] kind          Data kind, FIFF_NOP if no raw buffer arrived from the shared memory ring in time
     */
     void readRawBuffer(qint32 p_nChannels, MatrixXf& data, fiff_int_t& kind);
 
@@ -154,8 +178,29 @@ public:
     */
     void setClientAlias(const QString &p_sAlias);
 
+    //=========================================================================================================
+    /**
+    * Sets the size and policy of the send queue which mne_rt_server keeps for this client. When the queue is full
+    * the server drops the oldest or the newest raw buffer, or disconnects the client.
+    *
+    * @param[in] p_iMaxBuffers  Maximal number of raw buffers queued at the server
+    * @param[in] p_sPolicy      The overflow policy: "drop-oldest" (default), "drop-newest" or "disconnect"
+    */
+    void setClientQueue(qint32 p_iMaxBuffers, const QString &p_sPolicy = QString("drop-oldest"));
+
 private:
-    qint32 m_clientID;  /**< Corresponding client id of the data client at mne_rt_server */
+    //=========================================================================================================
+    /**
+    * Parses the fiff measurement information block from the given stream
+    *
+    * @param[in] t_fiffStream   The stream to read from
+    *
+    * @return the read fiff measurement information
+    */
+    FiffInfo::SPtr parseInfo(FiffStream& t_fiffStream);
+
+    qint32 m_clientID;          /**< Corresponding client id of the data client at mne_rt_server */
+    RtShmRing::SPtr m_pShmRing; /**< The shared memory ring, if connected to the shared memory of mne_rt_server */
 
 signals:
     
@@ -163,6 +208,17 @@ public slots:
     
 };
 
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool RtDataClient::isSharedMemoryConnected() const
+{
+    return !m_pShmRing.isNull() && m_pShmRing->isAttached();
+}
+
 } // NAMESPACE
 
 #endif // RTDATACLIENT_H
@@ -0,0 +1,435 @@
+//=============================================================================================================
+/**
+* @file     rtshmring.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Implementation of the RtShmRing Class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtshmring.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <atomic>
+#include <cstring>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QAtomicInteger>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTCLIENTLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// SHARED MEMORY LAYOUT
+//=============================================================================================================
+
+#define RTSHM_MAGIC     0x4d4e4532  /**< Magic number of the ring header ("MNE2"). */
+#define RTSHM_ALIGN(x)  (((x) + 63) & ~qint64(63))
+
+namespace RTCLIENTLIB
+{
+
+//=============================================================================================================
+/**
+* Header at the start of the shared memory segment, followed by the info area and the slots.
+*/
+struct RtShmHeader
+{
+    quint32                 iMagic;                             /**< RTSHM_MAGIC once the writer initialized the ring. */
+    qint32                  iNumSlots;                          /**< Number of raw buffer slots. */
+    qint32                  iSlotBytes;                         /**< Capacity of one slot in bytes. */
+    qint32                  iInfoBytes;                         /**< Capacity of the info area in bytes. */
+    QAtomicInteger<qint64>  iWriteSeq;                          /**< Number of raw buffers written so far. */
+    QAtomicInteger<qint64>  iInfoSeq;                           /**< Sequence lock of the info area, odd while writing. */
+    qint32                  iInfoSize;                          /**< Size of the serialized info in bytes. */
+    QAtomicInt              iWriterActive;                      /**< Whether the writer is attached. */
+    QAtomicInt              iReaderActive[RTSHM_MAX_READERS];   /**< Whether a reader slot is claimed. */
+    QAtomicInteger<qint64>  iReaderSeq[RTSHM_MAX_READERS];      /**< Read position of each reader. */
+    QAtomicInteger<qint64>  iReaderHeartbeat[RTSHM_MAX_READERS];/**< Time of the last read of each reader in ms since epoch. */
+};
+
+
+//=============================================================================================================
+/**
+* Header of one raw buffer slot, followed by the samples in column major order.
+*/
+struct RtShmSlot
+{
+    QAtomicInteger<qint64>  iSeq;       /**< Sequence number + 1 of the stored raw buffer, -1 while writing, 0 if empty. */
+    qint32                  iRows;      /**< Number of channels. */
+    qint32                  iCols;      /**< Number of samples. */
+};
+
+} // NAMESPACE
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RtShmRing::RtShmRing(const QString& p_sKey)
+: m_sKey(p_sKey)
+, m_shm(p_sKey)
+, m_pHeader(Q_NULLPTR)
+, m_bIsWriter(false)
+, m_iReader(-1)
+, m_iReadSeq(0)
+, m_iNumLostBuffers(0)
+, m_iHeartbeatMs(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+RtShmRing::~RtShmRing()
+{
+    detach();
+}
+
+
+//*************************************************************************************************************
+
+bool RtShmRing::create(qint32 p_iNumSlots, qint32 p_iSlotBytes, qint32 p_iInfoBytes)
+{
+    detach();
+
+    if(p_iNumSlots < 1 || p_iSlotBytes < 1 || p_iInfoBytes < 1)
+        return false;
+
+    qint64 t_iSize = RTSHM_ALIGN(sizeof(RtShmHeader)) + RTSHM_ALIGN(p_iInfoBytes)
+                     + p_iNumSlots * (RTSHM_ALIGN(sizeof(RtShmSlot)) + RTSHM_ALIGN(p_iSlotBytes));
+
+    if(!m_shm.create(t_iSize)) {
+        //Reuse a stale segment of a crashed server
+        if(m_shm.error() != QSharedMemory::AlreadyExists || !m_shm.attach() || m_shm.size() < t_iSize) {
+            qWarning() << "RtShmRing::create - Could not create shared memory" << m_sKey << ":" << m_shm.errorString();
+            if(m_shm.isAttached())
+                m_shm.detach();
+            return false;
+        }
+    }
+
+    m_shm.lock();
+    std::memset(m_shm.data(), 0, t_iSize);
+    RtShmHeader* t_pHeader = static_cast<RtShmHeader*>(m_shm.data());
+    t_pHeader->iNumSlots = p_iNumSlots;
+    t_pHeader->iSlotBytes = p_iSlotBytes;
+    t_pHeader->iInfoBytes = p_iInfoBytes;
+    t_pHeader->iWriterActive.storeRelease(1);
+    t_pHeader->iMagic = RTSHM_MAGIC;
+    m_shm.unlock();
+
+    m_pHeader = t_pHeader;
+    m_bIsWriter = true;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool RtShmRing::attach()
+{
+    detach();
+
+    if(!m_shm.attach())
+        return false;
+
+    RtShmHeader* t_pHeader = static_cast<RtShmHeader*>(m_shm.data());
+
+    qint64 t_iNow = QDateTime::currentMSecsSinceEpoch();
+
+    m_shm.lock();
+    bool t_bIsValid = t_pHeader->iMagic == RTSHM_MAGIC;
+    qint32 t_iReader = -1;
+    for(qint32 i = 0; t_bIsValid && i < RTSHM_MAX_READERS; ++i) {
+        if(t_pHeader->iReaderActive[i].testAndSetOrdered(0, 1)) {
+            t_iReader = i;
+            break;
+        }
+    }
+    //Reclaim the slot of a reader which crashed without detaching
+    for(qint32 i = 0; t_bIsValid && t_iReader < 0 && i < RTSHM_MAX_READERS; ++i) {
+        qint64 t_iHeartbeat = t_pHeader->iReaderHeartbeat[i].loadAcquire();
+        if(t_iNow - t_iHeartbeat > RTSHM_READER_TIMEOUT_MS && t_pHeader->iReaderHeartbeat[i].testAndSetOrdered(t_iHeartbeat, t_iNow)) {
+            qWarning() << "RtShmRing::attach - Reclaiming reader slot" << i << "of" << m_sKey << "without heartbeat.";
+            t_iReader = i;
+        }
+    }
+    if(t_iReader >= 0)
+        t_pHeader->iReaderHeartbeat[t_iReader].storeRelease(t_iNow);
+    m_shm.unlock();
+
+    if(t_iReader < 0) {
+        qWarning() << "RtShmRing::attach - Shared memory" << m_sKey << (t_bIsValid ? "has no free reader slot." : "is not initialized.");
+        m_shm.detach();
+        return false;
+    }
+
+    m_pHeader = t_pHeader;
+    m_bIsWriter = false;
+    m_iReader = t_iReader;
+    m_iReadSeq = m_pHeader->iWriteSeq.loadAcquire();
+    m_iNumLostBuffers = 0;
+    m_iHeartbeatMs = t_iNow;
+    m_pHeader->iReaderSeq[m_iReader].storeRelease(m_iReadSeq);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void RtShmRing::detach()
+{
+    if(m_pHeader && m_iReader >= 0)
+        m_pHeader->iReaderActive[m_iReader].storeRelease(0);
+
+    if(m_pHeader && m_bIsWriter)
+        m_pHeader->iWriterActive.storeRelease(0);
+
+    m_pHeader = Q_NULLPTR;
+    m_iReader = -1;
+
+    if(m_shm.isAttached())
+        m_shm.detach();
+}
+
+
+//*************************************************************************************************************
+
+bool RtShmRing::writeInfo(const QByteArray& p_measInfoPacket)
+{
+    if(!m_pHeader || !m_bIsWriter)
+        return false;
+
+    if(p_measInfoPacket.size() > m_pHeader->iInfoBytes) {
+        qWarning() << "RtShmRing::writeInfo - Measurement info of" << p_measInfoPacket.size() << "bytes exceeds the info area.";
+        return false;
+    }
+
+    char* t_pInfo = static_cast<char*>(m_shm.data()) + RTSHM_ALIGN(sizeof(RtShmHeader));
+
+    m_pHeader->iInfoSeq.fetchAndAddOrdered(1);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(t_pInfo, p_measInfoPacket.constData(), p_measInfoPacket.size());
+    m_pHeader->iInfoSize = p_measInfoPacket.size();
+    m_pHeader->iInfoSeq.fetchAndAddRelease(1);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool RtShmRing::writeRawBuffer(const MatrixXf& p_matData)
+{
+    if(!m_pHeader || !m_bIsWriter)
+        return false;
+
+    qint64 t_iBytes = p_matData.size() * sizeof(float);
+    if(t_iBytes > m_pHeader->iSlotBytes) {
+        qWarning() << "RtShmRing::writeRawBuffer - Raw buffer of" << t_iBytes << "bytes exceeds the slot capacity.";
+        return false;
+    }
+
+    qint64 t_iSeq = m_pHeader->iWriteSeq.loadAcquire();
+    RtShmSlot* t_pSlot = slot(t_iSeq);
+
+    //Readers which are copying this slot right now detect the change of the sequence number
+    t_pSlot->iSeq.store(-1);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    t_pSlot->iRows = p_matData.rows();
+    t_pSlot->iCols = p_matData.cols();
+    std::memcpy(reinterpret_cast<char*>(t_pSlot) + RTSHM_ALIGN(sizeof(RtShmSlot)), p_matData.data(), t_iBytes);
+
+    t_pSlot->iSeq.storeRelease(t_iSeq + 1);
+    m_pHeader->iWriteSeq.storeRelease(t_iSeq + 1);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool RtShmRing::readInfo(QByteArray& p_measInfoPacket, qint32 p_iTimeoutMs)
+{
+    if(!m_pHeader)
+        return false;
+
+    const char* t_pInfo = static_cast<const char*>(m_shm.constData()) + RTSHM_ALIGN(sizeof(RtShmHeader));
+
+    QElapsedTimer t_timer;
+    t_timer.start();
+
+    do {
+        qint64 t_iSeq = m_pHeader->iInfoSeq.loadAcquire();
+
+        if(t_iSeq > 0 && (t_iSeq & 1) == 0) {
+            p_measInfoPacket = QByteArray(t_pInfo, m_pHeader->iInfoSize);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(m_pHeader->iInfoSeq.load() == t_iSeq)
+                return true;
+        }
+
+        QThread::msleep(10);
+    } while(t_timer.elapsed() < p_iTimeoutMs);
+
+    return false;
+}
+
+
+//*************************************************************************************************************
+
+bool RtShmRing::readRawBuffer(MatrixXf& p_matData, qint32 p_iTimeoutMs)
+{
+    if(!m_pHeader || m_bIsWriter)
+        return false;
+
+    QElapsedTimer t_timer;
+    t_timer.start();
+
+    forever {
+        updateHeartbeat();
+
+        qint64 t_iWriteSeq = m_pHeader->iWriteSeq.loadAcquire();
+
+        //The server restarted with a fresh ring
+        if(t_iWriteSeq < m_iReadSeq)
+            m_iReadSeq = t_iWriteSeq;
+
+        if(m_iReadSeq < t_iWriteSeq) {
+            //Skip what was overwritten already
+            if(t_iWriteSeq - m_iReadSeq > m_pHeader->iNumSlots) {
+                m_iNumLostBuffers += t_iWriteSeq - m_pHeader->iNumSlots - m_iReadSeq;
+                m_iReadSeq = t_iWriteSeq - m_pHeader->iNumSlots;
+            }
+
+            RtShmSlot* t_pSlot = slot(m_iReadSeq);
+
+            if(t_pSlot->iSeq.loadAcquire() == m_iReadSeq + 1) {
+                //The writer may overwrite the slot at any time, validate the dimensions before using them
+                qint32 t_iRows = t_pSlot->iRows;
+                qint32 t_iCols = t_pSlot->iCols;
+
+                bool t_bIsValid = t_iRows >= 0 && t_iCols >= 0 && qint64(t_iRows) * t_iCols * qint64(sizeof(float)) <= m_pHeader->iSlotBytes;
+
+                if(t_bIsValid) {
+                    if(p_matData.rows() != t_iRows || p_matData.cols() != t_iCols)
+                        p_matData.resize(t_iRows, t_iCols);
+
+                    std::memcpy(p_matData.data(), reinterpret_cast<const char*>(t_pSlot) + RTSHM_ALIGN(sizeof(RtShmSlot)), p_matData.size() * sizeof(float));
+                }
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(t_bIsValid && t_pSlot->iSeq.load() == m_iReadSeq + 1) {
+                    ++m_iReadSeq;
+                    m_pHeader->iReaderSeq[m_iReader].storeRelease(m_iReadSeq);
+                    return true;
+                }
+            }
+
+            //Overwritten while copying
+            ++m_iNumLostBuffers;
+            ++m_iReadSeq;
+            continue;
+        }
+
+        if(!isWriterActive() || t_timer.elapsed() >= p_iTimeoutMs)
+            return false;
+
+        QThread::usleep(RTSHM_POLL_INTERVAL_US);
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool RtShmRing::isWriterActive() const
+{
+    return m_pHeader && m_pHeader->iWriterActive.loadAcquire() != 0;
+}
+
+
+//*************************************************************************************************************
+
+RtShmSlot* RtShmRing::slot(qint64 p_iSeq) const
+{
+    qint64 t_iStride = RTSHM_ALIGN(sizeof(RtShmSlot)) + RTSHM_ALIGN(m_pHeader->iSlotBytes);
+    qint64 t_iOffset = RTSHM_ALIGN(sizeof(RtShmHeader)) + RTSHM_ALIGN(m_pHeader->iInfoBytes) + (p_iSeq % m_pHeader->iNumSlots) * t_iStride;
+
+    return reinterpret_cast<RtShmSlot*>(static_cast<char*>(const_cast<void*>(m_shm.constData())) + t_iOffset);
+}
+
+
+//*************************************************************************************************************
+
+void RtShmRing::updateHeartbeat()
+{
+    qint64 t_iNow = QDateTime::currentMSecsSinceEpoch();
+
+    //A coarse heartbeat is sufficient, it is only compared against RTSHM_READER_TIMEOUT_MS
+    if(t_iNow - m_iHeartbeatMs >= 100) {
+        m_iHeartbeatMs = t_iNow;
+        m_pHeader->iReaderHeartbeat[m_iReader].storeRelease(t_iNow);
+    }
+}
@@ -0,0 +1,279 @@
+//=============================================================================================================
+/**
+* @file     rtshmring.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     RtShmRing class declaration.
+*
+*/
+
+#ifndef RTSHMRING_H
+#define RTSHMRING_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtclient_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QSharedMemory>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RTCLIENTLIB
+//=============================================================================================================
+
+namespace RTCLIENTLIB
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define RTSHM_DEFAULT_KEY           "mne_rt_server"     /**< Default key of the mne_rt_server shared memory ring. */
+#define RTSHM_MAX_READERS           16                  /**< Maximal number of readers attached at the same time. */
+#define RTSHM_DEFAULT_SLOTS         32                  /**< Default number of raw buffer slots. */
+#define RTSHM_DEFAULT_SLOT_BYTES    2097152             /**< Default capacity of one raw buffer slot in bytes. */
+#define RTSHM_DEFAULT_INFO_BYTES    4194304             /**< Default capacity of the measurement info area in bytes. */
+#define RTSHM_READER_TIMEOUT_MS     5000                /**< Reader slots without heartbeat for this long are reclaimed. */
+#define RTSHM_POLL_INTERVAL_US      500                 /**< Interval in which a waiting reader polls the ring. */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+struct RtShmHeader;
+struct RtShmSlot;
+
+
+//=============================================================================================================
+/**
+* Single writer, multiple reader broadcast ring in shared memory, used as local transport between mne_rt_server and
+* co-located clients. The writer (mne_rt_server) publishes each raw buffer once into the next slot, every reader
+* keeps its own read position and copies the samples straight into its matrix - no socket, no FIFF tag parsing.
+* The serialized measurement info is kept in a separate area, so that it can be read with the usual FIFF parser.
+*
+* The writer never waits for readers: a reader which falls more than one ring length behind loses the overwritten
+* buffers, which is detected with per slot sequence numbers. There is no wakeup primitive: waiting readers poll the
+* ring every RTSHM_POLL_INTERVAL_US with a timeout, so that they can be stopped and notice a writer which went away.
+* Each buffer is copied once from its slot into the reader's matrix, no view into a slot is handed out since the
+* writer may overwrite it at any time. Every reader refreshes a heartbeat while it reads, the
+* slots of readers which crashed without detaching are reclaimed once their heartbeat is older than
+* RTSHM_READER_TIMEOUT_MS.
+*
+* @brief Shared memory ring for raw buffers
+*/
+class RTCLIENTSHARED_EXPORT RtShmRing
+{
+public:
+    typedef QSharedPointer<RtShmRing> SPtr;               /**< Shared pointer type for RtShmRing. */
+    typedef QSharedPointer<const RtShmRing> ConstSPtr;    /**< Const shared pointer type for RtShmRing. */
+
+    //=========================================================================================================
+    /**
+    * Creates the shared memory ring object, no memory is created or attached yet.
+    *
+    * @param[in] p_sKey     The key of the shared memory
+    */
+    explicit RtShmRing(const QString& p_sKey = QString(RTSHM_DEFAULT_KEY));
+
+    //=========================================================================================================
+    /**
+    * Detaches from the shared memory.
+    */
+    ~RtShmRing();
+
+    //=========================================================================================================
+    /**
+    * Creates the shared memory as writer. A stale segment with the same key, left by a crashed server, is reused.
+    *
+    * @param[in] p_iNumSlots    Number of raw buffer slots
+    * @param[in] p_iSlotBytes   Capacity of one slot in bytes
+    * @param[in] p_iInfoBytes   Capacity of the measurement info area in bytes
+    *
+    * @return true if the shared memory is ready for writing
+    */
+    bool create(qint32 p_iNumSlots = RTSHM_DEFAULT_SLOTS, qint32 p_iSlotBytes = RTSHM_DEFAULT_SLOT_BYTES, qint32 p_iInfoBytes = RTSHM_DEFAULT_INFO_BYTES);
+
+    //=========================================================================================================
+    /**
+    * Attaches to the shared memory as reader. Reading starts with the next raw buffer which is written.
+    *
+    * @return true if the ring was found and a reader slot was available
+    */
+    bool attach();
+
+    //=========================================================================================================
+    /**
+    * Detaches from the shared memory and releases the reader slot.
+    */
+    void detach();
+
+    //=========================================================================================================
+    /**
+    * Returns whether the ring is created or attached.
+    *
+    * @return true if created or attached
+    */
+    inline bool isAttached() const;
+
+    //=========================================================================================================
+    /**
+    * Writer: publishes the serialized measurement info (FIFFB_MEAS_INFO block).
+    *
+    * @param[in] p_measInfoPacket   The serialized measurement info
+    *
+    * @return false if the info does not fit into the info area
+    */
+    bool writeInfo(const QByteArray& p_measInfoPacket);
+
+    //=========================================================================================================
+    /**
+    * Writer: publishes a raw buffer into the next slot.
+    *
+    * @param[in] p_matData  The raw buffer (channels x samples)
+    *
+    * @return false if the buffer does not fit into a slot
+    */
+    bool writeRawBuffer(const Eigen::MatrixXf& p_matData);
+
+    //=========================================================================================================
+    /**
+    * Reader: returns the serialized measurement info, waits until the writer published one.
+    *
+    * @param[out] p_measInfoPacket  The serialized measurement info
+    * @param[in] p_iTimeoutMs       Maximal time to wait in ms
+    *
+    * @return false if no measurement info was published within the timeout
+    */
+    bool readInfo(QByteArray& p_measInfoPacket, qint32 p_iTimeoutMs = 5000);
+
+    //=========================================================================================================
+    /**
+    * Reader: waits until the next raw buffer is available and copies it to p_matData. Has to be called regularly,
+    * also while no data is expected, since it refreshes the heartbeat of the reader slot.
+    *
+    * @param[out] p_matData     The raw buffer (channels x samples), only resized if the dimensions changed
+    * @param[in] p_iTimeoutMs   Maximal time to wait in ms
+    *
+    * @return false if the ring is not attached, the writer detached or no raw buffer arrived within the timeout
+    */
+    bool readRawBuffer(Eigen::MatrixXf& p_matData, qint32 p_iTimeoutMs = 100);
+
+    //=========================================================================================================
+    /**
+    * Reader: returns whether the writer is still attached to the ring.
+    *
+    * @return true if the writer is attached
+    */
+    bool isWriterActive() const;
+
+    //=========================================================================================================
+    /**
+    * Reader: returns the number of raw buffers which were overwritten before this reader could read them.
+    *
+    * @return the number of lost raw buffers
+    */
+    inline qint64 numLostBuffers() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Returns the slot which holds the raw buffer with the given sequence number.
+    *
+    * @param[in] p_iSeq     The sequence number
+    *
+    * @return the slot
+    */
+    RtShmSlot* slot(qint64 p_iSeq) const;
+
+    //=========================================================================================================
+    /**
+    * Reader: refreshes the heartbeat of the claimed reader slot.
+    */
+    void updateHeartbeat();
+
+    QString                                     m_sKey;             /**< The key of the shared memory. */
+    QSharedMemory                               m_shm;              /**< The shared memory segment. */
+    RtShmHeader*                                m_pHeader;          /**< The header at the start of the segment. */
+    bool                                        m_bIsWriter;        /**< Whether this instance created the ring. */
+
+    qint32                                      m_iReader;          /**< Reader: the claimed reader slot, -1 if none. */
+    qint64                                      m_iReadSeq;         /**< Reader: sequence number of the next raw buffer to read. */
+    qint64                                      m_iNumLostBuffers;  /**< Reader: number of overwritten raw buffers. */
+    qint64                                      m_iHeartbeatMs;     /**< Reader: time of the last heartbeat update. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool RtShmRing::isAttached() const
+{
+    return m_pHeader != Q_NULLPTR;
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 RtShmRing::numLostBuffers() const
+{
+    return m_iNumLostBuffers;
+}
+
+} // NAMESPACE
+
+#endif // RTSHMRING_H
@@ -0,0 +1,140 @@
+//=============================================================================================================
+/**
+* @file     rtspscqueue.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     RtSpscQueue class declaration.
+*
+*/
+
+#ifndef RTSPSCQUEUE_H
+#define RTSPSCQUEUE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QAtomicInt>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RTCLIENTLIB
+//=============================================================================================================
+
+namespace RTCLIENTLIB
+{
+
+//=============================================================================================================
+/**
+* Bounded single producer, single consumer queue without locks. One thread may call push, one other thread may
+* call pop at the same time. The storage is allocated once in the constructor.
+*
+* @brief Lock-free single producer, single consumer queue
+*/
+template<typename T>
+class RtSpscQueue
+{
+public:
+    //=========================================================================================================
+    /**
+    * Creates the queue.
+    *
+    * @param[in] iCapacity  Maximal number of elements in the queue
+    */
+    explicit RtSpscQueue(int iCapacity)
+    : m_qVecElements(iCapacity + 1)
+    , m_iHead(0)
+    , m_iTail(0)
+    {
+    }
+
+    //=========================================================================================================
+    /**
+    * Producer: appends an element.
+    *
+    * @param[in] element    The element
+    *
+    * @return false if the queue is full
+    */
+    inline bool push(const T& element)
+    {
+        int iTail = m_iTail.load();
+        int iNext = (iTail + 1) % m_qVecElements.size();
+        if(iNext == m_iHead.loadAcquire())
+            return false;
+
+        m_qVecElements[iTail] = element;
+        m_iTail.storeRelease(iNext);
+        return true;
+    }
+
+    //=========================================================================================================
+    /**
+    * Consumer: removes the oldest element.
+    *
+    * @param[out] element   The element
+    *
+    * @return false if the queue is empty
+    */
+    inline bool pop(T& element)
+    {
+        int iHead = m_iHead.load();
+        if(iHead == m_iTail.loadAcquire())
+            return false;
+
+        element = m_qVecElements[iHead];
+        m_iHead.storeRelease((iHead + 1) % m_qVecElements.size());
+        return true;
+    }
+
+    //=========================================================================================================
+    /**
+    * Returns the number of queued elements, only a snapshot if the other thread is active.
+    *
+    * @return the number of elements
+    */
+    inline int size() const
+    {
+        int iSize = m_iTail.loadAcquire() - m_iHead.loadAcquire();
+        return iSize < 0 ? iSize + m_qVecElements.size() : iSize;
+    }
+
+private:
+    QVector<T>  m_qVecElements;     /**< Ring storage, one element stays unused to distinguish full from empty. */
+    QAtomicInt  m_iHead;            /**< Index of the next element to pop, written by the consumer only. */
+    QAtomicInt  m_iTail;            /**< Index of the next element to push, written by the producer only. */
+};
+
+} // NAMESPACE
+
+#endif // RTSPSCQUEUE_H
@@ -0,0 +1,595 @@
+//=============================================================================================================
+/**
+* @file     rtstreamcodec.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Implementation of the RtStreamCodec Class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtstreamcodec.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FIFF INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff_constants.h>
+#include <fiff/fiff_stream.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cmath>
+#include <cstring>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDataStream>
+#include <QStringList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTCLIENTLIB;
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Converts a single precision value to half precision, rounding to nearest.
+*/
+quint16 floatToHalf(float f)
+{
+    quint32 x;
+    std::memcpy(&x, &f, sizeof(x));
+
+    quint16 sign = (x >> 16) & 0x8000;
+    qint32 exp = ((x >> 23) & 0xff) - 127 + 15;
+    quint32 mant = x & 0x7fffff;
+
+    if(exp <= 0) {
+        //Subnormal half or zero
+        if(exp < -10)
+            return sign;
+        mant |= 0x800000;
+        qint32 shift = 14 - exp;
+        quint16 h = mant >> shift;
+        if((mant >> (shift - 1)) & 1)
+            ++h;
+        return sign | h;
+    }
+
+    if(exp >= 31)
+        return sign | 0x7c00;
+
+    //A carry of the rounding correctly moves into the exponent
+    quint16 h = sign | (exp << 10) | (mant >> 13);
+    if(mant & 0x1000)
+        ++h;
+    return h;
+}
+
+
+//=============================================================================================================
+/**
+* Converts a half precision value to single precision.
+*/
+float halfToFloat(quint16 h)
+{
+    quint32 sign = quint32(h & 0x8000) << 16;
+    qint32 exp = (h >> 10) & 0x1f;
+    quint32 mant = h & 0x3ff;
+
+    if(exp == 0) {
+        float f = std::ldexp(float(mant), -24);
+        return sign ? -f : f;
+    }
+
+    quint32 x = (exp == 31) ? (sign | 0x7f800000 | (mant << 13)) : (sign | quint32(exp - 15 + 127) << 23 | (mant << 13));
+
+    float f;
+    std::memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+
+//=============================================================================================================
+/**
+* Appends a signed value as zigzag coded varint.
+*/
+void writeVarint(QByteArray& p_bytes, qint64 p_iValue)
+{
+    quint64 u = (quint64(p_iValue) << 1) ^ quint64(p_iValue >> 63);
+    while(u >= 0x80) {
+        p_bytes.append(char((u & 0x7f) | 0x80));
+        u >>= 7;
+    }
+    p_bytes.append(char(u));
+}
+
+
+//=============================================================================================================
+/**
+* Reads a zigzag coded varint, returns false if the data ends too early.
+*/
+bool readVarint(const uchar*& p_pData, const uchar* p_pEnd, qint64& p_iValue)
+{
+    quint64 u = 0;
+    for(qint32 iShift = 0; p_pData < p_pEnd && iShift < 64; iShift += 7) {
+        uchar b = *p_pData++;
+        u |= quint64(b & 0x7f) << iShift;
+        if(!(b & 0x80)) {
+            p_iValue = qint64(u >> 1) ^ -qint64(u & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // NAMESPACE
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS RtStreamProfile
+//=============================================================================================================
+
+RtStreamProfile::RtStreamProfile()
+: iDecimation(1)
+, encoding(Float32)
+, iCoalesce(1)
+{
+}
+
+
+//*************************************************************************************************************
+
+bool RtStreamProfile::fromString(const QString& p_sProfile, QString& p_sError)
+{
+    RtStreamProfile t_profile;
+
+    QStringList t_sListItems = p_sProfile.split(";", QString::SkipEmptyParts);
+    for(qint32 i = 0; i < t_sListItems.size(); ++i) {
+        QStringList t_sListKeyValue = t_sListItems[i].split("=");
+        if(t_sListKeyValue.size() != 2) {
+            p_sError = QString("'%1' is not a key=value pair").arg(t_sListItems[i]);
+            return false;
+        }
+
+        QString t_sKey = t_sListKeyValue[0].trimmed().toLower();
+        QString t_sValue = t_sListKeyValue[1].trimmed().toLower();
+        bool t_bOk = true;
+
+        if(t_sKey == "channels") {
+            if(t_sValue != "all") {
+                QStringList t_sListRanges = t_sValue.split(",", QString::SkipEmptyParts);
+                for(qint32 j = 0; j < t_sListRanges.size() && t_bOk; ++j) {
+                    QStringList t_sListRange = t_sListRanges[j].split("-");
+                    qint32 iFrom = t_sListRange[0].toInt(&t_bOk);
+                    qint32 iTo = iFrom;
+                    if(t_bOk && t_sListRange.size() == 2)
+                        iTo = t_sListRange[1].toInt(&t_bOk);
+                    t_bOk = t_bOk && t_sListRange.size() <= 2 && iFrom >= 0 && iTo >= iFrom;
+                    for(qint32 k = iFrom; t_bOk && k <= iTo; ++k)
+                        t_profile.qListChannels.append(k);
+                }
+            }
+        } else if(t_sKey == "decim") {
+            t_profile.iDecimation = t_sValue.toInt(&t_bOk);
+            t_bOk = t_bOk && t_profile.iDecimation >= 1;
+        } else if(t_sKey == "coalesce") {
+            t_profile.iCoalesce = t_sValue.toInt(&t_bOk);
+            t_bOk = t_bOk && t_profile.iCoalesce >= 1;
+        } else if(t_sKey == "encoding") {
+            if(t_sValue == "float32")
+                t_profile.encoding = Float32;
+            else if(t_sValue == "float16")
+                t_profile.encoding = Float16;
+            else if(t_sValue == "delta")
+                t_profile.encoding = Delta;
+            else
+                t_bOk = false;
+        } else {
+            p_sError = QString("unknown key '%1'").arg(t_sKey);
+            return false;
+        }
+
+        if(!t_bOk) {
+            p_sError = QString("invalid value '%1' for '%2'").arg(t_sValue).arg(t_sKey);
+            return false;
+        }
+    }
+
+    *this = t_profile;
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+QString RtStreamProfile::toString() const
+{
+    QString t_sChannels("all");
+    if(!qListChannels.isEmpty()) {
+        QStringList t_sListRanges;
+        for(qint32 i = 0; i < qListChannels.size(); ++i) {
+            qint32 j = i;
+            while(j + 1 < qListChannels.size() && qListChannels[j + 1] == qListChannels[j] + 1)
+                ++j;
+            t_sListRanges << (j > i ? QString("%1-%2").arg(qListChannels[i]).arg(qListChannels[j]) : QString::number(qListChannels[i]));
+            i = j;
+        }
+        t_sChannels = t_sListRanges.join(",");
+    }
+
+    QString t_sEncoding = encoding == Float16 ? "float16" : (encoding == Delta ? "delta" : "float32");
+
+    return QString("channels=%1;decim=%2;encoding=%3;coalesce=%4").arg(t_sChannels).arg(iDecimation).arg(t_sEncoding).arg(iCoalesce);
+}
+
+
+//*************************************************************************************************************
+
+bool RtStreamProfile::isDefault() const
+{
+    return qListChannels.isEmpty() && iDecimation == 1 && encoding == Float32 && iCoalesce == 1;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS RtStreamCodec
+//=============================================================================================================
+
+RtStreamCodec::RtStreamCodec(const RtStreamProfile& p_profile)
+: m_iPhase(0)
+, m_iNumCoalesced(0)
+{
+    setProfile(p_profile);
+}
+
+
+//*************************************************************************************************************
+
+void RtStreamCodec::setProfile(const RtStreamProfile& p_profile)
+{
+    m_profile = p_profile;
+    designFilter();
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+void RtStreamCodec::reset()
+{
+    m_matHistory.resize(0, 0);
+    m_iPhase = 0;
+    m_matCoalesced.resize(0, 0);
+    m_iNumCoalesced = 0;
+}
+
+
+//*************************************************************************************************************
+
+bool RtStreamCodec::encode(const MatrixXf& p_matData, QByteArray& p_packet)
+{
+    MatrixXf t_matDecimated = decimate(p_matData);
+
+    //
+    // Coalesce
+    //
+    if(m_iNumCoalesced == 0 || m_matCoalesced.rows() != t_matDecimated.rows()) {
+        m_matCoalesced = t_matDecimated;
+        m_iNumCoalesced = 1;
+    } else {
+        m_matCoalesced.conservativeResize(NoChange, m_matCoalesced.cols() + t_matDecimated.cols());
+        m_matCoalesced.rightCols(t_matDecimated.cols()) = t_matDecimated;
+        ++m_iNumCoalesced;
+    }
+
+    if(m_iNumCoalesced < m_profile.iCoalesce || m_matCoalesced.cols() == 0)
+        return false;
+
+    const MatrixXf& t_mat = m_matCoalesced;
+    qint32 nChan = t_mat.rows();
+    qint32 nSamp = t_mat.cols();
+
+    //
+    // Encode the payload, big endian like all FIFF data
+    //
+    QByteArray t_payload;
+    QDataStream t_payloadStream(&t_payload, QIODevice::WriteOnly);
+    t_payloadStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    t_payloadStream << (qint32)m_profile.encoding << nChan << nSamp;
+
+    switch(m_profile.encoding) {
+        case RtStreamProfile::Float16: {
+            VectorXf t_vecScale = t_mat.cwiseAbs().rowwise().maxCoeff();
+            for(qint32 i = 0; i < nChan; ++i) {
+                if(t_vecScale[i] <= 0.0f)
+                    t_vecScale[i] = 1.0f;
+                t_payloadStream << t_vecScale[i];
+            }
+
+            VectorXf t_vecInvScale = t_vecScale.cwiseInverse();
+            for(qint32 j = 0; j < nSamp; ++j)
+                for(qint32 i = 0; i < nChan; ++i)
+                    t_payloadStream << floatToHalf(t_mat(i,j) * t_vecInvScale[i]);
+            break;
+        }
+        case RtStreamProfile::Delta: {
+            //Quantize to 24 bit relative to the channel maximum, neighbouring samples differ little
+            VectorXf t_vecStep = t_mat.cwiseAbs().rowwise().maxCoeff() / 8388607.0f;
+            for(qint32 i = 0; i < nChan; ++i) {
+                if(t_vecStep[i] <= 0.0f)
+                    t_vecStep[i] = 1.0f;
+                t_payloadStream << t_vecStep[i];
+            }
+
+            QByteArray t_bytes;
+            t_bytes.reserve(nChan * nSamp * 2);
+            for(qint32 i = 0; i < nChan; ++i) {
+                qint64 iLast = 0;
+                float fInvStep = 1.0f / t_vecStep[i];
+                for(qint32 j = 0; j < nSamp; ++j) {
+                    qint64 iValue = qint64(std::floor(t_mat(i,j) * fInvStep + 0.5f));
+                    writeVarint(t_bytes, iValue - iLast);
+                    iLast = iValue;
+                }
+            }
+            t_payloadStream.writeRawData(t_bytes.constData(), t_bytes.size());
+            break;
+        }
+        default:
+            for(qint32 k = 0; k < nChan * nSamp; ++k)
+                t_payloadStream << t_mat.data()[k];
+    }
+
+    //
+    // Wrap into a tag
+    //
+    p_packet.clear();
+    FiffStream t_FiffStreamOut(&p_packet, QIODevice::WriteOnly);
+    t_FiffStreamOut << (qint32)FIFF_MNE_RT_DATA_BUFFER;
+    t_FiffStreamOut << (qint32)FIFFT_VOID;
+    t_FiffStreamOut << (qint32)t_payload.size();
+    t_FiffStreamOut << (qint32)FIFFV_NEXT_SEQ;
+    t_FiffStreamOut.writeRawData(t_payload.constData(), t_payload.size());
+
+    m_matCoalesced.resize(0, 0);
+    m_iNumCoalesced = 0;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool RtStreamCodec::decode(const FiffTag::SPtr& p_pTag, MatrixXf& p_matData)
+{
+    if(!p_pTag || p_pTag->kind != FIFF_MNE_RT_DATA_BUFFER)
+        return false;
+
+    QDataStream t_payloadStream(*p_pTag);
+    t_payloadStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    qint32 iEncoding, nChan, nSamp;
+    t_payloadStream >> iEncoding >> nChan >> nSamp;
+
+    if(t_payloadStream.status() != QDataStream::Ok || nChan < 0 || nSamp < 0)
+        return false;
+
+    p_matData.resize(nChan, nSamp);
+
+    switch(iEncoding) {
+        case RtStreamProfile::Float16: {
+            VectorXf t_vecScale(nChan);
+            for(qint32 i = 0; i < nChan; ++i)
+                t_payloadStream >> t_vecScale[i];
+
+            quint16 h;
+            for(qint32 j = 0; j < nSamp; ++j) {
+                for(qint32 i = 0; i < nChan; ++i) {
+                    t_payloadStream >> h;
+                    p_matData(i,j) = halfToFloat(h) * t_vecScale[i];
+                }
+            }
+            break;
+        }
+        case RtStreamProfile::Delta: {
+            VectorXf t_vecStep(nChan);
+            for(qint32 i = 0; i < nChan; ++i)
+                t_payloadStream >> t_vecStep[i];
+
+            qint64 iOffset = 3 * sizeof(qint32) + nChan * sizeof(float);
+            const uchar* pData = reinterpret_cast<const uchar*>(p_pTag->constData()) + iOffset;
+            const uchar* pEnd = reinterpret_cast<const uchar*>(p_pTag->constData()) + p_pTag->size();
+
+            for(qint32 i = 0; i < nChan; ++i) {
+                qint64 iValue = 0, iDelta;
+                for(qint32 j = 0; j < nSamp; ++j) {
+                    if(!readVarint(pData, pEnd, iDelta))
+                        return false;
+                    iValue += iDelta;
+                    p_matData(i,j) = iValue * t_vecStep[i];
+                }
+            }
+            return true;
+        }
+        case RtStreamProfile::Float32:
+            for(qint32 k = 0; k < nChan * nSamp; ++k)
+                t_payloadStream >> p_matData.data()[k];
+            break;
+        default:
+            return false;
+    }
+
+    return t_payloadStream.status() == QDataStream::Ok;
+}
+
+
+//*************************************************************************************************************
+
+FiffInfo RtStreamCodec::adaptInfo(const FiffInfo& p_fiffInfo, const RtStreamProfile& p_profile)
+{
+    FiffInfo t_fiffInfo;
+
+    if(p_profile.qListChannels.isEmpty()) {
+        t_fiffInfo = p_fiffInfo;
+    } else {
+        QList<qint32> t_qListValid;
+        for(qint32 i = 0; i < p_profile.qListChannels.size(); ++i)
+            if(p_profile.qListChannels[i] < p_fiffInfo.nchan)
+                t_qListValid.append(p_profile.qListChannels[i]);
+
+        RowVectorXi t_vecSel(t_qListValid.size());
+        for(qint32 i = 0; i < t_qListValid.size(); ++i)
+            t_vecSel[i] = t_qListValid[i];
+
+        t_fiffInfo = p_fiffInfo.pick_info(t_vecSel);
+    }
+
+    if(p_profile.iDecimation > 1) {
+        t_fiffInfo.sfreq = p_fiffInfo.sfreq / p_profile.iDecimation;
+        t_fiffInfo.lowpass = qMin(p_fiffInfo.lowpass, 0.4f * t_fiffInfo.sfreq);
+    }
+
+    return t_fiffInfo;
+}
+
+
+//*************************************************************************************************************
+
+void RtStreamCodec::designFilter()
+{
+    qint32 D = m_profile.iDecimation;
+
+    if(D <= 1) {
+        m_vecFilter = VectorXf::Ones(1);
+        return;
+    }
+
+    //8 taps per output sample give > 40 dB stop band attenuation with the Hamming window
+    qint32 iNumTaps = 8 * D + 1;
+    double dCutOff = 0.4 / D;
+    double dCenter = (iNumTaps - 1) / 2.0;
+
+    m_vecFilter.resize(iNumTaps);
+    for(qint32 k = 0; k < iNumTaps; ++k) {
+        double x = 2.0 * dCutOff * (k - dCenter);
+        double dSinc = (x == 0.0) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+        double dWindow = 0.54 - 0.46 * std::cos(2.0 * M_PI * k / (iNumTaps - 1));
+        m_vecFilter[k] = float(2.0 * dCutOff * dSinc * dWindow);
+    }
+
+    m_vecFilter /= m_vecFilter.sum();
+}
+
+
+//*************************************************************************************************************
+
+MatrixXf RtStreamCodec::decimate(const MatrixXf& p_matData)
+{
+    //
+    // Pick channels
+    //
+    MatrixXf t_matPicked;
+    if(m_profile.qListChannels.isEmpty()) {
+        if(m_profile.iDecimation <= 1)
+            return p_matData;
+        t_matPicked = p_matData;
+    } else {
+        qint32 nValid = 0;
+        t_matPicked.resize(m_profile.qListChannels.size(), p_matData.cols());
+        for(qint32 i = 0; i < m_profile.qListChannels.size(); ++i)
+            if(m_profile.qListChannels[i] < p_matData.rows())
+                t_matPicked.row(nValid++) = p_matData.row(m_profile.qListChannels[i]);
+        t_matPicked.conservativeResize(nValid, NoChange);
+
+        if(m_profile.iDecimation <= 1)
+            return t_matPicked;
+    }
+
+    //
+    // Filter and decimate, only the output samples are computed
+    //
+    qint32 D = m_profile.iDecimation;
+    qint32 L = m_vecFilter.size();
+    qint32 nChan = t_matPicked.rows();
+    qint32 n = t_matPicked.cols();
+
+    if(m_matHistory.rows() != nChan || m_matHistory.cols() != L - 1) {
+        m_matHistory = MatrixXf::Zero(nChan, L - 1);
+        m_iPhase = 0;
+    }
+
+    MatrixXf t_matInput(nChan, L - 1 + n);
+    t_matInput << m_matHistory, t_matPicked;
+
+    qint32 nOut = m_iPhase < n ? (n - 1 - m_iPhase) / D + 1 : 0;
+    MatrixXf t_matOut(nChan, nOut);
+
+    for(qint32 k = 0; k < nOut; ++k)
+        t_matOut.col(k) = t_matInput.middleCols(m_iPhase + k * D, L) * m_vecFilter;
+
+    m_iPhase += nOut * D - n;
+    m_matHistory = t_matInput.rightCols(L - 1);
+
+    return t_matOut;
+}
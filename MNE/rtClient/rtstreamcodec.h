@@ -0,0 +1,259 @@
+//=============================================================================================================
+/**
+* @file     rtstreamcodec.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     RtStreamCodec class declaration.
+*
+*/
+
+#ifndef RTSTREAMCODEC_H
+#define RTSTREAMCODEC_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtclient_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FIFF INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff_info.h>
+#include <fiff/fiff_tag.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QByteArray>
+#include <QString>
+#include <QList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RTCLIENTLIB
+//=============================================================================================================
+
+namespace RTCLIENTLIB
+{
+
+
+//=============================================================================================================
+/**
+* Describes which part of the raw data a client wants to receive and how it is encoded. The textual form is a
+* semicolon separated list of key=value pairs, e.g. "channels=0-63;decim=5;encoding=float16;coalesce=2".
+* Keys which are not given keep their default (all channels, no decimation, float32, no coalescing).
+*
+* @brief Stream profile of a mne_rt_server client
+*/
+class RTCLIENTSHARED_EXPORT RtStreamProfile
+{
+public:
+    enum Encoding {
+        Float32 = 0,    /**< Plain single precision samples, lossless. */
+        Float16 = 1,    /**< Half precision samples relative to a per channel scale, 11 bit resolution. */
+        Delta = 2       /**< First order differences of samples quantized to 24 bit per channel, variable length coded. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Creates the default profile: all channels at full rate as float32, no coalescing.
+    */
+    RtStreamProfile();
+
+    //=========================================================================================================
+    /**
+    * Parses a profile from its textual form.
+    *
+    * @param[in] p_sProfile     The profile, e.g. "channels=0-63;decim=5;encoding=float16;coalesce=2"
+    * @param[out] p_sError      Description of the first error, if any
+    *
+    * @return true if the profile was parsed successfully
+    */
+    bool fromString(const QString& p_sProfile, QString& p_sError);
+
+    //=========================================================================================================
+    /**
+    * Returns the textual form of the profile.
+    *
+    * @return the profile as string
+    */
+    QString toString() const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether this is the default profile, i.e. the client gets the plain FIFF_DATA_BUFFER.
+    *
+    * @return true if this is the default profile
+    */
+    bool isDefault() const;
+
+    QList<qint32>   qListChannels;  /**< Channel indices to send, empty for all channels. */
+    qint32          iDecimation;    /**< Decimation factor, the data is low-pass filtered before decimation. */
+    Encoding        encoding;       /**< Sample encoding. */
+    qint32          iCoalesce;      /**< Number of raw buffers which are combined into one packet. */
+};
+
+
+//=============================================================================================================
+/**
+* Encodes the raw buffers for one client according to its stream profile: channel selection, anti-aliased
+* decimation, block coalescing and sample encoding. The encoder keeps the filter history and the decimation phase
+* between the buffers, so the decimated stream is continuous. The packets are FIFF_MNE_RT_DATA_BUFFER tags, which
+* are decoded by RtDataClient transparently.
+*
+* @brief Per client raw buffer encoder of mne_rt_server
+*/
+class RTCLIENTSHARED_EXPORT RtStreamCodec
+{
+public:
+    typedef QSharedPointer<RtStreamCodec> SPtr;               /**< Shared pointer type for RtStreamCodec. */
+    typedef QSharedPointer<const RtStreamCodec> ConstSPtr;    /**< Const shared pointer type for RtStreamCodec. */
+
+    //=========================================================================================================
+    /**
+    * Creates the encoder.
+    *
+    * @param[in] p_profile  The stream profile
+    */
+    explicit RtStreamCodec(const RtStreamProfile& p_profile = RtStreamProfile());
+
+    //=========================================================================================================
+    /**
+    * Sets a new profile and resets the encoder state.
+    *
+    * @param[in] p_profile  The stream profile
+    */
+    void setProfile(const RtStreamProfile& p_profile);
+
+    //=========================================================================================================
+    /**
+    * Returns the stream profile.
+    *
+    * @return the stream profile
+    */
+    inline const RtStreamProfile& profile() const;
+
+    //=========================================================================================================
+    /**
+    * Resets the filter history, the decimation phase and drops coalesced buffers.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Processes the next raw buffer.
+    *
+    * @param[in] p_matData      The raw buffer (all channels x samples)
+    * @param[out] p_packet      The serialized FIFF_MNE_RT_DATA_BUFFER tag, only set if true is returned
+    *
+    * @return true if a packet is ready, false while buffers are coalesced
+    */
+    bool encode(const Eigen::MatrixXf& p_matData, QByteArray& p_packet);
+
+    //=========================================================================================================
+    /**
+    * Decodes a FIFF_MNE_RT_DATA_BUFFER tag.
+    *
+    * @param[in] p_pTag         The tag
+    * @param[out] p_matData     The decoded samples (channels x samples)
+    *
+    * @return false if the tag could not be decoded
+    */
+    static bool decode(const FIFFLIB::FiffTag::SPtr& p_pTag, Eigen::MatrixXf& p_matData);
+
+    //=========================================================================================================
+    /**
+    * Adapts the measurement info to what a client with the given profile receives: the selected channels, the
+    * decimated sampling frequency and the low-pass of the anti-aliasing filter.
+    *
+    * @param[in] p_fiffInfo     The measurement info of the full stream
+    * @param[in] p_profile      The stream profile
+    *
+    * @return the measurement info of the profiled stream
+    */
+    static FIFFLIB::FiffInfo adaptInfo(const FIFFLIB::FiffInfo& p_fiffInfo, const RtStreamProfile& p_profile);
+
+private:
+    //=========================================================================================================
+    /**
+    * Designs the Hamming windowed sinc low-pass with the cutoff at 0.4 of the decimated sampling frequency.
+    */
+    void designFilter();
+
+    //=========================================================================================================
+    /**
+    * Picks, filters and decimates one raw buffer.
+    *
+    * @param[in] p_matData      The raw buffer
+    *
+    * @return the decimated samples of the picked channels
+    */
+    Eigen::MatrixXf decimate(const Eigen::MatrixXf& p_matData);
+
+    RtStreamProfile     m_profile;          /**< The stream profile. */
+    Eigen::VectorXf     m_vecFilter;        /**< Coefficients of the anti-aliasing filter. */
+    Eigen::MatrixXf     m_matHistory;       /**< Last input samples of the picked channels, length of the filter - 1. */
+    qint32              m_iPhase;           /**< Position of the next output sample in the next raw buffer. */
+    Eigen::MatrixXf     m_matCoalesced;     /**< Decimated samples waiting for coalescing. */
+    qint32              m_iNumCoalesced;    /**< Number of raw buffers in m_matCoalesced. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline const RtStreamProfile& RtStreamCodec::profile() const
+{
+    return m_profile;
+}
+
+} // NAMESPACE
+
+#endif // RTSTREAMCODEC_H
@@ -91,8 +91,11 @@ SOURCES += \
         rtcov.cpp \
         rtinvop.cpp \
         rtave.cpp \
+        rtaveengine.cpp \
         rtnoise.cpp \
         rthpis.cpp \
+        rthpifit.cpp \
+        rthpidemod.cpp \
         rtfilter.cpp
 
 HEADERS +=  \
@@ -100,8 +103,11 @@ HEADERS +=  \
         rtcov.h \
         rtinvop.h \
         rtave.h \
+        rtaveengine.h \
         rtnoise.h \
         rthpis.h \
+        rthpifit.h \
+        rthpidemod.h \
         rtfilter.h
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
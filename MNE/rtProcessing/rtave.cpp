@@ -89,8 +89,10 @@ RtAve::RtAve(quint32 numAverages, quint32 p_iPreStimSamples, quint32 p_iPostStim
 , m_iAverageMode(0)
 , m_iNewAverageMode(0)
 , m_bDoBaselineCorrection(false)
+, m_bDoStdErr(false)
 , m_pairBaselineSec(qMakePair(QVariant(QString::number(p_iBaselineFromSecs)),QVariant(QString::number(p_iBaselineToSecs))))
 , m_pStimEvoked(FiffEvoked::SPtr(new FiffEvoked))
+, m_pStimEvokedStdErr(FiffEvoked::SPtr(new FiffEvoked))
 , m_iMatDataPostIdx(0)
 , m_iNumberCalcAverages(0)
 , m_iCurrentBlockSize(0)
@@ -208,6 +210,16 @@ void RtAve::setBaselineActive(bool activate)
 }
 
 
+//*************************************************************************************************************
+
+void RtAve::setStdErrActive(bool activate)
+{
+    m_qMutex.lock();
+    m_bDoStdErr = activate;
+    m_qMutex.unlock();
+}
+
+
 //*************************************************************************************************************
 
 void RtAve::setBaselineFrom(int fromSamp, int fromMSec)
@@ -307,17 +319,25 @@ void RtAve::run()
                     //Merge the different buffers
                     mergeData();
 
+                    m_qMutex.lock();
+                    bool bDoStdErr = m_bDoStdErr;
+                    m_qMutex.unlock();
+
                     //Calculate the actual average
-                    generateEvoked();
+                    generateEvoked(bDoStdErr);
 
                     //If number of averages was reached emit new average
-                    if(m_qListStimAve.size() > 0)
+                    if(m_aveEngine.count() > 0) {
                         emit evokedStim(m_pStimEvoked);
 
+                        if(bDoStdErr && m_aveEngine.count() > 1)
+                            emit evokedStdErr(m_pStimEvokedStdErr);
+                    }
+
                     m_bFillingBackBuffer = false;
 
                     qDebug()<<"RtAve::run() - Number of calculated averages:"<<m_iNumberCalcAverages;
-                    qDebug()<<"RtAve::run() - m_qListStimAve.size():"<<m_qListStimAve.size();
+                    qDebug()<<"RtAve::run() - m_aveEngine.count():"<<m_aveEngine.count();
                 } else {
                     fillBackBuffer(rawSegment);
                 }
@@ -422,30 +442,20 @@ void RtAve::fillFrontBuffer(MatrixXd &data)
 
 void RtAve::mergeData()
 {
-    MatrixXd mergedData(m_matDataPre.rows(), m_matDataPre.cols()+m_matDataPost.cols());
-
-    mergedData << m_matDataPre, m_matDataPost;
+    //Merge into the preallocated epoch matrix
+    m_matEpoch.leftCols(m_matDataPre.cols()) = m_matDataPre;
+    m_matEpoch.rightCols(m_matDataPost.cols()) = m_matDataPost;
 
     //Perform artifact threshold
     bool bArtifactedDetected = false;
 
     if(m_bDoArtifactReduction) {
-       bArtifactedDetected = checkForArtifact(mergedData, m_dArtifactThreshold);
+       bArtifactedDetected = checkForArtifact(m_matEpoch, m_dArtifactThreshold);
     }
 
     if(bArtifactedDetected == false) {
-        //Add cut data to average buffer
-        m_qListStimAve.append(mergedData);
-
-        //Pop data from buffer
-        if(m_qListStimAve.size() > m_iNumAverages && m_iNumAverages >= 1) {
-            m_qListStimAve.pop_front();
-        }
-
-        //Proceed a bit different if we use zero number of averages
-        if(m_qListStimAve.size() > 1 && m_iNumAverages == 0) {
-            m_qListStimAve.pop_front();
-        }
+        //Add cut data to the averaging engine. Once the window is full the oldest epoch drops out.
+        m_aveEngine.addEpoch(m_matEpoch);
     }
 }
 
@@ -494,38 +504,27 @@ bool RtAve::checkForArtifact(MatrixXd& data, double dThreshold)
 
 //*************************************************************************************************************
 
-void RtAve::generateEvoked()
+void RtAve::generateEvoked(bool bDoStdErr)
 {
-    if(m_qListStimAve.isEmpty())
+    if(m_aveEngine.count() == 0)
         return;
 
     // Generate final evoked
-    MatrixXd finalAverage = MatrixXd::Zero(m_qListStimAve.first().rows(), m_iPreStimSamples+m_iPostStimSamples);
-
-    if(m_iAverageMode == 0) {
-        for(int i = 0; i<m_qListStimAve.size(); i++) {
-            finalAverage += m_qListStimAve.at(i);
-        }
-        finalAverage = finalAverage/m_qListStimAve.size();
+    MatrixXd finalAverage;
+    m_aveEngine.average(finalAverage);
 
-        if(m_bDoBaselineCorrection)
-            finalAverage = MNEMath::rescale(finalAverage, m_pStimEvoked->times, m_pairBaselineSec, QString("mean"));
+    if(m_bDoBaselineCorrection)
+        finalAverage = MNEMath::rescale(finalAverage, m_pStimEvoked->times, m_pairBaselineSec, QString("mean"));
 
-        m_pStimEvoked->data = finalAverage;
-        m_pStimEvoked->nave = m_iNumAverages;
+    m_pStimEvoked->data = finalAverage;
+    m_pStimEvoked->nave = m_aveEngine.count();
 
-        if(m_iNumberCalcAverages<m_iNumAverages)
-            m_iNumberCalcAverages++;
-    } else if(m_iAverageMode == 1) {
-        MatrixXd tempMatrix = m_qListStimAve.last();
-
-        if(m_bDoBaselineCorrection)
-            tempMatrix = MNEMath::rescale(tempMatrix, m_pStimEvoked->times, m_pairBaselineSec, QString("mean"));
-
-        *m_pStimEvoked.data() += tempMatrix;
+    if(bDoStdErr && m_aveEngine.standardError(m_pStimEvokedStdErr->data)) {
+        m_pStimEvokedStdErr->nave = m_aveEngine.count();
+    }
 
+    if(m_iAverageMode == 1 || m_iNumberCalcAverages<m_iNumAverages)
         m_iNumberCalcAverages++;
-    }
 }
 
 
@@ -551,6 +550,10 @@ void RtAve::reset()
     m_matDataPre.setZero();
     m_matDataPost.resize(m_pFiffInfo->chs.size(), m_iPostStimSamples);
     m_matDataPost.setZero();
+    m_matEpoch.resize(m_pFiffInfo->chs.size(), m_iPreStimSamples+m_iPostStimSamples);
+
+    //Running average over the last m_iNumAverages epochs (at least one), cumulative average otherwise
+    m_aveEngine.init(m_pFiffInfo->chs.size(), m_iPreStimSamples+m_iPostStimSamples, m_iAverageMode == 0 ? qMax(m_iNumAverages, 1) : 0);
 
     //Full real-time evoked response
     m_pStimEvoked->setInfo(*m_pFiffInfo.data());
@@ -563,12 +566,12 @@ void RtAve::reset()
     m_pStimEvoked->last = m_pStimEvoked->times[m_pStimEvoked->times.size()-1];
     m_pStimEvoked->data.setZero();
 
-    if(m_iAverageMode == 0)
-        m_pStimEvoked->nave = m_iNumAverages;
-    else
-        m_pStimEvoked->nave = 0;
+    m_pStimEvoked->nave = 0;
+
+    //Standard error of the real-time evoked response
+    *m_pStimEvokedStdErr = *m_pStimEvoked;
+    m_pStimEvokedStdErr->aspect_kind = FIFFV_ASPECT_STD_ERR;
 
-    m_qListStimAve.clear();
     clearDetectedTriggers();
 
     m_bFillingBackBuffer = false;
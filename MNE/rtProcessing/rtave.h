@@ -43,6 +43,7 @@
 //=============================================================================================================
 
 #include "rtprocessing_global.h"
+#include "rtaveengine.h"
 #include "utils/detecttrigger.h"
 #include "utils/mnemath.h"
 
@@ -155,7 +156,8 @@ public:
 
     //=========================================================================================================
     /**
-    * Sets the average mode
+    * Sets the average mode. The running mode averages the last n epochs, the cumulative mode emits the mean of
+    * all epochs since the last reset (earlier versions emitted the running sum of the epochs instead).
     *
     * @param[in] mode     average mode (0-running or 1-cumulative)
     */
@@ -204,6 +206,14 @@ public:
     */
     void setBaselineActive(bool activate);
 
+    //=========================================================================================================
+    /**
+    * Sets whether the standard error of the mean is calculated and emitted via evokedStdErr
+    *
+    * @param[in] activate    activate standard error output
+    */
+    void setStdErrActive(bool activate);
+
     //=========================================================================================================
     /**
     * Sets the from mSeconds of the baseline area
@@ -280,15 +290,17 @@ private:
 
     //=========================================================================================================
     /**
-    * Packs the buffers togehter as one and calcualtes the current running average and emits the result if number of averages has been reached.
+    * Packs the buffers togehter as one and adds the epoch to the averaging engine.
     */
     void mergeData();
 
     //=========================================================================================================
     /**
     * Generates the final evoke variable.
+    *
+    * @param[in] bDoStdErr  whether to calculate the standard error of the mean as well.
     */
-    void generateEvoked();
+    void generateEvoked(bool bDoStdErr);
 
     //=========================================================================================================
     /**
@@ -335,12 +347,14 @@ private:
     bool    m_bAutoAspect;              /**< Auto aspect detection on or off. */
     bool    m_bFillingBackBuffer;       /**< Whether the back buffer is currently getting filled. */
     bool    m_bDoBaselineCorrection;    /**< Whether to perform baseline correction. */
+    bool    m_bDoStdErr;                /**< Whether to calculate the standard error of the mean. */
 
     QPair<QVariant,QVariant>                m_pairBaselineSec;              /**< Baseline information in seconds form where the seconds are seen relative to the trigger, meaning they can also be negative [from to]*/
     QPair<QVariant,QVariant>                m_pairBaselineSamp;             /**< Baseline information in samples form where the seconds are seen relative to the trigger, meaning they can also be negative [from to]*/
 
     FiffInfo::SPtr                          m_pFiffInfo;                    /**< Holds the fiff measurement information. */
     FiffEvoked::SPtr                        m_pStimEvoked;                  /**< Holds the evoked information. */
+    FiffEvoked::SPtr                        m_pStimEvokedStdErr;            /**< Holds the standard error of the evoked information. */
 
     CircularMatrixBuffer<double>::SPtr      m_pRawMatrixBuffer;             /**< The Circular Raw Matrix Buffer. */
 
@@ -348,8 +362,9 @@ private:
 
     Eigen::MatrixXd                         m_matDataPre;                   /**< The matrix holding the pre stim data. */
     Eigen::MatrixXd                         m_matDataPost;                  /**< The matrix holding the post stim data. */
+    Eigen::MatrixXd                         m_matEpoch;                     /**< The preallocated matrix holding the merged pre and post stim data. */
 
-    QList<Eigen::MatrixXd>                  m_qListStimAve;                 /**< the current stimulus average buffer. Holds m_iNumAverages vectors */
+    RtAveEngine                             m_aveEngine;                    /**< The incremental averaging engine holding the running sums of the last m_iNumAverages epochs. */
 
 signals:
     //=========================================================================================================
@@ -360,6 +375,14 @@ signals:
     */
     void evokedStim(FIFFLIB::FiffEvoked::SPtr p_pEvokedStim);
 
+    //=========================================================================================================
+    /**
+    * Signal which is emitted when new standard error data are available. Only emitted if activated via setStdErrActive.
+    *
+    * @param[out] p_pEvokedStdErr   The standard error of the evoked stimulus data
+    */
+    void evokedStdErr(FIFFLIB::FiffEvoked::SPtr p_pEvokedStdErr);
+
     //=========================================================================================================
     /**
     * Emitted when number of averages changed
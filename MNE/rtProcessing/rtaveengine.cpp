@@ -0,0 +1,245 @@
+//=============================================================================================================
+/**
+* @file     rtaveengine.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Implementation of the RtAveEngine Class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtaveengine.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RtAveEngine::RtAveEngine(qint32 iNumChannels, qint32 iNumSamples, qint32 iWindowSize)
+: m_iNumChannels(0)
+, m_iNumSamples(0)
+, m_iWindowSize(0)
+{
+    init(iNumChannels, iNumSamples, iWindowSize);
+}
+
+
+//*************************************************************************************************************
+
+RtAveEngine::~RtAveEngine()
+{
+}
+
+
+//*************************************************************************************************************
+
+void RtAveEngine::init(qint32 iNumChannels, qint32 iNumSamples, qint32 iWindowSize)
+{
+    m_iNumChannels = iNumChannels > 0 ? iNumChannels : 0;
+    m_iNumSamples = iNumSamples > 0 ? iNumSamples : 0;
+    m_iWindowSize = iWindowSize > 0 ? iWindowSize : 0;
+
+    m_qMapAccumulators.clear();
+}
+
+
+//*************************************************************************************************************
+
+void RtAveEngine::clear()
+{
+    //Keep the allocated slots, only reset the counters and sums
+    QMutableMapIterator<qint32, RtAveAccumulator> i(m_qMapAccumulators);
+    while(i.hasNext()) {
+        i.next();
+        i.value().matSum.setZero();
+        i.value().matSumSq.setZero();
+        i.value().iRingPos = 0;
+        i.value().iCount = 0;
+        i.value().iNumReplaced = 0;
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool RtAveEngine::addEpoch(const MatrixXd &matEpoch, qint32 iCondition)
+{
+    if(matEpoch.rows() != m_iNumChannels || matEpoch.cols() != m_iNumSamples) {
+        qWarning() << "RtAveEngine::addEpoch - Epoch dimensions" << matEpoch.rows() << "x" << matEpoch.cols() << "do not match" << m_iNumChannels << "x" << m_iNumSamples;
+        return false;
+    }
+
+    RtAveAccumulator& acc = accumulator(iCondition);
+
+    if(m_iWindowSize == 0) {
+        //Cumulative mode - no need to keep the epochs
+        acc.matSum += matEpoch;
+        acc.matSumSq += matEpoch.cwiseAbs2();
+        ++acc.iCount;
+        return true;
+    }
+
+    MatrixXd& slot = acc.qVecRing[acc.iRingPos];
+
+    if(acc.iCount == m_iWindowSize) {
+        //Window is full - the epoch in this slot drops out
+        acc.matSum -= slot;
+        acc.matSumSq -= slot.cwiseAbs2();
+        ++acc.iNumReplaced;
+    } else {
+        ++acc.iCount;
+    }
+
+    slot = matEpoch;
+    acc.matSum += slot;
+    acc.matSumSq += slot.cwiseAbs2();
+
+    acc.iRingPos = (acc.iRingPos + 1) % m_iWindowSize;
+
+    //Round-off of the add/subtract updates grows slowly - refresh once per 16 window lengths (amortized O(1))
+    if(acc.iNumReplaced >= 16 * m_iWindowSize)
+        refreshSums(acc);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool RtAveEngine::average(MatrixXd &matAverage, qint32 iCondition) const
+{
+    QMap<qint32, RtAveAccumulator>::const_iterator it = m_qMapAccumulators.constFind(iCondition);
+    if(it == m_qMapAccumulators.constEnd())
+        return false;
+
+    const RtAveAccumulator& acc = it.value();
+
+    if(acc.iCount < 1)
+        return false;
+
+    matAverage = acc.matSum / acc.iCount;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool RtAveEngine::standardError(MatrixXd &matStdErr, qint32 iCondition) const
+{
+    QMap<qint32, RtAveAccumulator>::const_iterator it = m_qMapAccumulators.constFind(iCondition);
+    if(it == m_qMapAccumulators.constEnd())
+        return false;
+
+    const RtAveAccumulator& acc = it.value();
+
+    if(acc.iCount < 2)
+        return false;
+
+    double n = acc.iCount;
+
+    //Unbiased variance var = (sum(x^2) - sum(x)^2/n)/(n-1), stderr = sqrt(var/n)
+    matStdErr = ((acc.matSumSq - acc.matSum.cwiseAbs2() / n) / (n - 1.0)).cwiseMax(0.0);
+    matStdErr = (matStdErr / n).cwiseSqrt();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+qint32 RtAveEngine::count(qint32 iCondition) const
+{
+    QMap<qint32, RtAveAccumulator>::const_iterator it = m_qMapAccumulators.constFind(iCondition);
+    if(it == m_qMapAccumulators.constEnd())
+        return 0;
+
+    return it.value().iCount;
+}
+
+
+//*************************************************************************************************************
+
+RtAveAccumulator& RtAveEngine::accumulator(qint32 iCondition)
+{
+    QMap<qint32, RtAveAccumulator>::iterator it = m_qMapAccumulators.find(iCondition);
+    if(it == m_qMapAccumulators.end()) {
+        RtAveAccumulator acc;
+        acc.matSum = MatrixXd::Zero(m_iNumChannels, m_iNumSamples);
+        acc.matSumSq = MatrixXd::Zero(m_iNumChannels, m_iNumSamples);
+        acc.qVecRing = QVector<MatrixXd>(m_iWindowSize, MatrixXd(m_iNumChannels, m_iNumSamples));
+        acc.iRingPos = 0;
+        acc.iCount = 0;
+        acc.iNumReplaced = 0;
+
+        it = m_qMapAccumulators.insert(iCondition, acc);
+    }
+
+    return it.value();
+}
+
+
+//*************************************************************************************************************
+
+void RtAveEngine::refreshSums(RtAveAccumulator &acc) const
+{
+    acc.matSum.setZero();
+    acc.matSumSq.setZero();
+
+    for(qint32 i = 0; i < acc.iCount; ++i) {
+        acc.matSum += acc.qVecRing[i];
+        acc.matSumSq += acc.qVecRing[i].cwiseAbs2();
+    }
+
+    acc.iNumReplaced = 0;
+}
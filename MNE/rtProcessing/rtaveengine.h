@@ -0,0 +1,248 @@
+//=============================================================================================================
+/**
+* @file     rtaveengine.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     RtAveEngine class declaration.
+*
+*/
+
+#ifndef RTAVEENGINE_H
+#define RTAVEENGINE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtprocessing_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+#include <QMap>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RTPROCESSINGLIB
+//=============================================================================================================
+
+namespace RTPROCESSINGLIB
+{
+
+
+//=============================================================================================================
+/**
+* Running sum and sum of squares of the epochs of one condition. In the moving window mode the epochs are kept
+* in a preallocated ring of slots, so that the oldest epoch can be subtracted again when it drops out of the window.
+* The slots keep the full double precision of the input, so the average is not affected by the storage.
+*
+* @brief Accumulator of one averaging condition
+*/
+struct RTPROCESSINGSHARED_EXPORT RtAveAccumulator
+{
+    Eigen::MatrixXd             matSum;         /**< Running sum of all epochs in the window. */
+    Eigen::MatrixXd             matSumSq;       /**< Running sum of the squared epochs in the window. */
+    QVector<Eigen::MatrixXd>    qVecRing;       /**< Preallocated epoch slots, only used in the moving window mode. */
+    qint32                      iRingPos;       /**< Next slot of the ring which is to be overwritten. */
+    qint32                      iCount;         /**< Number of epochs currently accumulated. */
+    qint32                      iNumReplaced;   /**< Number of epochs replaced since the sums were last refreshed. */
+};
+
+
+//=============================================================================================================
+/**
+* Averaging engine which updates the average of each condition in constant time per epoch. Two modes are
+* supported: a moving window over the last n epochs (running average) and an unlimited cumulative average.
+* The standard error of the mean can be derived from the same accumulators.
+*
+* @brief Incremental epoch store and running-average engine
+*/
+class RTPROCESSINGSHARED_EXPORT RtAveEngine
+{
+
+public:
+    typedef QSharedPointer<RtAveEngine> SPtr;             /**< Shared pointer type for RtAveEngine. */
+    typedef QSharedPointer<const RtAveEngine> ConstSPtr;  /**< Const shared pointer type for RtAveEngine. */
+
+    //=========================================================================================================
+    /**
+    * Creates the averaging engine.
+    *
+    * @param[in] iNumChannels   Number of channels of each epoch
+    * @param[in] iNumSamples    Number of samples of each epoch
+    * @param[in] iWindowSize    Number of epochs in the moving window, values < 1 select the cumulative mode
+    */
+    explicit RtAveEngine(qint32 iNumChannels = 0, qint32 iNumSamples = 0, qint32 iWindowSize = 0);
+
+    //=========================================================================================================
+    /**
+    * Destroys the averaging engine.
+    */
+    ~RtAveEngine();
+
+    //=========================================================================================================
+    /**
+    * Reinitializes the engine with new epoch dimensions and window size. All accumulated epochs are discarded.
+    *
+    * @param[in] iNumChannels   Number of channels of each epoch
+    * @param[in] iNumSamples    Number of samples of each epoch
+    * @param[in] iWindowSize    Number of epochs in the moving window, values < 1 select the cumulative mode
+    */
+    void init(qint32 iNumChannels, qint32 iNumSamples, qint32 iWindowSize);
+
+    //=========================================================================================================
+    /**
+    * Discards all accumulated epochs of all conditions. The dimensions and the window size are kept.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Adds a new epoch to the accumulator of the given condition. In the moving window mode the oldest epoch is
+    * removed from the sums once the window is full.
+    *
+    * @param[in] matEpoch       The epoch of size iNumChannels x iNumSamples
+    * @param[in] iCondition     The condition the epoch belongs to, e.g. the trigger value
+    *
+    * @return false if the epoch dimensions do not match, true otherwise
+    */
+    bool addEpoch(const Eigen::MatrixXd &matEpoch, qint32 iCondition = 0);
+
+    //=========================================================================================================
+    /**
+    * Writes the current average of the given condition to matAverage.
+    *
+    * @param[out] matAverage    The average, resized if necessary
+    * @param[in] iCondition     The condition
+    *
+    * @return false if no epoch was accumulated for this condition yet, true otherwise
+    */
+    bool average(Eigen::MatrixXd &matAverage, qint32 iCondition = 0) const;
+
+    //=========================================================================================================
+    /**
+    * Writes the current standard error of the mean of the given condition to matStdErr.
+    *
+    * @param[out] matStdErr     The standard error, resized if necessary
+    * @param[in] iCondition     The condition
+    *
+    * @return false if less than two epochs were accumulated for this condition, true otherwise
+    */
+    bool standardError(Eigen::MatrixXd &matStdErr, qint32 iCondition = 0) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of epochs currently contributing to the average of the given condition.
+    *
+    * @param[in] iCondition     The condition
+    *
+    * @return the number of accumulated epochs
+    */
+    qint32 count(qint32 iCondition = 0) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the conditions for which epochs were accumulated.
+    *
+    * @return the list of conditions
+    */
+    inline QList<qint32> conditions() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the moving window size, or 0 in the cumulative mode.
+    *
+    * @return the window size
+    */
+    inline qint32 windowSize() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Returns the accumulator of the given condition and creates and preallocates it if not present yet.
+    *
+    * @param[in] iCondition     The condition
+    *
+    * @return reference to the accumulator
+    */
+    RtAveAccumulator& accumulator(qint32 iCondition);
+
+    //=========================================================================================================
+    /**
+    * Recomputes the sums of a moving window accumulator from its ring to get rid of accumulated round-off.
+    *
+    * @param[in, out] acc       The accumulator
+    */
+    void refreshSums(RtAveAccumulator &acc) const;
+
+    qint32                          m_iNumChannels;     /**< Number of channels of each epoch. */
+    qint32                          m_iNumSamples;      /**< Number of samples of each epoch. */
+    qint32                          m_iWindowSize;      /**< Moving window size, 0 for cumulative averaging. */
+
+    QMap<qint32, RtAveAccumulator>  m_qMapAccumulators; /**< Accumulator per condition. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline QList<qint32> RtAveEngine::conditions() const
+{
+    return m_qMapAccumulators.keys();
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 RtAveEngine::windowSize() const
+{
+    return m_iWindowSize;
+}
+
+} // NAMESPACE
+
+#endif // RTAVEENGINE_H
@@ -0,0 +1,175 @@
+//=============================================================================================================
+/**
+* @file     rthpidemod.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Implementation of the RtHPIDemod Class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rthpidemod.h"
+
+#include <cmath>
+#include <limits>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Dense>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RtHPIDemod::RtHPIDemod()
+: m_dSFreq(0)
+, m_iWindowSamples(0)
+, m_iWindowPos(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+RtHPIDemod::~RtHPIDemod()
+{
+}
+
+
+//*************************************************************************************************************
+
+void RtHPIDemod::setup(const VectorXd &vecCoilFreqs, double dSFreq, int iWindowSamples, const QVector<int> &vecChannels)
+{
+    bool bNewBasis = m_vecCoilFreqs.size() != vecCoilFreqs.size()
+            || m_vecCoilFreqs != vecCoilFreqs
+            || m_dSFreq != dSFreq
+            || m_iWindowSamples != iWindowSamples;
+
+    m_vecChannels = vecChannels;
+    m_iWindowPos = 0;
+    m_matWindow.resize(m_vecChannels.size(), iWindowSamples);
+
+    if(!bNewBasis)
+        return;
+
+    m_vecCoilFreqs = vecCoilFreqs;
+    m_dSFreq = dSFreq;
+    m_iWindowSamples = iWindowSamples;
+
+    int iNumCoils = m_vecCoilFreqs.size();
+
+    //Sine and cosine basis - same layout as used by RtHPIS::run
+    m_matBasis.resize(m_iWindowSamples, 2 * iNumCoils);
+    for(int i = 0; i < iNumCoils; ++i) {
+        for(int j = 0; j < m_iWindowSamples; ++j) {
+            double dPhase = 2.0 * M_PI * m_vecCoilFreqs[i] * j / m_dSFreq;
+            m_matBasis(j, i) = std::sin(dPhase);
+            m_matBasis(j, i + iNumCoils) = std::cos(dPhase);
+        }
+    }
+
+    //Pseudo-inverse via SVD, computed only once per configuration
+    JacobiSVD<MatrixXd> svd(m_matBasis, ComputeThinU | ComputeThinV);
+    VectorXd vecSingular = svd.singularValues();
+    double dTolerance = std::numeric_limits<double>::epsilon() * std::max(m_matBasis.rows(), m_matBasis.cols()) * vecSingular(0);
+    VectorXd vecInvSingular = (vecSingular.array() > dTolerance).select(vecSingular.array().inverse(), 0);
+
+    //(pinv(basis))^T = U * S^-1 * V^T
+    m_matProjT = svd.matrixU() * vecInvSingular.asDiagonal() * svd.matrixV().transpose();
+}
+
+
+//*************************************************************************************************************
+
+QList<MatrixXd> RtHPIDemod::append(const MatrixXd &matData)
+{
+    QList<MatrixXd> lTopos;
+
+    if(m_iWindowSamples <= 0) {
+        qWarning() << "RtHPIDemod::append - Demodulator was not set up.";
+        return lTopos;
+    }
+
+    int iCol = 0;
+    while(iCol < matData.cols()) {
+        int iNumCopy = std::min(m_iWindowSamples - m_iWindowPos, int(matData.cols()) - iCol);
+
+        for(int i = 0; i < m_vecChannels.size(); ++i)
+            m_matWindow.block(i, m_iWindowPos, 1, iNumCopy) = matData.block(m_vecChannels[i], iCol, 1, iNumCopy);
+
+        m_iWindowPos += iNumCopy;
+        iCol += iNumCopy;
+
+        if(m_iWindowPos == m_iWindowSamples) {
+            MatrixXd matTopo;
+            demodulate(m_matWindow, matTopo);
+            lTopos.append(matTopo);
+            m_iWindowPos = 0;
+        }
+    }
+
+    return lTopos;
+}
+
+
+//*************************************************************************************************************
+
+void RtHPIDemod::demodulate(const MatrixXd &matWindow, MatrixXd &matTopo) const
+{
+    matTopo.noalias() = matWindow * m_matProjT;
+}
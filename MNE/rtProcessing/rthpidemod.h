@@ -0,0 +1,183 @@
+//=============================================================================================================
+/**
+* @file     rthpidemod.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     RtHPIDemod class declaration.
+*
+*/
+
+#ifndef RTHPIDEMOD_H
+#define RTHPIDEMOD_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtprocessing_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+#include <QList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RTPROCESSINGLIB
+//=============================================================================================================
+
+namespace RTPROCESSINGLIB
+{
+
+
+//=============================================================================================================
+/**
+* Streaming demodulation of the continuous HPI signals. The sine/cosine basis of the coil frequencies and its
+* pseudo-inverse are computed once per configuration. Incoming data blocks of arbitrary size are collected into
+* a preallocated window and each completed window is demodulated with a single matrix product.
+*
+* @brief Streaming cHPI amplitude demodulation
+*/
+class RTPROCESSINGSHARED_EXPORT RtHPIDemod
+{
+
+public:
+    typedef QSharedPointer<RtHPIDemod> SPtr;             /**< Shared pointer type for RtHPIDemod. */
+    typedef QSharedPointer<const RtHPIDemod> ConstSPtr;  /**< Const shared pointer type for RtHPIDemod. */
+
+    //=========================================================================================================
+    /**
+    * Creates the demodulator. setup() has to be called before data can be appended.
+    */
+    explicit RtHPIDemod();
+
+    //=========================================================================================================
+    /**
+    * Destroys the demodulator.
+    */
+    ~RtHPIDemod();
+
+    //=========================================================================================================
+    /**
+    * Sets up the demodulator. The basis pseudo-inverse is only recomputed if frequencies, sampling frequency or
+    * window length changed. Samples of a not yet completed window are discarded.
+    *
+    * @param[in] vecCoilFreqs       The coil driving frequencies in Hz
+    * @param[in] dSFreq             The sampling frequency in Hz
+    * @param[in] iWindowSamples     The number of samples of each demodulation window
+    * @param[in] vecChannels        The rows of the incoming data which are to be demodulated
+    */
+    void setup(const Eigen::VectorXd &vecCoilFreqs, double dSFreq, int iWindowSamples, const QVector<int> &vecChannels);
+
+    //=========================================================================================================
+    /**
+    * Appends a data block. Every time a window is completed its sine/cosine topographies are computed.
+    *
+    * @param[in] matData        The data block (all channels x samples)
+    *
+    * @return the topographies (channels x 2*coils, sine then cosine parts) of all windows completed by this block
+    */
+    QList<Eigen::MatrixXd> append(const Eigen::MatrixXd &matData);
+
+    //=========================================================================================================
+    /**
+    * Demodulates a complete window of the selected channels.
+    *
+    * @param[in] matWindow      The window (selected channels x window samples)
+    * @param[out] matTopo       The sine/cosine topographies (selected channels x 2*coils)
+    */
+    void demodulate(const Eigen::MatrixXd &matWindow, Eigen::MatrixXd &matTopo) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the sine/cosine basis (window samples x 2*coils).
+    *
+    * @return the basis
+    */
+    inline const Eigen::MatrixXd& basis() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples of each demodulation window.
+    *
+    * @return the window length
+    */
+    inline int windowSamples() const;
+
+private:
+    Eigen::VectorXd     m_vecCoilFreqs;     /**< The coil driving frequencies in Hz. */
+    double              m_dSFreq;           /**< The sampling frequency in Hz. */
+    int                 m_iWindowSamples;   /**< The number of samples of each window. */
+    int                 m_iWindowPos;       /**< The number of samples already collected in the current window. */
+
+    QVector<int>        m_vecChannels;      /**< The rows of the incoming data which are demodulated. */
+
+    Eigen::MatrixXd     m_matBasis;         /**< The sine/cosine basis (window samples x 2*coils). */
+    Eigen::MatrixXd     m_matProjT;         /**< The transposed pseudo-inverse of the basis (window samples x 2*coils). */
+    Eigen::MatrixXd     m_matWindow;        /**< The preallocated window of the selected channels. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline const Eigen::MatrixXd& RtHPIDemod::basis() const
+{
+    return m_matBasis;
+}
+
+
+//*************************************************************************************************************
+
+inline int RtHPIDemod::windowSamples() const
+{
+    return m_iWindowSamples;
+}
+
+} // NAMESPACE
+
+#endif // RTHPIDEMOD_H
@@ -0,0 +1,314 @@
+//=============================================================================================================
+/**
+* @file     rthpifit.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Implementation of the RtHPIFit Class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rthpifit.h"
+
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Dense>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtConcurrent/QtConcurrent>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+const double dDipoleConst = 1e-7 / (4.0 * M_PI);  /**< Same field scaling as RtHPIS::magnetic_dipole. */
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+double HPIFitData::evaluate(const Vector3d &vecPos, const Vector3d &vecMom, Matrix<double,6,6> *pJtJ, Matrix<double,6,1> *pJtr) const
+{
+    const MatrixXd& matPos = *pSensorPos;
+    const MatrixXd& matOri = *pSensorOri;
+
+    if(pJtJ && pJtr) {
+        pJtJ->setZero();
+        pJtr->setZero();
+    }
+
+    Vector3d d, o, dBdm, dBdd;
+    Matrix<double,6,1> j;
+    double dCost = 0.0;
+
+    for(int i = 0; i < matPos.rows(); ++i) {
+        d << matPos(i,0) - vecPos(0), matPos(i,1) - vecPos(1), matPos(i,2) - vecPos(2);
+        o << matOri(i,0), matOri(i,1), matOri(i,2);
+
+        double r2 = d.squaredNorm();
+        if(r2 < 1e-12)
+            continue;
+
+        double ir2 = 1.0 / r2;
+        double ir3 = ir2 / std::sqrt(r2);
+        double ir5 = ir3 * ir2;
+        double od = o.dot(d);
+        double md = vecMom.dot(d);
+        double mo = vecMom.dot(o);
+
+        //B = c * (3*(m.d)*(o.d)/r^5 - (m.o)/r^3)
+        double dRes = vecData(i) - dDipoleConst * (3.0 * md * od * ir5 - mo * ir3);
+        dCost += dRes * dRes;
+
+        if(pJtJ && pJtr) {
+            //Residual derivative with respect to the position equals dB/dd since d = sensor - pos
+            dBdd = dDipoleConst * (3.0 * ir5 * (vecMom * od + o * md) + (3.0 * mo * ir5 - 15.0 * md * od * ir5 * ir2) * d);
+            dBdm = dDipoleConst * (3.0 * od * ir5 * d - ir3 * o);
+
+            j << dBdd, -dBdm;
+
+            pJtJ->noalias() += j * j.transpose();
+            pJtr->noalias() += j * dRes;
+        }
+    }
+
+    return dCost;
+}
+
+
+//*************************************************************************************************************
+
+Vector3d HPIFitData::linearMoment(const Vector3d &vecPos) const
+{
+    const MatrixXd& matPos = *pSensorPos;
+    const MatrixXd& matOri = *pSensorOri;
+
+    Matrix3d matLtL = Matrix3d::Zero();
+    Vector3d vecLtb = Vector3d::Zero();
+    Vector3d d, o, l;
+
+    for(int i = 0; i < matPos.rows(); ++i) {
+        d << matPos(i,0) - vecPos(0), matPos(i,1) - vecPos(1), matPos(i,2) - vecPos(2);
+        o << matOri(i,0), matOri(i,1), matOri(i,2);
+
+        double r2 = d.squaredNorm();
+        if(r2 < 1e-12)
+            continue;
+
+        double ir3 = 1.0 / (r2 * std::sqrt(r2));
+
+        //Lead field row of the three moment components
+        l = dDipoleConst * (3.0 * o.dot(d) * ir3 / r2 * d - ir3 * o);
+
+        matLtL.noalias() += l * l.transpose();
+        vecLtb += l * vecData(i);
+    }
+
+    return matLtL.ldlt().solve(vecLtb);
+}
+
+
+//*************************************************************************************************************
+
+void HPIFitData::doFit()
+{
+    double dDataNorm = vecData.squaredNorm();
+
+    iNumIter = 0;
+
+    if(dDataNorm <= 0.0) {
+        vecMom.setZero();
+        dError = 1.0;
+        return;
+    }
+
+    Matrix<double,6,6> matJtJ, matH;
+    Matrix<double,6,1> vecJtr, vecDelta;
+    Vector3d vecPosTrial, vecMomTrial;
+
+    vecMom = linearMoment(vecPos);
+
+    double dLambda = 1e-3;
+    double dCost = evaluate(vecPos, vecMom, &matJtJ, &vecJtr);
+
+    while(iNumIter < iMaxIter) {
+        ++iNumIter;
+
+        //Marquardt scaling of the damping, which makes the step independent of the units of position and moment
+        matH = matJtJ;
+        matH.diagonal() *= (1.0 + dLambda);
+        vecDelta = matH.ldlt().solve(-vecJtr);
+
+        vecPosTrial = vecPos + vecDelta.head<3>();
+        vecMomTrial = vecMom + vecDelta.tail<3>();
+
+        double dCostTrial = evaluate(vecPosTrial, vecMomTrial);
+
+        if(dCostTrial < dCost) {
+            double dImprovement = (dCost - dCostTrial) / dCost;
+
+            vecPos = vecPosTrial;
+            vecMom = vecMomTrial;
+            dLambda = std::max(dLambda * 0.1, 1e-12);
+            dCost = evaluate(vecPos, vecMom, &matJtJ, &vecJtr);
+
+            if(dImprovement < 1e-10 || vecDelta.head<3>().norm() < 1e-9)
+                break;
+        } else {
+            dLambda *= 10.0;
+            if(dLambda > 1e10)
+                break;
+        }
+    }
+
+    dError = dCost / dDataNorm;
+}
+
+
+//*************************************************************************************************************
+
+RtHPIFit::RtHPIFit(int iMaxIter)
+: m_iMaxIter(iMaxIter)
+, m_bConcurrent(true)
+{
+}
+
+
+//*************************************************************************************************************
+
+RtHPIFit::~RtHPIFit()
+{
+}
+
+
+//*************************************************************************************************************
+
+void RtHPIFit::setSensors(const struct sens &sensors)
+{
+    m_matSensorPos = sensors.coilpos;
+    m_matSensorOri = sensors.coilori;
+
+    m_lFitData.clear();
+}
+
+
+//*************************************************************************************************************
+
+bool RtHPIFit::fit(struct coilParam &coil, const MatrixXd &matData)
+{
+    if(matData.rows() != m_matSensorPos.rows() || m_matSensorPos.rows() == 0) {
+        qWarning() << "RtHPIFit::fit - Data rows" << matData.rows() << "do not match the number of sensors" << m_matSensorPos.rows();
+        return false;
+    }
+
+    int iNumCoils = matData.cols();
+
+    if(coil.pos.rows() != iNumCoils || coil.pos.cols() != 3)
+        coil.pos = MatrixXd::Zero(iNumCoils, 3);
+    coil.mom.resize(iNumCoils, 3);
+    coil.dpfiterror.resize(iNumCoils);
+    coil.dpfitnumitr.resize(iNumCoils);
+
+    //Keep the per coil fit state between calls
+    while(m_lFitData.size() < iNumCoils) {
+        HPIFitData fitData;
+        fitData.pSensorPos = &m_matSensorPos;
+        fitData.pSensorOri = &m_matSensorOri;
+        fitData.vecData.resize(m_matSensorPos.rows());
+        m_lFitData.append(fitData);
+    }
+    while(m_lFitData.size() > iNumCoils)
+        m_lFitData.removeLast();
+
+    for(int i = 0; i < iNumCoils; ++i) {
+        HPIFitData& fitData = m_lFitData[i];
+        fitData.vecData = matData.col(i);
+        fitData.iMaxIter = m_iMaxIter;
+        fitData.vecPos = coil.pos.row(i).transpose();
+
+        //Cold start below the sensor which sees the coil best
+        if(fitData.vecPos.isZero()) {
+            int iMaxIdx = 0;
+            fitData.vecData.cwiseAbs().maxCoeff(&iMaxIdx);
+            fitData.vecPos = 0.9 * m_matSensorPos.row(iMaxIdx).transpose();
+        }
+    }
+
+    if(m_bConcurrent && iNumCoils > 1) {
+        QFuture<void> future = QtConcurrent::map(m_lFitData, &HPIFitData::doFit);
+        future.waitForFinished();
+    } else {
+        for(int i = 0; i < iNumCoils; ++i)
+            m_lFitData[i].doFit();
+    }
+
+    for(int i = 0; i < iNumCoils; ++i) {
+        const HPIFitData& fitData = m_lFitData.at(i);
+        coil.pos.row(i) = fitData.vecPos.transpose();
+        coil.mom.row(i) = fitData.vecMom.transpose();
+        coil.dpfiterror(i) = fitData.dError;
+        coil.dpfitnumitr(i) = fitData.iNumIter;
+    }
+
+    return true;
+}
@@ -0,0 +1,229 @@
+//=============================================================================================================
+/**
+* @file     rthpifit.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     RtHPIFit class declaration.
+*
+*/
+
+#ifndef RTHPIFIT_H
+#define RTHPIFIT_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtprocessing_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RTPROCESSINGLIB
+//=============================================================================================================
+
+namespace RTPROCESSINGLIB
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Declare all structures to be used
+//=============================================================================================================
+
+struct coilParam {
+    Eigen::MatrixXd pos;
+    Eigen::MatrixXd mom;
+    Eigen::VectorXd dpfiterror;
+    Eigen::VectorXd dpfitnumitr;
+};
+
+struct dipError {
+    double error;
+    Eigen::MatrixXd moment;
+};
+
+struct sens {
+    Eigen::MatrixXd coilpos;
+    Eigen::MatrixXd coilori;
+    Eigen::MatrixXd tra;
+};
+
+
+//=============================================================================================================
+/**
+* Fit of a single magnetic dipole to the amplitudes of one HPI coil. All state needed by the fit is held in the
+* object itself, so that the coils can be fitted concurrently.
+*
+* @brief Levenberg-Marquardt fit of one HPI coil
+*/
+struct RTPROCESSINGSHARED_EXPORT HPIFitData
+{
+    //=========================================================================================================
+    /**
+    * Fits position and moment of the dipole starting from vecPos. The residual and its analytic Jacobian are
+    * accumulated channel by channel into fixed size normal equations, hence no memory is allocated while iterating.
+    */
+    void doFit();
+
+    //=========================================================================================================
+    /**
+    * Evaluates the squared residual norm at the given dipole and, if pJtJ and pJtr are given, the normal
+    * equations of the linearized problem.
+    *
+    * @param[in] vecPos     Dipole position
+    * @param[in] vecMom     Dipole moment
+    * @param[out] pJtJ      J^T*J of the residual Jacobian J (optional)
+    * @param[out] pJtr      J^T*r of the residual Jacobian J and the residual r (optional)
+    *
+    * @return the squared residual norm
+    */
+    double evaluate(const Eigen::Vector3d &vecPos, const Eigen::Vector3d &vecMom, Eigen::Matrix<double,6,6> *pJtJ = 0, Eigen::Matrix<double,6,1> *pJtr = 0) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the moment which fits the data best at the given position (linear least squares).
+    *
+    * @param[in] vecPos     Dipole position
+    *
+    * @return the dipole moment
+    */
+    Eigen::Vector3d linearMoment(const Eigen::Vector3d &vecPos) const;
+
+    const Eigen::MatrixXd*  pSensorPos;     /**< Sensor positions (nchan x 3). */
+    const Eigen::MatrixXd*  pSensorOri;     /**< Sensor orientations (nchan x 3). */
+    Eigen::VectorXd         vecData;        /**< Coil amplitudes measured at the sensors. */
+    Eigen::Vector3d         vecPos;         /**< Dipole position, initial guess on input and fit result on output. */
+    Eigen::Vector3d         vecMom;         /**< Fitted dipole moment. */
+    double                  dError;         /**< Relative residual error of the fit. */
+    int                     iNumIter;       /**< Number of iterations needed. */
+    int                     iMaxIter;       /**< Maximal number of iterations. */
+};
+
+
+//=============================================================================================================
+/**
+* Fits the HPI coils as magnetic dipoles in an infinite medium. Instead of a simplex search each coil is fitted
+* with Levenberg-Marquardt iterations on position and moment using the analytic Jacobian of the dipole field.
+* The fit is warm started from the previous coil positions and the coils are fitted in parallel.
+*
+* @brief Fast HPI coil fitting
+*/
+class RTPROCESSINGSHARED_EXPORT RtHPIFit
+{
+
+public:
+    typedef QSharedPointer<RtHPIFit> SPtr;             /**< Shared pointer type for RtHPIFit. */
+    typedef QSharedPointer<const RtHPIFit> ConstSPtr;  /**< Const shared pointer type for RtHPIFit. */
+
+    //=========================================================================================================
+    /**
+    * Creates the HPI fit object.
+    *
+    * @param[in] iMaxIter       Maximal number of Levenberg-Marquardt iterations per coil
+    */
+    explicit RtHPIFit(int iMaxIter = 50);
+
+    //=========================================================================================================
+    /**
+    * Destroys the HPI fit object.
+    */
+    ~RtHPIFit();
+
+    //=========================================================================================================
+    /**
+    * Sets the sensors used for the fit. Only sensors.coilpos and sensors.coilori are used.
+    *
+    * @param[in] sensors        The sensor definition
+    */
+    void setSensors(const struct sens &sensors);
+
+    //=========================================================================================================
+    /**
+    * Sets whether the coils are fitted concurrently.
+    *
+    * @param[in] bConcurrent    Whether to fit the coils in parallel
+    */
+    inline void setConcurrent(bool bConcurrent);
+
+    //=========================================================================================================
+    /**
+    * Fits all coils. The positions in coil are used as initial guess. Coils which have not been fitted before
+    * (zero position) are started below the sensor with the strongest amplitude.
+    *
+    * @param[in, out] coil      The coil parameters, holding the previous fit on input
+    * @param[in] matData        The coil amplitudes (nchan x ncoils)
+    *
+    * @return false if the data do not match the sensors, true otherwise
+    */
+    bool fit(struct coilParam &coil, const Eigen::MatrixXd &matData);
+
+private:
+    int                     m_iMaxIter;         /**< Maximal number of iterations per coil. */
+    bool                    m_bConcurrent;      /**< Whether to fit the coils in parallel. */
+
+    Eigen::MatrixXd         m_matSensorPos;     /**< Sensor positions (nchan x 3). */
+    Eigen::MatrixXd         m_matSensorOri;     /**< Sensor orientations (nchan x 3). */
+
+    QList<HPIFitData>       m_lFitData;         /**< Fit state of each coil, reused between fits. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline void RtHPIFit::setConcurrent(bool bConcurrent)
+{
+    m_bConcurrent = bConcurrent;
+}
+
+} // NAMESPACE
+
+#endif // RTHPIFIT_H
@@ -45,7 +45,6 @@
 
 #include <iostream>
 #include <fiff/fiff_cov.h>
-#include <fstream>
 
 
 //*************************************************************************************************************
@@ -171,32 +170,6 @@ void RtHPIS::run()
     coil.dpfiterror = Eigen::VectorXd::Zero(numCoils);
     coil.dpfitnumitr = Eigen::VectorXd::Zero(numCoils);
 
-    // Generate simulated data
-    Eigen::MatrixXd simsig(samLoc,numCoils*2);
-    Eigen::VectorXd time(samLoc);
-
-    for (int i = 0;i < samLoc;i++) time[i] = i*1.0/samF;
-
-    std::ofstream outsin;
-    outsin.open ("C:/Users/babyMEG/Desktop/Seok/sin.txt");
-    std::ofstream outcos;
-    outcos.open ("C:/Users/babyMEG/Desktop/Seok/cos.txt");
-
-    for(int i=0;i<numCoils;i++) {
-        for(int j=0;j<samLoc;j++) {
-            simsig(j,i) = sin(2*M_PI*coilfreq[i]*time[j]);
-            simsig(j,i+numCoils) = cos(2*M_PI*coilfreq[i]*time[j]);
-
-            outsin <<simsig(j,i)<<" ";
-            outcos <<simsig(j,i+numCoils) << " ";
-        }
-            outsin <<"\n";
-            outcos <<"\n";
-    }
-
-    outsin.close();
-    outcos.close();
-
     // Get the indices of inner layer channels
     QVector<int> innerind(0);
     for (int i = 0;i < numCh;i++) {
@@ -241,6 +214,11 @@ void RtHPIS::run()
         sensors.coilori(i,2) = m_pFiffInfo->chs[innerind.at(i)].loc(11,0);
     }
 
+    m_hpiFit.setSensors(sensors);
+
+    // Set up the demodulation of the inner layer channels. The basis pseudo-inverse is computed only once here.
+    m_hpiDemod.setup(coilfreq, m_pFiffInfo->sfreq, samLoc, innerind);
+
     //load polhemus HPI
     Eigen::MatrixXd headHPI(numCoils,3);
 
@@ -278,38 +256,10 @@ void RtHPIS::run()
     Eigen::MatrixXd amp(innerind.size(),numCoils);
     Eigen::Matrix4d trans;
 
-    QVector<MatrixXd> buffer;
     double phase;
 
-    // Seok ---------------------------------
     qDebug()<< "======= coil driving frequency (Hz)======== ";
     qDebug() << coilfreq[0] << ", " << coilfreq[1] << ", " << coilfreq[2] << ", " << coilfreq[3];
-//    qDebug() << "samLoc (1024): " << samLoc;
-    int OUT_FLAG = 1;
-    int OUT_RAW = 1;
-    std::ofstream outinnerdata;
-    outinnerdata.open ("C:/Users/babyMEG/Desktop/Seok/innerdata.txt");
-    std::ofstream outtrigdata;
-    outtrigdata.open ("C:/Users/babyMEG/Desktop/Seok/trigdata.txt");
-
-    std::ofstream outtopo;
-    outtopo.open ("C:/Users/babyMEG/Desktop/Seok/topo.txt");
-    std::ofstream outamp;
-    outamp.open ("C:/Users/babyMEG/Desktop/Seok/amp.txt");
-    std::ofstream outphase;
-    outphase.open ("C:/Users/babyMEG/Desktop/Seok/phase.txt");
-    std::ofstream outxfm;
-    outxfm.open ("C:/Users/babyMEG/Desktop/Seok/xfm.txt");
-    std::ofstream outcoilp;
-    outcoilp.open ("C:/Users/babyMEG/Desktop/Seok/coilp.txt");
-    std::ofstream outcoilm;
-    outcoilm.open ("C:/Users/babyMEG/Desktop/Seok/coilm.txt");
-    std::ofstream outdpfiterror;
-    outdpfiterror.open ("C:/Users/babyMEG/Desktop/Seok/dpfiterror.txt");
-    std::ofstream outdpfitnumitr;
-    outdpfitnumitr.open ("C:/Users/babyMEG/Desktop/Seok/dpfitnumitr.txt");
-
-    // --------------------------------------
 
     int counter = 0;
     int sum = 0;
@@ -323,201 +273,63 @@ void RtHPIS::run()
 
             MatrixXd t_mat = m_pRawMatrixBuffer->pop();
 
-            buffer.append(t_mat);
-//            qDebug() << "buffer(size): " << buffer.length();
-//            qDebug() << "t_mat(size): " << t_mat.rows() << " x " << t_mat.cols();
+            // Demodulate every completed window, which costs one matrix product per window
+            QList<MatrixXd> lTopos = m_hpiDemod.append(t_mat);
 
-            if(buffer.size()*t_mat.cols() >= samLoc)
+            for(int w = 0; w < lTopos.size(); ++w)
             {
-                Eigen::MatrixXd alldata(t_mat.rows(),buffer.size()*t_mat.cols());
-
-                // Concatenate data into a matrix
-                for(int i=0;i<buffer.size();i++) alldata << buffer[i];
-
-                // Get the data from inner layer channels
-                Eigen::MatrixXd innerdata(innerind.size(),samLoc);
-                Eigen::MatrixXd trigdata(trigind.size(),samLoc);
-
-                numBlock = alldata.cols()/samLoc;
-
-                // Loop for localizing coils
-                for(int i = 0;i<numBlock;i++) {
-                    for(int j = 0;j < innerind.size();j++){
-                        innerdata.row(j) << alldata.block(innerind[j],i*samLoc,1,samLoc);
-                        if (OUT_RAW == 1) {
-                            for (int k = 0; k < innerdata.cols(); k++)
-                                outinnerdata << innerdata(j,k) << " ";
-                        }
-                   }
-                    for(int j = 0;j < trigind.size();j++){
-                        trigdata.row(j) << alldata.block(trigind[j],i*samLoc,1,samLoc);
-                        if (OUT_RAW == 1) {
-                            for (int k = 0; k < trigdata.cols(); k++)
-                                outtrigdata << trigdata(j,k) << " ";
-                        }
-                   }
-                    if (OUT_RAW == 1) {
-                       outinnerdata << "\n";
-                       outtrigdata << "\n";
-                   }
-                }
-
-//                    qDebug() << "numBlock: " << numBlock;
-//                    qDebug() << "alldata: " << alldata.rows() << " x " << alldata.cols();
-//                    qDebug() << "innerdata: " << innerdata.rows() << " x " << innerdata.cols();
-//                    qDebug() << "trigdata: " << trigdata.rows() << " x " << trigdata.cols();
-
-                    // topo 247 x 8
-                    topo = innerdata * pinv(simsig).transpose();
-                    //topo = innerdata * pinv(trigdata.transpose()).transpose();
-                    qDebug() << "topo: " << topo.rows() << " " << topo.cols();
-
-                    for (int i =0; i<numCoils; i++) {
-                        for (int j =0; j< innerind.size(); j++)
-                            outtopo << topo(j,i) << " ";
+                // topo 247 x 8
+                topo = lTopos.at(w);
 
-                        outtopo << "\n";
-                    }
+                // amp 247 x 4
+                amp = (topo.leftCols(numCoils).array().square() + topo.rightCols(numCoils).array().square()).array().sqrt();
 
+                for (int i = 0;i < numCoils;i++) {
+                    for (int j = 0;j < innerind.size();j++) {
+                        phase = atan2(topo(j,i+numCoils),topo(j,i)) * 180/M_PI;
+                        if(phase < 0) phase = 360 + phase;
+                        if(phase <= 90) phase = 1;
+                        else if(phase > 90 || phase <= 270) phase = -1;
+                        else phase = 1;
 
-                    // amp 247 x 4
-                    amp = (topo.leftCols(numCoils).array().square() + topo.rightCols(numCoils).array().square()).array().sqrt();
-                    //amp = (topo.array().square()).array().sqrt();
-                    qDebug() << "amp: " << amp.rows() << " " << amp.cols();
-
-                    for (int i = 0;i < numCoils;i++) {
-                        for (int j = 0;j < innerind.size();j++) {
-                            phase = atan2(topo(j,i+numCoils),topo(j,i)) * 180/M_PI;
-                            if(phase < 0) phase = 360 + phase;
-                            if(phase <= 90) phase = 1;
-                            else if(phase > 90 || phase <= 270) phase = -1;
-                            else phase = 1;
-
-                            amp(j,i) = amp(j,i) * phase;
-
-                            if (OUT_FLAG == 1) {
-                                outamp << amp(j,i) << " ";
-                                outphase << phase << " ";
-                            }
-                        }
-                        if (OUT_FLAG == 1) {
-                            outamp << "\n";
-                            outphase << "\n";
-                        }
+                        amp(j,i) = amp(j,i) * phase;
                     }
+                }
 
-//                    coil.pos(0,0) = 22; coil.pos(0,1) = 60; coil.pos(0,2) = 20;
-//                    coil.pos(1,0) = 32; coil.pos(1,1) = 48; coil.pos(1,2) = 34;
-//                    coil.pos(2,0) = 35; coil.pos(2,1) = 10; coil.pos(2,2) = 48;
-//                    coil.pos(3,0) = 60; coil.pos(3,1) =  4; coil.pos(3,2) = 12;
-//                    coil.pos(0,0) = 0; coil.pos(0,1) = 0; coil.pos(0,2) = 0;
-//                    coil.pos(1,0) = 0; coil.pos(1,1) = 0; coil.pos(1,2) = 0;
-//                    coil.pos(2,0) = 0; coil.pos(2,1) = 0; coil.pos(2,2) = 0;
-//                    coil.pos(3,0) = 0; coil.pos(3,1) = 0; coil.pos(3,2) = 0;
-                    coil = dipfit(coil, sensors, amp, numCoils);
-
-//                    qDebug()<<"HPI head "<<headHPI(0,0)<<" "<<headHPI(0,1)<<" "<<headHPI(0,2);
-//                    qDebug()<<"HPI head "<<headHPI(1,0)<<" "<<headHPI(1,1)<<" "<<headHPI(1,2);
-//                    qDebug()<<"HPI head "<<headHPI(2,0)<<" "<<headHPI(2,1)<<" "<<headHPI(2,2);
-//                    qDebug()<<"HPI head "<<headHPI(3,0)<<" "<<headHPI(3,1)<<" "<<headHPI(3,2);
-
-
-//                    qDebug()<<"HPI device "<<1e3*coil.pos(0,0)<<" "<<1e3*coil.pos(0,1)<<" "<<1e3*coil.pos(0,2);
-//                    qDebug()<<"HPI device "<<1e3*coil.pos(1,0)<<" "<<1e3*coil.pos(1,1)<<" "<<1e3*coil.pos(1,2);
-//                    qDebug()<<"HPI device "<<1e3*coil.pos(2,0)<<" "<<1e3*coil.pos(2,1)<<" "<<1e3*coil.pos(2,2);
-//                    qDebug()<<"HPI device "<<1e3*coil.pos(3,0)<<" "<<1e3*coil.pos(3,1)<<" "<<1e3*coil.pos(3,2);
-//                    qDebug()<<"HPI dpfit error "<<coil.dpfiterror(0) <<" "<<coil.dpfiterror(1) <<" "<<coil.dpfiterror (2)<<" " << coil.dpfiterror(3);
-
-                    //outcoilp << "   coil position" << "\n";
-                    if (OUT_FLAG == 1) {
-                        outcoilp <<coil.pos(0,0)<<" "<<coil.pos(0,1)<<" "<<coil.pos(0,2) <<"\n";
-                        outcoilp <<coil.pos(1,0)<<" "<<coil.pos(1,1)<<" "<<coil.pos(1,2) <<"\n";
-                        outcoilp <<coil.pos(2,0)<<" "<<coil.pos(2,1)<<" "<<coil.pos(2,2) <<"\n";
-                        outcoilp <<coil.pos(3,0)<<" "<<coil.pos(3,1)<<" "<<coil.pos(3,2) <<"\n";
-
-                        outcoilm <<coil.mom(0,0)<<" "<<coil.mom(0,1)<<" "<<coil.mom(0,2) <<"\n";
-                        outcoilm <<coil.mom(1,0)<<" "<<coil.mom(1,1)<<" "<<coil.mom(1,2) <<"\n";
-                        outcoilm <<coil.mom(2,0)<<" "<<coil.mom(2,1)<<" "<<coil.mom(2,2) <<"\n";
-                        outcoilm <<coil.mom(3,0)<<" "<<coil.mom(3,1)<<" "<<coil.mom(3,2) <<"\n";
-
-                        outdpfiterror << coil.dpfiterror(0) <<" "<<coil.dpfiterror(1) <<" "<<coil.dpfiterror(2) <<" " << coil.dpfiterror(3) <<"\n";
-                        outdpfitnumitr << coil.dpfitnumitr(0) <<" "<<coil.dpfitnumitr(1) <<" "<<coil.dpfitnumitr(2) <<" " << coil.dpfitnumitr(3) <<"\n";
-                    }
-                    trans = computeTransformation(coil.pos,headHPI);
+                coil = dipfit(coil, amp, numCoils);
 
-                    for(int ti =0; ti<4;ti++)
-                        for(int tj=0;tj<4;tj++)
-                    m_pFiffInfo->dev_head_t.trans(ti,tj) = trans(ti,tj);
+                trans = computeTransformation(coil.pos,headHPI);
 
-//                    qDebug()<<"**** rotation ------- dev2head transformation ************";
-//                    qDebug()<< trans(0,0)<<" "<<trans(0,1)<<" "<<trans(0,2);
-//                    qDebug()<< trans(1,0)<<" "<<trans(1,1)<<" "<<trans(1,2);
-//                    qDebug()<< trans(2,0)<<" "<<trans(2,1)<<" "<<trans(2,2);
-//                    qDebug()<<"**** translation(dx,dy,dz) - dev2head transformation ***********";
-//                    qDebug()<< 1e3*trans(0,3)<<" "<<1e3*trans(1,3)<<" "<<1e3*trans(2,3);
-
-/*                     if (OUT_FLAG == 1) {
-                    //outxfm << "   rotation" << "\n";
-                    outxfm << trans(0,0)<<" "<<trans(0,1)<<" "<<trans(0,2) <<" "<< trans(0,3)<<"\n";
-                    outxfm << trans(1,0)<<" "<<trans(1,1)<<" "<<trans(1,2) <<" "<< trans(1,3)<<"\n";
-                    outxfm << trans(2,0)<<" "<<trans(2,1)<<" "<<trans(2,2) <<" "<< trans(2,3)<<"\n";
-                    }
-*/
-                }
-                buffer.clear();
-
-                int elapsed = timer.elapsed();
-                qDebug() << "hpi took" << elapsed << "milliseconds";
+                for(int ti =0; ti<4;ti++)
+                    for(int tj=0;tj<4;tj++)
+                        m_pFiffInfo->dev_head_t.trans(ti,tj) = trans(ti,tj);
+            }
 
-                counter++;
-                sum += elapsed;
+            int elapsed = timer.elapsed();
+            qDebug() << "hpi took" << elapsed << "milliseconds";
 
-                qDebug() << "current average time for"<< counter <<"values is"<< sum/counter << "milliseconds";
+            counter++;
+            sum += elapsed;
 
+            qDebug() << "current average time for"<< counter <<"values is"<< sum/counter << "milliseconds";
         }//m_pRawMatrixBuffer
-
     } //m_bIsRunning
-    outinnerdata.close();
-    outtrigdata.close();
-    outtopo.close();
-    outamp.close();
-    outphase.close();
-    outxfm.close();
-    outcoilp.close();
-    outcoilm.close();
-    outdpfiterror.close();
-    outdpfitnumitr.close();
-
 }
 
 
 /*********************************************************************************
- * dipfit function is adapted from Fieldtrip Software. It has been
- * heavily edited for use with MNE Scan Software
+ * dipfit fits all coils with the Levenberg-Marquardt fit of RtHPIFit, starting
+ * from the previous coil positions. The sensors have to be set via
+ * m_hpiFit.setSensors beforehand.
  *********************************************************************************/
 
-coilParam RtHPIS::dipfit(struct coilParam coil, struct sens sensors, Eigen::MatrixXd data, int numCoils)
+coilParam RtHPIS::dipfit(const struct coilParam &coil, const Eigen::MatrixXd &data, int numCoils)
 {
-    // Initialize variables
-    int display = 0;
-//    int maxiter = 100;
-// Seok
-    int maxiter = 500;
-
-
-    dipError temp;
+    coilParam fitted = coil;
 
-    for(int i = 0;i<numCoils;i++) {
-        coil.pos.row(i).array() = fminsearch(coil.pos.row(i), maxiter, 2 * maxiter * coil.pos.cols(), display, data.col(i), sensors);
-        temp = dipfitError(coil.pos.row(i), data.col(i), sensors);
-        coil.mom = temp.moment.transpose();
+    m_hpiFit.fit(fitted, data.leftCols(numCoils));
 
-        // Seok
-        coil.dpfiterror(i) = temp.error;
-        coil.dpfitnumitr(i) = simplex_numitr;
-    }
-
-    return coil;
+    return fitted;
 }
 
 /*********************************************************************************
@@ -526,7 +338,7 @@ coilParam RtHPIS::dipfit(struct coilParam coil, struct sens sensors, Eigen::Matr
  * attempts to find a local minimizer
  *********************************************************************************/
 
-Eigen::MatrixXd RtHPIS::fminsearch(Eigen::MatrixXd pos,int maxiter, int maxfun, int display, Eigen::MatrixXd data, struct sens sensors)
+Eigen::MatrixXd RtHPIS::fminsearch(Eigen::MatrixXd pos,int maxiter, int maxfun, int display, const Eigen::MatrixXd &data, const struct sens &sensors)
 {
     double tolx, tolf, rho, chi, psi, sigma, func_evals, usual_delta, zero_term_delta, temp1, temp2;
     std::string header, how;
@@ -735,7 +547,7 @@ Eigen::MatrixXd RtHPIS::fminsearch(Eigen::MatrixXd pos,int maxiter, int maxfun,
  * same output
  *********************************************************************************/
 
-dipError RtHPIS::dipfitError(Eigen::MatrixXd pos, Eigen::MatrixXd data, struct sens sensors)
+dipError RtHPIS::dipfitError(const Eigen::MatrixXd &pos, const Eigen::MatrixXd &data, const struct sens &sensors)
 {
     // Variable Declaration
     struct dipError e;
@@ -762,7 +574,7 @@ dipError RtHPIS::dipfitError(Eigen::MatrixXd pos, Eigen::MatrixXd data, struct s
  * same output
  *********************************************************************************/
 
-Eigen::MatrixXd RtHPIS::ft_compute_leadfield(Eigen::MatrixXd pos, struct sens sensors)
+Eigen::MatrixXd RtHPIS::ft_compute_leadfield(const Eigen::MatrixXd &pos, const struct sens &sensors)
 {
 
     Eigen::MatrixXd pnt, ori, lf;
@@ -782,7 +594,7 @@ Eigen::MatrixXd RtHPIS::ft_compute_leadfield(Eigen::MatrixXd pos, struct sens se
  * The function has been compared with matlab magnetic_dipole and it gives same output
  *********************************************************************************/
 
-Eigen::MatrixXd RtHPIS::magnetic_dipole(Eigen::MatrixXd pos, Eigen::MatrixXd pnt, Eigen::MatrixXd ori) {
+Eigen::MatrixXd RtHPIS::magnetic_dipole(const Eigen::MatrixXd &pos, Eigen::MatrixXd pnt, const Eigen::MatrixXd &ori) {
 
     double u0 = 1e-7;
     int nchan;
@@ -950,6 +762,8 @@ void RtHPIS::test()
         sensors.coilori(i,2) = m_pFiffInfo->chs[innerind.at(i)].loc(11,0);
     }
 
+    m_hpiFit.setSensors(sensors);
+
     //load polhemus HPI
     Eigen::MatrixXd headHPI(numCoils,3);
 
@@ -1043,7 +857,7 @@ void RtHPIS::test()
 //                    std::cout << ampreal.rows() << std::endl;
 //                    std::cout << ampreal.cols() << std::endl;
 
-                    coil = dipfit(coil, sensors, ampreal, numCoils);
+                    coil = dipfit(coil, ampreal, numCoils);
 
                     qDebug()<<"HPI head "<<headHPI(0,0)<<" "<<headHPI(0,1)<<" "<<headHPI(0,2);
                     qDebug()<<"HPI head "<<headHPI(1,0)<<" "<<headHPI(1,1)<<" "<<headHPI(1,2);
@@ -43,6 +43,8 @@
 //=============================================================================================================
 
 #include "rtprocessing_global.h"
+#include "rthpifit.h"
+#include "rthpidemod.h"
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -97,30 +99,6 @@ using namespace Eigen;
 using namespace IOBuffer;
 using namespace FIFFLIB;
 
-//*************************************************************************************************************
-//=============================================================================================================
-// Declare all structures to be used
-//=============================================================================================================
-
-struct coilParam {
-    Eigen::MatrixXd pos;
-    Eigen::MatrixXd mom;
-    Eigen::VectorXd dpfiterror;
-    Eigen::VectorXd dpfitnumitr;
-};
-
-struct dipError {
-    double error;
-    Eigen::MatrixXd moment;
-};
-
-struct sens {
-    Eigen::MatrixXd coilpos;
-    Eigen::MatrixXd coilori;
-    Eigen::MatrixXd tra;
-};
-
-
 //=============================================================================================================
 /**
 * Real-time Head Coil Positions estimation
@@ -183,11 +161,11 @@ public:
     */
     virtual bool stop();
 
-    dipError dipfitError (Eigen::MatrixXd, Eigen::MatrixXd, struct sens);
-    Eigen::MatrixXd ft_compute_leadfield(Eigen::MatrixXd, struct sens);
-    Eigen::MatrixXd magnetic_dipole(Eigen::MatrixXd, Eigen::MatrixXd, Eigen::MatrixXd);
-    coilParam dipfit(struct coilParam, struct sens, Eigen::MatrixXd, int numCoils);
-    Eigen::MatrixXd fminsearch(Eigen::MatrixXd,int, int, int, Eigen::MatrixXd, struct sens);
+    dipError dipfitError (const Eigen::MatrixXd &, const Eigen::MatrixXd &, const struct sens &);
+    Eigen::MatrixXd ft_compute_leadfield(const Eigen::MatrixXd &, const struct sens &);
+    Eigen::MatrixXd magnetic_dipole(const Eigen::MatrixXd &, Eigen::MatrixXd, const Eigen::MatrixXd &);
+    coilParam dipfit(const struct coilParam &, const Eigen::MatrixXd &, int numCoils);
+    Eigen::MatrixXd fminsearch(Eigen::MatrixXd,int, int, int, const Eigen::MatrixXd &, const struct sens &);
     static bool compar (int, int);
     Eigen::MatrixXd pinv(Eigen::MatrixXd);
     Eigen::Matrix4d computeTransformation(Eigen::MatrixXd, Eigen::MatrixXd);
@@ -225,6 +203,9 @@ private:
 
     CircularMatrixBuffer<double>::SPtr m_pRawMatrixBuffer;   /**< The Circular Raw Matrix Buffer. */
 
+    RtHPIFit    m_hpiFit;               /**< Levenberg-Marquardt fit of the coil dipoles. */
+    RtHPIDemod  m_hpiDemod;             /**< Streaming demodulation of the coil amplitudes. */
+
 //    QVector <float> m_fWin;
 
 //    double m_Fs;
@@ -0,0 +1,342 @@
+//=============================================================================================================
+/**
+* @file     streamtriggerdetector.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Implementation of the StreamTriggerDetector Class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "streamtriggerdetector.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+StreamTriggerDetector::StreamTriggerDetector(const QList<int>& lTriggerChannels, DetectionMode mode, double dThreshold)
+: m_lTriggerChannels(lTriggerChannels)
+, m_mode(mode)
+, m_dThreshold(dThreshold)
+, m_bFalling(false)
+, m_iBitMask(~0)
+, m_bDecodeBits(false)
+, m_iMinDuration(1)
+, m_iHoldOff(0)
+, m_bInitialized(false)
+, m_iSamplesProcessed(0)
+{
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+void StreamTriggerDetector::setTriggerChannels(const QList<int>& lTriggerChannels)
+{
+    m_lTriggerChannels = lTriggerChannels;
+    reset(m_iSamplesProcessed);
+}
+
+
+//*************************************************************************************************************
+
+void StreamTriggerDetector::setMode(DetectionMode mode)
+{
+    m_mode = mode;
+    reset(m_iSamplesProcessed);
+}
+
+
+//*************************************************************************************************************
+
+void StreamTriggerDetector::setThreshold(double dThreshold)
+{
+    m_dThreshold = dThreshold;
+}
+
+
+//*************************************************************************************************************
+
+void StreamTriggerDetector::setFallingFlank(bool bFalling)
+{
+    m_bFalling = bFalling;
+}
+
+
+//*************************************************************************************************************
+
+void StreamTriggerDetector::setBitMask(int iMask, bool bDecodeBits)
+{
+    m_iBitMask = iMask;
+    m_bDecodeBits = bDecodeBits;
+}
+
+
+//*************************************************************************************************************
+
+void StreamTriggerDetector::setMinDuration(int iSamples)
+{
+    m_iMinDuration = iSamples > 1 ? iSamples : 1;
+}
+
+
+//*************************************************************************************************************
+
+void StreamTriggerDetector::setHoldOff(int iSamples)
+{
+    m_iHoldOff = iSamples > 0 ? iSamples : 0;
+}
+
+
+//*************************************************************************************************************
+
+void StreamTriggerDetector::reset(qint64 iFirstSample)
+{
+    m_iSamplesProcessed = iFirstSample;
+    m_bInitialized = false;
+
+    ChannelState state;
+    state.dLast = 0.0;
+    state.iLastCode = 0;
+    state.bActive = false;
+    state.iHoldOff = 0;
+    state.iPendingCount = 0;
+    state.pending.iChannel = -1;
+    state.pending.iSample = 0;
+    state.pending.iCode = 0;
+    state.pending.dValue = 0.0;
+
+    m_vecState.fill(state, m_lTriggerChannels.size());
+}
+
+
+//*************************************************************************************************************
+
+QList<TriggerEvent> StreamTriggerDetector::detect(const MatrixXd& data)
+{
+    QList<TriggerEvent> lEvents;
+
+    const int iNumCh = m_lTriggerChannels.size();
+    const int iNumSamples = data.cols();
+
+    if(iNumCh == 0 || iNumSamples == 0) {
+        m_iSamplesProcessed += iNumSamples;
+        return lEvents;
+    }
+
+    //Gather the trigger rows. Column 0 carries the last sample of the previous block, so that a flank between
+    //two blocks is seen like any other flank.
+    m_matTrig.resize(iNumCh, iNumSamples + 1);
+
+    for(int i = 0; i < iNumCh; ++i) {
+        int iRow = m_lTriggerChannels.at(i);
+
+        if(iRow < 0 || iRow >= data.rows()) {
+            qWarning() << "StreamTriggerDetector::detect - Trigger channel" << iRow << "is out of range. Data has" << data.rows() << "rows.";
+            m_iSamplesProcessed += iNumSamples;
+            return lEvents;
+        }
+
+        if(!m_bInitialized) {
+            m_vecState[i].dLast = data(iRow, 0);
+            m_vecState[i].iLastCode = code(data(iRow, 0));
+            m_vecState[i].bActive = isActive(data(iRow, 0));
+        }
+
+        m_matTrig(i, 0) = m_vecState[i].dLast;
+    }
+
+    for(int j = 0; j < iNumSamples; ++j)
+        for(int i = 0; i < iNumCh; ++i)
+            m_matTrig(i, j + 1) = data(m_lTriggerChannels.at(i), j);
+
+    m_bInitialized = true;
+
+    //Check all channels at once. The gathered matrix is column major, i.e. the trigger channels of one sample are
+    //contiguous and Eigen vectorizes the differences and the row wise reductions over the channels.
+    VectorXd vecCandidate;
+
+    switch(m_mode) {
+        case Level: {
+            //A crossing requires samples on both sides of the threshold
+            VectorXd vecMax = m_matTrig.rowwise().maxCoeff();
+            VectorXd vecMin = m_matTrig.rowwise().minCoeff();
+            vecCandidate = ((vecMax.array() >= m_dThreshold) && (vecMin.array() < m_dThreshold)).cast<double>()
+                         + ((vecMin.array() <= m_dThreshold) && (vecMax.array() > m_dThreshold)).cast<double>();
+            break;
+        }
+        case Gradient: {
+            m_matDiff = m_matTrig.rightCols(iNumSamples) - m_matTrig.leftCols(iNumSamples);
+            if(m_bFalling)
+                vecCandidate = (m_matDiff.rowwise().minCoeff().array() <= -m_dThreshold).cast<double>();
+            else
+                vecCandidate = (m_matDiff.rowwise().maxCoeff().array() >= m_dThreshold).cast<double>();
+            break;
+        }
+        case Digital: {
+            m_matDiff = m_matTrig.rightCols(iNumSamples) - m_matTrig.leftCols(iNumSamples);
+            vecCandidate = (m_matDiff.cwiseAbs().rowwise().maxCoeff().array() > 0.0).cast<double>();
+            break;
+        }
+    }
+
+    for(int i = 0; i < iNumCh; ++i) {
+        ChannelState& state = m_vecState[i];
+
+        if(vecCandidate(i) != 0.0 || state.iPendingCount > 0) {
+            scanChannel(i, lEvents);
+        } else {
+            //Nothing happened on this channel, only advance its state
+            state.dLast = m_matTrig(i, iNumSamples);
+            state.iHoldOff = qMax(0, state.iHoldOff - iNumSamples);
+        }
+    }
+
+    m_iSamplesProcessed += iNumSamples;
+
+    return lEvents;
+}
+
+
+//*************************************************************************************************************
+
+void StreamTriggerDetector::scanChannel(int iRow, QList<TriggerEvent>& lEvents)
+{
+    ChannelState& state = m_vecState[iRow];
+    const int iNumSamples = m_matTrig.cols() - 1;
+
+    TriggerEvent event;
+    event.iChannel = m_lTriggerChannels.at(iRow);
+
+    for(int j = 1; j <= iNumSamples; ++j) {
+        const double dValue = m_matTrig(iRow, j);
+        const double dStep = dValue - m_matTrig(iRow, j - 1);
+
+        event.iSample = m_iSamplesProcessed + j - 1;
+        event.dValue = dStep;
+
+        if(state.iHoldOff > 0)
+            --state.iHoldOff;
+
+        bool bOnset = false;
+        bool bHolds = false;
+
+        switch(m_mode) {
+            case Level: {
+                bool bActive = isActive(dValue);
+                bOnset = bActive && !state.bActive;
+                bHolds = bActive;
+                state.bActive = bActive;
+                event.iCode = 1;
+                break;
+            }
+            case Gradient: {
+                bOnset = m_bFalling ? -dStep >= m_dThreshold : dStep >= m_dThreshold;
+                bHolds = true;
+                event.iCode = 1;
+                break;
+            }
+            case Digital: {
+                int iCode = code(dValue);
+                if(m_bDecodeBits) {
+                    event.iCode = iCode & ~state.iLastCode;
+                    bOnset = event.iCode != 0;
+                    bHolds = state.iPendingCount > 0 && (iCode & state.pending.iCode) == state.pending.iCode;
+                } else {
+                    event.iCode = iCode;
+                    bOnset = iCode != 0 && iCode != state.iLastCode;
+                    bHolds = state.iPendingCount > 0 && iCode == state.pending.iCode;
+                }
+                state.iLastCode = iCode;
+                break;
+            }
+        }
+
+        //Confirm or drop the event which waits for the minimal duration
+        if(state.iPendingCount > 0) {
+            if(bHolds && !bOnset) {
+                if(++state.iPendingCount >= m_iMinDuration) {
+                    publish(state, state.pending, lEvents);
+                    state.iPendingCount = 0;
+                }
+            } else {
+                state.iPendingCount = 0;
+            }
+        }
+
+        if(bOnset) {
+            if(m_iMinDuration > 1 && m_mode != Gradient) {
+                state.pending = event;
+                state.iPendingCount = 1;
+            } else {
+                publish(state, event, lEvents);
+            }
+        }
+    }
+
+    state.dLast = m_matTrig(iRow, iNumSamples);
+}
+
+
+//*************************************************************************************************************
+
+void StreamTriggerDetector::publish(ChannelState& state, const TriggerEvent& event, QList<TriggerEvent>& lEvents) const
+{
+    if(state.iHoldOff > 0)
+        return;
+
+    lEvents.append(event);
+    state.iHoldOff = m_iHoldOff > 0 ? m_iHoldOff + 1 : 0;
+}
@@ -0,0 +1,313 @@
+//=============================================================================================================
+/**
+* @file     streamtriggerdetector.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     StreamTriggerDetector class declaration.
+*
+*/
+
+#ifndef STREAMTRIGGERDETECTOR_H
+#define STREAMTRIGGERDETECTOR_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QList>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+
+//=============================================================================================================
+/**
+* A single trigger flank found by the StreamTriggerDetector.
+*
+* @brief Detected trigger event
+*/
+struct UTILSSHARED_EXPORT TriggerEvent
+{
+    int         iChannel;   /**< Row index of the trigger channel in the data blocks. */
+    qint64      iSample;    /**< Absolute sample index of the flank, counted from the last reset of the detector. */
+    int         iCode;      /**< Decoded trigger code. In the bit decoding mode the newly set bits, 1 for the level and gradient modes. */
+    double      dValue;     /**< Signal step at the flank, i.e. the difference to the preceding sample. */
+};
+
+
+//=============================================================================================================
+/**
+* Trigger detection on a continuous stream of data blocks. In contrast to DetectTrigger the state of each
+* trigger channel (last sample, current level, hold-off and pending events) is carried over from one block to
+* the next, so that flanks which fall onto a block boundary are neither missed nor reported twice. All trigger
+* channels are first checked at once with vectorized block operations and only channels which may contain a
+* flank are scanned sample by sample.
+*
+* @brief Stateful streaming trigger detector
+*/
+class UTILSSHARED_EXPORT StreamTriggerDetector
+{
+
+public:
+    typedef QSharedPointer<StreamTriggerDetector> SPtr;            /**< Shared pointer type for StreamTriggerDetector. */
+    typedef QSharedPointer<const StreamTriggerDetector> ConstSPtr; /**< Const shared pointer type for StreamTriggerDetector. */
+
+    /**
+    * The criterion which marks a trigger flank.
+    */
+    enum DetectionMode {
+        Level,          /**< The signal crosses the threshold. */
+        Gradient,       /**< The sample to sample difference exceeds the threshold. */
+        Digital         /**< The masked integer value (e.g. of a STI101 composite channel) changes to a non-zero code. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs a StreamTriggerDetector.
+    *
+    * @param[in] lTriggerChannels   The row indices of the trigger channels in the data blocks
+    * @param[in] mode               The detection mode
+    * @param[in] dThreshold         The threshold used by the level and gradient modes
+    */
+    explicit StreamTriggerDetector(const QList<int>& lTriggerChannels = QList<int>(), DetectionMode mode = Digital, double dThreshold = 0.5);
+
+    //=========================================================================================================
+    /**
+    * Sets the row indices of the trigger channels and resets the detector.
+    *
+    * @param[in] lTriggerChannels   The row indices of the trigger channels in the data blocks
+    */
+    void setTriggerChannels(const QList<int>& lTriggerChannels);
+
+    //=========================================================================================================
+    /**
+    * Sets the detection mode and resets the detector.
+    *
+    * @param[in] mode       The detection mode
+    */
+    void setMode(DetectionMode mode);
+
+    //=========================================================================================================
+    /**
+    * Sets the threshold of the level and gradient modes.
+    *
+    * @param[in] dThreshold     The threshold
+    */
+    void setThreshold(double dThreshold);
+
+    //=========================================================================================================
+    /**
+    * Selects falling instead of rising flanks for the level and gradient modes.
+    *
+    * @param[in] bFalling       Whether to detect falling flanks
+    */
+    void setFallingFlank(bool bFalling);
+
+    //=========================================================================================================
+    /**
+    * Sets the bit mask of the digital mode. If bDecodeBits is set, every bit which is newly set is reported as
+    * an event of its own (composite STI101 channels carrying several independent trigger lines). Otherwise an
+    * event is reported whenever the masked code changes to a non-zero value.
+    *
+    * @param[in] iMask          The bit mask applied to the rounded channel values
+    * @param[in] bDecodeBits    Whether to report the newly set bits separately
+    */
+    void setBitMask(int iMask, bool bDecodeBits = false);
+
+    //=========================================================================================================
+    /**
+    * Sets the minimal number of samples a level (level mode) or a code (digital mode) has to persist before it is
+    * reported. This suppresses short glitches. The event keeps the sample index of the onset.
+    *
+    * @param[in] iSamples       The minimal duration in samples, values < 2 report the flanks immediately
+    */
+    void setMinDuration(int iSamples);
+
+    //=========================================================================================================
+    /**
+    * Sets the number of samples which are skipped on a channel after an event was reported on it.
+    *
+    * @param[in] iSamples       The hold-off in samples
+    */
+    void setHoldOff(int iSamples);
+
+    //=========================================================================================================
+    /**
+    * Discards the state of all channels. The next block is treated as the start of a new stream.
+    *
+    * @param[in] iFirstSample   The absolute sample index of the first sample of the next block
+    */
+    void reset(qint64 iFirstSample = 0);
+
+    //=========================================================================================================
+    /**
+    * Scans the next block of the stream for trigger flanks.
+    *
+    * @param[in] data       The data block (channels x samples) which contains the trigger channels as rows
+    *
+    * @return the events of all trigger channels in the order of their sample index per channel
+    */
+    QList<TriggerEvent> detect(const Eigen::MatrixXd& data);
+
+    //=========================================================================================================
+    /**
+    * Returns the absolute sample index of the first sample of the next block.
+    *
+    * @return the number of samples processed since the last reset, plus the start index passed to reset
+    */
+    inline qint64 samplesProcessed() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the row indices of the trigger channels.
+    *
+    * @return the trigger channel indices
+    */
+    inline const QList<int>& triggerChannels() const;
+
+private:
+    /**
+    * Detection state of a single trigger channel which is carried over between blocks.
+    */
+    struct ChannelState {
+        double      dLast;              /**< Last sample of the previous block. */
+        int         iLastCode;          /**< Masked code of the last sample (digital mode). */
+        bool        bActive;            /**< Whether the last sample was beyond the threshold (level mode). */
+        int         iHoldOff;           /**< Remaining samples to skip after the last event. */
+        int         iPendingCount;      /**< Number of samples the pending event persisted so far, 0 if none is pending. */
+        TriggerEvent pending;           /**< The event which waits for the minimal duration. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Returns the masked integer code of a sample value.
+    */
+    inline int code(double dValue) const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether a sample value is beyond the threshold, taking the flank direction into account.
+    */
+    inline bool isActive(double dValue) const;
+
+    //=========================================================================================================
+    /**
+    * Scans one row of m_matTrig sample by sample.
+    *
+    * @param[in] iRow           The row in m_matTrig
+    * @param[out] lEvents       The list the events are appended to
+    */
+    void scanChannel(int iRow, QList<TriggerEvent>& lEvents);
+
+    //=========================================================================================================
+    /**
+    * Appends the event if the channel is not in its hold-off period.
+    */
+    void publish(ChannelState& state, const TriggerEvent& event, QList<TriggerEvent>& lEvents) const;
+
+    QList<int>              m_lTriggerChannels;     /**< Row indices of the trigger channels. */
+    DetectionMode           m_mode;                 /**< The detection mode. */
+    double                  m_dThreshold;           /**< Threshold of the level and gradient modes. */
+    bool                    m_bFalling;             /**< Detect falling instead of rising flanks. */
+    int                     m_iBitMask;             /**< Bit mask of the digital mode. */
+    bool                    m_bDecodeBits;          /**< Report newly set bits separately in the digital mode. */
+    int                     m_iMinDuration;         /**< Minimal duration of a level or code in samples. */
+    int                     m_iHoldOff;             /**< Samples to skip after an event. */
+
+    bool                    m_bInitialized;         /**< Whether the channel states hold the end of a previous block. */
+    qint64                  m_iSamplesProcessed;    /**< Absolute index of the first sample of the next block. */
+    QVector<ChannelState>   m_vecState;             /**< State of each trigger channel. */
+    Eigen::MatrixXd         m_matTrig;              /**< Gathered trigger rows, column 0 holds the last sample of the previous block. */
+    Eigen::MatrixXd         m_matDiff;              /**< Sample to sample differences of the gathered trigger rows. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline qint64 StreamTriggerDetector::samplesProcessed() const
+{
+    return m_iSamplesProcessed;
+}
+
+
+//*************************************************************************************************************
+
+inline const QList<int>& StreamTriggerDetector::triggerChannels() const
+{
+    return m_lTriggerChannels;
+}
+
+
+//*************************************************************************************************************
+
+inline int StreamTriggerDetector::code(double dValue) const
+{
+    return static_cast<int>(dValue >= 0.0 ? dValue + 0.5 : dValue - 0.5) & m_iBitMask;
+}
+
+
+//*************************************************************************************************************
+
+inline bool StreamTriggerDetector::isActive(double dValue) const
+{
+    return m_bFalling ? dValue <= m_dThreshold : dValue >= m_dThreshold;
+}
+
+} // NAMESPACE
+
+#endif // STREAMTRIGGERDETECTOR_H
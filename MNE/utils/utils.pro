@@ -87,6 +87,7 @@ SOURCES += \
     filterTools/filterdata.cpp \
     filterTools/filterio.cpp \
     detecttrigger.cpp \
+    streamtriggerdetector.cpp \
     spectrogram.cpp \
     warp.cpp \
     filterTools/sphara.cpp \
@@ -110,6 +111,7 @@ HEADERS += \
     filterTools/filterdata.h \
     filterTools/filterio.h \
     detecttrigger.h \
+    streamtriggerdetector.h \
     spectrogram.h \
     warp.h \
     filterTools/sphara.h \
@@ -49,6 +49,7 @@
 //=============================================================================================================
 
 #include <QBrush>
+#include <QtMath>
 
 
 //*************************************************************************************************************
@@ -82,6 +83,8 @@ RawDelegate::RawDelegate(QObject *parent)
     m_pEventView = new QTableView(NULL);
     m_pRawView = new QTableView(NULL);
 
+    m_pTileCache = new RawTileCache(DELEGATE_TILE_CACHE_SIZE, this);
+
     //Init m_scaleMap
     m_scaleMap["MEG_grad"] = 400 * 1e-15 * 100; //*100 because data in fiff files is stored as fT/m not fT/cm
     m_scaleMap["MEG_mag"] = 1.2 * 1e-12;
@@ -148,20 +151,22 @@ void RawDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, c
         painter->drawPath(path);
         painter->restore();
 
-        //Plot data path
-        path = QPainterPath(QPointF(option.rect.x()+t_rawModel->relFiffCursor(), option.rect.y()));
-        createPlotPath(index, option, path, listPairs, channelMean);
+        //Plot data path - blit the pre-rendered tiles and only fall back to plotting the samples while tiles are missing
+        if(!drawTiles(index, option, painter, listPairs, channelMean)) {
+            path = QPainterPath(QPointF(option.rect.x()+t_rawModel->relFiffCursor(), option.rect.y()));
+            createPlotPath(index, option, path, listPairs, channelMean);
 
-        if(option.state & QStyle::State_Selected) {
-            pen.setStyle(Qt::SolidLine);
-            pen.setWidthF(1);
-            pen.setColor(Qt::red);
-            painter->setPen(pen);
-        }
+            if(option.state & QStyle::State_Selected) {
+                pen.setStyle(Qt::SolidLine);
+                pen.setWidthF(1);
+                pen.setColor(Qt::red);
+                painter->setPen(pen);
+            }
 
-        painter->translate(0,t_fPlotHeight/2);
-        painter->setRenderHint(QPainter::Antialiasing, true);
-        painter->drawPath(path);
+            painter->translate(0,t_fPlotHeight/2);
+            painter->setRenderHint(QPainter::Antialiasing, true);
+            painter->drawPath(path);
+        }
         painter->restore();
 
         //Plot events
@@ -207,6 +212,9 @@ void RawDelegate::setModelView(EventModel *eventModel, QTableView* eventView, QT
     m_pEventModel = eventModel;
     m_pEventView = eventView;
     m_pRawView = rawView;
+
+    connect(m_pTileCache, &RawTileCache::tileReady,
+            m_pRawView->viewport(), static_cast<void (QWidget::*)()>(&QWidget::update));
 }
 
 
@@ -220,7 +228,7 @@ void RawDelegate::setScaleMap(const QMap<QString,double> &scaleMap)
 
 //*************************************************************************************************************
 
-void RawDelegate::createPlotPath(const QModelIndex &index, const QStyleOptionViewItem &option, QPainterPath& path, QList<RowVectorPair>& listPairs, double channelMean) const
+double RawDelegate::channelMaxValue(const QModelIndex &index) const
 {
     //get maximum range of respective channel type (range value in FiffChInfo does not seem to contain a reasonable value)
     qint32 kind = (static_cast<const RawModel*>(index.model()))->m_chInfolist[index.row()].kind;
@@ -258,14 +266,48 @@ void RawDelegate::createPlotPath(const QModelIndex &index, const QStyleOptionVie
     }
     }
 
+    return dMaxValue;
+}
+
+
+//*************************************************************************************************************
+
+void RawDelegate::createPlotPath(const QModelIndex &index, const QStyleOptionViewItem &option, QPainterPath& path, QList<RowVectorPair>& listPairs, double channelMean) const
+{
     double dValue;
-    double dScaleY = option.rect.height()/(2*dMaxValue);
+    double dScaleY = option.rect.height()/(2*channelMaxValue(index));
 
     double y_base = -path.currentPosition().y();
     QPointF qSamplePosition;
 
     path.moveTo(path.currentPosition().x(), -(y_base + ((*(listPairs[0].first) - channelMean)*dScaleY)));
 
+    //More than two samples per pixel - draw the min/max of each pixel column instead of every sample
+    if(m_dDx < 0.5) {
+        const RawModel* t_rawModel = static_cast<const RawModel*>(index.model());
+        QVector<double> vecMin, vecMax;
+        bool bEnvelope = true;
+        QPainterPath pathEnvelope(path.currentPosition());
+
+        for(qint8 i=0; i < listPairs.size() && bEnvelope; ++i) {
+            qint32 iNumColumns = qMax(1, qRound(listPairs[i].second*m_dDx));
+            double dColumnDx = listPairs[i].second*m_dDx/iNumColumns;
+
+            bEnvelope = t_rawModel->getEnvelope(index.row(), i, iNumColumns, vecMin, vecMax);
+
+            for(qint32 c=0; c < iNumColumns && bEnvelope; ++c) {
+                double x = pathEnvelope.currentPosition().x()+dColumnDx;
+                pathEnvelope.lineTo(x, -(y_base + (vecMin[c] - channelMean)*dScaleY));
+                pathEnvelope.lineTo(x, -(y_base + (vecMax[c] - channelMean)*dScaleY));
+            }
+        }
+
+        if(bEnvelope) {
+            path = pathEnvelope;
+            return;
+        }
+    }
+
     //plot all rows from list of pairs
     for(qint8 i=0; i < listPairs.size(); ++i) {
         //create lines from one to the next sample
@@ -289,6 +331,109 @@ void RawDelegate::createPlotPath(const QModelIndex &index, const QStyleOptionVie
 }
 
 
+//*************************************************************************************************************
+
+bool RawDelegate::drawTiles(const QModelIndex &index, const QStyleOptionViewItem &option, QPainter *painter, const QList<RowVectorPair>& listPairs, double channelMean) const
+{
+    const RawModel* t_rawModel = static_cast<const RawModel*>(index.model());
+
+    if(listPairs.isEmpty() || m_dDx <= 0)
+        return false;
+
+    m_pTileCache->setRevision(t_rawModel->dataRevision());
+
+    //Loaded samples [iLoadedFrom, iLoadedTo) relative to the first sample of the file
+    qint32 iLoadedFrom = t_rawModel->relFiffCursor();
+    qint32 iLoadedTo = iLoadedFrom;
+    for(qint32 i = 0; i < listPairs.size(); ++i)
+        iLoadedTo += listPairs[i].second;
+
+    qint32 iFileSize = t_rawModel->lastSample() - t_rawModel->firstSample() + 1;
+
+    //Sample s is plotted at x = dX0 + s*m_dDx, see createPlotPath
+    double dX0 = option.rect.x() + iLoadedFrom + (1 - iLoadedFrom)*m_dDx;
+
+    qint32 iVisibleFrom = qMax(iLoadedFrom, qFloor(-dX0/m_dDx));
+    qint32 iVisibleTo = qMin(iLoadedTo - 1, qCeil((m_pRawView->viewport()->width() - dX0)/m_dDx));
+
+    if(iVisibleFrom > iVisibleTo)
+        return true;
+
+    RawTileKey key;
+    key.iRow = index.row();
+    key.iTileSamples = qMax(1, qRound(DELEGATE_TILE_WIDTH/m_dDx));
+    key.dDx = m_dDx;
+    key.dMaxValue = channelMaxValue(index);
+    key.iHeight = option.rect.height();
+    key.dChannelMean = channelMean;
+    key.bSelected = option.state.testFlag(QStyle::State_Selected);
+    key.iRevision = t_rawModel->dataRevision();
+
+    qint32 iFirstTile = iVisibleFrom/key.iTileSamples;
+    qint32 iLastTile = iVisibleTo/key.iTileSamples;
+
+    //Queues a tile if all of its samples (plus one neighbour on each side) are loaded and not being processed
+    auto requestTile = [&](qint32 iTile) {
+        if(iTile < 0 || t_rawModel->isProcessing())
+            return;
+
+        key.iTile = iTile;
+        if(m_pTileCache->contains(key))
+            return;
+
+        RawTileJob job;
+        job.key = key;
+        job.iFirstSample = qMax(0, iTile*key.iTileSamples - 1);
+        qint32 iLastSample = qMin(iFileSize - 1, (iTile+1)*key.iTileSamples);
+
+        if(job.iFirstSample < iLoadedFrom || iLastSample >= iLoadedTo || job.iFirstSample > iLastSample)
+            return;
+
+        job.vecSamples.resize(iLastSample - job.iFirstSample + 1);
+
+        qint32 iWindowStart = iLoadedFrom;
+        for(qint32 i = 0; i < listPairs.size(); ++i) {
+            qint32 iFrom = qMax(job.iFirstSample, iWindowStart);
+            qint32 iTo = qMin(iLastSample + 1, iWindowStart + listPairs[i].second);
+
+            for(qint32 s = iFrom; s < iTo; ++s)
+                job.vecSamples[s - job.iFirstSample] = *(listPairs[i].first + s - iWindowStart);
+
+            iWindowStart += listPairs[i].second;
+        }
+
+        m_pTileCache->requestTile(job);
+    };
+
+    bool bComplete = true;
+    for(qint32 iTile = iFirstTile; iTile <= iLastTile; ++iTile) {
+        key.iTile = iTile;
+        if(!m_pTileCache->tile(key)) {
+            bComplete = false;
+            requestTile(iTile);
+        }
+    }
+
+    //Pre-render the neighbouring tiles so that they are ready when scrolling
+    requestTile(iFirstTile - 1);
+    requestTile(iLastTile + 1);
+
+    if(!bComplete)
+        return false;
+
+    for(qint32 iTile = iFirstTile; iTile <= iLastTile; ++iTile) {
+        key.iTile = iTile;
+        const QImage* pTile = m_pTileCache->tile(key);
+        if(!pTile)
+            return false;
+
+        painter->drawImage(QPointF(dX0 + iTile*key.iTileSamples*m_dDx, option.rect.y()), *pTile);
+    }
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 void RawDelegate::createGridPath(QPainterPath& path, const QStyleOptionViewItem &option, QList<RowVectorPair>& listPairs) const
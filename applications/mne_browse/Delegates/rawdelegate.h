@@ -55,6 +55,7 @@
 
 #include "../Utils/types.h"
 #include "../Utils/rawsettings.h"
+#include "../Utils/rawtilecache.h"
 
 #include "../Windows/scalewindow.h"
 
@@ -175,6 +176,31 @@ private:
     */
     void createPlotPath(const QModelIndex &index, const QStyleOptionViewItem &option, QPainterPath& path, QList<RowVectorPair>& listPairs, double channelMean) const;
 
+    //=========================================================================================================
+    /**
+    * drawTiles blits the pre-rendered tiles of the visible part of a channel strip and queues missing and
+    * neighbouring tiles for background rendering.
+    *
+    * @param[in] index QModelIndex for accessing associated data and model object.
+    * @param[in] option The style option of the table cell.
+    * @param[in] painter The painter of the current table item.
+    * @param[in] listPairs The loaded data windows of the channel.
+    * @param[in] channelMean The mean which is subtracted from the data.
+    *
+    * @return false if not all visible tiles are rendered yet - the data path needs to be plotted directly then.
+    */
+    bool drawTiles(const QModelIndex &index, const QStyleOptionViewItem &option, QPainter *painter, const QList<RowVectorPair>& listPairs, double channelMean) const;
+
+    //=========================================================================================================
+    /**
+    * channelMaxValue returns the amplitude which is mapped to half the row height for the channel type of a row.
+    *
+    * @param[in] index QModelIndex for accessing associated data and model object.
+    *
+    * @return the maximum value
+    */
+    double channelMaxValue(const QModelIndex &index) const;
+
     //=========================================================================================================
     /**
     * createGridPath Creates the QPointer path for the grid plot.
@@ -202,6 +228,8 @@ private:
     QTableView*     m_pEventView;            /**< Pointer to the event view. */
     QTableView*     m_pRawView;              /**< Pointer to the raw view. */
     ScaleWindow*    m_pScaleWindow;          /**< Pointer to the scale window. */
+
+    RawTileCache*   m_pTileCache;            /**< Off-screen tiles of the channel strips. */
 };
 
 } // NAMESPACE
@@ -74,6 +74,7 @@ RawModel::RawModel(QObject *parent)
 , m_bEndReached(false)
 , m_bReloading(false)
 , m_bProcessing(false)
+, m_iDataRevision(0)
 , m_pFiffInfo(new FiffInfo())
 , m_pfiffIO(QSharedPointer<FiffIO>(new FiffIO()))
 , m_filterChType("All")
@@ -97,6 +98,16 @@ RawModel::RawModel(QObject *parent)
         insertReloadedData(m_reloadFutureWatcher.future().result());
     });
 
+    //connect overview computation - this is done concurrently
+    connect(&m_overviewFutureWatcher,&QFutureWatcher<RawOverview::SPtr>::finished,[this](){
+        if(!m_pOverviewCanceled || m_pOverviewCanceled->load() != 0)
+            return;
+
+        m_pOverview = m_overviewFutureWatcher.future().result();
+        if(m_pOverview)
+            emit overviewReady();
+    });
+
     //connect filtering reloading - this is done after a new block has been loaded
     connect(this,&RawModel::dataReloaded,[this](){
         if(!m_assignedOperators.empty())
@@ -107,10 +118,10 @@ RawModel::RawModel(QObject *parent)
 //        insertProcessedData(index);
 //    });
     connect(&m_operatorFutureWatcher,&QFutureWatcher<void>::finished,[this](){
-        insertProcessedDataAll();
+        insertProcessedData();
     });
 //    connect(&m_operatorFutureWatcher,&QFutureWatcher<QPair<int,RowVectorXd> >::progressValueChanged,[this](int progressValue){
-//        qDebug() << "RawModel: ProgressValue m_operatorFutureWatcher, " << progressValue << " items processed out of" << m_listTmpChData.size();
+//        qDebug() << "RawModel: ProgressValue m_operatorFutureWatcher, " << progressValue << " items processed out of" << m_listProcChs.size();
 //    });
 }
 
@@ -124,6 +135,7 @@ RawModel::RawModel(QFile &qFile, QObject *parent)
 , m_bEndReached(false)
 , m_bReloading(false)
 , m_bProcessing(false)
+, m_iDataRevision(0)
 , m_pFiffInfo(new FiffInfo())
 , m_pfiffIO(QSharedPointer<FiffIO>(new FiffIO()))
 , m_filterChType("All")
@@ -133,6 +145,16 @@ RawModel::RawModel(QFile &qFile, QObject *parent)
     m_maxWindows = MODEL_MAX_WINDOWS;
     m_iFilterTaps = MODEL_NUM_FILTER_TAPS;
 
+    //connect overview computation before the file is loaded, which starts the computation
+    connect(&m_overviewFutureWatcher,&QFutureWatcher<RawOverview::SPtr>::finished,[this](){
+        if(!m_pOverviewCanceled || m_pOverviewCanceled->load() != 0)
+            return;
+
+        m_pOverview = m_overviewFutureWatcher.future().result();
+        if(m_pOverview)
+            emit overviewReady();
+    });
+
     //read fiff data
     loadFiffData(&qFile);
 
@@ -153,14 +175,27 @@ RawModel::RawModel(QFile &qFile, QObject *parent)
 //        insertProcessedData(index);
 //    });
     connect(&m_operatorFutureWatcher,&QFutureWatcher<void>::finished,[this](){
-        insertProcessedDataAll();
+        insertProcessedData();
     });
 //    connect(&m_operatorFutureWatcher,&QFutureWatcher<QPair<int,RowVectorXd> >::progressValueChanged,[this](int progressValue){
-//        qDebug() << "RawModel: ProgressValue m_operatorFutureWatcher, " << progressValue << " items processed out of" << m_listTmpChData.size();
+//        qDebug() << "RawModel: ProgressValue m_operatorFutureWatcher, " << progressValue << " items processed out of" << m_listProcChs.size();
 //    });
 }
 
 
+//*************************************************************************************************************
+
+RawModel::~RawModel()
+{
+    //Let a running overview computation return early instead of reading the whole file for nothing
+    cancelOverview();
+
+    //The channel tasks iterate m_listProcChs and write the loaded windows, wait for them before both are freed
+    m_operatorFutureWatcher.cancel();
+    m_operatorFutureWatcher.waitForFinished();
+}
+
+
 //*************************************************************************************************************
 //virtual functions
 int RawModel::rowCount(const QModelIndex & /*parent*/) const
@@ -205,7 +240,7 @@ QVariant RawModel::data(const QModelIndex &index, int role) const
 
                 for(qint16 i=0; i < m_data.size(); ++i) {
                     //if channel is not filtered or background Processing pending...
-                    if(!m_assignedOperators.contains(index.row()) || (m_bProcessing && m_bReloadBefore && i==0) || (m_bProcessing && !m_bReloadBefore && i==m_data.size()-1)) {
+                    if(!m_assignedOperators.contains(index.row()) || m_listProcWindows.contains(m_data[i]) || m_listPendingWindows.contains(m_data[i])) {
                         rowVectorPair.first = m_data[i]->dataRaw().data() + index.row()*m_data[i]->dataRaw().cols();
                         rowVectorPair.second  = m_data[i]->dataRaw().cols();
                     }
@@ -273,6 +308,35 @@ QVariant RawModel::data(const QModelIndex &index, int role) const
 }
 
 
+//*************************************************************************************************************
+
+bool RawModel::getEnvelope(int row, int window, qint32 iNumColumns, QVector<double>& vecMin, QVector<double>& vecMax) const
+{
+    if(window < 0 || window >= m_data.size())
+        return false;
+
+    //Same selection of the displayed data as in data()
+    const MatrixXdR* pMatData;
+    const DISPLIB::MinMaxPyramid* pPyramid;
+
+    if(!m_assignedOperators.contains(row) || m_listProcWindows.contains(m_data[window]) || m_listPendingWindows.contains(m_data[window])) {
+        pMatData = &m_data[window]->dataRaw();
+        pPyramid = &m_data[window]->pyramidRaw();
+    }
+    else {
+        pMatData = &m_data[window]->dataProc();
+        pPyramid = &m_data[window]->pyramidProc();
+    }
+
+    if(row >= pMatData->rows() || pPyramid->rows() != pMatData->rows() || pPyramid->samples() != pMatData->cols())
+        return false;
+
+    pPyramid->envelope(row, pMatData->data() + row*pMatData->cols(), 0, pMatData->cols(), iNumColumns, vecMin, vecMax);
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 QVariant RawModel::headerData(int section, Qt::Orientation orientation, int role) const
@@ -414,6 +478,8 @@ bool RawModel::loadFiffData(QFile* qFile)
 
     qFile->close();
 
+    computeOverview(qFile->fileName());
+
     emit fileLoaded(m_pFiffInfo);
     emit assignedOperatorsChanged(m_assignedOperators);
 
@@ -502,16 +568,22 @@ void RawModel::clearModel()
 
     //data model structure
     m_data.clear();
+    m_listPendingWindows.clear();
 
     //MNEOperators
     m_assignedOperators.clear();
 
+    //Overview of the previous file
+    cancelOverview();
+
     //View parameters
     m_iAbsFiffCursor = 0;
     m_iCurAbsScrollPos = 0;
     m_bStartReached = false;
     m_bEndReached = false;
 
+    ++m_iDataRevision;
+
     qDebug("RawModel cleared.");
 }
 
@@ -529,6 +601,8 @@ void RawModel::resetPosition(qint32 position)
     m_bEndReached = false;
     m_bReloading = false;
     m_bProcessing = false;
+    m_listPendingWindows.clear();
+    ++m_iDataRevision;
 
     //calculate multiple integer of m_iWindowSize from beginning of Fiff file (rounded down)
     qint32 distance = position - firstSample();
@@ -637,6 +711,33 @@ QPair<MatrixXd,MatrixXd> RawModel::readSegment(fiff_int_t from, fiff_int_t to)
 }
 
 
+//*************************************************************************************************************
+
+void RawModel::computeOverview(const QString& sFileName)
+{
+    cancelOverview();
+
+    QSharedPointer<QAtomicInt> pCanceled(new QAtomicInt(0));
+    m_pOverviewCanceled = pCanceled;
+
+    //The overview opens the file on its own, so it does not interfere with the reloading of m_pfiffIO
+    m_overviewFutureWatcher.setFuture(QtConcurrent::run([sFileName, pCanceled]() {
+        return RawOverview::compute(sFileName, pCanceled);
+    }));
+}
+
+
+//*************************************************************************************************************
+
+void RawModel::cancelOverview()
+{
+    if(m_pOverviewCanceled)
+        m_pOverviewCanceled->store(1);
+
+    m_pOverview.clear();
+}
+
+
 //*************************************************************************************************************
 //public SLOTS
 void RawModel::updateScrollPos(int value)
@@ -715,14 +816,8 @@ void RawModel::applyOperator(QModelIndexList chlist, const QSharedPointer<MNEOpe
         }
     }
 
-    m_bProcessing = true;
-
-    for(int i=0; i<m_data.size(); i++)
-        updateOperatorsConcurrently(i);
-
-    performOverlapAdd();
-
-    m_bProcessing = false;
+    //filter all loaded windows in the background-thread
+    processWindows(m_data);
 
     emit assignedOperatorsChanged(m_assignedOperators);
 
@@ -753,14 +848,8 @@ void RawModel::applyOperator(QModelIndexList chlist, const QSharedPointer<MNEOpe
         }
     }
 
-    m_bProcessing = true;
-
-    for(int i=0; i<m_data.size(); i++)
-        updateOperatorsConcurrently(i);
-
-    performOverlapAdd();
-
-    m_bProcessing = false;
+    //filter all loaded windows in the background-thread
+    processWindows(m_data);
 
     emit assignedOperatorsChanged(m_assignedOperators);
 
@@ -772,24 +861,7 @@ void RawModel::applyOperator(QModelIndexList chlist, const QSharedPointer<MNEOpe
 
 void RawModel::applyOperatorsConcurrently(QPair<int,RowVectorXd>& chdata) const
 {
-    QSharedPointer<FilterOperator> filter;
-
-    //QList<int> listFilteredChs = m_assignedOperators.keys();
-
-    QList<QSharedPointer<MNEOperator> > ops = m_assignedOperators.values(chdata.first);
-    for(qint32 i=0; i < ops.size(); ++i) {
-        switch(ops[i]->m_OperatorType) {
-        case MNEOperator::FILTER: {
-            filter = ops[i].staticCast<FilterOperator>();
-            RowVectorXd tmp = filter->applyFFTFilter(chdata.second);
-            chdata.second = tmp;
-        }
-        case MNEOperator::PCA: {
-            //do something
-        }
-        }
-    }
-//    return chdata;
+    applyOperators(chdata.second, m_assignedOperators.values(chdata.first));
 }
 
 
@@ -804,14 +876,8 @@ void RawModel::updateOperators(QModelIndex chan)
         }
     }
 
-    m_bProcessing = true;
-
-    for(int i=0; i<m_data.size(); i++)
-        updateOperatorsConcurrently(i);
-
-    performOverlapAdd();
-
-    m_bProcessing = false;
+    //filter all loaded windows in the background-thread
+    processWindows(m_data);
 
     emit assignedOperatorsChanged(m_assignedOperators);
 }
@@ -832,14 +898,8 @@ void RawModel::updateOperators(QModelIndexList chlist)
         }
     }
 
-    m_bProcessing = true;
-
-    for(int i=0; i<m_data.size(); i++)
-        updateOperatorsConcurrently(i);
-
-    performOverlapAdd();
-
-    m_bProcessing = false;
+    //filter all loaded windows in the background-thread
+    processWindows(m_data);
 
     emit assignedOperatorsChanged(m_assignedOperators);
 }
@@ -877,6 +937,8 @@ void RawModel::undoFilter(QModelIndexList chlist, const QSharedPointer<MNEOperat
         }
     }
 
+    ++m_iDataRevision;
+
     emit assignedOperatorsChanged(m_assignedOperators);
 }
 
@@ -890,6 +952,8 @@ void RawModel::undoFilter(QModelIndexList chlist)
         qDebug() << "RawModel: All filter operator removed of type for channel" << chlist[i].row();
     }
 
+    ++m_iDataRevision;
+
     emit assignedOperatorsChanged(m_assignedOperators);
 }
 
@@ -907,6 +971,8 @@ void RawModel::undoFilter(const QString &chType)
                 m_assignedOperators.remove(i);
     }
 
+    ++m_iDataRevision;
+
     emit assignedOperatorsChanged(m_assignedOperators);
 }
 
@@ -917,6 +983,8 @@ void RawModel::undoFilter()
 {
     m_assignedOperators.clear();
 
+    ++m_iDataRevision;
+
     emit assignedOperatorsChanged(m_assignedOperators);
 }
 
@@ -1054,321 +1122,186 @@ void RawModel::insertReloadedData(QPair<MatrixXd,MatrixXd> dataTimesPair)
 
 void RawModel::updateOperatorsConcurrently()
 {
-    m_bProcessing = true;
-
-    QList<int> listFilteredChs = m_assignedOperators.keys();
-    m_listTmpChData.clear();
-
-    //get the rows which are to be filtered out of the m_data matrix. Note that this is done windows wise, hence jumps in the filtered signal might be visible
-    for(qint32 i=0; i < listFilteredChs.size(); ++i) {
-        if(m_bReloadBefore)
-            m_listTmpChData.append(QPair<int,RowVectorXd>(listFilteredChs[i],m_data.first()->dataRawOrig().row(listFilteredChs[i])));
-        else
-            m_listTmpChData.append(QPair<int,RowVectorXd>(listFilteredChs[i],m_data.last()->dataRawOrig().row(listFilteredChs[i])));
-    }
-
-    qDebug() << "RawModel: Starting of concurrent PROCESSING operation of" << listFilteredChs.size() << "items";
-
-    //************* here it could be also performed QtConcurrent::mapped() *************
-    // advantage: QFutureWatcher would give partial results -> signal resultsReadyAt(int idx)
-    // disadvantage: data needs to be copied twice (also to QFuture<QPair<int,RowVectorXd> > object) instead of once (to m_listTmpChData)
-
-    //generate lambda function
-//    std::function<QPair<int,RowVectorXd> (QPair<int,RowVectorXd>&)> applyOps = [this](QPair<int,RowVectorXd>& chdata) -> QPair<int,RowVectorXd> {
-//        return applyOperatorsConcurrently(chdata);
-//    };
-
-//    QFuture<QPair<int,RowVectorXd> > future = QtConcurrent::mapped(m_listTmpChData.begin(),m_listTmpChData.end(),applyOps);
-    //**************************************************************************************************************************************************************************
-
-    QFuture<void > future = QtConcurrent::map(m_listTmpChData,[this](QPair<int,RowVectorXd>& chdata) {
-        return applyOperatorsConcurrently(chdata);
-    });
-
-    m_operatorFutureWatcher.setFuture(future);
-
-    //Wait for thread to be finished processig the data, then insert data
-    //future.waitForFinished();
+    if(m_data.empty())
+        return;
 
-    qDebug() << "RawModel: finished concurrent PROCESSING operation of" << listFilteredChs.size() << "items";
+    //Only the reloaded window is filtered, the already filtered windows are kept
+    QList<QSharedPointer<DataPackage> > listWindows;
+    listWindows.append(m_bReloadBefore ? m_data.first() : m_data.last());
 
-    //insertProcessedDataAll();
+    processWindows(listWindows);
 }
 
 
 //*************************************************************************************************************
 
-void RawModel::updateOperatorsConcurrently(int windowIndex)
+void RawModel::processWindows(const QList<QSharedPointer<DataPackage> >& listWindows)
 {
-    if(windowIndex >= m_data.size() || windowIndex < 0)
-        windowIndex = 0;
-
-    QList<int> listFilteredChs = m_assignedOperators.keys();
-    m_listTmpChData.clear();
-
-    //get the rows which are to be filtered out of the m_data matrix. Note that this is done windows wise, hence jumps in the filtered signal might be visible
-    for(qint32 i=0; i < listFilteredChs.size(); ++i) {
-        if(m_bReloadBefore)
-            m_listTmpChData.append(QPair<int,RowVectorXd>(listFilteredChs[i],m_data[windowIndex]->dataRawOrig().row(listFilteredChs[i])));
-        else
-            m_listTmpChData.append(QPair<int,RowVectorXd>(listFilteredChs[i],m_data[windowIndex]->dataRawOrig().row(listFilteredChs[i])));
+    //Queue the windows if the background-thread is still busy, they are processed once it has finished
+    if(m_operatorFutureWatcher.isRunning()) {
+        for(int i = 0; i < listWindows.size(); ++i)
+            if(!m_listPendingWindows.contains(listWindows[i]))
+                m_listPendingWindows.append(listWindows[i]);
+        return;
     }
 
-    qDebug() << "RawModel: Starting of concurrent PROCESSING operation of" << listFilteredChs.size() << "items in m_data block"<<windowIndex;
-
-    //************* here it could be also performed QtConcurrent::mapped() *************
-    // advantage: QFutureWatcher would give partial results -> signal resultsReadyAt(int idx)
-    // disadvantage: data needs to be copied twice (also to QFuture<QPair<int,RowVectorXd> > object) instead of once (to m_listTmpChData)
-
-    //generate lambda function
-//    std::function<QPair<int,RowVectorXd> (QPair<int,RowVectorXd>&)> applyOps = [this](QPair<int,RowVectorXd>& chdata) -> QPair<int,RowVectorXd> {
-//        return applyOperatorsConcurrently(chdata);
-//    };
-
-//    QFuture<QPair<int,RowVectorXd> > future = QtConcurrent::mapped(m_listTmpChData.begin(),m_listTmpChData.end(),applyOps);
-    //**************************************************************************************************************************************************************************
-
-    QFuture<void > future = QtConcurrent::map(m_listTmpChData,[this](QPair<int,RowVectorXd>& chdata) {
-        return applyOperatorsConcurrently(chdata);
-    });
-
-    //Wait for thread to be finished processig the data, then insert data
-    future.waitForFinished();
-
-    qDebug() << "RawModel: finished concurrent PROCESSING operation of" << listFilteredChs.size() << "items";
-
-    insertProcessedDataAll(windowIndex);
-}
-
+    m_listProcChs = m_assignedOperators.uniqueKeys();
 
-//*************************************************************************************************************
-
-void RawModel::insertProcessedDataRow(int rowIndex)
-{
-    QList<int> listFilteredChs = m_assignedOperators.keys();
-
-    int dataLength = m_iWindowSize;
-    if(m_bReloadBefore)
-        dataLength = m_data.first()->dataRaw().cols();
-    else
-        dataLength = m_data.last()->dataRaw().cols();
+    if(m_listProcChs.empty() || listWindows.empty() || m_data.empty())
+        return;
 
-    int cutFront = m_iCurrentFFTLength/4;
-    int cutBack = m_iCurrentFFTLength/4 + (m_listTmpChData[0].second.cols()-m_iCurrentFFTLength/2-dataLength);
+    m_bProcessing = true;
+    ++m_iDataRevision;
+
+    //Work on a snapshot, m_data may change while the background-thread is running
+    QList<QSharedPointer<DataPackage> > listAllWindows = m_data;
+    QVector<bool> vecFilter(listAllWindows.size(), false);
+    for(int i = 0; i < listAllWindows.size(); ++i)
+        vecFilter[i] = listWindows.contains(listAllWindows[i]);
+
+    //The overlap add also writes the processed data of the neighbours of the filtered windows, they are displayed
+    //unfiltered as well until the processing has finished
+    m_listProcWindows.clear();
+    for(int i = 0; i < listAllWindows.size(); ++i)
+        if(vecFilter[i] || (i > 0 && vecFilter[i-1]) || (i < listAllWindows.size()-1 && vecFilter[i+1]))
+            m_listProcWindows.append(listAllWindows[i]);
+
+    //The cut values are shared by all channels of a window, set them here instead of in every channel task
+    for(int i = 0; i < m_listProcWindows.size(); ++i) {
+        int dataLength = m_listProcWindows[i]->dataRaw().cols();
+        m_listProcWindows[i]->setCutProc(m_iCurrentFFTLength/4, m_iCurrentFFTLength/4 + (m_iCurrentFFTLength/2-dataLength));
+    }
 
-    if(m_bReloadBefore)
-        m_data.first()->setOrigProcData(m_listTmpChData[rowIndex].second, m_listTmpChData[rowIndex].first, cutFront, cutBack);
-    else
-        m_data.last()->setOrigProcData(m_listTmpChData[rowIndex].second, m_listTmpChData[rowIndex].first, cutFront, cutBack);
+    QMap<int,QSharedPointer<MNEOperator> > assignedOperators = m_assignedOperators;
+    int fftLength = m_iCurrentFFTLength;
 
-    performOverlapAdd();
+    qDebug() << "RawModel: Starting of concurrent PROCESSING operation of" << m_listProcChs.size() << "channels in" << listWindows.size() << "windows";
 
-    emit dataChanged(createIndex(listFilteredChs[rowIndex],1),createIndex(listFilteredChs[rowIndex],1));
+    //One task per channel, it filters the channel and performs the overlap add
+    QFuture<void> future = QtConcurrent::map(m_listProcChs,[listAllWindows, vecFilter, assignedOperators, fftLength](int& row) {
+        processChannel(row, listAllWindows, vecFilter, assignedOperators.values(row), fftLength);
+    });
 
-    if(rowIndex == listFilteredChs.last())
-        m_bProcessing = false;
+    m_operatorFutureWatcher.setFuture(future);
 }
 
 
 //*************************************************************************************************************
 
-void RawModel::insertProcessedDataAll(int windowIndex)
+void RawModel::insertProcessedData()
 {
-    if(windowIndex >= m_data.size() || windowIndex < 0 || m_assignedOperators.empty())
-        windowIndex = 0;
+    m_listProcWindows.clear();
+    m_bProcessing = false;
 
-    QList<int> listFilteredChs = m_assignedOperators.keys();
+    ++m_iDataRevision;
 
-    int dataLength = m_data[windowIndex]->dataRaw().cols();;
+    emit dataChanged(createIndex(0,1),createIndex(m_chInfolist.size()-1,1));
 
-    int cutFront = m_iCurrentFFTLength/4;
-    int cutBack = m_iCurrentFFTLength/4 + (m_listTmpChData[0].second.cols()-m_iCurrentFFTLength/2-dataLength);
+    qDebug() << "RawModel: Finished concurrent PROCESSING operation of" << m_listProcChs.size() << "channels.";
 
-    //Set and cut original data to window size and calculate mean for filtered data
-    for(int i=0; i < listFilteredChs.size(); ++i)
-        m_data[windowIndex]->setOrigProcData(m_listTmpChData[i].second, listFilteredChs[i], cutFront, cutBack);
+    //Process the windows which were queued in the meantime and are still loaded
+    QList<QSharedPointer<DataPackage> > listWindows;
+    for(int i = 0; i < m_listPendingWindows.size(); ++i)
+        if(m_data.contains(m_listPendingWindows[i]))
+            listWindows.append(m_listPendingWindows[i]);
 
-    emit dataChanged(createIndex(0,1),createIndex(m_chInfolist.size(),1));
+    m_listPendingWindows.clear();
 
-    qDebug() << "RawModel: Finished inserting" << listFilteredChs.size() << "channels in window "<<windowIndex;
+    if(!listWindows.empty())
+        processWindows(listWindows);
 }
 
 
 //*************************************************************************************************************
 
-void RawModel::insertProcessedDataAll()
+void RawModel::applyOperators(RowVectorXd& data, const QList<QSharedPointer<MNEOperator> >& ops)
 {
-    QList<int> listFilteredChs = m_assignedOperators.keys();
-
-    int dataLength = m_iWindowSize;
-    if(m_bReloadBefore)
-        dataLength = m_data.first()->dataRaw().cols();
-    else
-        dataLength = m_data.last()->dataRaw().cols();
-
-    int cutFront = m_iCurrentFFTLength/4;
-    int cutBack = m_iCurrentFFTLength/4 + (m_listTmpChData[0].second.cols()-m_iCurrentFFTLength/2-dataLength);
-
-    //Set and cut original data to window size and calculate mean for filtered data
-    for(int i=0; i < listFilteredChs.size(); ++i) {
-        if(m_bReloadBefore)
-            m_data.first()->setOrigProcData(m_listTmpChData[i].second, listFilteredChs[i], cutFront, cutBack);
-        else
-            m_data.last()->setOrigProcData(m_listTmpChData[i].second, listFilteredChs[i], cutFront, cutBack);
+    for(qint32 i=0; i < ops.size(); ++i) {
+        switch(ops[i]->m_OperatorType) {
+        case MNEOperator::FILTER: {
+            QSharedPointer<FilterOperator> filter = ops[i].staticCast<FilterOperator>();
+            RowVectorXd tmp = filter->applyFFTFilter(data);
+            data = tmp;
+            break;
+        }
+        case MNEOperator::PCA: {
+            //do something
+            break;
+        }
+        default:
+            break;
+        }
     }
-
-    performOverlapAdd();
-
-    emit dataChanged(createIndex(0,1),createIndex(m_chInfolist.size(),1));
-
-    qDebug() << "RawModel: Finished inserting" << listFilteredChs.size() << "channels.";
-    m_bProcessing = false;
 }
 
 
 //*************************************************************************************************************
 
-void RawModel::performOverlapAdd()
+void RawModel::processChannel(int row, const QList<QSharedPointer<DataPackage> >& listWindows, const QVector<bool>& vecFilter, const QList<QSharedPointer<MNEOperator> >& ops, int fftLength)
 {
-    if(m_data.empty() || m_data.size()<2)
-        return;
-
-    QList<int> listFilteredChs = m_assignedOperators.keys();
-
-    //Overlap add window data
-    int numberWin = m_data.size();
-    int cols = m_data[0]->dataProcOrig().cols();
-    int filterLength = m_iCurrentFFTLength/2; //Total number of zeros which needed to be added to compensate the covolution size increasement. zeroTaper/2 zeros were added at front and back of the data
-    int zeroFFT;
-
-    //Iterate through window data
-    for(int i = 0; i<numberWin; i++) {
-        for(int j = 0; j<listFilteredChs.size(); j++) {
-            RowVectorXd front = RowVectorXd::Zero(cols);
-            RowVectorXd back = RowVectorXd::Zero(cols);
-
-            //First window
-            if(i==0) {
-                zeroFFT = m_iCurrentFFTLength - filterLength - m_data[i]->dataRaw().cols(); //The total number of zeros added to compensate for multiple integer of 2^x
-                back.segment(cols-filterLength-zeroFFT, filterLength) =
-                        m_data[i+1]->dataProcOrig().row(listFilteredChs[j]).segment(0, filterLength);
-            }
-
-            //Middle windows
-            if(i > 0 && i < numberWin-1) {
-                zeroFFT = m_iCurrentFFTLength - filterLength - m_data[i-1]->dataRaw().cols(); //The total number of zeros added to compensate for multiple integer of 2^x
-                front.segment(0, filterLength) =
-                        m_data[i-1]->dataProcOrig().row(listFilteredChs[j]).segment(cols-filterLength-zeroFFT, filterLength);
-
-                zeroFFT = m_iCurrentFFTLength - filterLength - m_data[i]->dataRaw().cols(); //The total number of zeros added to compensate for multiple integer of 2^x
-                back.segment(cols-filterLength-zeroFFT, filterLength) =
-                        m_data[i+1]->dataProcOrig().row(listFilteredChs[j]).segment(0, filterLength);
-            }
-
-            //Last window
-            if(i == numberWin-1) {
-                zeroFFT = m_iCurrentFFTLength - filterLength - m_data[i-1]->dataRaw().cols(); //The total number of zeros added to compensate for multiple integer of 2^x
-                front.segment(0, filterLength) =
-                        m_data[i-1]->dataProcOrig().row(listFilteredChs[j]).segment(cols-filterLength-zeroFFT, filterLength);
-            }
-
-            //Do the overlap add
-            zeroFFT = m_iCurrentFFTLength - filterLength - m_data[i]->dataRaw().cols(); //The total number of zeros added to compensate for multiple integer of 2^x
-            m_data[i]->setMappedProcData(m_data[i]->dataProcOrig().row(listFilteredChs[j])+front+back,
-                                       listFilteredChs[j],
-                                       filterLength/2,
-                                       filterLength/2+zeroFFT);
-
-//            QFile file("D:/inputData.txt");
-//            file.open(QFile::WriteOnly | QFile::Text);
-//            QTextStream out(&file);
-
-//            for(int i=0; i < m_listTmpChData[0].second.cols(); ++i)
-//                out << m_listTmpChData[0].second(0,i) << endl;
-
-//            file.close();
-
-//            QFile file1("D:/front.txt");
-//            file1.open(QFile::WriteOnly | QFile::Text);
-//            QTextStream out1(&file1);
+    int numberWin = listWindows.size();
 
-//            for(int i=0; i < front.cols(); ++i)
-//                out1 << front(0,i) << endl;
-
-//            file1.close();
-
-//            QFile file2("D:/back.txt");
-//            file2.open(QFile::WriteOnly | QFile::Text);
-//            QTextStream out2(&file2);
+    //Filter the channel in the selected windows
+    for(int i = 0; i < numberWin; ++i) {
+        if(!vecFilter[i])
+            continue;
 
-//            for(int i=0; i < back.cols(); ++i)
-//                out2 << back(0,i) << endl;
+        RowVectorXd chData = listWindows[i]->dataRawOrig().row(row);
+        applyOperators(chData, ops);
 
-//            file2.close();
+        int dataLength = listWindows[i]->dataRaw().cols();
+        int cutFront = fftLength/4;
+        int cutBack = fftLength/4 + (chData.cols()-fftLength/2-dataLength);
 
-//            RowVectorXd result = m_listTmpChData[j].second+front+back;
-//            QFile file3("D:/result.txt");
-//            file3.open(QFile::WriteOnly | QFile::Text);
-//            QTextStream out3(&file3);
+        //Set and cut original data to window size and calculate mean for filtered data
+        listWindows[i]->setOrigProcData(chData, row, cutFront, cutBack);
+    }
 
-//            for(int i=0; i < result.cols(); ++i)
-//                out3 << result(0,i) << endl;
+    if(numberWin < 2)
+        return;
 
-//            file3.close();
-        }
+    //Overlap add the filtered windows and their neighbours, whose tails reach into the filtered windows and vice versa
+    for(int i = 0; i < numberWin; ++i) {
+        if(vecFilter[i] || (i > 0 && vecFilter[i-1]) || (i < numberWin-1 && vecFilter[i+1]))
+            overlapAdd(row, listWindows, i, fftLength);
     }
 }
 
 
 //*************************************************************************************************************
 
-void RawModel::performOverlapAdd(int windowIndex)
+void RawModel::overlapAdd(int row, const QList<QSharedPointer<DataPackage> >& listWindows, int windowIndex, int fftLength)
 {
-    if(windowIndex<0 || windowIndex>m_data.size()-1 || m_data.size()<2)
-        return;
+    int numberWin = listWindows.size();
 
-    QList<int> listFilteredChs = m_assignedOperators.keys();
+    if(windowIndex < 0 || windowIndex > numberWin-1 || numberWin < 2)
+        return;
 
-    //Overlap add window data
-    int numberWin = m_data.size();
-    int cols = m_data[windowIndex]->dataProcOrig().cols();
-    int filterLength = m_iCurrentFFTLength/2; //Total number of zeros which needed to be added to compensate the covolution size increasement. zeroTaper/2 zeros were added at front and back of the data
+    int cols = listWindows[windowIndex]->dataProcOrig().cols();
+    int filterLength = fftLength/2; //Total number of zeros which needed to be added to compensate the covolution size increasement. zeroTaper/2 zeros were added at front and back of the data
     int zeroFFT;
 
-    for(int j = 0; j<listFilteredChs.size(); j++) {
-        RowVectorXd front = RowVectorXd::Zero(cols);
-        RowVectorXd back = RowVectorXd::Zero(cols);
-
-        //First window
-        if(windowIndex==0) {
-            zeroFFT = m_iCurrentFFTLength - filterLength - m_data[windowIndex]->dataRaw().cols(); //The total number of zeros added to compensate for multiple integer of 2^x
-            back.segment(cols-filterLength-zeroFFT, filterLength) =
-                    m_data[windowIndex+1]->dataProcOrig().row(listFilteredChs[j]).segment(0, filterLength);
-        }
-
-        //Middle windows
-        if(windowIndex > 0 && windowIndex < numberWin-1) {
-            zeroFFT = m_iCurrentFFTLength - filterLength - m_data[windowIndex-1]->dataRaw().cols(); //The total number of zeros added to compensate for multiple integer of 2^x
-            front.segment(0, filterLength) =
-                    m_data[windowIndex-1]->dataProcOrig().row(listFilteredChs[j]).segment(cols-filterLength-zeroFFT, filterLength);
+    RowVectorXd front = RowVectorXd::Zero(cols);
+    RowVectorXd back = RowVectorXd::Zero(cols);
 
-            zeroFFT = m_iCurrentFFTLength - filterLength - m_data[windowIndex]->dataRaw().cols(); //The total number of zeros added to compensate for multiple integer of 2^x
-            back.segment(cols-filterLength-zeroFFT, filterLength) =
-                    m_data[windowIndex+1]->dataProcOrig().row(listFilteredChs[j]).segment(0, filterLength);
-        }
-
-        //Last window
-        if(windowIndex == numberWin-1) {
-            zeroFFT = m_iCurrentFFTLength - filterLength - m_data[windowIndex-1]->dataRaw().cols(); //The total number of zeros added to compensate for multiple integer of 2^x
-            front.segment(0, filterLength) =
-                    m_data[windowIndex-1]->dataProcOrig().row(listFilteredChs[j]).segment(cols-filterLength-zeroFFT, filterLength);
-        }
+    //Tail of the previous window
+    if(windowIndex > 0) {
+        zeroFFT = fftLength - filterLength - listWindows[windowIndex-1]->dataRaw().cols(); //The total number of zeros added to compensate for multiple integer of 2^x
+        front.segment(0, filterLength) =
+                listWindows[windowIndex-1]->dataProcOrig().row(row).segment(cols-filterLength-zeroFFT, filterLength);
+    }
 
-        //Do the overlap add
-        zeroFFT = m_iCurrentFFTLength - filterLength - m_data[windowIndex]->dataRaw().cols(); //The total number of zeros added to compensate for multiple integer of 2^x
-        m_data[windowIndex]->setMappedProcData(m_data[windowIndex]->dataProcOrig().row(listFilteredChs[j])+front+back,
-                                   listFilteredChs[j],
-                                   filterLength/2,
-                                   filterLength/2+zeroFFT);
+    //Head of the next window
+    if(windowIndex < numberWin-1) {
+        zeroFFT = fftLength - filterLength - listWindows[windowIndex]->dataRaw().cols(); //The total number of zeros added to compensate for multiple integer of 2^x
+        back.segment(cols-filterLength-zeroFFT, filterLength) =
+                listWindows[windowIndex+1]->dataProcOrig().row(row).segment(0, filterLength);
     }
+
+    //Do the overlap add
+    zeroFFT = fftLength - filterLength - listWindows[windowIndex]->dataRaw().cols(); //The total number of zeros added to compensate for multiple integer of 2^x
+    listWindows[windowIndex]->setMappedProcData(listWindows[windowIndex]->dataProcOrig().row(row)+front+back,
+                                                row,
+                                                filterLength/2,
+                                                filterLength/2+zeroFFT);
 }
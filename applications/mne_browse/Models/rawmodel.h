@@ -75,6 +75,7 @@
 #include "../Utils/filteroperator.h"
 #include "../Utils/rawsettings.h"
 #include "../Utils/datapackage.h"
+#include "../Utils/rawoverview.h"
 
 
 //*************************************************************************************************************
@@ -151,6 +152,7 @@ class RawModel : public QAbstractTableModel
 public:
     RawModel(QObject *parent);
     RawModel(QFile& qFile, QObject *parent);
+    ~RawModel();
 
     //=========================================================================================================
     /**
@@ -179,6 +181,21 @@ public:
     */
     bool writeFiffData(QIODevice *p_IODevice);
 
+    //=========================================================================================================
+    /**
+    * getEnvelope computes the minimum and maximum of the displayed data of one loaded window for each pixel column.
+    * The values are taken from the min/max pyramid of the window, so the costs do not depend on its number of samples.
+    *
+    * @param[in] row            the channel
+    * @param[in] window         index of the loaded window, in the order of the pairs returned by data()
+    * @param[in] iNumColumns    number of pixel columns the samples of the window are distributed over
+    * @param[out] vecMin        the minimum of each column
+    * @param[out] vecMax        the maximum of each column
+    *
+    * @return false if no pyramid is available for the window, true otherwise
+    */
+    bool getEnvelope(int row, int window, qint32 iNumColumns, QVector<double>& vecMin, QVector<double>& vecMax) const;
+
     //VARIABLES
     bool                                        m_bFileloaded;  /**< true when a Fiff file is loaded */
     QList<FiffChInfo>                           m_chInfolist;   /**< List of FiffChInfo objects that holds the corresponding channels information */
@@ -232,6 +249,54 @@ private:
     */
     QPair<MatrixXd,MatrixXd> readSegment(fiff_int_t from, fiff_int_t to);
 
+    //=========================================================================================================
+    /**
+    * computeOverview starts computing the min/max/RMS overview of the whole recording in a background-thread.
+    * A previously started computation is canceled.
+    *
+    * @param sFileName the raw fiff file
+    */
+    void computeOverview(const QString& sFileName);
+
+    //=========================================================================================================
+    /**
+    * cancelOverview cancels a running overview computation and discards the current overview.
+    */
+    void cancelOverview();
+
+    //=========================================================================================================
+    /**
+    * applyOperators applies MNEOperators to a RowVectorXd and modifies it in-place. This is thread-safe.
+    *
+    * @param data[in,out] the channel data
+    * @param ops the operators to apply
+    */
+    static void applyOperators(RowVectorXd& data, const QList<QSharedPointer<MNEOperator> >& ops);
+
+    //=========================================================================================================
+    /**
+    * processChannel filters one channel in the selected windows and performs the overlap add for all windows whose
+    * own or adjacent processed data changed. Only the row of the channel is written, so the channels can be processed in parallel.
+    *
+    * @param row the channel
+    * @param listWindows all loaded windows in the order of m_data
+    * @param vecFilter whether the channel is to be filtered in the corresponding window
+    * @param ops the operators assigned to the channel
+    * @param fftLength the fft length of the operators
+    */
+    static void processChannel(int row, const QList<QSharedPointer<DataPackage> >& listWindows, const QVector<bool>& vecFilter, const QList<QSharedPointer<MNEOperator> >& ops, int fftLength);
+
+    //=========================================================================================================
+    /**
+    * overlapAdd adds the filter responses of the adjacent windows which reach into a window to the processed data of one channel
+    *
+    * @param row the channel
+    * @param listWindows all loaded windows in the order of m_data
+    * @param windowIndex the window
+    * @param fftLength the fft length of the operators
+    */
+    static void overlapAdd(int row, const QList<QSharedPointer<DataPackage> >& listWindows, int windowIndex, int fftLength);
+
     //VARIABLES
     //Reload control
     bool                                    m_bStartReached;            /**< signals, whether the start of the fiff data file is reached. */
@@ -242,11 +307,19 @@ private:
     QFutureWatcher<QPair<MatrixXd,MatrixXd> > m_reloadFutureWatcher;    /**< QFutureWatcher for watching process of reloading fiff data. */
     bool                                    m_bReloading;               /**< signals when the reloading is ongoing. */
 
+    //Concurrent overview computation
+    QFutureWatcher<RawOverview::SPtr>       m_overviewFutureWatcher;    /**< QFutureWatcher for watching the computation of the whole-recording overview. */
+    QSharedPointer<QAtomicInt>              m_pOverviewCanceled;        /**< set to cancel the running overview computation. */
+    RawOverview::SPtr                       m_pOverview;                /**< min/max/RMS overview of the whole recording, empty while it is computed. */
+
     //Concurrent processing
 //    QFutureWatcher<QPair<int,RowVectorXd> > m_operatorFutureWatcher; /**< QFutureWatcher for watching process of applying Operators to reloaded fiff data. */
     QFutureWatcher<void>                    m_operatorFutureWatcher;    /**< QFutureWatcher for watching process of applying Operators to reloaded fiff data. */
-    QList<QPair<int,RowVectorXd> >          m_listTmpChData;            /**< contains pairs with a channel number and the corresponding RowVectorXd. */
+    QList<int>                              m_listProcChs;              /**< the channels which are processed in the background-thread, one task per channel. */
+    QList<QSharedPointer<DataPackage> >     m_listProcWindows;          /**< the windows which are filtered or overlap added in the background-thread, they are displayed unfiltered until processing has finished. */
+    QList<QSharedPointer<DataPackage> >     m_listPendingWindows;       /**< windows which are to be filtered once the running processing has finished, they are displayed unfiltered until then. */
     bool                                    m_bProcessing;              /**< true when processing in a background-thread is ongoing.*/
+    quint32                                 m_iDataRevision;            /**< incremented whenever the displayed data of already loaded samples changes. */
     QString                                 m_filterChType;
 
     QMutex                                  m_Mutex;                    /**< mutex for locking against simultaenous access to shared objects >. */
@@ -273,6 +346,12 @@ signals:
     */
     void dataReloaded();
 
+    //=========================================================================================================
+    /**
+    * overviewReady is emitted when the overview of the whole recording is available
+    */
+    void overviewReady();
+
     //=========================================================================================================
     /**
     * fileLoaded is emitted whenever a file was to be loaded
@@ -415,53 +494,26 @@ private slots:
 
     //=========================================================================================================
     /**
-    * updateOperatorsConcurrently runs the processing of the MNEOperators in a background-thread
+    * updateOperatorsConcurrently runs the processing of the MNEOperators in a background-thread for the newly reloaded window only
     */
     void updateOperatorsConcurrently();
 
     //=========================================================================================================
     /**
-    * updateOperatorsConcurrently runs the processing of the MNEOperators in a background-thread for a given index of the data package list m_data
-    *
-    * @param windowIndex the index of m_data which is to be filtered
-    */
-    void updateOperatorsConcurrently(int windowIndex);
-
-    //=========================================================================================================
-    /**
-    * insertProcessedDataRow inserts the processed data row into m_data when background-thread has finished (this method would be used for QtConcurrent::mapped)
-    *
-    * @param index represents the row index in m_data
-    */
-    void insertProcessedDataRow(int rowIndex);
-
-    //=========================================================================================================
-    /**
-    * insertProcessedDataAll inserts all the processed data into m_data[windowIndex] when background-thread has finished
+    * processWindows filters the given windows of m_data in a background-thread. Every channel is one task which
+    * filters the channel in all given windows and performs the overlap add with the adjacent windows, so that the
+    * filter responses continue across the window boundaries. If processing is already running, the windows are
+    * queued and processed afterwards.
     *
-    * @param index represents the window index in m_data
+    * @param listWindows the windows which are to be filtered
     */
-    void insertProcessedDataAll(int windowIndex);
+    void processWindows(const QList<QSharedPointer<DataPackage> >& listWindows);
 
     //=========================================================================================================
     /**
-    * insertProcessedDataAll inserts all the processed data into m_data in front (m_ReloadFront = true) or back (m_ReloadFront = false) when background-thread has finished (this method would be used for QtConcurrent::map)
+    * insertProcessedData is called when the background-thread has finished, it updates the view and starts the processing of queued windows
     */
-    void insertProcessedDataAll();
-
-    //=========================================================================================================
-    /**
-    * performs overlap add method to the processed data
-    */
-    void performOverlapAdd();
-
-    //=========================================================================================================
-    /**
-    * performs overlap add method to the processed data
-    *
-    * @param windowIndex the window index
-    */
-    void performOverlapAdd(int windowIndex);
+    void insertProcessedData();
 
 public:
     //=========================================================================================================
@@ -511,6 +563,30 @@ public:
     * @return the absolute cursor in the fiff file
     */
     inline qint32 absFiffCursor() const;
+
+    //=========================================================================================================
+    /**
+    * dataRevision
+    *
+    * @return counter which changes whenever already loaded samples are displayed with different values, e.g. after filtering
+    */
+    inline quint32 dataRevision() const;
+
+    //=========================================================================================================
+    /**
+    * isProcessing
+    *
+    * @return true while the loaded data is being processed
+    */
+    inline bool isProcessing() const;
+
+    //=========================================================================================================
+    /**
+    * overview
+    *
+    * @return the min/max/RMS overview of the whole recording, or an empty pointer while it is computed
+    */
+    inline RawOverview::ConstSPtr overview() const;
 };
 
 //*************************************************************************************************************
@@ -566,6 +642,27 @@ inline qint32 RawModel::absFiffCursor() const {
     return m_iAbsFiffCursor;
 }
 
+
+//*************************************************************************************************************
+
+inline quint32 RawModel::dataRevision() const {
+    return m_iDataRevision;
+}
+
+
+//*************************************************************************************************************
+
+inline bool RawModel::isProcessing() const {
+    return m_bProcessing;
+}
+
+
+//*************************************************************************************************************
+
+inline RawOverview::ConstSPtr RawModel::overview() const {
+    return m_pOverview;
+}
+
 } // NAMESPACE
 
 #endif // RAWMODEL_H
@@ -74,6 +74,7 @@ DataPackage::DataPackage(const MatrixXdR &originalRawData, const MatrixXdR &orig
 
     m_dataProcOriginal = MatrixXdR::Zero(m_dataRawOriginal.rows(), length);
     m_dataProcMapped = MatrixXdR::Zero(m_dataRawMapped.rows(), m_dataRawMapped.cols());
+    m_pyramidProc.build(m_dataProcMapped.data(), m_dataProcMapped.rows(), m_dataProcMapped.cols());
 
     //Init mean data
     m_dataRawMean = calculateMatMean(m_dataRawMapped);
@@ -90,6 +91,7 @@ void DataPackage::setOrigRawData(const MatrixXdR &originalRawData, int cutFront,
 
     //Cut data
     m_dataRawMapped = cutData(m_dataRawOriginal, cutFront, cutBack);
+    m_pyramidRaw.build(m_dataRawMapped.data(), m_dataRawMapped.rows(), m_dataRawMapped.cols());
 
     if(cutFront != m_iCutFrontRaw)
         m_iCutFrontRaw = cutFront;
@@ -116,6 +118,7 @@ void DataPackage::setOrigRawData(const RowVectorXd &originalRawData, int row, in
 
     //Cut data
     m_dataRawMapped.row(row) = cutData(m_dataRawOriginal, cutFront, cutBack);
+    m_pyramidRaw.updateRow(row, m_dataRawMapped.data() + row*m_dataRawMapped.cols(), 0, m_dataRawMapped.cols());
 
     if(cutFront != m_iCutFrontRaw)
         m_iCutFrontRaw = cutFront;
@@ -137,6 +140,7 @@ void DataPackage::setOrigProcData(const MatrixXdR &originalProcData, int cutFron
 
     //Cut data
     m_dataProcMapped = cutData(m_dataProcOriginal, cutFront, cutBack);
+    m_pyramidProc.build(m_dataProcMapped.data(), m_dataProcMapped.rows(), m_dataProcMapped.cols());
 
     if(cutFront != m_iCutFrontProc)
         m_iCutFrontProc = cutFront;
@@ -155,6 +159,7 @@ void DataPackage::setMappedProcData(const MatrixXdR &originalProcData, int cutFr
 {
     //Cut data
     m_dataProcMapped = cutData(originalProcData, cutFront, cutBack);
+    m_pyramidProc.build(m_dataProcMapped.data(), m_dataProcMapped.rows(), m_dataProcMapped.cols());
 
     if(cutFront != m_iCutFrontProc)
         m_iCutFrontProc = cutFront;
@@ -181,12 +186,9 @@ void DataPackage::setOrigProcData(const RowVectorXd &originalProcData, int row,
 
     //Cut data
     m_dataProcMapped.row(row) = cutData(originalProcData, cutFront, cutBack);
+    m_pyramidProc.updateRow(row, m_dataProcMapped.data() + row*m_dataProcMapped.cols(), 0, m_dataProcMapped.cols());
 
-    if(cutFront != m_iCutFrontProc)
-        m_iCutFrontProc = cutFront;
-
-    if(cutBack != m_iCutBackProc)
-        m_iCutBackProc = cutBack;
+    //The cut values are shared by all rows, they are set once via setCutProc since the rows are processed concurrently
 
     //Calculate mean
     m_dataProcMean(row) = calculateRowMean(m_dataProcMapped.row(row));
@@ -204,17 +206,23 @@ void DataPackage::setMappedProcData(const RowVectorXd &originalProcData, int row
 
     //Cut data
     m_dataProcMapped.row(row) = cutData(originalProcData, cutFront, cutBack);
+    m_pyramidProc.updateRow(row, m_dataProcMapped.data() + row*m_dataProcMapped.cols(), 0, m_dataProcMapped.cols());
 
-    if(cutFront != m_iCutFrontProc)
-        m_iCutFrontProc = cutFront;
-
-    if(cutBack != m_iCutBackProc)
-        m_iCutBackProc = cutBack;
+    //The cut values are shared by all rows, they are set once via setCutProc since the rows are processed concurrently
 
     //Calculate mean
     m_dataProcMean(row) = calculateRowMean(m_dataProcMapped.row(row));
 }
 
+//*************************************************************************************************************
+
+void DataPackage::setCutProc(int cutFront, int cutBack)
+{
+    m_iCutFrontProc = cutFront;
+    m_iCutBackProc = cutBack;
+}
+
+
 //*************************************************************************************************************
 
 const MatrixXdR & DataPackage::dataRawOrig()
@@ -247,6 +255,22 @@ const MatrixXdR & DataPackage::dataProc()
 }
 
 
+//*************************************************************************************************************
+
+const DISPLIB::MinMaxPyramid & DataPackage::pyramidRaw()
+{
+    return m_pyramidRaw;
+}
+
+
+//*************************************************************************************************************
+
+const DISPLIB::MinMaxPyramid & DataPackage::pyramidProc()
+{
+    return m_pyramidProc;
+}
+
+
 //*************************************************************************************************************
 
 double DataPackage::dataProcMean(int row)
@@ -285,6 +309,7 @@ void DataPackage::applyFFTFilter(int channelNumber, QSharedPointer<FilterOperato
 
     //Cut filtered m_dataProcOriginal
     m_dataProcMapped = cutData(m_dataProcOriginal, m_iCutFrontProc, m_iCutBackProc);
+    m_pyramidProc.build(m_dataProcMapped.data(), m_dataProcMapped.rows(), m_dataProcMapped.cols());
 
     //Calculate mean
     m_dataProcMean(channelNumber) = calculateRowMean(m_dataProcMapped);
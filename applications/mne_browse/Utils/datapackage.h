@@ -45,6 +45,8 @@
 #include "filteroperator.h"
 #include "types.h"
 
+#include <disp/helpers/minmaxpyramid.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -163,6 +165,16 @@ public:
     */
     void setMappedProcData(const RowVectorXd &originalProcData, int row, int cutFront, int cutBack);
 
+    //=========================================================================================================
+    /**
+    * Sets the cut values of the processed data. The row wise setters do not change them, since the rows may be
+    * set from several threads at once.
+    *
+    * @param cutFront the amount cut from the front of the original processed data
+    * @param cutBack the amount cut from the back of the original processed data
+    */
+    void setCutProc(int cutFront, int cutBack);
+
     //=========================================================================================================
     /**
     * Returns the original full raw data.
@@ -195,6 +207,22 @@ public:
     */
     const MatrixXdR & dataProc();
 
+    //=========================================================================================================
+    /**
+    * Returns the min/max pyramid of the mapped raw data.
+    *
+    * @return the pyramid of the mapped raw data
+    */
+    const DISPLIB::MinMaxPyramid & pyramidRaw();
+
+    //=========================================================================================================
+    /**
+    * Returns the min/max pyramid of the mapped processed data.
+    *
+    * @return the pyramid of the mapped processed data
+    */
+    const DISPLIB::MinMaxPyramid & pyramidProc();
+
     //=========================================================================================================
     /**
     * Returns the mean of the processed mapped data.
@@ -271,11 +299,13 @@ private:
     MatrixXdR   m_dataRawMapped;        /**< The mapped/cut raw data */
     MatrixXdR   m_dataRawOriginal;      /**< The original raw data */
     VectorXd    m_dataRawMean;          /**< The mean of the mapped/cut raw data */
+    DISPLIB::MinMaxPyramid m_pyramidRaw;    /**< The min/max pyramid of the mapped/cut raw data */
 
     //Processed data
     MatrixXdR   m_dataProcOriginal;     /**< The mapped/cut processed/filtered data */
     MatrixXdR   m_dataProcMapped;       /**< The original processed/filtered data */
     VectorXd    m_dataProcMean;         /**< The mean of the mapped/cut processed/filtered data */
+    DISPLIB::MinMaxPyramid m_pyramidProc;   /**< The min/max pyramid of the mapped/cut processed/filtered data */
 
     //Cutting parameters
     int m_iCutFrontRaw;                 /**< The last used cut front value of the raw data */
@@ -0,0 +1,502 @@
+//=============================================================================================================
+/**
+* @file     rawoverview.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Definition of the RawOverview class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rawoverview.h"
+#include "rawsettings.h"
+
+#include <fiff/fiff_raw_data.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QtMath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNEBROWSE;
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define OVERVIEW_CACHE_MAGIC    0x4D424F56  //"MBOV"
+#define OVERVIEW_CACHE_VERSION  1
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+bool MNEBROWSE::operator==(const RawOverviewStamp &lhs, const RawOverviewStamp &rhs)
+{
+    return lhs.iFileSize == rhs.iFileSize
+            && lhs.iModified == rhs.iModified
+            && lhs.iFirstSample == rhs.iFirstSample
+            && lhs.iLastSample == rhs.iLastSample
+            && lhs.iNumChannels == rhs.iNumChannels
+            && lhs.iNumBuffers == rhs.iNumBuffers;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RawOverview::RawOverview()
+: m_iNumRows(0)
+, m_iNumSamples(0)
+, m_iBinSize(MODEL_OVERVIEW_BIN_SIZE)
+, m_iLevelFactor(MODEL_OVERVIEW_LEVEL_FACTOR)
+{
+}
+
+
+//*************************************************************************************************************
+
+RawOverview::SPtr RawOverview::compute(const QString &sFileName, const QSharedPointer<QAtomicInt> &pCanceled)
+{
+    QFile t_File(sFileName);
+    FiffRawData t_Raw(t_File);
+
+    if(t_Raw.isEmpty() || t_Raw.rawdir.isEmpty()) {
+        qWarning() << "RawOverview::compute - Could not read raw data from" << sFileName;
+        return SPtr();
+    }
+
+    QFileInfo t_FileInfo(sFileName);
+
+    RawOverviewStamp stamp;
+    stamp.iFileSize = t_FileInfo.size();
+    stamp.iModified = t_FileInfo.lastModified().toMSecsSinceEpoch();
+    stamp.iFirstSample = t_Raw.first_samp;
+    stamp.iLastSample = t_Raw.last_samp;
+    stamp.iNumChannels = t_Raw.info.nchan;
+    stamp.iNumBuffers = t_Raw.rawdir.size();
+
+    SPtr pOverview(new RawOverview());
+    QStringList listCacheFiles = sidecarFileNames(sFileName);
+
+    for(int i = 0; i < listCacheFiles.size(); ++i) {
+        if(pOverview->readCache(listCacheFiles[i], stamp)) {
+            return pOverview;
+        }
+
+        *pOverview = RawOverview();
+    }
+
+    if(!pOverview->computeFromRaw(t_Raw, pCanceled)) {
+        return SPtr();
+    }
+
+    bool bWritten = false;
+    for(int i = 0; i < listCacheFiles.size() && !bWritten; ++i) {
+        bWritten = pOverview->writeCache(listCacheFiles[i], stamp);
+    }
+
+    if(!bWritten) {
+        qWarning() << "RawOverview::compute - Could not write the overview cache of" << sFileName;
+    }
+
+    return pOverview;
+}
+
+
+//*************************************************************************************************************
+
+QStringList RawOverview::sidecarFileNames(const QString &sFileName)
+{
+    QString sAbsFileName = QFileInfo(sFileName).absoluteFilePath();
+    QString sHash = QCryptographicHash::hash(sAbsFileName.toUtf8(), QCryptographicHash::Sha1).toHex();
+
+    QStringList listFileNames;
+    listFileNames << sAbsFileName + ".overview";
+    listFileNames << QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/overview/" + sHash + ".overview";
+
+    return listFileNames;
+}
+
+
+//*************************************************************************************************************
+
+bool RawOverview::envelope(qint32 iRow, qint32 iFrom, qint32 iTo, qint32 iNumColumns, QVector<double>& vecMin, QVector<double>& vecMax, QVector<double>& vecRms) const
+{
+    iFrom = qMax(iFrom, 0);
+    iTo = qMin(iTo, m_iNumSamples);
+
+    if(isEmpty() || iRow < 0 || iRow >= m_iNumRows || iFrom >= iTo || iNumColumns < 1)
+        return false;
+
+    double dPart = double(iTo - iFrom) / iNumColumns;
+
+    //Coarsest level whose bins still fit into one part
+    qint32 iLevel = 0;
+    while(iLevel + 1 < numLevels() && binSize(iLevel + 1) <= dPart)
+        ++iLevel;
+
+    const MatrixXfR& matMin = m_qVecMin[iLevel];
+    const MatrixXfR& matMax = m_qVecMax[iLevel];
+    const MatrixXfR& matRms = m_qVecRms[iLevel];
+    qint32 iBinSize = binSize(iLevel);
+    qint32 iNumBins = matMin.cols();
+
+    vecMin.resize(iNumColumns);
+    vecMax.resize(iNumColumns);
+    vecRms.resize(iNumColumns);
+
+    for(qint32 c = 0; c < iNumColumns; ++c) {
+        qint32 iStart = iFrom + qint32(c * dPart);
+        qint32 iEnd = (c == iNumColumns - 1) ? iTo : iFrom + qint32((c + 1) * dPart);
+
+        qint32 iFirstBin = qMin(iStart / iBinSize, iNumBins - 1);
+        qint32 iLastBin = qBound(iFirstBin, (iEnd - 1) / iBinSize, iNumBins - 1);
+
+        double dMin = matMin(iRow, iFirstBin);
+        double dMax = matMax(iRow, iFirstBin);
+        double dSumSq = 0.0;
+        qint32 iCount = 0;
+
+        for(qint32 b = iFirstBin; b <= iLastBin; ++b) {
+            dMin = qMin(dMin, (double)matMin(iRow, b));
+            dMax = qMax(dMax, (double)matMax(iRow, b));
+
+            qint32 iBinSamples = qMin(iBinSize, m_iNumSamples - b * iBinSize);
+            dSumSq += double(matRms(iRow, b)) * matRms(iRow, b) * iBinSamples;
+            iCount += iBinSamples;
+        }
+
+        vecMin[c] = dMin;
+        vecMax[c] = dMax;
+        vecRms[c] = iCount > 0 ? qSqrt(dSumSq / iCount) : 0.0;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+qint32 RawOverview::findNextExceeding(qint32 iRow, qint32 iFrom, double dThreshold) const
+{
+    if(isEmpty() || iRow < 0 || iRow >= m_iNumRows)
+        return -1;
+
+    iFrom = qMax(iFrom, 0);
+
+    float fThreshold = (float)dThreshold;
+    qint32 iNumBins = m_qVecMin[0].cols();
+    qint32 iBin = iFrom / m_iBinSize;
+
+    while(iBin < iNumBins) {
+        if(exceeds(0, iRow, iBin, fThreshold))
+            return qMax(iFrom, iBin * m_iBinSize);
+
+        //Skip the largest aligned coarse bin which stays below the threshold
+        qint32 iLevel = 0;
+        qint32 iSpan = 1;
+        while(iLevel + 1 < numLevels()
+              && iBin % (iSpan * m_iLevelFactor) == 0
+              && !exceeds(iLevel + 1, iRow, iBin / (iSpan * m_iLevelFactor), fThreshold)) {
+            iSpan *= m_iLevelFactor;
+            ++iLevel;
+        }
+
+        iBin += iSpan;
+    }
+
+    return -1;
+}
+
+
+//*************************************************************************************************************
+
+bool RawOverview::computeFromRaw(FiffRawData &raw, const QSharedPointer<QAtomicInt> &pCanceled)
+{
+    m_iNumRows = raw.info.nchan;
+    m_iNumSamples = raw.last_samp - raw.first_samp + 1;
+    m_iBinSize = MODEL_OVERVIEW_BIN_SIZE;
+    m_iLevelFactor = MODEL_OVERVIEW_LEVEL_FACTOR;
+
+    if(m_iNumRows < 1 || m_iNumSamples < 1)
+        return false;
+
+    qint32 iNumBins = (m_iNumSamples + m_iBinSize - 1) / m_iBinSize;
+
+    m_qVecMin = QVector<MatrixXfR>(1, MatrixXfR(m_iNumRows, iNumBins));
+    m_qVecMax = QVector<MatrixXfR>(1, MatrixXfR(m_iNumRows, iNumBins));
+    m_qVecRms = QVector<MatrixXfR>(1, MatrixXfR(m_iNumRows, iNumBins));
+
+    //Read whole raw buffers, several at once until a chunk is long enough
+    qint32 iChunkSize = qMax(m_iBinSize, (qint32)qCeil(MODEL_OVERVIEW_CHUNK_SEC * raw.info.sfreq));
+
+    VectorXd vecMin, vecMax, vecSumSq;
+    qint32 iCount = 0;
+    qint32 iBin = 0;
+    qint32 iNumRead = 0;
+
+    int i = 0;
+    while(i < raw.rawdir.size()) {
+        if(pCanceled && pCanceled->load() != 0)
+            return false;
+
+        fiff_int_t from = raw.rawdir[i].first;
+        fiff_int_t to = raw.rawdir[i].last;
+        ++i;
+
+        while(i < raw.rawdir.size() && to - from + 1 < iChunkSize) {
+            to = raw.rawdir[i].last;
+            ++i;
+        }
+
+        MatrixXd matData, matTimes;
+        if(!raw.read_raw_segment(matData, matTimes, from, to)) {
+            qWarning() << "RawOverview::computeFromRaw - Could not read samples" << from << "to" << to;
+            return false;
+        }
+
+        //Bins continue across chunk boundaries
+        qint32 iPos = 0;
+        while(iPos < matData.cols() && iBin < iNumBins) {
+            qint32 iNum = qMin(m_iBinSize - iCount, (qint32)matData.cols() - iPos);
+            MatrixXd::ColsBlockXpr matBlock = matData.middleCols(iPos, iNum);
+
+            if(iCount == 0) {
+                vecMin = matBlock.rowwise().minCoeff();
+                vecMax = matBlock.rowwise().maxCoeff();
+                vecSumSq = matBlock.rowwise().squaredNorm();
+            } else {
+                vecMin = vecMin.cwiseMin(matBlock.rowwise().minCoeff());
+                vecMax = vecMax.cwiseMax(matBlock.rowwise().maxCoeff());
+                vecSumSq += matBlock.rowwise().squaredNorm();
+            }
+
+            iCount += iNum;
+            iPos += iNum;
+            iNumRead += iNum;
+
+            if(iCount == m_iBinSize) {
+                m_qVecMin[0].col(iBin) = vecMin.cast<float>();
+                m_qVecMax[0].col(iBin) = vecMax.cast<float>();
+                m_qVecRms[0].col(iBin) = (vecSumSq / iCount).cwiseSqrt().cast<float>();
+                ++iBin;
+                iCount = 0;
+            }
+        }
+    }
+
+    if(iCount > 0) {
+        m_qVecMin[0].col(iBin) = vecMin.cast<float>();
+        m_qVecMax[0].col(iBin) = vecMax.cast<float>();
+        m_qVecRms[0].col(iBin) = (vecSumSq / iCount).cwiseSqrt().cast<float>();
+        ++iBin;
+    }
+
+    if(iBin == 0)
+        return false;
+
+    //The buffer directory may cover less samples than announced
+    if(iBin < iNumBins) {
+        m_qVecMin[0].conservativeResize(m_iNumRows, iBin);
+        m_qVecMax[0].conservativeResize(m_iNumRows, iBin);
+        m_qVecRms[0].conservativeResize(m_iNumRows, iBin);
+    }
+    m_iNumSamples = iNumRead;
+
+    buildLevels();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void RawOverview::buildLevels()
+{
+    while(m_qVecMin.last().cols() > 1) {
+        qint32 iLevel = m_qVecMin.size() - 1;
+        qint32 iBinSize = binSize(iLevel);
+        qint32 iNumBinsPrev = m_qVecMin[iLevel].cols();
+        qint32 iNumBins = (iNumBinsPrev + m_iLevelFactor - 1) / m_iLevelFactor;
+
+        MatrixXfR matMin(m_iNumRows, iNumBins);
+        MatrixXfR matMax(m_iNumRows, iNumBins);
+        MatrixXfR matRms(m_iNumRows, iNumBins);
+
+        for(qint32 b = 0; b < iNumBins; ++b) {
+            qint32 iFirst = b * m_iLevelFactor;
+            qint32 iNum = qMin(m_iLevelFactor, iNumBinsPrev - iFirst);
+
+            matMin.col(b) = m_qVecMin[iLevel].middleCols(iFirst, iNum).rowwise().minCoeff();
+            matMax.col(b) = m_qVecMax[iLevel].middleCols(iFirst, iNum).rowwise().maxCoeff();
+
+            //Weight the mean squares with the number of samples, the last bin may be partially filled
+            VectorXd vecSumSq = VectorXd::Zero(m_iNumRows);
+            qint32 iCount = 0;
+
+            for(qint32 j = iFirst; j < iFirst + iNum; ++j) {
+                qint32 iBinSamples = qMin(iBinSize, m_iNumSamples - j * iBinSize);
+                vecSumSq += m_qVecRms[iLevel].col(j).cast<double>().cwiseAbs2() * iBinSamples;
+                iCount += iBinSamples;
+            }
+
+            matRms.col(b) = (vecSumSq / iCount).cwiseSqrt().cast<float>();
+        }
+
+        m_qVecMin.append(matMin);
+        m_qVecMax.append(matMax);
+        m_qVecRms.append(matRms);
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool RawOverview::readCache(const QString &sCacheFileName, const RawOverviewStamp &stamp)
+{
+    QFile t_File(sCacheFileName);
+    if(!t_File.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&t_File);
+
+    quint32 iMagic, iVersion;
+    quint8 iByteOrder;
+    in >> iMagic >> iVersion >> iByteOrder;
+
+    if(iMagic != OVERVIEW_CACHE_MAGIC || iVersion != OVERVIEW_CACHE_VERSION || iByteOrder != (quint8)QSysInfo::ByteOrder)
+        return false;
+
+    RawOverviewStamp cachedStamp;
+    in >> cachedStamp.iFileSize >> cachedStamp.iModified >> cachedStamp.iFirstSample >> cachedStamp.iLastSample >> cachedStamp.iNumChannels >> cachedStamp.iNumBuffers;
+
+    if(!(cachedStamp == stamp))
+        return false;
+
+    qint32 iNumLevels;
+    in >> m_iNumRows >> m_iNumSamples >> m_iBinSize >> m_iLevelFactor >> iNumLevels;
+
+    if(in.status() != QDataStream::Ok || m_iNumRows != stamp.iNumChannels || m_iNumSamples < 1 || m_iBinSize < 1 || m_iLevelFactor < 2 || iNumLevels < 1)
+        return false;
+
+    m_qVecMin.clear();
+    m_qVecMax.clear();
+    m_qVecRms.clear();
+
+    for(qint32 l = 0; l < iNumLevels; ++l) {
+        qint32 iNumBins;
+        in >> iNumBins;
+
+        if(in.status() != QDataStream::Ok || iNumBins != (m_iNumSamples + binSize(l) - 1) / binSize(l))
+            return false;
+
+        MatrixXfR matMin(m_iNumRows, iNumBins);
+        MatrixXfR matMax(m_iNumRows, iNumBins);
+        MatrixXfR matRms(m_iNumRows, iNumBins);
+        int iNumBytes = m_iNumRows * iNumBins * sizeof(float);
+
+        if(in.readRawData(reinterpret_cast<char*>(matMin.data()), iNumBytes) != iNumBytes
+                || in.readRawData(reinterpret_cast<char*>(matMax.data()), iNumBytes) != iNumBytes
+                || in.readRawData(reinterpret_cast<char*>(matRms.data()), iNumBytes) != iNumBytes)
+            return false;
+
+        m_qVecMin.append(matMin);
+        m_qVecMax.append(matMax);
+        m_qVecRms.append(matRms);
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool RawOverview::writeCache(const QString &sCacheFileName, const RawOverviewStamp &stamp) const
+{
+    QDir().mkpath(QFileInfo(sCacheFileName).absolutePath());
+
+    //QSaveFile only replaces an existing cache once everything was written
+    QSaveFile t_File(sCacheFileName);
+    if(!t_File.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&t_File);
+
+    out << (quint32)OVERVIEW_CACHE_MAGIC << (quint32)OVERVIEW_CACHE_VERSION << (quint8)QSysInfo::ByteOrder;
+    out << stamp.iFileSize << stamp.iModified << stamp.iFirstSample << stamp.iLastSample << stamp.iNumChannels << stamp.iNumBuffers;
+    out << m_iNumRows << m_iNumSamples << m_iBinSize << m_iLevelFactor << (qint32)numLevels();
+
+    for(qint32 l = 0; l < numLevels(); ++l) {
+        qint32 iNumBins = m_qVecMin[l].cols();
+        int iNumBytes = m_iNumRows * iNumBins * sizeof(float);
+
+        out << iNumBins;
+        out.writeRawData(reinterpret_cast<const char*>(m_qVecMin[l].data()), iNumBytes);
+        out.writeRawData(reinterpret_cast<const char*>(m_qVecMax[l].data()), iNumBytes);
+        out.writeRawData(reinterpret_cast<const char*>(m_qVecRms[l].data()), iNumBytes);
+    }
+
+    if(out.status() != QDataStream::Ok) {
+        t_File.cancelWriting();
+        return false;
+    }
+
+    return t_File.commit();
+}
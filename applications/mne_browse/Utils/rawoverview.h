@@ -0,0 +1,334 @@
+//=============================================================================================================
+/**
+* @file     rawoverview.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     RawOverview class declaration.
+*
+*/
+
+#ifndef RAWOVERVIEW_H
+#define RAWOVERVIEW_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Forward Declarations
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+    class FiffRawData;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNEBROWSE
+//=============================================================================================================
+
+namespace MNEBROWSE
+{
+
+//=============================================================================================================
+/**
+* Identifies the raw data an overview was computed from. A cached overview is only used if its stamp matches
+* the stamp of the fiff file.
+*/
+struct RawOverviewStamp
+{
+    qint64      iFileSize;      /**< Size of the fiff file in bytes. */
+    qint64      iModified;      /**< Last modification of the fiff file [ms since epoch]. */
+    qint32      iFirstSample;   /**< First sample of the raw data. */
+    qint32      iLastSample;    /**< Last sample of the raw data. */
+    qint32      iNumChannels;   /**< Number of channels. */
+    qint32      iNumBuffers;    /**< Number of entries of the raw buffer directory. */
+};
+
+bool operator==(const RawOverviewStamp &lhs, const RawOverviewStamp &rhs);
+
+
+//=============================================================================================================
+/**
+* Multiresolution summary of a whole raw recording. Level 0 holds the minimum, maximum and RMS of consecutive
+* bins of binSize() samples of each channel, every further level combines levelFactor() bins of the level below.
+* The summary is computed in one streaming pass over the raw buffer directory and cached in a sidecar file next
+* to the fiff file, so that reopening a recording gives the whole-recording overview instantly.
+*
+* All sample indices are relative to the first sample of the recording.
+*
+* @brief Min/max/RMS overview pyramid of a raw fiff recording
+*/
+class RawOverview
+{
+public:
+    typedef QSharedPointer<RawOverview> SPtr;            /**< Shared pointer type for RawOverview. */
+    typedef QSharedPointer<const RawOverview> ConstSPtr; /**< Const shared pointer type for RawOverview. */
+
+    //=========================================================================================================
+    /**
+    * Constructs an empty RawOverview.
+    */
+    RawOverview();
+
+    //=========================================================================================================
+    /**
+    * Returns the overview of a raw fiff file. A valid cached overview is read from the sidecar file, otherwise
+    * the overview is computed from the raw buffers and written to the sidecar file. This is thread-safe and
+    * meant to be run in a background-thread. The fiff file is opened separately, so the file used by the model
+    * is not touched.
+    *
+    * @param[in] sFileName      The raw fiff file
+    * @param[in] pCanceled      Set to a non-zero value to abort the computation
+    *
+    * @return the overview, or an empty pointer if the file could not be read or the computation was canceled
+    */
+    static SPtr compute(const QString &sFileName, const QSharedPointer<QAtomicInt> &pCanceled);
+
+    //=========================================================================================================
+    /**
+    * Returns the sidecar file names the overview of a fiff file is cached in, in the order they are tried.
+    * The first one is located next to the fiff file, the second one in the user's cache directory in case the
+    * directory of the fiff file is not writable.
+    *
+    * @param[in] sFileName      The raw fiff file
+    *
+    * @return the sidecar file names
+    */
+    static QStringList sidecarFileNames(const QString &sFileName);
+
+    //=========================================================================================================
+    /**
+    * Splits the samples [iFrom, iTo) of one channel into iNumColumns equally sized parts, i.e. pixel columns,
+    * and computes the minimum, maximum and RMS of each part from the coarsest level whose bins are not larger
+    * than a part.
+    *
+    * @param[in] iRow           The channel
+    * @param[in] iFrom          First sample
+    * @param[in] iTo            One past the last sample
+    * @param[in] iNumColumns    Number of parts
+    * @param[out] vecMin        The minimum of each part
+    * @param[out] vecMax        The maximum of each part
+    * @param[out] vecRms        The RMS of each part
+    *
+    * @return false if the channel or the range is not covered by the overview, true otherwise
+    */
+    bool envelope(qint32 iRow, qint32 iFrom, qint32 iTo, qint32 iNumColumns, QVector<double>& vecMin, QVector<double>& vecMax, QVector<double>& vecRms) const;
+
+    //=========================================================================================================
+    /**
+    * Searches the first bin at or after iFrom in which the absolute value of a channel exceeds dThreshold.
+    * Coarse bins below the threshold are skipped as a whole, so the search does not scan the whole recording.
+    * To continue the search, start again at the returned sample plus binSize().
+    *
+    * @param[in] iRow           The channel
+    * @param[in] iFrom          Sample to start the search at
+    * @param[in] dThreshold     The threshold
+    *
+    * @return the first sample of the bin but not before iFrom, or -1 if the threshold is not exceeded after iFrom
+    */
+    qint32 findNextExceeding(qint32 iRow, qint32 iFrom, double dThreshold) const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether the overview holds any bins.
+    *
+    * @return true if empty
+    */
+    inline bool isEmpty() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of channels.
+    *
+    * @return the number of channels
+    */
+    inline qint32 rows() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples per channel.
+    *
+    * @return the number of samples
+    */
+    inline qint32 samples() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of levels.
+    *
+    * @return the number of levels
+    */
+    inline qint32 numLevels() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples summarized by one bin of a level.
+    *
+    * @param[in] iLevel     The level
+    *
+    * @return the bin size [in samples]
+    */
+    inline qint32 binSize(qint32 iLevel = 0) const;
+
+private:
+    typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatrixXfR;
+
+    //=========================================================================================================
+    /**
+    * Computes the level 0 bins in one pass over the raw buffer directory and builds the coarser levels.
+    *
+    * @param[in] raw            The raw data
+    * @param[in] pCanceled      Set to a non-zero value to abort the computation
+    *
+    * @return false if the raw data could not be read or the computation was canceled
+    */
+    bool computeFromRaw(FIFFLIB::FiffRawData &raw, const QSharedPointer<QAtomicInt> &pCanceled);
+
+    //=========================================================================================================
+    /**
+    * Builds all levels above level 0.
+    */
+    void buildLevels();
+
+    //=========================================================================================================
+    /**
+    * Reads the overview from a sidecar file.
+    *
+    * @param[in] sCacheFileName The sidecar file
+    * @param[in] stamp          The stamp the cached overview has to match
+    *
+    * @return false if the file does not exist, is outdated or corrupt
+    */
+    bool readCache(const QString &sCacheFileName, const RawOverviewStamp &stamp);
+
+    //=========================================================================================================
+    /**
+    * Writes the overview to a sidecar file.
+    *
+    * @param[in] sCacheFileName The sidecar file
+    * @param[in] stamp          The stamp of the raw data
+    *
+    * @return false if the file could not be written
+    */
+    bool writeCache(const QString &sCacheFileName, const RawOverviewStamp &stamp) const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether the absolute value of a channel exceeds the threshold anywhere in a bin.
+    */
+    inline bool exceeds(qint32 iLevel, qint32 iRow, qint32 iBin, float fThreshold) const;
+
+    qint32              m_iNumRows;     /**< Number of channels. */
+    qint32              m_iNumSamples;  /**< Number of samples per channel. */
+    qint32              m_iBinSize;     /**< Number of samples per bin of level 0. */
+    qint32              m_iLevelFactor; /**< Number of bins combined to one bin of the next level. */
+
+    QVector<MatrixXfR>  m_qVecMin;      /**< Bin minima per level. */
+    QVector<MatrixXfR>  m_qVecMax;      /**< Bin maxima per level. */
+    QVector<MatrixXfR>  m_qVecRms;      /**< Bin RMS values per level. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool RawOverview::isEmpty() const
+{
+    return m_qVecMin.isEmpty();
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 RawOverview::rows() const
+{
+    return m_iNumRows;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 RawOverview::samples() const
+{
+    return m_iNumSamples;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 RawOverview::numLevels() const
+{
+    return m_qVecMin.size();
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 RawOverview::binSize(qint32 iLevel) const
+{
+    qint32 iBinSize = m_iBinSize;
+    for(qint32 i = 0; i < iLevel; ++i)
+        iBinSize *= m_iLevelFactor;
+
+    return iBinSize;
+}
+
+
+//*************************************************************************************************************
+
+inline bool RawOverview::exceeds(qint32 iLevel, qint32 iRow, qint32 iBin, float fThreshold) const
+{
+    return m_qVecMax[iLevel](iRow, iBin) > fThreshold || m_qVecMin[iLevel](iRow, iBin) < -fThreshold;
+}
+
+} // NAMESPACE
+
+#endif // RAWOVERVIEW_H
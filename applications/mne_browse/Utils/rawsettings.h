@@ -82,12 +82,17 @@
 #define MODEL_MAX_WINDOWS 3 //number of windows that are at maximum remained in m_data
 #define MODEL_NUM_FILTER_TAPS 80 //number of filter taps, required to take into account because of FFT convolution (zero padding)
 #define MODEL_MAX_NUM_FILTER_TAPS 0 //number of maximal filter taps
+#define MODEL_OVERVIEW_BIN_SIZE 512 //number of samples summarized by one bin of the finest overview level
+#define MODEL_OVERVIEW_LEVEL_FACTOR 4 //number of bins of an overview level which are combined to one bin of the next level
+#define MODEL_OVERVIEW_CHUNK_SEC 10 //minimum length of the raw buffers which are read at once while computing the overview [in seconds]
 
 //RawDelegate
 //Look
 #define DELEGATE_PLOT_HEIGHT 40 //height of a single plot (row)
 #define DELEGATE_DX 1 //each DX pixel a sample is plot -> plot resolution
 #define DELEGATE_NHLINES 6 //number of horizontal lines within a single plot (row)
+#define DELEGATE_TILE_WIDTH 512 //width of a pre-rendered tile of a channel strip [in pixels]
+#define DELEGATE_TILE_CACHE_SIZE 262144 //maximum memory used by the pre-rendered tiles [in kB]
 
 //maximum values for different channels types according to FiffChInfo
 #define DELEGATE_MAX_MEG_GRAD 1e-10 // kind=FIFFV_MEG_CH && unit=FIFF_UNIT_T_M
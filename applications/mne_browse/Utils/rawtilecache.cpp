@@ -0,0 +1,233 @@
+//=============================================================================================================
+/**
+* @file     rawtilecache.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Definition of the RawTileCache class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rawtilecache.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtConcurrent>
+#include <QPainter>
+#include <QPainterPath>
+#include <QtMath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNEBROWSE;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+bool MNEBROWSE::operator==(const RawTileKey &lhs, const RawTileKey &rhs)
+{
+    return lhs.iRow == rhs.iRow
+            && lhs.iTile == rhs.iTile
+            && lhs.iTileSamples == rhs.iTileSamples
+            && lhs.dDx == rhs.dDx
+            && lhs.dMaxValue == rhs.dMaxValue
+            && lhs.iHeight == rhs.iHeight
+            && lhs.dChannelMean == rhs.dChannelMean
+            && lhs.bSelected == rhs.bSelected
+            && lhs.iRevision == rhs.iRevision;
+}
+
+
+//*************************************************************************************************************
+
+uint MNEBROWSE::qHash(const RawTileKey &key, uint seed)
+{
+    return ::qHash(key.iRow, seed) ^ ::qHash(key.iTile << 8, seed) ^ ::qHash(key.iTileSamples << 20, seed) ^ ::qHash(key.iRevision, seed);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RawTileCache::RawTileCache(int iMaxCostKB, QObject *parent)
+: QObject(parent)
+, m_cache(iMaxCostKB)
+, m_iRevision(0)
+{
+    //Leave one core to the GUI thread
+    m_threadPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()-1));
+    m_iMaxPending = 4*m_threadPool.maxThreadCount();
+}
+
+
+//*************************************************************************************************************
+
+RawTileCache::~RawTileCache()
+{
+    m_threadPool.waitForDone();
+}
+
+
+//*************************************************************************************************************
+
+const QImage* RawTileCache::tile(const RawTileKey &key) const
+{
+    return m_cache.object(key);
+}
+
+
+//*************************************************************************************************************
+
+bool RawTileCache::requestTile(const RawTileJob &job)
+{
+    if(job.key.iRevision != m_iRevision || contains(job.key) || m_pendingKeys.size() >= m_iMaxPending)
+        return false;
+
+    m_pendingKeys.insert(job.key);
+
+    QFutureWatcher<RawTileResult>* pWatcher = new QFutureWatcher<RawTileResult>(this);
+    connect(pWatcher, &QFutureWatcher<RawTileResult>::finished,
+            this, &RawTileCache::onTileRendered);
+    pWatcher->setFuture(QtConcurrent::run(&m_threadPool, &RawTileCache::renderTile, job));
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool RawTileCache::contains(const RawTileKey &key) const
+{
+    return m_cache.contains(key) || m_pendingKeys.contains(key);
+}
+
+
+//*************************************************************************************************************
+
+void RawTileCache::setRevision(quint32 iRevision)
+{
+    if(iRevision == m_iRevision)
+        return;
+
+    m_iRevision = iRevision;
+    m_cache.clear();
+}
+
+
+//*************************************************************************************************************
+
+RawTileResult RawTileCache::renderTile(const RawTileJob &job)
+{
+    const RawTileKey& key = job.key;
+
+    RawTileResult result;
+    result.key = key;
+    result.image = QImage(qCeil(key.iTileSamples*key.dDx), key.iHeight, QImage::Format_ARGB32_Premultiplied);
+    result.image.fill(Qt::transparent);
+
+    const QVector<double>& vecSamples = job.vecSamples;
+    if(vecSamples.isEmpty())
+        return result;
+
+    double dScaleY = key.iHeight/(2*key.dMaxValue);
+    double dBaseY = key.iHeight/2.0;
+    qint32 iOffset = job.iFirstSample - key.iTile*key.iTileSamples;
+
+    QPainterPath path(QPointF(iOffset*key.dDx, dBaseY - (vecSamples[0] - key.dChannelMean)*dScaleY));
+
+    if(key.dDx < 0.5) {
+        //More than two samples per pixel - draw the min/max of each pixel column instead of every sample
+        qint32 k = 1;
+        while(k < vecSamples.size()) {
+            int iColumn = qFloor((iOffset + k)*key.dDx);
+            double dMin = vecSamples[k];
+            double dMax = dMin;
+
+            for(++k; k < vecSamples.size() && qFloor((iOffset + k)*key.dDx) == iColumn; ++k) {
+                dMin = qMin(dMin, vecSamples[k]);
+                dMax = qMax(dMax, vecSamples[k]);
+            }
+
+            path.lineTo(iColumn, dBaseY - (dMin - key.dChannelMean)*dScaleY);
+            path.lineTo(iColumn, dBaseY - (dMax - key.dChannelMean)*dScaleY);
+        }
+    }
+    else {
+        for(qint32 k = 1; k < vecSamples.size(); ++k)
+            path.lineTo((iOffset + k)*key.dDx, dBaseY - (vecSamples[k] - key.dChannelMean)*dScaleY);
+    }
+
+    //QImage may be painted on outside the GUI thread
+    QPainter painter(&result.image);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+
+    QPen pen(key.bSelected ? Qt::red : Qt::black);
+    pen.setWidthF(1);
+    painter.setPen(pen);
+    painter.drawPath(path);
+
+    return result;
+}
+
+
+//*************************************************************************************************************
+
+void RawTileCache::onTileRendered()
+{
+    QFutureWatcher<RawTileResult>* pWatcher = static_cast<QFutureWatcher<RawTileResult>*>(sender());
+    RawTileResult result = pWatcher->result();
+    pWatcher->deleteLater();
+
+    m_pendingKeys.remove(result.key);
+
+    //Drop tiles which were rendered from outdated data
+    if(result.key.iRevision != m_iRevision)
+        return;
+
+    m_cache.insert(result.key, new QImage(result.image), qMax(1, result.image.byteCount()/1024));
+
+    emit tileReady();
+}
@@ -0,0 +1,206 @@
+//=============================================================================================================
+/**
+* @file     rawtilecache.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Declaration of the RawTileCache class.
+*
+*/
+
+#ifndef RAWTILECACHE_H
+#define RAWTILECACHE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QObject>
+#include <QCache>
+#include <QSet>
+#include <QImage>
+#include <QVector>
+#include <QThreadPool>
+#include <QFutureWatcher>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNEBROWSE
+//=============================================================================================================
+
+namespace MNEBROWSE
+{
+
+//=============================================================================================================
+/**
+* Everything the look of a tile depends on. Tile iTile of a channel strip holds the samples
+* [iTile*iTileSamples, (iTile+1)*iTileSamples) relative to the first sample of the fiff file.
+*/
+struct RawTileKey
+{
+    int         iRow;           /**< Channel row of the tile. */
+    qint32      iTile;          /**< Tile index within the channel strip. */
+    qint32      iTileSamples;   /**< Number of samples per tile (depends on the zoom level). */
+    double      dDx;            /**< Pixel distance between two samples. */
+    double      dMaxValue;      /**< Amplitude which is mapped to half the row height. */
+    int         iHeight;        /**< Row height in pixels. */
+    double      dChannelMean;   /**< Mean subtracted from the samples (DC removal). */
+    bool        bSelected;      /**< Whether the row is drawn as selected. */
+    quint32     iRevision;      /**< Data revision of the model the samples were taken from. */
+};
+
+bool operator==(const RawTileKey &lhs, const RawTileKey &rhs);
+
+uint qHash(const RawTileKey &key, uint seed = 0);
+
+
+//=============================================================================================================
+/**
+* Samples which are needed to render one tile. vecSamples holds the samples starting at iFirstSample, including the
+* neighbouring sample on each side so that the trace continues seamlessly into the adjacent tiles.
+*/
+struct RawTileJob
+{
+    RawTileKey          key;            /**< The tile to render. */
+    qint32              iFirstSample;   /**< Sample index (relative to the first sample of the file) of vecSamples[0]. */
+    QVector<double>     vecSamples;     /**< The samples to render. */
+};
+
+
+//=============================================================================================================
+/**
+* A rendered tile together with its key.
+*/
+struct RawTileResult
+{
+    RawTileKey          key;            /**< The tile. */
+    QImage              image;          /**< The rendered trace on a transparent background. */
+};
+
+
+//=============================================================================================================
+/**
+* The RawTileCache keeps the traces of the channel strips as off-screen QImage tiles. Missing tiles are rendered on a
+* private thread pool, so that scrolling only needs to blit already rendered tiles. The cache is bounded by memory
+* and drops the least recently used tiles first.
+*
+* @brief Background-rendered tile cache for the raw data view.
+*/
+class RawTileCache : public QObject
+{
+    Q_OBJECT
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a RawTileCache.
+    *
+    * @param[in] iMaxCostKB     Maximum memory used by the cached tiles in kB.
+    * @param[in] parent         Parent QObject.
+    */
+    explicit RawTileCache(int iMaxCostKB, QObject *parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Waits for all pending render jobs.
+    */
+    ~RawTileCache();
+
+    //=========================================================================================================
+    /**
+    * Returns the rendered tile.
+    *
+    * @param[in] key    The tile.
+    *
+    * @return the tile or NULL if it is not rendered yet. The pointer is only valid until the next request.
+    */
+    const QImage* tile(const RawTileKey &key) const;
+
+    //=========================================================================================================
+    /**
+    * Queues a tile for background rendering. Requests for tiles which are already cached or queued are ignored,
+    * as well as requests exceeding the maximum number of queued jobs.
+    *
+    * @param[in] job    The tile and its samples.
+    *
+    * @return true if the tile was queued.
+    */
+    bool requestTile(const RawTileJob &job);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the tile is cached or queued for rendering.
+    *
+    * @param[in] key    The tile.
+    */
+    bool contains(const RawTileKey &key) const;
+
+    //=========================================================================================================
+    /**
+    * Sets the current data revision. Changing the revision drops all tiles, results of jobs which were queued with
+    * an older revision are discarded.
+    *
+    * @param[in] iRevision  The data revision of the model.
+    */
+    void setRevision(quint32 iRevision);
+
+    //=========================================================================================================
+    /**
+    * Renders a tile. This is thread-safe and called from the thread pool.
+    *
+    * @param[in] job    The tile and its samples.
+    *
+    * @return the rendered tile.
+    */
+    static RawTileResult renderTile(const RawTileJob &job);
+
+signals:
+    //=========================================================================================================
+    /**
+    * Emitted whenever a new tile was rendered and inserted into the cache.
+    */
+    void tileReady();
+
+private:
+    //=========================================================================================================
+    /**
+    * Moves the result of a finished render job into the cache.
+    */
+    void onTileRendered();
+
+    QCache<RawTileKey, QImage>  m_cache;            /**< The rendered tiles, the cost of a tile is its size in kB. */
+    QSet<RawTileKey>            m_pendingKeys;      /**< Tiles which are queued or being rendered. */
+    QThreadPool                 m_threadPool;       /**< Threads the tiles are rendered with. */
+    quint32                     m_iRevision;        /**< Current data revision. */
+    int                         m_iMaxPending;      /**< Maximum number of queued render jobs. */
+};
+
+} // NAMESPACE
+
+#endif // RAWTILECACHE_H
@@ -103,6 +103,8 @@ SOURCES += \
     Windows/scalewindow.cpp \
     Windows/chinfowindow.cpp \
     Utils/datapackage.cpp \    
+    Utils/rawtilecache.cpp \
+    Utils/rawoverview.cpp \
     Windows/noisereductionwindow.cpp
 
 HEADERS += \
@@ -131,6 +133,8 @@ HEADERS += \
     Windows/chinfowindow.h \
     Windows/noisereductionwindow.h \
     Utils/datapackage.h \
+    Utils/rawtilecache.h \
+    Utils/rawoverview.h \
 
 FORMS += \
     Windows/eventwindowdock.ui \
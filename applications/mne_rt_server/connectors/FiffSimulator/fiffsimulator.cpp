@@ -98,6 +98,8 @@ const QString FiffSimulator::Commands::BUFSIZE      = "bufsize";
 const QString FiffSimulator::Commands::GETBUFSIZE   = "getbufsize";
 const QString FiffSimulator::Commands::ACCEL        = "accel";
 const QString FiffSimulator::Commands::GETACCEL     = "getaccel";
+const QString FiffSimulator::Commands::PACE         = "pace";
+const QString FiffSimulator::Commands::GETPACE      = "getpace";
 const QString FiffSimulator::Commands::SIMFILE      = "simfile";
 
 
@@ -112,6 +114,7 @@ FiffSimulator::FiffSimulator()
 , m_uiBufferSampleSize(100)//(4)
 , m_AccelerationFactor(1.0)
 , m_TrueSamplingRate(0.0)
+, m_PaceFactor(1.0)
 , m_pRawMatrixBuffer(NULL)
 , m_bIsRunning(false)
 {
@@ -247,6 +250,59 @@ void FiffSimulator::comGetAccel(Command p_command)
 
 //*************************************************************************************************************
 
+void FiffSimulator::comPace(Command p_command)
+{
+    float t_fPace = p_command.pValues()[0].toFloat();
+
+    if(t_fPace >= 0)
+    {
+        //The pause between two buffers is evaluated when the simulator thread starts
+        bool t_bWasRunning = m_bIsRunning;
+
+        if(m_bIsRunning)
+        {
+            m_pFiffProducer->stop();
+            this->stop();
+        }
+
+        m_PaceFactor = t_fPace;
+
+        if(t_bWasRunning)
+            this->start();
+
+        QString str = t_fPace > 0 ? QString("\tSet replay speed to %1\r\n\n").arg(t_fPace, 0, 'f', 3) : QString("\tSet replay speed to unthrottled\r\n\n");
+
+        m_commandManager[Commands::PACE].reply(str);
+    }
+    else
+        m_commandManager[Commands::PACE].reply("Replay speed not set\r\n");
+}
+
+//*************************************************************************************************************
+
+void FiffSimulator::comGetPace(Command p_command)
+{
+    bool t_bCommandIsJson = p_command.isJson();
+    if(t_bCommandIsJson)
+    {
+        //
+        //create JSON help object
+        //
+        QJsonObject t_qJsonObjectRoot;
+        t_qJsonObjectRoot.insert(Commands::PACE, QJsonValue((double)m_PaceFactor));
+        QJsonDocument p_qJsonDocument(t_qJsonObjectRoot);
+
+        m_commandManager[Commands::GETPACE].reply(p_qJsonDocument.toJson());
+    }
+    else
+    {
+        QString str = QString("\t%1\r\n\n").arg(m_PaceFactor, 0, 'f', 3);
+        m_commandManager[Commands::GETPACE].reply(str);
+    }
+}
+
+//*************************************************************************************************************
+
 void FiffSimulator::comSimfile(Command p_command)
 {
     //
@@ -294,6 +350,8 @@ void FiffSimulator::connectCommandManager()
     QObject::connect(&m_commandManager[Commands::GETBUFSIZE], &Command::executed, this, &FiffSimulator::comGetBufsize);
     QObject::connect(&m_commandManager[Commands::ACCEL], &Command::executed, this, &FiffSimulator::comAccel);
     QObject::connect(&m_commandManager[Commands::GETACCEL], &Command::executed, this, &FiffSimulator::comGetAccel);
+    QObject::connect(&m_commandManager[Commands::PACE], &Command::executed, this, &FiffSimulator::comPace);
+    QObject::connect(&m_commandManager[Commands::GETPACE], &Command::executed, this, &FiffSimulator::comGetPace);
     QObject::connect(&m_commandManager[Commands::SIMFILE], &Command::executed, this, &FiffSimulator::comSimfile);
 }
 
@@ -525,6 +583,12 @@ void FiffSimulator::run()
 
     quint32 uiSamplePeriod = (unsigned int) ((t_fBuffSampleSize/t_fSamplingFrequency)*1000000.0f);
 
+    //The replay speed shortens the pause without changing the announced sampling rate, 0 means no pause at all
+    if(m_PaceFactor > 0)
+        uiSamplePeriod = (unsigned int) (uiSamplePeriod / m_PaceFactor);
+    else
+        uiSamplePeriod = 0;
+
 //    quint32 count = 0;
 
     while(m_bIsRunning)
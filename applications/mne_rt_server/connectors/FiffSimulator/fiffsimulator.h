@@ -110,6 +110,8 @@ public:
         static const QString GETBUFSIZE;
         static const QString ACCEL;
         static const QString GETACCEL;
+        static const QString PACE;
+        static const QString GETPACE;
         static const QString SIMFILE;
     };
 
@@ -175,6 +177,23 @@ private:
     */
     void comGetAccel(Command p_command);
 
+    //=========================================================================================================
+    /**
+    * Sets the replay speed as multiple of real time, 0 replays as fast as possible. In contrast to the
+    * acceleration factor the announced sampling rate stays the true sampling rate of the file.
+    *
+    * @param[in] p_command  The replay speed command.
+    */
+    void comPace(Command p_command);
+
+    //=========================================================================================================
+    /**
+    * Returns the replay speed
+    *
+    * @param[in] p_command  The replay speed command.
+    */
+    void comGetPace(Command p_command);
+
     //=========================================================================================================
     /**
     * Sets the fiff simulation file
@@ -201,6 +220,7 @@ private:
     quint32         m_uiBufferSampleSize;   /**< Sample size of the buffer */
     float           m_AccelerationFactor;   /**< Acceleration factor to simulate different sampling rates. */
     float           m_TrueSamplingRate;     /**< The true sampling rate of the fif file. */
+    float           m_PaceFactor;           /**< Replay speed as multiple of real time, 0 if unthrottled. Does not change the sampling rate. */
 
     RawMatrixBuffer* m_pRawMatrixBuffer;    /**< The Circular Raw Matrix Buffer. */
 
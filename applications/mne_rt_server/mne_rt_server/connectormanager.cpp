@@ -161,6 +161,8 @@ void ConnectorManager::comSelcon(Command p_command)
 
 void ConnectorManager::comStart(Command p_command)//comMeas
 {
+    //The info may have changed since the last measurement (e.g. buffer size or acceleration)
+    m_pFiffStreamServer->resetSharedMemoryInfo();
     getActiveConnector()->start();
     qobject_cast<MNERTServer*>(this->parent())->getCommandManager()["start"].reply("Starting active connector.\n");
 
@@ -185,6 +187,8 @@ void ConnectorManager::connectActiveConnector()
 {
     IConnector* t_activeConnector = ConnectorManager::getActiveConnector();
 
+    m_pFiffStreamServer->resetSharedMemoryInfo();
+
     if(t_activeConnector)
     {
         // use signal slots instead of call backs
@@ -43,6 +43,8 @@
 
 #include "mne_rt_server.h"
 
+#include <fiff/fiff_constants.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -69,6 +71,8 @@ using namespace FIFFLIB;
 FiffStreamServer::FiffStreamServer(QObject *parent)
 : QTcpServer(parent)
 , m_iNextClientId(0)
+, m_bShmInfoRequested(false)
+, m_iShmInfoRows(-1)
 {
 
 }
@@ -88,11 +92,11 @@ void FiffStreamServer::comClist(Command p_command)
 {
     //ToDo JSON
     QString t_sOutput("");
-    t_sOutput.append("\tID\tAlias\r\n");
+    t_sOutput.append("\tID\tAlias\tDropped\r\n");
     QMap<qint32, FiffStreamThread*>::iterator i;
     for (i = this->m_qClientList.begin(); i != this->m_qClientList.end(); ++i)
     {
-        QString str = QString("\t%1\t%2\r\n").arg(i.key()).arg(i.value()->getAlias());
+        QString str = QString("\t%1\t%2\t%3\r\n").arg(i.key()).arg(i.value()->getAlias()).arg(i.value()->getNumDroppedBuffers());
         t_sOutput.append(str);
     }
     t_sOutput.append("\n");
@@ -173,6 +177,41 @@ void FiffStreamServer::comStopAll(Command p_command)
 }
 
 
+//*************************************************************************************************************
+
+void FiffStreamServer::comProfile(Command p_command)
+{
+    qint32 t_id = -1;
+    QString t_sOutput("");
+    QString t_sAlias(p_command.pValues()[0].toString());
+    t_sOutput.append(parseToId(t_sAlias,t_id));
+
+    if(t_id != -1)
+    {
+        RtStreamProfile t_profile;
+        QString t_sError;
+        if(t_profile.fromString(p_command.pValues()[1].toString(), t_sError))
+        {
+            if(t_profile.isDefault())
+                m_qMapProfiles.remove(t_id);
+            else
+                m_qMapProfiles.insert(t_id, t_profile);
+
+            emit setProfileFiffStreamClient(t_id, t_profile.toString());
+
+            QString str = QString("\tFiffStreamClient (ID: %1) stream profile: %2\r\n\tre-request the measurement info to get the matching channels and sampling frequency\r\n\n").arg(t_id).arg(t_profile.toString());
+            t_sOutput.append(str);
+        }
+        else
+        {
+            QString str = QString("\terror: %1\r\n\n").arg(t_sError);
+            t_sOutput.append(str);
+        }
+    }
+    qobject_cast<MNERTServer*>(this->parent())->getCommandManager()["profile"].reply(t_sOutput);
+}
+
+
 //*************************************************************************************************************
 
 void FiffStreamServer::connectCommands()
@@ -185,6 +224,7 @@ void FiffStreamServer::connectCommands()
     QObject::connect(&t_pMNERTServer->getCommandManager()["start"], &Command::executed, this, &FiffStreamServer::comStart);
     QObject::connect(&t_pMNERTServer->getCommandManager()["stop"], &Command::executed, this, &FiffStreamServer::comStop);
     QObject::connect(&t_pMNERTServer->getCommandManager()["stop-all"], &Command::executed, this, &FiffStreamServer::comStopAll);
+    QObject::connect(&t_pMNERTServer->getCommandManager()["profile"], &Command::executed, this, &FiffStreamServer::comProfile);
 
 //    t_pMNERTServer->getCommandManager().connectSlot(QString("clist"), this, &FiffStreamServer::comClist);
 //    t_pMNERTServer->getCommandManager().connectSlot(QString("measinfo"), this, &FiffStreamServer::comMeasinfo);
@@ -305,6 +345,32 @@ void FiffStreamServer::connectCommands()
 //}
 
 
+//*************************************************************************************************************
+
+bool FiffStreamServer::createSharedMemory(const QString& p_sKey)
+{
+    m_pShmRing = RtShmRing::SPtr(new RtShmRing(p_sKey));
+    resetSharedMemoryInfo();
+
+    if(!m_pShmRing->create())
+    {
+        m_pShmRing.clear();
+        return false;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamServer::resetSharedMemoryInfo()
+{
+    m_bShmInfoRequested = false;
+    m_iShmInfoRows = -1;
+}
+
+
 //*************************************************************************************************************
 
 QByteArray FiffStreamServer::parseToId(QString& p_sRawId, qint32& p_iParsedId)
@@ -368,15 +434,55 @@ QByteArray FiffStreamServer::parseToId(QString& p_sRawId, qint32& p_iParsedId)
 
 void FiffStreamServer::forwardMeasInfo(qint32 ID, const FiffInfo& p_fiffInfo)
 {
-    emit remitMeasInfo(ID, p_fiffInfo);
+    QByteArray t_packet;
+    FiffStream t_FiffStreamOut(&t_packet, QIODevice::WriteOnly);
+    p_fiffInfo.writeToStream(&t_FiffStreamOut);
+
+    if(m_pShmRing)
+        m_pShmRing->writeInfo(t_packet);
+
+    if(m_qMapProfiles.contains(ID))
+    {
+        //The profiled client gets the info of the channels and the sampling frequency it receives
+        QByteArray t_profiledPacket;
+        FiffStream t_FiffStreamProfiled(&t_profiledPacket, QIODevice::WriteOnly);
+        RtStreamCodec::adaptInfo(p_fiffInfo, m_qMapProfiles[ID]).writeToStream(&t_FiffStreamProfiled);
+
+        emit remitMeasInfo(ID, t_profiledPacket);
+        return;
+    }
+
+    emit remitMeasInfo(ID, t_packet);
 }
 
 
 //*************************************************************************************************************
-//ToDo increase preformance --> try inline
+
 void FiffStreamServer::forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData)
 {
-    emit remitRawBuffer(m_pMatRawData);
+    if(m_pShmRing)
+    {
+        //Local clients need the measurement info of the running connector, request it again if the channel
+        //count changed
+        if(!m_bShmInfoRequested || m_iShmInfoRows != m_pMatRawData->rows())
+        {
+            m_bShmInfoRequested = true;
+            m_iShmInfoRows = m_pMatRawData->rows();
+            emit requestMeasInfo(-1);
+        }
+
+        m_pShmRing->writeRawBuffer(*m_pMatRawData);
+    }
+
+    if(m_qClientList.isEmpty())
+        return;
+
+    //Serialize once - the sessions only hold references to the implicitly shared packet
+    QByteArray t_packet;
+    FiffStream t_FiffStreamOut(&t_packet, QIODevice::WriteOnly);
+    t_FiffStreamOut.write_float(FIFF_DATA_BUFFER, m_pMatRawData->data(), m_pMatRawData->rows()*m_pMatRawData->cols());
+
+    emit remitRawBuffer(t_packet, m_pMatRawData);
 }
 
 
@@ -43,6 +43,8 @@
 
 #include <fiff/fiff_info.h>
 #include <rtCommand/commandmanager.h>
+#include <rtClient/rtshmring.h>
+#include <rtClient/rtstreamcodec.h>
 
 
 //*************************************************************************************************************
@@ -69,6 +71,7 @@ namespace RTSERVER
 
 using namespace FIFFLIB;
 using namespace RTCOMMANDLIB;
+using namespace RTCLIENTLIB;
 
 
 //*************************************************************************************************************
@@ -112,6 +115,25 @@ public:
     */
     void connectCommands();
 
+    //=========================================================================================================
+    /**
+    * Creates the shared memory ring for local clients. Every raw buffer is published to the ring in addition
+    * to the socket clients.
+    *
+    * @param[in] p_sKey     The key of the shared memory ring
+    *
+    * @return true if the ring was created
+    */
+    bool createSharedMemory(const QString& p_sKey = QString(RTSHM_DEFAULT_KEY));
+
+    //=========================================================================================================
+    /**
+    * Requests the measurement info for the shared memory ring again with the next raw buffer. Has to be called
+    * whenever the measurement info of the active connector may have changed, e.g. when the connector is switched
+    * or started.
+    */
+    void resetSharedMemoryInfo();
+
 //    virtual bool parseCommand(QStringList& p_sListCommand, QByteArray& p_blockOutputInfo);
 
 
@@ -122,7 +144,21 @@ public:
 //    void clearClients();
 
 //public slots: --> in Qt 5 not anymore declared as slot
+    //=========================================================================================================
+    /**
+    * Serializes the measurement info once and remits the packet to the client sessions.
+    *
+    * @param[in] ID             The id of the client which requested the measurement info
+    * @param[in] p_fiffInfo     The measurement info
+    */
     void forwardMeasInfo(qint32 ID, const FiffInfo& p_fiffInfo);
+
+    //=========================================================================================================
+    /**
+    * Serializes the raw buffer once and remits the packet to all client sessions, which share the packet data.
+    *
+    * @param[in] m_pMatRawData  The raw buffer
+    */
     void forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData);
 
 signals:
@@ -131,8 +167,10 @@ signals:
     void startMeasFiffStreamClient(qint32 ID);
     void stopMeasFiffStreamClient(qint32 ID);
 
-    void remitMeasInfo(qint32 ID, const FIFFLIB::FiffInfo& p_fiffInfo);
-    void remitRawBuffer(QSharedPointer<Eigen::MatrixXf>);
+    void remitMeasInfo(qint32 ID, const QByteArray& p_measInfoPacket);
+    void remitRawBuffer(const QByteArray& p_rawBufferPacket, QSharedPointer<Eigen::MatrixXf> p_pMatRawData);
+
+    void setProfileFiffStreamClient(qint32 ID, const QString& p_sProfile);
 
     void closeFiffStreamServer();
 
@@ -181,10 +219,23 @@ private:
     */
     void comStopAll(Command p_command);
 
+    //=========================================================================================================
+    /**
+    * Sets the stream profile of a fiff data client: channel subset, decimation, encoding and coalescing
+    *
+    * @param[in] p_command  The profile command.
+    */
+    void comProfile(Command p_command);
+
     QByteArray parseToId(QString& p_sRawId, qint32& p_iParsedId);
 
     QMap<qint32, FiffStreamThread*> m_qClientList;
     qint32                          m_iNextClientId;
+    QMap<qint32, RtStreamProfile>   m_qMapProfiles;         /**< Stream profiles of the clients which do not get the full stream. */
+
+    RtShmRing::SPtr                 m_pShmRing;             /**< Shared memory ring for local clients. */
+    bool                            m_bShmInfoRequested;    /**< Whether the measurement info was requested for the shared memory ring. */
+    qint32                          m_iShmInfoRows;         /**< Number of channels of the raw buffers when the info was requested. */
 
 };
 
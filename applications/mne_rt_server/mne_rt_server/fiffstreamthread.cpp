@@ -82,8 +82,14 @@ FiffStreamThread::FiffStreamThread(qint32 id, int socketDescriptor, QObject *par
 , m_iDataClientId(id)
 , m_sDataClientAlias(QString(""))
 , m_iSocketDescriptor(socketDescriptor)
+, m_pTcpSocket(Q_NULLPTR)
+, m_iNumQueuedBuffers(0)
+, m_iMaxQueuedBuffers(32)
+, m_iNumDroppedBuffers(0)
+, m_iMaxSocketBytes(1048576)
+, m_queuePolicy(DropOldest)
+, m_bHasProfile(false)
 , m_bIsSendingRawBuffer(false)
-, m_bIsRunning(false)
 {
 }
 
@@ -95,9 +101,12 @@ FiffStreamThread::~FiffStreamThread()
     //Remove from client list
     FiffStreamServer* t_pFiffStreamServer = qobject_cast<FiffStreamServer*>(this->parent());
     if(t_pFiffStreamServer)
+    {
         t_pFiffStreamServer->m_qClientList.remove(m_iDataClientId);
+        t_pFiffStreamServer->m_qMapProfiles.remove(m_iDataClientId);
+    }
 
-    m_bIsRunning = false;
+    QThread::quit();
     QThread::wait();
 }
 
@@ -110,12 +119,14 @@ void FiffStreamThread::startMeas(qint32 ID)
     {
         qDebug() << "Activate raw buffer sending.";
 
-        m_qMutex.lock();
         // ToDo send start meas
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+        QByteArray t_packet;
+        FiffStream t_FiffStreamOut(&t_packet, QIODevice::WriteOnly);
         t_FiffStreamOut.start_block(FIFFB_RAW_DATA);
+        enqueue(t_packet, true);
+
+        m_streamCodec.reset();
         m_bIsSendingRawBuffer = true;
-        m_qMutex.unlock();
     }
 }
 
@@ -129,11 +140,12 @@ void FiffStreamThread::stopMeas(qint32 ID)
     {
         qDebug() << "stop raw buffer sending.";
 
-        m_qMutex.lock();
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+        QByteArray t_packet;
+        FiffStream t_FiffStreamOut(&t_packet, QIODevice::WriteOnly);
         t_FiffStreamOut.end_block(FIFFB_RAW_DATA);
+        enqueue(t_packet, true);
+
         m_bIsSendingRawBuffer = false;
-        m_qMutex.unlock();
     }
 }
 
@@ -164,6 +176,13 @@ void FiffStreamThread::parseCommand(FiffTag::SPtr p_pTag)
             printf("FiffStreamClient (ID %d): send client ID %d\r\n\n", m_iDataClientId, m_iDataClientId);
             writeClientId();
         }
+        else if(t_iCmd == MNE_RT_SET_CLIENT_QUEUE)
+        {
+            //
+            // Set Send Queue
+            //
+            setQueueSettings(QString(p_pTag->mid(4, p_pTag->size()-4)));
+        }
         else
         {
             printf("FiffStreamClient (ID %d): unknown command\r\n\n", m_iDataClientId);
@@ -178,137 +197,196 @@ void FiffStreamThread::parseCommand(FiffTag::SPtr p_pTag)
 
 //*************************************************************************************************************
 
-void FiffStreamThread::sendRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData)
+void FiffStreamThread::setQueueSettings(const QString& p_sSettings)
 {
-    if(m_bIsSendingRawBuffer)
-    {
-//        qDebug() << "Send RawBuffer to client";
+    QStringList t_sListSettings = p_sSettings.split(" ", QString::SkipEmptyParts);
 
-        m_qMutex.lock();
+    bool t_bIsInt = false;
+    qint32 t_iMaxBuffers = t_sListSettings.size() > 0 ? t_sListSettings[0].toInt(&t_bIsInt) : 0;
 
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
-        t_FiffStreamOut.write_float(FIFF_DATA_BUFFER,m_pMatRawData->data(),m_pMatRawData->rows()*m_pMatRawData->cols());
+    if(!t_bIsInt || t_iMaxBuffers < 1)
+    {
+        printf("FiffStreamClient (ID %d): invalid queue settings '%s'\r\n\n", m_iDataClientId, p_sSettings.toUtf8().constData());
+        return;
+    }
 
-        m_qMutex.unlock();
+    m_iMaxQueuedBuffers = t_iMaxBuffers;
 
+    if(t_sListSettings.size() > 1)
+    {
+        if(t_sListSettings[1].compare("drop-newest", Qt::CaseInsensitive) == 0)
+            m_queuePolicy = DropNewest;
+        else if(t_sListSettings[1].compare("disconnect", Qt::CaseInsensitive) == 0)
+            m_queuePolicy = Disconnect;
+        else
+            m_queuePolicy = DropOldest;
     }
-//    else
-//    {
-//        qDebug() << "Send RawBuffer is not activated";
-//    }
+
+    printf("FiffStreamClient (ID %d): send queue = %d raw buffers, policy %d\r\n\n", m_iDataClientId, m_iMaxQueuedBuffers, m_queuePolicy);
 }
 
 
 //*************************************************************************************************************
 
-//void FiffStreamThread::sendData(QTcpSocket& p_qTcpSocket)
-//{
-//    if(p_qTcpSocket.state() != QAbstractSocket::UnconnectedState && m_bIsRunning)
-//    {
-//        m_qMutex.lock();
-//        qint32 t_iBlockSize = m_qSendBlock.size();
-//        if(t_iBlockSize > 0)
-//        {
-////            qDebug() << "data available" << t_iBlockSize;
-//            qint32 t_iBytesWritten = p_qTcpSocket.write(m_qSendBlock);
-//            qDebug()<<"[Block to write]"<<t_iBlockSize<<"[bytes has been Written]"<<t_iBytesWritten;
-//            p_qTcpSocket.waitForBytesWritten();
-//        }
-//        m_qMutex.unlock();
-//    }
-//}
+void FiffStreamThread::sendRawBuffer(const QByteArray& p_rawBufferPacket, QSharedPointer<Eigen::MatrixXf> p_pMatRawData)
+{
+    if(!m_bIsSendingRawBuffer)
+        return;
+
+    if(!m_bHasProfile)
+    {
+        enqueue(p_rawBufferPacket);
+        return;
+    }
+
+    //Profiled clients are encoded within their own thread
+    QByteArray t_packet;
+    if(m_streamCodec.encode(*p_pMatRawData, t_packet))
+        enqueue(t_packet);
+}
 
 
 //*************************************************************************************************************
 
-void FiffStreamThread::sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo)
+void FiffStreamThread::setProfile(qint32 ID, const QString& p_sProfile)
 {
-    if(ID == m_iDataClientId)
+    if(ID != m_iDataClientId)
+        return;
+
+    RtStreamProfile t_profile;
+    QString t_sError;
+    if(t_profile.fromString(p_sProfile, t_sError))
     {
-        m_qMutex.lock();
+        m_streamCodec.setProfile(t_profile);
+        m_bHasProfile = !t_profile.isDefault();
+    }
+}
 
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
 
-//        qint32 init_info[2];
-//        init_info[0] = FIFF_MNE_RT_CLIENT_ID;
-//        init_info[1] = m_iDataClientId;
+//*************************************************************************************************************
 
-//        t_FiffStreamOut.start_block(FIFFB_MNE_RT_MEAS_INFO);
+void FiffStreamThread::sendMeasurementInfo(qint32 ID, const QByteArray& p_measInfoPacket)
+{
+    if(ID == m_iDataClientId)
+        enqueue(p_measInfoPacket, true);
+}
 
-//FiffStream::start_writing_raw
 
-        p_fiffInfo.writeToStream(&t_FiffStreamOut);
-        m_qMutex.unlock();
+//*************************************************************************************************************
 
-//        qDebug() << "MeasInfo Blocksize: " << m_qSendBlock.size();
-    }
+void FiffStreamThread::writeClientId()
+{
+    QByteArray t_packet;
+    FiffStream t_FiffStreamOut(&t_packet, QIODevice::WriteOnly);
+    t_FiffStreamOut.write_int(FIFF_MNE_RT_CLIENT_ID, &m_iDataClientId);
+
+    enqueue(t_packet, true);
 }
 
 
 //*************************************************************************************************************
 
-void FiffStreamThread::writeClientId()
+void FiffStreamThread::enqueue(const QByteArray& p_packet, bool p_bIsControl)
 {
-    FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+    if(!p_bIsControl && m_iNumQueuedBuffers >= m_iMaxQueuedBuffers)
+    {
+        switch(m_queuePolicy)
+        {
+            case DropNewest:
+                ++m_iNumDroppedBuffers;
+                return;
+            case Disconnect:
+                printf("FiffStreamClient (ID %d): send queue overflow, disconnecting\r\n\n", m_iDataClientId);
+                if(m_pTcpSocket)
+                    m_pTcpSocket->abort();
+                return;
+            default:
+                //Drop the oldest raw buffer, control packets keep their position
+                for(qint32 i = 0; i < m_qSendQueue.size(); ++i)
+                {
+                    if(!m_qSendQueueIsControl[i])
+                    {
+                        m_qSendQueue.removeAt(i);
+                        m_qSendQueueIsControl.removeAt(i);
+                        --m_iNumQueuedBuffers;
+                        ++m_iNumDroppedBuffers;
+                        break;
+                    }
+                }
+        }
+    }
 
-    t_FiffStreamOut.write_int(FIFF_MNE_RT_CLIENT_ID, &m_iDataClientId);
+    //The packet data is shared with all other clients, nothing is copied here
+    m_qSendQueue.enqueue(p_packet);
+    m_qSendQueueIsControl.enqueue(p_bIsControl);
+    if(!p_bIsControl)
+        ++m_iNumQueuedBuffers;
+
+    flushQueue();
 }
 
 
 //*************************************************************************************************************
 
-//void FiffStreamThread::readProc(QTcpSocket& p_qTcpSocket)
-//{
-//    FiffStream t_FiffStreamIn(&p_qTcpSocket);
-
-//    //
-//    // Read: Wait 10ms for incomming tag header, read and continue
-//    //
-//    p_qTcpSocket.waitForReadyRead(10);
-
-//    if (p_qTcpSocket.bytesAvailable() >= (int)sizeof(qint32)*4)
-//    {
-//        qDebug() << "goes to read bytes " ;
-//        FiffTag::SPtr t_pTag;
-//        FiffTag::read_tag_info(&t_FiffStreamIn, t_pTag, false);
-
-//        //
-//        // wait until tag size data are available and read the data
-//        //
-//        while (p_qTcpSocket.bytesAvailable() < t_pTag->size())
-//        {
-//            p_qTcpSocket.waitForReadyRead(10);
-//        }
-//        FiffTag::read_tag_data(&t_FiffStreamIn, t_pTag);
-
-//        //
-//        // Parse the tag
-//        //
-//        if(t_pTag->kind == FIFF_MNE_RT_COMMAND)
-//        {
-//            parseCommand(t_pTag);
-//        }
-//    }
-//}
+void FiffStreamThread::flushQueue()
+{
+    if(!m_pTcpSocket || m_pTcpSocket->state() != QAbstractSocket::ConnectedState)
+        return;
+
+    while(!m_qSendQueue.isEmpty() && m_pTcpSocket->bytesToWrite() < m_iMaxSocketBytes)
+    {
+        m_pTcpSocket->write(m_qSendQueue.dequeue());
+        if(!m_qSendQueueIsControl.dequeue())
+            --m_iNumQueuedBuffers;
+    }
+}
 
 
 //*************************************************************************************************************
 
-void FiffStreamThread::run()
+void FiffStreamThread::readCommands()
 {
-    m_bIsRunning = true;
+    FiffStream t_FiffStreamIn(m_pTcpSocket);
 
-    FiffStreamServer* t_pParentServer = qobject_cast<FiffStreamServer*>(this->parent());
+    forever
+    {
+        //
+        // Read the tag header as soon as it is available
+        //
+        if(!m_pPendingTag)
+        {
+            if(m_pTcpSocket->bytesAvailable() < (int)sizeof(qint32)*4)
+                return;
+
+            FiffTag::read_tag_info(&t_FiffStreamIn, m_pPendingTag, false);
+        }
+
+        //
+        // The tag data may arrive with a later readyRead
+        //
+        if(m_pTcpSocket->bytesAvailable() < m_pPendingTag->size())
+            return;
+
+        FiffTag::read_tag_data(&t_FiffStreamIn, m_pPendingTag);
+
+        //
+        // Parse the tag
+        //
+        FiffTag::SPtr t_pTag = m_pPendingTag;
+        m_pPendingTag.clear();
+
+        if(t_pTag->kind == FIFF_MNE_RT_COMMAND)
+        {
+            parseCommand(t_pTag);
+        }
+    }
+}
 
-    connect(t_pParentServer, &FiffStreamServer::remitMeasInfo,
-            this, &FiffStreamThread::sendMeasurementInfo);
-    connect(t_pParentServer, &FiffStreamServer::remitRawBuffer,
-            this, &FiffStreamThread::sendRawBuffer);
-    connect(t_pParentServer, &FiffStreamServer::startMeasFiffStreamClient,
-            this, &FiffStreamThread::startMeas);
-    connect(t_pParentServer, &FiffStreamServer::stopMeasFiffStreamClient,
-            this, &FiffStreamThread::stopMeas);
 
+//*************************************************************************************************************
+
+void FiffStreamThread::run()
+{
     QTcpSocket t_qTcpSocket;
     if (!t_qTcpSocket.setSocketDescriptor(m_iSocketDescriptor)) {
         emit error(t_qTcpSocket.error());
@@ -322,64 +400,37 @@ void FiffStreamThread::run()
                t_qTcpSocket.peerPort());
     }
 
-    FiffStream t_FiffStreamIn(&t_qTcpSocket);
+    m_pTcpSocket = &t_qTcpSocket;
 
-//    int i = 0;
-    while(t_qTcpSocket.state() != QAbstractSocket::UnconnectedState && m_bIsRunning)
-    {
-        //
-        // Write available data
-        //
-        m_qMutex.lock();
-        qint32 t_iBlockSize = m_qSendBlock.size();
-//        qDebug() << "data available" << t_iBlockSize;
-        if(t_iBlockSize > 0)
-        {
-            qint32 t_iBytesWritten = t_qTcpSocket.write(m_qSendBlock);
-//            qDebug() << ++i<< "[wrote bytes] " << t_iBytesWritten;
-            t_qTcpSocket.waitForBytesWritten();
-            if(t_iBytesWritten == t_iBlockSize)
-            {
-                m_qSendBlock.clear();
-            }
-            else
-            {
-                //we have to store bytes which were not written to the socket, due to writing limit
-                //m_qSendBlock = m_qSendBlock.mid(t_iBytesWritten, t_iBlockSize-t_iBytesWritten);
-                m_qSendBlock.remove(0,t_iBytesWritten); //higher performance then mid
-            }
-        }
-        m_qMutex.unlock();
+    //
+    // The socket is the context of all connections, so that everything is executed within the event loop of this thread
+    //
+    FiffStreamServer* t_pParentServer = qobject_cast<FiffStreamServer*>(this->parent());
 
-        //
-        // Read: Wait 10ms for incomming tag header, read and continue
-        //
-        t_qTcpSocket.waitForReadyRead(10);
+    connect(t_pParentServer, &FiffStreamServer::remitMeasInfo,
+            &t_qTcpSocket, [this](qint32 ID, const QByteArray& p_measInfoPacket) { sendMeasurementInfo(ID, p_measInfoPacket); });
+    connect(t_pParentServer, &FiffStreamServer::remitRawBuffer,
+            &t_qTcpSocket, [this](const QByteArray& p_rawBufferPacket, QSharedPointer<Eigen::MatrixXf> p_pMatRawData) { sendRawBuffer(p_rawBufferPacket, p_pMatRawData); });
+    connect(t_pParentServer, &FiffStreamServer::setProfileFiffStreamClient,
+            &t_qTcpSocket, [this](qint32 ID, const QString& p_sProfile) { setProfile(ID, p_sProfile); });
+    connect(t_pParentServer, &FiffStreamServer::startMeasFiffStreamClient,
+            &t_qTcpSocket, [this](qint32 ID) { startMeas(ID); });
+    connect(t_pParentServer, &FiffStreamServer::stopMeasFiffStreamClient,
+            &t_qTcpSocket, [this](qint32 ID) { stopMeas(ID); });
 
-        if (t_qTcpSocket.bytesAvailable() >= (int)sizeof(qint32)*4)
-        {
-//            qDebug() << "goes to read bytes " ;
-            FiffTag::SPtr t_pTag;
-            FiffTag::read_tag_info(&t_FiffStreamIn, t_pTag, false);
+    connect(&t_qTcpSocket, &QTcpSocket::readyRead,
+            &t_qTcpSocket, [this]() { readCommands(); });
+    connect(&t_qTcpSocket, &QTcpSocket::bytesWritten,
+            &t_qTcpSocket, [this]() { flushQueue(); });
+    connect(&t_qTcpSocket, &QTcpSocket::disconnected,
+            &t_qTcpSocket, [this]() { quit(); });
 
-            //
-            // wait until tag size data are available and read the data
-            //
-            while (t_qTcpSocket.bytesAvailable() < t_pTag->size())
-            {
-                t_qTcpSocket.waitForReadyRead(10);
-            }
-            FiffTag::read_tag_data(&t_FiffStreamIn, t_pTag);
+    //Commands may have arrived before the connections were made
+    readCommands();
 
-            //
-            // Parse the tag
-            //
-            if(t_pTag->kind == FIFF_MNE_RT_COMMAND)
-            {
-                parseCommand(t_pTag);
-            }
-        }
-    }
+    exec();
+
+    m_pTcpSocket = Q_NULLPTR;
 
     t_qTcpSocket.disconnectFromHost();
     if(t_qTcpSocket.state() != QAbstractSocket::UnconnectedState)
@@ -43,6 +43,8 @@
 
 #include <fiff/fiff_stream.h>
 #include <fiff/fiff_info.h>
+#include <fiff/fiff_tag.h>
+#include <rtClient/rtstreamcodec.h>
 
 
 //*************************************************************************************************************
@@ -52,8 +54,8 @@
 
 #include <QThread>
 #include <QTcpSocket>
-#include <QMutex>
 #include <QSharedPointer>
+#include <QQueue>
 
 
 //*************************************************************************************************************
@@ -70,17 +72,33 @@ namespace RTSERVER
 //=============================================================================================================
 
 using namespace FIFFLIB;
+using namespace RTCLIENTLIB;
 
 
-//*************************************************************************************************************
-//=============================================================================================================
-// FORWARD DECLARATIONS
 //=============================================================================================================
-
+/**
+* One client session of the FiffStreamServer. The session runs its own event loop: incoming commands are read on
+* readyRead and the send queue is drained on bytesWritten, no polling is involved. Raw buffers arrive already
+* serialized by the FiffStreamServer, all sessions share the same implicitly shared packet. The number of queued
+* raw buffers is bounded, a slow client loses buffers according to its queue policy instead of growing the
+* server memory. Clients with a stream profile get their own encoding of the raw buffers, see RtStreamCodec.
+*
+* @brief Client session of the FiffStreamServer
+*/
 class FiffStreamThread : public QThread
 {
     Q_OBJECT
 public:
+    //=========================================================================================================
+    /**
+    * What to do with a new raw buffer when the send queue of the client is full.
+    */
+    enum QueuePolicy {
+        DropOldest,     /**< Drop the oldest queued raw buffer, the client stays close to real time (default). */
+        DropNewest,     /**< Drop the new raw buffer, the queued data stays contiguous. */
+        Disconnect      /**< Disconnect the client, for consumers which must not miss any data, e.g. recorders. */
+    };
+
     FiffStreamThread(qint32 id, int socketDescriptor, QObject *parent);
 
     ~FiffStreamThread();
@@ -91,40 +109,89 @@ public:
 
     inline QString getAlias();
 
-//    void deactivateRawBufferSending();
-
+    //=========================================================================================================
+    /**
+    * Returns the number of raw buffers which were dropped for this client because its send queue was full.
+    *
+    * @return the number of dropped raw buffers
+    */
+    inline qint32 getNumDroppedBuffers();
 
     void parseCommand(QSharedPointer<FiffTag> p_pTag);
 
     void writeClientId();
 
-//    void sendData(QTcpSocket& p_qTcpSocket);
-
 signals:
     void error(QTcpSocket::SocketError socketError);
 
 private:
-    qint32 m_iDataClientId;
-    QString m_sDataClientAlias;
+    //=========================================================================================================
+    /**
+    * Appends a packet to the send queue and applies the queue policy to raw buffer packets.
+    *
+    * @param[in] p_packet       The serialized packet
+    * @param[in] p_bIsControl   Whether the packet is a control packet (block start/end, meas info, client id),
+    *                           control packets are never dropped
+    */
+    void enqueue(const QByteArray& p_packet, bool p_bIsControl = false);
+
+    //=========================================================================================================
+    /**
+    * Moves queued packets to the socket as long as the socket holds less than m_iMaxSocketBytes unsent bytes.
+    */
+    void flushQueue();
+
+    //=========================================================================================================
+    /**
+    * Reads and parses all complete command tags available at the socket.
+    */
+    void readCommands();
+
+    //=========================================================================================================
+    /**
+    * Sets the queue size and policy, the settings are given as "<max buffers> <drop-oldest|drop-newest|disconnect>".
+    *
+    * @param[in] p_sSettings    The queue settings
+    */
+    void setQueueSettings(const QString& p_sSettings);
 
-    int m_iSocketDescriptor;
+    void startMeas(qint32 ID);
+
+    void stopMeas(qint32 ID);
 
-    QMutex m_qMutex;
-    QByteArray m_qSendBlock;
+    void sendMeasurementInfo(qint32 ID, const QByteArray& p_measInfoPacket);
 
-    bool m_bIsSendingRawBuffer;
+    void sendRawBuffer(const QByteArray& p_rawBufferPacket, QSharedPointer<Eigen::MatrixXf> p_pMatRawData);
 
-    bool m_bIsRunning;
+    //=========================================================================================================
+    /**
+    * Sets the stream profile of the client, see RtStreamProfile for the format.
+    *
+    * @param[in] ID             The client id
+    * @param[in] p_sProfile     The stream profile
+    */
+    void setProfile(qint32 ID, const QString& p_sProfile);
 
-    void startMeas(qint32 ID);
+    qint32 m_iDataClientId;
+    QString m_sDataClientAlias;
 
-    void stopMeas(qint32 ID);
+    int m_iSocketDescriptor;
+    QTcpSocket* m_pTcpSocket;                   /**< The client socket, only valid while the event loop is running. */
 
-    void sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo);
+    QQueue<QByteArray> m_qSendQueue;            /**< Packets waiting to be written to the socket. */
+    QQueue<bool> m_qSendQueueIsControl;         /**< Whether the corresponding packet of m_qSendQueue is a control packet. */
+    qint32 m_iNumQueuedBuffers;                 /**< Number of raw buffer packets in m_qSendQueue. */
+    qint32 m_iMaxQueuedBuffers;                 /**< Maximal number of queued raw buffer packets. */
+    qint32 m_iNumDroppedBuffers;                /**< Number of dropped raw buffer packets. */
+    qint64 m_iMaxSocketBytes;                   /**< Maximal number of unsent bytes handed to the socket. */
+    QueuePolicy m_queuePolicy;                  /**< What to do when the send queue is full. */
 
-    void sendRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData);
-    //void readToBuffer1();
-//    void readProc(QTcpSocket& p_qTcpSocket);
+    FiffTag::SPtr m_pPendingTag;                /**< Command tag whose header was read but whose data is not complete yet. */
+
+    RtStreamCodec m_streamCodec;                /**< Encoder of the raw buffers according to the stream profile of the client. */
+    bool m_bHasProfile;                         /**< Whether the client has a stream profile other than the default. */
+
+    bool m_bIsSendingRawBuffer;
 };
 
 
@@ -140,6 +207,12 @@ inline QString FiffStreamThread::getAlias()
 }
 
 
+inline qint32 FiffStreamThread::getNumDroppedBuffers()
+{
+    return m_iNumDroppedBuffers;
+}
+
+
 } // NAMESPACE
 
 #endif //FIFFSTREAMTHREAD_H
@@ -51,6 +51,7 @@ namespace RTSERVER
 
 #define MNE_RT_GET_CLIENT_ID        1       /**< Request client id at mne_rt_server */
 #define MNE_RT_SET_CLIENT_ALIAS     2       /**< Set client alias at mne_rt_server */
+#define MNE_RT_SET_CLIENT_QUEUE     3       /**< Set send queue size and policy of the client at mne_rt_server */
 
 } // NAMESPACE
 
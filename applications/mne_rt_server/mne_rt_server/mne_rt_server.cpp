@@ -153,6 +153,14 @@ MNERTServer::MNERTServer()
         ipAddress = QHostAddress(QHostAddress::LocalHost).toString();
 
     printf("mne_rt_server is running on\n\tIP:\t\t%s\n\tcommand port:\t%d\n\tfiff data port:\t%d\n\n",ipAddress.toUtf8().constData(), m_commandServer.serverPort(), m_fiffStreamServer.serverPort());
+
+    //
+    // Run shared memory ring for local clients
+    //
+    if (m_fiffStreamServer.createSharedMemory())
+        printf("\tshared memory:\t%s\n\n", RTSHM_DEFAULT_KEY);
+    else
+        printf("Unable to create the shared memory ring, local clients have to use the fiff data port.\n\n");
 }
 
 
@@ -341,6 +349,19 @@ void MNERTServer::init()
             "               }"
             "           }"
             "       },"
+            "       \"profile\": {"
+            "           \"description\": \"Sets the stream profile of the specified FiffStreamClient, e.g. channels=0-63;decim=5;encoding=float16;coalesce=2 (encodings: float32, float16, delta).\","
+            "           \"parameters\": {"
+            "               \"id\": {"
+            "                   \"description\": \"ID/Alias\","
+            "                   \"type\": \"QString\" "
+            "               },"
+            "               \"profile\": {"
+            "                   \"description\": \"Stream profile, 'channels=all' resets to the full stream\","
+            "                   \"type\": \"QString\" "
+            "               }"
+            "           }"
+            "        },"
             "       \"selcon\": {"
             "           \"description\": \"Selects a new connector, if a measurement is running it will be stopped.\","
             "           \"parameters\": {"
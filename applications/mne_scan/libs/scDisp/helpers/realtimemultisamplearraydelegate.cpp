@@ -554,6 +554,10 @@ void RealTimeMultiSampleArrayDelegate::createPlotPath(const QModelIndex &index,
         path.moveTo(qSamplePosition);
     }
 
+    //More than two samples per pixel - draw the min/max of each pixel column instead of every sample
+    if(data.second > 2*option.rect.width() && createEnvelopePath(index, option, path, ellipsePos, amplitude, data, fScaleY))
+        return;
+
     float val;
 
     for(qint32 j=0; j < data.second; ++j)
@@ -583,6 +587,60 @@ void RealTimeMultiSampleArrayDelegate::createPlotPath(const QModelIndex &index,
 }
 
 
+//*************************************************************************************************************
+
+bool RealTimeMultiSampleArrayDelegate::createEnvelopePath(const QModelIndex &index, const QStyleOptionViewItem &option, QPainterPath& path, QPointF &ellipsePos, QString &amplitude, RowVectorPair &data, float fScaleY) const
+{
+    const RealTimeMultiSampleArrayModel* t_pModel = static_cast<const RealTimeMultiSampleArrayModel*>(index.model());
+
+    float y_base = path.currentPosition().y();
+    float x_base = path.currentPosition().x();
+    float fDx = ((float)option.rect.width()) / t_pModel->getMaxSamples();
+
+    //The current sweep is plotted relative to its first sample, the rest of the last sweep relative to the last block's first value
+    qint32 currentSampleIndex = qBound(0, t_pModel->getCurrentSampleIndex(), data.second);
+    qint32 segmentStart[2] = {0, currentSampleIndex};
+    qint32 segmentEnd[2] = {currentSampleIndex, data.second};
+    double segmentOffset[2] = {*(data.first), t_pModel->getLastBlockFirstValue(index.row())};
+
+    QVector<double> vecMin, vecMax;
+
+    for(qint32 s = 0; s < 2; ++s) {
+        qint32 iNumSamples = segmentEnd[s] - segmentStart[s];
+
+        if(iNumSamples <= 0)
+            continue;
+
+        qint32 iNumColumns = qMax(1, qRound(iNumSamples * fDx));
+
+        if(!t_pModel->getEnvelope(index.row(), segmentStart[s], segmentEnd[s], iNumColumns, vecMin, vecMax))
+            return false;
+
+        float fColumnDx = iNumSamples * fDx / iNumColumns;
+
+        for(qint32 c = 0; c < iNumColumns; ++c) {
+            float x = x_base + segmentStart[s] * fDx + (c + 1) * fColumnDx;
+
+            path.lineTo(x, y_base - (vecMin[c] - segmentOffset[s]) * fScaleY);
+            path.lineTo(x, y_base - (vecMax[c] - segmentOffset[s]) * fScaleY);
+        }
+    }
+
+    //Create ellipse position
+    qint32 j = (qint32)(m_markerPosition.x()/fDx);
+    if(j >= 0 && j < data.second) {
+        double val = *(data.first+j) - (j < currentSampleIndex ? segmentOffset[0] : segmentOffset[1]);
+
+        ellipsePos.setX(x_base + (j+1)*fDx);
+        ellipsePos.setY(y_base - val*fScaleY);
+
+        amplitude = QString::number(*(data.first+j));
+    }
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 void RealTimeMultiSampleArrayDelegate::createCurrentPositionMarkerPath(const QModelIndex &index, const QStyleOptionViewItem &option, QPainterPath& path) const
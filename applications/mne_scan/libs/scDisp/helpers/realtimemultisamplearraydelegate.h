@@ -163,6 +163,22 @@ private:
     */
     void createPlotPath(const QModelIndex &index, const QStyleOptionViewItem &option, QPainterPath& path, QPointF &ellipsePos, QString &amplitude, SCDISPLIB::RowVectorPair &data) const;
 
+    //=========================================================================================================
+    /**
+    * createEnvelopePath creates the data plot from the min/max pyramid of the model, with two points per pixel column.
+    *
+    * @param[in] index      Used to locate data in a data model.
+    * @param[in] option     Describes the parameters used to draw an item in a view widget
+    * @param[in,out] path   The QPointerPath to create for the data plot.
+    * @param[in] ellipsePos Position of the ellipse which is plotted at the current channel signal value.
+    * @param[in] amplitude  String which is to be plotted.
+    * @param[in] data       Current data for the given row.
+    * @param[in] fScaleY    Scaling from values to pixels.
+    *
+    * @return false if the model provides no envelope for the row, true otherwise.
+    */
+    bool createEnvelopePath(const QModelIndex &index, const QStyleOptionViewItem &option, QPainterPath& path, QPointF &ellipsePos, QString &amplitude, SCDISPLIB::RowVectorPair &data, float fScaleY) const;
+
     //=========================================================================================================
     /**
     * createCurrentPositionMarkerPath Creates the QPointer path for the current marker position plot.
@@ -49,6 +49,7 @@
 
 using namespace SCDISPLIB;
 using namespace UTILSLIB;
+using namespace SCMEASLIB;
 
 
 //*************************************************************************************************************
@@ -325,6 +326,9 @@ void RealTimeMultiSampleArrayModel::setFiffInfo(FiffInfo::SPtr& p_pFiffInfo)
         m_matDataFiltered.conservativeResize(m_pFiffInfo->chs.size(), m_iMaxSamples);
         m_matDataFiltered.setZero();
 
+        m_pyramidRaw.build(m_matDataRaw.data(), m_matDataRaw.rows(), m_matDataRaw.cols());
+        m_pyramidFiltered.build(m_matDataFiltered.data(), m_matDataFiltered.rows(), m_matDataFiltered.cols());
+
         m_vecLastBlockFirstValuesFiltered.conservativeResize(m_pFiffInfo->chs.size());
         m_vecLastBlockFirstValuesFiltered.setZero();
 
@@ -391,6 +395,9 @@ void RealTimeMultiSampleArrayModel::setSamplingInfo(float sps, int T)
     m_matDataRaw.conservativeResize(m_pFiffInfo->chs.size(), m_iMaxSamples);
     m_matDataFiltered.conservativeResize(m_pFiffInfo->chs.size(), m_iMaxSamples);
     m_vecLastBlockFirstValuesRaw.conservativeResize(m_pFiffInfo->chs.size());
+
+    m_pyramidRaw.build(m_matDataRaw.data(), m_matDataRaw.rows(), m_matDataRaw.cols());
+    m_pyramidFiltered.build(m_matDataFiltered.data(), m_matDataFiltered.rows(), m_matDataFiltered.cols());
     m_vecLastBlockFirstValuesFiltered.conservativeResize(m_pFiffInfo->chs.size());
 
     if(m_iCurrentSample>m_iMaxSamples)
@@ -402,7 +409,7 @@ void RealTimeMultiSampleArrayModel::setSamplingInfo(float sps, int T)
 
 //*************************************************************************************************************
 
-void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
+void RealTimeMultiSampleArrayModel::addData(const QList<MeasurementBlock::ConstSPtr> &data, const QList<TriggerEvent> &lEvents, qint64 iFirstSample)
 {
     //SSP
     bool doProj = m_bProjActivated && m_matDataRaw.cols() > 0 && m_matDataRaw.rows() == m_matProj.cols() ? true : false;
@@ -413,10 +420,17 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
     //SPHARA
     bool doSphara = m_bSpharaActivated && m_matSparseSpharaMult.cols() > 0 && m_matDataRaw.rows() == m_matSparseSpharaMult.cols() ? true : false;
 
+    //Absolute index of the first sample of the current block
+    qint64 iBlockStart = iFirstSample;
+
     //Copy new data into the global data matrix
     for(qint32 b = 0; b < data.size(); ++b) {
-        int nCol = data.at(b).cols();
-        int nRow = data.at(b).rows();
+        //Shared with all other observers of the measurement - float blocks are converted once for all of them
+        const MatrixXd& matBlock = data.at(b)->toDouble();
+
+        int nCol = matBlock.cols();
+        int nRow = matBlock.rows();
+        int iWrapFrom = -1;
 
         if(nRow != m_matDataRaw.rows()) {
             std::cout<<"incoming data does not match internal data row size. Returning..."<<std::endl;
@@ -431,6 +445,8 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
                 m_iResidual = 0;
             }
 
+            iWrapFrom = m_iCurrentSample;
+
 //            std::cout<<"incoming data exceeds internal data cols by: "<<(m_iCurrentSample+nCol) % m_matDataRaw.cols()<<std::endl;
 //            std::cout<<"m_iCurrentSample+nCol: "<<m_iCurrentSample+nCol<<std::endl;
 //            std::cout<<"m_matDataRaw.cols(): "<<m_matDataRaw.cols()<<std::endl;
@@ -439,19 +455,19 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
             if(doComp) {
                 if(doProj) {
                     //Comp + Proj
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjCompMult * data.at(b).block(0,0,nRow,m_iResidual);
+                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjCompMult * matBlock.block(0,0,nRow,m_iResidual);
                 } else {
                     //Comp
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseCompMult * data.at(b).block(0,0,nRow,m_iResidual);
+                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseCompMult * matBlock.block(0,0,nRow,m_iResidual);
                 }
             } else {
                 if(doProj)
                 {
                     //Proj
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjMult * data.at(b).block(0,0,nRow,m_iResidual);
+                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjMult * matBlock.block(0,0,nRow,m_iResidual);
                 } else {
                     //None - Raw
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = data.at(b).block(0,0,nRow,m_iResidual);
+                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = matBlock.block(0,0,nRow,m_iResidual);
                 }
             }
 
@@ -482,18 +498,18 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
         if(doComp) {
             if(doProj) {
                 //Comp + Proj
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjCompMult * data.at(b);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjCompMult * matBlock;
             } else {
                 //Comp
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseCompMult * data.at(b);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseCompMult * matBlock;
             }
         } else {
             if(doProj) {
                 //Proj
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjMult * data.at(b);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjMult * matBlock;
             } else {
                 //None - Raw
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = data.at(b);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = matBlock;
             }
         }
 
@@ -523,6 +539,18 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
             }
         }
 
+        //Keep the min/max pyramids in sync with the written samples. The filter also touches the samples in front
+        //of and behind the block, and at the start of a sweep the tail of the matrix.
+        m_pyramidRaw.update(m_matDataRaw.data(), m_iCurrentSample, m_iCurrentSample+nCol);
+        if(iWrapFrom >= 0)
+            m_pyramidRaw.update(m_matDataRaw.data(), iWrapFrom, iWrapFrom+m_iResidual);
+
+        if(!m_filterData.isEmpty()) {
+            m_pyramidFiltered.update(m_matDataFiltered.data(), m_iCurrentSample-m_iMaxFilterLength, m_iCurrentSample+nCol+m_iMaxFilterLength);
+            if(m_iCurrentSample < m_iMaxFilterLength)
+                m_pyramidFiltered.update(m_matDataFiltered.data(), m_matDataFiltered.cols()-m_iMaxFilterLength-m_iResidual, m_matDataFiltered.cols());
+        }
+
         m_iCurrentSample += nCol;
         m_iCurrentBlockSize = nCol;
 
@@ -530,16 +558,36 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
         if(m_bTriggerDetectionActive) {
             int iOldDetectedTriggers = m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].size();
 
-            QString detectionType("Rising");
+            //The events were detected once by the measurement, across block boundaries - only place the rising
+            //flanks above the threshold of this block. Events confirmed late (minimal duration) go to the first block.
+            for(int e = 0; e < lEvents.size(); ++e) {
+                const TriggerEvent& event = lEvents.at(e);
 
-            //m_qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksMax(data.at(b), m_lTriggerChannelIndices, m_iCurrentSample-nCol, m_dTriggerThreshold, true);
-            QMap<int,QList<QPair<int,double> > > qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksGrad(data.at(b), m_lTriggerChannelIndices, m_iCurrentSample-nCol, m_dTriggerThreshold, false, detectionType);
+                bool bInBlock = event.iSample < iBlockStart + nCol && (event.iSample >= iBlockStart || b == 0);
 
-            //Append results to already found triggers
-            QMapIterator<int,QList<QPair<int,double> > > i(qMapDetectedTrigger);
-            while (i.hasNext()) {
-                i.next();
-                m_qMapDetectedTrigger[i.key()].append(i.value());
+                if(bInBlock && event.dValue >= m_dTriggerThreshold && m_lTriggerChannelIndices.contains(event.iChannel)) {
+                    int iPos = m_iCurrentSample - nCol + qMax(0, int(event.iSample - iBlockStart));
+                    m_qMapDetectedTrigger[event.iChannel].append(QPair<int,double>(iPos, event.dValue));
+                }
+            }
+
+            //The measurement only scans the stimulus channels - detect the flanks of other (analog) trigger
+            //channels with the user threshold here, as before
+            QList<int> lAnalogTriggerChannels;
+            for(int i = 0; i < m_lTriggerChannelIndices.size(); ++i) {
+                if(m_pFiffInfo->chs[m_lTriggerChannelIndices.at(i)].kind != FIFFV_STIM_CH)
+                    lAnalogTriggerChannels.append(m_lTriggerChannelIndices.at(i));
+            }
+
+            if(!lAnalogTriggerChannels.isEmpty()) {
+                QString detectionType("Rising");
+                QMap<int,QList<QPair<int,double> > > qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksGrad(matBlock, lAnalogTriggerChannels, m_iCurrentSample-nCol, m_dTriggerThreshold, false, detectionType);
+
+                QMapIterator<int,QList<QPair<int,double> > > i(qMapDetectedTrigger);
+                while(i.hasNext()) {
+                    i.next();
+                    m_qMapDetectedTrigger[i.key()].append(i.value());
+                }
             }
 
             //Compute newly counted triggers
@@ -550,6 +598,8 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
                 emit triggerDetected(m_iDetectedTriggers);
             }
         }
+
+        iBlockStart += nCol;
     }
 
     //Update data content
@@ -560,6 +610,33 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
 }
 
 
+//*************************************************************************************************************
+
+bool RealTimeMultiSampleArrayModel::getEnvelope(int row, qint32 iFrom, qint32 iTo, qint32 iNumColumns, QVector<double>& vecMin, QVector<double>& vecMax) const
+{
+    qint32 chRow = m_qMapIdxRowSelection.value(row,0);
+
+    //Same selection of the displayed data as in data()
+    const MatrixXdR* pMatData;
+    const DISPLIB::MinMaxPyramid* pPyramid;
+
+    if(m_bIsFreezed) {
+        pMatData = m_filterData.isEmpty() ? &m_matDataRawFreeze : &m_matDataFilteredFreeze;
+        pPyramid = m_filterData.isEmpty() ? &m_pyramidRawFreeze : &m_pyramidFilteredFreeze;
+    } else {
+        pMatData = m_filterData.isEmpty() ? &m_matDataRaw : &m_matDataFiltered;
+        pPyramid = m_filterData.isEmpty() ? &m_pyramidRaw : &m_pyramidFiltered;
+    }
+
+    if(chRow >= pMatData->rows() || pPyramid->rows() != pMatData->rows() || pPyramid->samples() != pMatData->cols())
+        return false;
+
+    pPyramid->envelope(chRow, pMatData->data() + chRow*pMatData->cols(), iFrom, iTo, iNumColumns, vecMin, vecMax);
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 fiff_int_t RealTimeMultiSampleArrayModel::getKind(qint32 row) const
@@ -666,6 +743,8 @@ void RealTimeMultiSampleArrayModel::toggleFreeze(const QModelIndex &)
     if(m_bIsFreezed) {
         m_matDataRawFreeze = m_matDataRaw;
         m_matDataFilteredFreeze = m_matDataFiltered;
+        m_pyramidRawFreeze = m_pyramidRaw;
+        m_pyramidFilteredFreeze = m_pyramidFiltered;
         m_qMapDetectedTriggerFreeze = m_qMapDetectedTrigger;
         m_qMapDetectedTriggerOldFreeze = m_qMapDetectedTriggerOld;
 
@@ -1059,6 +1138,10 @@ void RealTimeMultiSampleArrayModel::triggerInfoChanged(const QMap<QString, QColo
             if(m_pFiffInfo->chs[i].ch_name == m_sCurrentTriggerCh) {
                 m_iCurrentTriggerChIndex = i;
                 m_qMapDetectedTrigger.insert(i, temp);
+
+                //A channel which is not a stimulus channel (e.g. an analog trigger) is scanned in addData
+                if(!m_lTriggerChannelIndices.contains(i))
+                    m_lTriggerChannelIndices.append(i);
                 break;
             }
         }
@@ -1189,6 +1272,8 @@ void RealTimeMultiSampleArrayModel::filterChannelsConcurrently()
         m_vecLastBlockFirstValuesFiltered = m_matDataFiltered.col(0);
     }
 
+    m_pyramidFiltered.update(m_matDataFiltered.data(), 0, m_matDataFiltered.cols());
+
     //std::cout<<"END RealTimeMultiSampleArrayModel::filterChannelsConcurrently"<<std::endl;
 }
 
@@ -1318,6 +1403,10 @@ void RealTimeMultiSampleArrayModel::clearModel()
     m_matDataFiltered.setZero();
     m_matDataRawFreeze.setZero();
     m_matDataFilteredFreeze.setZero();
+    m_pyramidRaw.build(m_matDataRaw.data(), m_matDataRaw.rows(), m_matDataRaw.cols());
+    m_pyramidFiltered.build(m_matDataFiltered.data(), m_matDataFiltered.rows(), m_matDataFiltered.cols());
+    m_pyramidRawFreeze.build(m_matDataRawFreeze.data(), m_matDataRawFreeze.rows(), m_matDataRawFreeze.cols());
+    m_pyramidFilteredFreeze.build(m_matDataFilteredFreeze.data(), m_matDataFilteredFreeze.rows(), m_matDataFilteredFreeze.cols());
     m_vecLastBlockFirstValuesFiltered.setZero();
     m_vecLastBlockFirstValuesRaw.setZero();
     m_matOverlap.setZero();
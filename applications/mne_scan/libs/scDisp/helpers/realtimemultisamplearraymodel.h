@@ -43,15 +43,19 @@
 //=============================================================================================================
 
 #include <scMeas/realtimesamplearraychinfo.h>
+#include <scMeas/measurementblock.h>
 #include <fiff/fiff_types.h>
 #include <fiff/fiff_info.h>
 
 #include <utils/filterTools/filterdata.h>
 #include <utils/mnemath.h>
+#include <utils/streamtriggerdetector.h>
 #include <utils/detecttrigger.h>
 #include <utils/ioutils.h>
 #include <utils/filterTools/sphara.h>
 
+#include <disp/helpers/minmaxpyramid.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -195,9 +199,11 @@ public:
     /**
     * Adds multiple time points (QVector) for a channel set (VectorXd)
     *
-    * @param[in] data       data to add (Time points of channel samples)
+    * @param[in] data           data blocks to add (Time points of channel samples), read without copying
+    * @param[in] lEvents        the trigger events which were detected in the stimulus channels of data
+    * @param[in] iFirstSample   the absolute sample index of the first sample of data, used to place the events
     */
-    void addData(const QList<MatrixXd> &data);
+    void addData(const QList<SCMEASLIB::MeasurementBlock::ConstSPtr> &data, const QList<UTILSLIB::TriggerEvent> &lEvents = QList<UTILSLIB::TriggerEvent>(), qint64 iFirstSample = 0);
 
     //=========================================================================================================
     /**
@@ -255,6 +261,22 @@ public:
     */
     inline double getLastBlockFirstValue(int row) const;
 
+    //=========================================================================================================
+    /**
+    * Computes the minimum and maximum of the currently displayed data of a row for each pixel column. The
+    * values are assembled from the min/max pyramid, so the costs do not depend on the number of samples.
+    *
+    * @param[in] row            row for which the envelope is to be computed
+    * @param[in] iFrom          first sample
+    * @param[in] iTo            one past the last sample
+    * @param[in] iNumColumns    number of pixel columns the samples are distributed over
+    * @param[out] vecMin        the minimum of each column
+    * @param[out] vecMax        the maximum of each column
+    *
+    * @return false if no pyramid is available for the displayed data, true otherwise
+    */
+    bool getEnvelope(int row, qint32 iFrom, qint32 iTo, qint32 iNumColumns, QVector<double>& vecMin, QVector<double>& vecMax) const;
+
     //=========================================================================================================
     /**
     * Returns a map which conatins the channel idx and its corresponding selection status
@@ -571,6 +593,10 @@ private:
     MatrixXdR                           m_matDataFiltered;                          /**< The filtered data */
     MatrixXdR                           m_matDataRawFreeze;                         /**< The raw data in freeze mode */
     MatrixXdR                           m_matDataFilteredFreeze;                    /**< The raw filtered data in freeze mode */
+    DISPLIB::MinMaxPyramid              m_pyramidRaw;                               /**< Min/max pyramid of the raw data */
+    DISPLIB::MinMaxPyramid              m_pyramidFiltered;                          /**< Min/max pyramid of the filtered data */
+    DISPLIB::MinMaxPyramid              m_pyramidRawFreeze;                         /**< Min/max pyramid of the raw data in freeze mode */
+    DISPLIB::MinMaxPyramid              m_pyramidFilteredFreeze;                    /**< Min/max pyramid of the filtered data in freeze mode */
     MatrixXd                            m_matOverlap;                               /**< Last overlap block for the back */
 
     Eigen::VectorXi                     m_vecIndicesFirstVV;                        /**< The indices of the channels to pick for the first SPHARA operator in case of a VectorView system.*/
@@ -165,6 +165,7 @@ void RealTimeSourceEstimateWidget::getData()
                 m_lRtItem.at(i)->setVisualizationType("Annotation based");
                 //m_lRtItem.at(i)->onTimeIntervalChanged(m_pRTSE->getValue()->tstep*1000000);
                 m_lRtItem.at(i)->setNumberAverages(1);
+                m_lRtItem.at(i)->setAverageSkippedSamples(true);
                 m_lRtItem.at(i)->setStreamingActive(true);
             }
         } else {
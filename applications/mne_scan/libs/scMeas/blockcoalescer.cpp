@@ -0,0 +1,159 @@
+//=============================================================================================================
+/**
+* @file     blockcoalescer.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Definition of the BlockCoalescer Class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "blockcoalescer.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtGlobal>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCMEASLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+BlockCoalescer::BlockCoalescer(double dLatencyBudgetMs, double dSFreq)
+: m_dLatencyBudgetMs(dLatencyBudgetMs)
+, m_dSFreq(dSFreq)
+, m_iNumSamples(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void BlockCoalescer::setLatencyBudget(double dLatencyBudgetMs)
+{
+    m_dLatencyBudgetMs = dLatencyBudgetMs;
+}
+
+
+//*************************************************************************************************************
+
+void BlockCoalescer::setSamplingFrequency(double dSFreq)
+{
+    m_dSFreq = dSFreq;
+}
+
+
+//*************************************************************************************************************
+
+qint32 BlockCoalescer::targetSamples() const
+{
+    if(m_dLatencyBudgetMs <= 0.0)
+        return 1;
+
+    if(m_dSFreq <= 0.0)
+        return 0;
+
+    return qMax(1, qRound(m_dSFreq * m_dLatencyBudgetMs / 1000.0));
+}
+
+
+//*************************************************************************************************************
+
+bool BlockCoalescer::isReady() const
+{
+    if(m_iNumSamples == 0)
+        return false;
+
+    qint32 iTargetSamples = targetSamples();
+
+    if(iTargetSamples > 0 && m_iNumSamples >= iTargetSamples)
+        return true;
+
+    return m_timerFirstSample.elapsed() >= m_dLatencyBudgetMs;
+}
+
+
+//*************************************************************************************************************
+
+bool BlockCoalescer::takeBlock(MatrixXd& matBlock)
+{
+    if(m_iNumSamples == 0)
+        return false;
+
+    matBlock = m_matBuffer.leftCols(m_iNumSamples);
+    m_iNumSamples = 0;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void BlockCoalescer::clear()
+{
+    m_iNumSamples = 0;
+}
+
+
+//*************************************************************************************************************
+
+void BlockCoalescer::reserve(qint32 iNumRows, qint32 iNumSamples)
+{
+    qint32 iRequired = m_iNumSamples + iNumSamples;
+
+    if(m_matBuffer.rows() == iNumRows && m_matBuffer.cols() >= iRequired)
+        return;
+
+    //Grow geometrically, but at least to the target size so that the buffer settles after the first block
+    qint32 iCapacity = qMax(qMax(iRequired, targetSamples()), 2 * static_cast<qint32>(m_matBuffer.cols()));
+
+    if(m_matBuffer.rows() == iNumRows)
+        m_matBuffer.conservativeResize(iNumRows, iCapacity);
+    else
+        m_matBuffer.resize(iNumRows, iCapacity);
+}
@@ -0,0 +1,234 @@
+//=============================================================================================================
+/**
+* @file     blockcoalescer.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     BlockCoalescer class declaration.
+*
+*/
+
+#ifndef BLOCKCOALESCER_H
+#define BLOCKCOALESCER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "scmeas_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QElapsedTimer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCMEASLIB
+//=============================================================================================================
+
+namespace SCMEASLIB
+{
+
+
+//=============================================================================================================
+/**
+* Sensor drivers often deliver only a handful of samples per call. Emitting each of these blocks costs a signal,
+* a mutex and a matrix copy downstream, which at high sampling rates exceeds the processing itself. The coalescer
+* collects the driver blocks in a preallocated matrix and reports a block as ready once it holds the number of
+* samples corresponding to the latency budget, or once the budget has elapsed since its first sample.
+*
+* @brief Collects small driver blocks into larger contiguous blocks within a latency budget
+*/
+class SCMEASSHARED_EXPORT BlockCoalescer
+{
+public:
+    typedef QSharedPointer<BlockCoalescer> SPtr;            /**< Shared pointer type for BlockCoalescer. */
+    typedef QSharedPointer<const BlockCoalescer> ConstSPtr; /**< Const shared pointer type for BlockCoalescer. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a BlockCoalescer.
+    *
+    * @param[in] dLatencyBudgetMs   Maximal time in ms a sample is held back, values <= 0 pass every block through
+    * @param[in] dSFreq             Sampling frequency in Hz, values <= 0 only use the elapsed time
+    */
+    explicit BlockCoalescer(double dLatencyBudgetMs = 20.0, double dSFreq = 0.0);
+
+    //=========================================================================================================
+    /**
+    * Sets the latency budget.
+    *
+    * @param[in] dLatencyBudgetMs   Maximal time in ms a sample is held back, values <= 0 pass every block through
+    */
+    void setLatencyBudget(double dLatencyBudgetMs);
+
+    //=========================================================================================================
+    /**
+    * Returns the latency budget in ms.
+    *
+    * @return the latency budget
+    */
+    inline double latencyBudget() const;
+
+    //=========================================================================================================
+    /**
+    * Sets the sampling frequency which is used to derive the target block size from the latency budget.
+    *
+    * @param[in] dSFreq     Sampling frequency in Hz, values <= 0 only use the elapsed time
+    */
+    void setSamplingFrequency(double dSFreq);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples after which a block is ready, 0 if only the elapsed time is used.
+    *
+    * @return the target block size
+    */
+    qint32 targetSamples() const;
+
+    //=========================================================================================================
+    /**
+    * Appends a driver block. A change of the channel number discards the samples buffered so far.
+    *
+    * @param[in] matBlock   The driver block (channels x samples) of any scalar type
+    *
+    * @return true if a coalesced block is ready to be taken
+    */
+    template<typename Derived>
+    bool append(const Eigen::MatrixBase<Derived>& matBlock);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the buffered samples reached the target size or the latency budget elapsed.
+    *
+    * @return true if a coalesced block is ready to be taken
+    */
+    bool isReady() const;
+
+    //=========================================================================================================
+    /**
+    * Moves all buffered samples to matBlock, regardless whether the block is ready. Used to flush on stop.
+    *
+    * @param[out] matBlock  The coalesced block
+    *
+    * @return false if no samples were buffered
+    */
+    bool takeBlock(Eigen::MatrixXd& matBlock);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of buffered samples.
+    *
+    * @return the number of buffered samples
+    */
+    inline qint32 numBufferedSamples() const;
+
+    //=========================================================================================================
+    /**
+    * Discards all buffered samples.
+    */
+    void clear();
+
+private:
+    //=========================================================================================================
+    /**
+    * Makes room for iNumSamples further samples of iNumRows channels.
+    *
+    * @param[in] iNumRows       Number of channels
+    * @param[in] iNumSamples    Number of samples to be appended
+    */
+    void reserve(qint32 iNumRows, qint32 iNumSamples);
+
+    double              m_dLatencyBudgetMs; /**< Maximal time in ms a sample is held back. */
+    double              m_dSFreq;           /**< Sampling frequency in Hz. */
+
+    Eigen::MatrixXd     m_matBuffer;        /**< Preallocated buffer, only the first m_iNumSamples columns are valid. */
+    qint32              m_iNumSamples;      /**< Number of buffered samples. */
+    QElapsedTimer       m_timerFirstSample; /**< Started when the first sample of a block is buffered. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline double BlockCoalescer::latencyBudget() const
+{
+    return m_dLatencyBudgetMs;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 BlockCoalescer::numBufferedSamples() const
+{
+    return m_iNumSamples;
+}
+
+
+//*************************************************************************************************************
+
+template<typename Derived>
+bool BlockCoalescer::append(const Eigen::MatrixBase<Derived>& matBlock)
+{
+    if(matBlock.cols() == 0)
+        return isReady();
+
+    if(m_iNumSamples > 0 && m_matBuffer.rows() != matBlock.rows())
+        clear();
+
+    reserve(matBlock.rows(), matBlock.cols());
+
+    if(m_iNumSamples == 0)
+        m_timerFirstSample.start();
+
+    m_matBuffer.middleCols(m_iNumSamples, matBlock.cols()) = matBlock.template cast<double>();
+    m_iNumSamples += matBlock.cols();
+
+    return isReady();
+}
+
+} // NAMESPACE
+
+#endif // BLOCKCOALESCER_H
@@ -0,0 +1,216 @@
+//=============================================================================================================
+/**
+* @file     measurementblock.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Definition of the MeasurementBlock and MeasurementBlockPool classes.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "measurementblock.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutexLocker>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCMEASLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MeasurementBlock::MeasurementBlock(Precision precision, int iRows, int iCols)
+: m_precision(precision)
+, m_bConverted(false)
+{
+    if(m_precision == Float32)
+        m_matFloat.resize(iRows, iCols);
+    else
+        m_matDouble.resize(iRows, iCols);
+}
+
+
+//*************************************************************************************************************
+
+MeasurementBlock::SPtr MeasurementBlock::create(const MatrixXd& mat)
+{
+    SPtr pBlock(new MeasurementBlock(Float64));
+    pBlock->m_matDouble = mat;
+    return pBlock;
+}
+
+
+//*************************************************************************************************************
+
+const MatrixXd& MeasurementBlock::toDouble() const
+{
+    if(m_precision == Float64)
+        return m_matDouble;
+
+    QMutexLocker locker(&m_qMutex);
+    if(!m_bConverted) {
+        m_matDouble = m_matFloat.cast<double>();
+        m_bConverted = true;
+    }
+
+    return m_matDouble;
+}
+
+
+//*************************************************************************************************************
+
+const MatrixXf& MeasurementBlock::toFloat() const
+{
+    if(m_precision == Float32)
+        return m_matFloat;
+
+    QMutexLocker locker(&m_qMutex);
+    if(!m_bConverted) {
+        m_matFloat = m_matDouble.cast<float>();
+        m_bConverted = true;
+    }
+
+    return m_matFloat;
+}
+
+
+//*************************************************************************************************************
+
+void MeasurementBlock::reset(int iRows, int iCols)
+{
+    //resize keeps the allocation if the size did not change
+    if(m_precision == Float32)
+        m_matFloat.resize(iRows, iCols);
+    else
+        m_matDouble.resize(iRows, iCols);
+
+    m_bConverted = false;
+}
+
+
+//*************************************************************************************************************
+
+MeasurementBlockPool::MeasurementBlockPool(int iMaxFreeBlocks)
+: m_iMaxFreeBlocks(iMaxFreeBlocks > 0 ? iMaxFreeBlocks : 0)
+{
+}
+
+
+//*************************************************************************************************************
+
+MeasurementBlockPool::SPtr MeasurementBlockPool::create(int iMaxFreeBlocks)
+{
+    return SPtr(new MeasurementBlockPool(iMaxFreeBlocks));
+}
+
+
+//*************************************************************************************************************
+
+MeasurementBlockPool::~MeasurementBlockPool()
+{
+    qDeleteAll(m_qListFreeBlocks);
+}
+
+
+//*************************************************************************************************************
+
+MeasurementBlock::SPtr MeasurementBlockPool::acquire(MeasurementBlock::Precision precision, int iRows, int iCols)
+{
+    MeasurementBlock* pBlock = Q_NULLPTR;
+
+    m_qMutex.lock();
+    for(int i = 0; i < m_qListFreeBlocks.size(); ++i) {
+        MeasurementBlock* pFree = m_qListFreeBlocks[i];
+        if(pFree->precision() == precision && pFree->rows() == iRows && pFree->cols() == iCols) {
+            pBlock = m_qListFreeBlocks.takeAt(i);
+            break;
+        }
+    }
+
+    //Reuse a block of another size rather than allocating a new one and letting the old one rot in the pool
+    if(!pBlock && !m_qListFreeBlocks.isEmpty() && m_qListFreeBlocks.first()->precision() == precision)
+        pBlock = m_qListFreeBlocks.takeFirst();
+    m_qMutex.unlock();
+
+    if(pBlock)
+        pBlock->reset(iRows, iCols);
+    else
+        pBlock = new MeasurementBlock(precision, iRows, iCols);
+
+    QWeakPointer<MeasurementBlockPool> pWeakPool = sharedFromThis().toWeakRef();
+
+    return MeasurementBlock::SPtr(pBlock, [pWeakPool](MeasurementBlock* pReleased) {
+        QSharedPointer<MeasurementBlockPool> pPool = pWeakPool.toStrongRef();
+        if(pPool)
+            pPool->recycle(pReleased);
+        else
+            delete pReleased;
+    });
+}
+
+
+//*************************************************************************************************************
+
+int MeasurementBlockPool::numFreeBlocks() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_qListFreeBlocks.size();
+}
+
+
+//*************************************************************************************************************
+
+void MeasurementBlockPool::recycle(MeasurementBlock* pBlock)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    if(m_qListFreeBlocks.size() < m_iMaxFreeBlocks)
+        m_qListFreeBlocks.append(pBlock);
+    else
+        delete pBlock;
+}
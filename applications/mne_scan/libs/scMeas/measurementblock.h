@@ -0,0 +1,315 @@
+//=============================================================================================================
+/**
+* @file     measurementblock.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     MeasurementBlock and MeasurementBlockPool class declaration.
+*
+*/
+
+#ifndef MEASUREMENTBLOCK_H
+#define MEASUREMENTBLOCK_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "scmeas_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QEnableSharedFromThis>
+#include <QMutex>
+#include <QList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCMEASLIB
+//=============================================================================================================
+
+namespace SCMEASLIB
+{
+
+class MeasurementBlockPool;
+
+
+//=============================================================================================================
+/**
+* Reference counted block of channels x samples data. A block is filled once by its producer and is immutable
+* as soon as it is published as ConstSPtr: all subscribers share the same memory and keep it alive as long as
+* they hold the pointer. Blocks acquired from a MeasurementBlockPool return their storage to the pool when the
+* last reference is dropped.
+*
+* @brief Immutable, shared data block of a measurement
+*/
+class SCMEASSHARED_EXPORT MeasurementBlock
+{
+public:
+    typedef QSharedPointer<MeasurementBlock> SPtr;               /**< Shared pointer type for MeasurementBlock, only used by the producer. */
+    typedef QSharedPointer<const MeasurementBlock> ConstSPtr;    /**< Const shared pointer type for MeasurementBlock. */
+
+    /**
+    * Storage precision of the block.
+    */
+    enum Precision {
+        Float32,
+        Float64
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs a block of the given precision and size.
+    *
+    * @param[in] precision  the storage precision.
+    * @param[in] iRows      number of channels.
+    * @param[in] iCols      number of samples.
+    */
+    MeasurementBlock(Precision precision = Float64, int iRows = 0, int iCols = 0);
+
+    //=========================================================================================================
+    /**
+    * Creates a block which is not pooled and holds a copy of the given data.
+    *
+    * @param[in] mat        the data.
+    *
+    * @return the block.
+    */
+    static SPtr create(const Eigen::MatrixXd& mat);
+
+    //=========================================================================================================
+    /**
+    * Returns the storage precision.
+    *
+    * @return the precision.
+    */
+    inline Precision precision() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of channels.
+    *
+    * @return the number of rows.
+    */
+    inline int rows() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples.
+    *
+    * @return the number of columns.
+    */
+    inline int cols() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the writable single precision storage. Only valid for Float32 blocks which are not published yet.
+    *
+    * @return the data.
+    */
+    inline Eigen::MatrixXf& dataFloat();
+
+    //=========================================================================================================
+    /**
+    * Returns the writable double precision storage. Only valid for Float64 blocks which are not published yet.
+    *
+    * @return the data.
+    */
+    inline Eigen::MatrixXd& dataDouble();
+
+    //=========================================================================================================
+    /**
+    * Returns the data in double precision. Float64 blocks return their storage, Float32 blocks are converted
+    * once on first request and the conversion is shared by all subscribers.
+    *
+    * @return the data in double precision.
+    */
+    const Eigen::MatrixXd& toDouble() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the data in single precision. Float32 blocks return their storage, Float64 blocks are converted
+    * once on first request and the conversion is shared by all subscribers.
+    *
+    * @return the data in single precision.
+    */
+    const Eigen::MatrixXf& toFloat() const;
+
+private:
+    friend class MeasurementBlockPool;
+
+    //=========================================================================================================
+    /**
+    * Prepares a recycled block for its next use.
+    *
+    * @param[in] iRows      number of channels.
+    * @param[in] iCols      number of samples.
+    */
+    void reset(int iRows, int iCols);
+
+    Precision               m_precision;        /**< Storage precision. */
+    mutable Eigen::MatrixXf m_matFloat;         /**< Single precision data, storage of Float32 blocks or conversion of Float64 blocks. */
+    mutable Eigen::MatrixXd m_matDouble;        /**< Double precision data, storage of Float64 blocks or conversion of Float32 blocks. */
+    mutable QMutex          m_qMutex;           /**< Guards the lazy conversion. */
+    mutable bool            m_bConverted;       /**< Whether the other precision was converted already. */
+};
+
+
+//=============================================================================================================
+/**
+* Pool of MeasurementBlocks. Released blocks keep their allocation and are handed out again for the next block
+* of the same precision and size, so that a streaming producer does not allocate in steady state. The pool may
+* be destroyed before its blocks, the remaining blocks are then deleted when released.
+*
+* @brief Recycling allocator of MeasurementBlocks
+*/
+class SCMEASSHARED_EXPORT MeasurementBlockPool : public QEnableSharedFromThis<MeasurementBlockPool>
+{
+public:
+    typedef QSharedPointer<MeasurementBlockPool> SPtr;               /**< Shared pointer type for MeasurementBlockPool. */
+    typedef QSharedPointer<const MeasurementBlockPool> ConstSPtr;    /**< Const shared pointer type for MeasurementBlockPool. */
+
+    //=========================================================================================================
+    /**
+    * Creates a pool.
+    *
+    * @param[in] iMaxFreeBlocks     maximal number of released blocks which are kept for reuse.
+    *
+    * @return the pool.
+    */
+    static SPtr create(int iMaxFreeBlocks = 32);
+
+    //=========================================================================================================
+    /**
+    * Destroys the pool and all released blocks.
+    */
+    ~MeasurementBlockPool();
+
+    //=========================================================================================================
+    /**
+    * Returns a writable block of the given precision and size. The content is undefined.
+    *
+    * @param[in] precision  the storage precision.
+    * @param[in] iRows      number of channels.
+    * @param[in] iCols      number of samples.
+    *
+    * @return the block, which returns to the pool when its last reference is dropped.
+    */
+    MeasurementBlock::SPtr acquire(MeasurementBlock::Precision precision, int iRows, int iCols);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of released blocks which are ready for reuse.
+    *
+    * @return the number of free blocks.
+    */
+    int numFreeBlocks() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Constructs a pool.
+    *
+    * @param[in] iMaxFreeBlocks     maximal number of released blocks which are kept for reuse.
+    */
+    explicit MeasurementBlockPool(int iMaxFreeBlocks);
+
+    //=========================================================================================================
+    /**
+    * Takes back a released block.
+    *
+    * @param[in] pBlock     the block.
+    */
+    void recycle(MeasurementBlock* pBlock);
+
+    mutable QMutex              m_qMutex;           /**< Guards the free list. */
+    QList<MeasurementBlock*>    m_qListFreeBlocks;  /**< Released blocks. */
+    int                         m_iMaxFreeBlocks;   /**< Maximal number of released blocks kept for reuse. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline MeasurementBlock::Precision MeasurementBlock::precision() const
+{
+    return m_precision;
+}
+
+
+//*************************************************************************************************************
+
+inline int MeasurementBlock::rows() const
+{
+    return m_precision == Float32 ? m_matFloat.rows() : m_matDouble.rows();
+}
+
+
+//*************************************************************************************************************
+
+inline int MeasurementBlock::cols() const
+{
+    return m_precision == Float32 ? m_matFloat.cols() : m_matDouble.cols();
+}
+
+
+//*************************************************************************************************************
+
+inline Eigen::MatrixXf& MeasurementBlock::dataFloat()
+{
+    return m_matFloat;
+}
+
+
+//*************************************************************************************************************
+
+inline Eigen::MatrixXd& MeasurementBlock::dataDouble()
+{
+    return m_matDouble;
+}
+
+} // NAMESPACE
+
+#endif // MEASUREMENTBLOCK_H
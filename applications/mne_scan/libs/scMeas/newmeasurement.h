@@ -125,6 +125,23 @@ public:
     */
     inline int type() const;
 
+    //=========================================================================================================
+    /**
+    * Returns the monotonic time in nanoseconds at which the data currently held by the Measurement were acquired.
+    * The time is stamped when a sensor plugin emits the data and is handed on along the plugin graph.
+    *
+    * @return the acquisition time in ns, 0 if unknown.
+    */
+    inline qint64 acquisitionTime() const;
+
+    //=========================================================================================================
+    /**
+    * Sets the monotonic acquisition time of the data currently held by the Measurement.
+    *
+    * @param[in] iTimeNs    the acquisition time in ns.
+    */
+    inline void setAcquisitionTime(qint64 iTimeNs);
+
 signals:
     void notify();
 
@@ -142,6 +159,7 @@ private:
     int     m_iMetaTypeId;      /**< QMetaType id of the Measurement */
     QString m_qString_Name;     /**< Name of the Measurement */
     bool    m_bVisibility;      /**< Visibility status */
+    qint64  m_iAcquisitionTime; /**< Monotonic acquisition time of the current data in ns, 0 if unknown */
 };
 
 
@@ -201,6 +219,24 @@ inline int NewMeasurement::type() const
     return m_iMetaTypeId;
 }
 
+
+//*************************************************************************************************************
+
+inline qint64 NewMeasurement::acquisitionTime() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_iAcquisitionTime;
+}
+
+
+//*************************************************************************************************************
+
+inline void NewMeasurement::setAcquisitionTime(qint64 iTimeNs)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_iAcquisitionTime = iTimeNs;
+}
+
 } //NAMESPACE
 
 Q_DECLARE_METATYPE(SCMEASLIB::NewMeasurement::SPtr)
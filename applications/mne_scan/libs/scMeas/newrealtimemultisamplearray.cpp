@@ -68,6 +68,9 @@ NewRealTimeMultiSampleArray::NewRealTimeMultiSampleArray(QObject *parent)
 : NewMeasurement(QMetaType::type("NewRealTimeMultiSampleArray::SPtr"), parent)
 , m_dSamplingRate(0)
 , m_iMultiArraySize(10)
+, m_pBlockPool(MeasurementBlockPool::create())
+, m_iPendingFirstSample(0)
+, m_iFirstSample(0)
 , m_bChInfoIsInit(false)
 {
     m_slDisplayFlag << "compensators" << "projections" << "filter" << "view" << "triggerdetection" << "scaling" << "sphara" << "colors";
@@ -110,6 +113,8 @@ void NewRealTimeMultiSampleArray::initFromFiffInfo(FiffInfo::SPtr &p_pFiffInfo)
     m_qListChInfo.clear();
     m_bChInfoIsInit = false;
 
+    QList<int> lStimChannels;
+
     bool t_bIsBabyMEG = false;
 
     if(p_pFiffInfo->acq_pars == "BabyMEG")
@@ -221,6 +226,9 @@ void NewRealTimeMultiSampleArray::initFromFiffInfo(FiffInfo::SPtr &p_pFiffInfo)
         // set channel Kind
         initChInfo.setKind(p_pFiffInfo->chs[i].kind);
 
+        if(p_pFiffInfo->chs[i].kind == FIFFV_STIM_CH)
+            lStimChannels.append(i);
+
         // set channel coil
         initChInfo.setCoil(p_pFiffInfo->chs[i].coil_type);
 
@@ -232,10 +240,52 @@ void NewRealTimeMultiSampleArray::initFromFiffInfo(FiffInfo::SPtr &p_pFiffInfo)
 
     m_pFiffInfo_orig = p_pFiffInfo;
 
+    //Trigger detection on the stimulus channels
+    m_triggerDetector.setTriggerChannels(lStimChannels);
+    m_triggerDetector.reset();
+    m_qListPendingTriggerEvents.clear();
+    m_qListTriggerEvents.clear();
+    m_iPendingFirstSample = 0;
+    m_iFirstSample = 0;
+
     m_bChInfoIsInit = true;
 }
 
 
+//*************************************************************************************************************
+
+void NewRealTimeMultiSampleArray::setTriggerDecoding(int iMask, bool bDecodeBits, int iMinDuration)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_triggerDetector.setBitMask(iMask, bDecodeBits);
+    m_triggerDetector.setMinDuration(iMinDuration);
+}
+
+
+//*************************************************************************************************************
+
+const QList< MatrixXd >& NewRealTimeMultiSampleArray::getMultiSampleArray()
+{
+    QMutexLocker locker(&m_qMutex);
+
+    if(m_matSamples.size() != m_qListBlocks.size()) {
+        m_matSamples.clear();
+        for(qint32 i = 0; i < m_qListBlocks.size(); ++i)
+            m_matSamples.append(m_qListBlocks[i]->toDouble());
+    }
+
+    return m_matSamples;
+}
+
+
+//*************************************************************************************************************
+
+MeasurementBlock::SPtr NewRealTimeMultiSampleArray::acquireBlock(MeasurementBlock::Precision precision, int iRows, int iCols)
+{
+    return m_pBlockPool->acquire(precision, iRows, iCols);
+}
+
+
 //*************************************************************************************************************
 
 void NewRealTimeMultiSampleArray::setValue(const MatrixXd& mat)
@@ -243,9 +293,23 @@ void NewRealTimeMultiSampleArray::setValue(const MatrixXd& mat)
     if(!m_bChInfoIsInit)
         return;
 
+    MeasurementBlock::SPtr pBlock = m_pBlockPool->acquire(MeasurementBlock::Float64, mat.rows(), mat.cols());
+    pBlock->dataDouble() = mat;
+
+    setValue(MeasurementBlock::ConstSPtr(pBlock));
+}
+
+
+//*************************************************************************************************************
+
+void NewRealTimeMultiSampleArray::setValue(const MeasurementBlock::ConstSPtr& pBlock)
+{
+    if(!m_bChInfoIsInit || !pBlock)
+        return;
+
     m_qMutex.lock();
     //check vector size
-    if(mat.rows() != m_qListChInfo.size())
+    if(pBlock->rows() != m_qListChInfo.size())
         qCritical() << "Error Occured in RealTimeMultiSampleArrayNew::setVector: Vector size does not match the number of channels! ";
 
     //ToDo
@@ -256,17 +320,29 @@ void NewRealTimeMultiSampleArray::setValue(const MatrixXd& mat)
 //        else if(v[i] > m_qListChInfo[i].getMaxValue()) v[i] = m_qListChInfo[i].getMaxValue();
 //    }
 
-    //Store
-    m_matSamples.push_back(mat);
+    //Detect the trigger events once for all observers
+    if(!m_triggerDetector.triggerChannels().isEmpty() && pBlock->rows() == m_qListChInfo.size())
+        m_qListPendingTriggerEvents.append(m_triggerDetector.detect(pBlock->toDouble()));
 
-    m_qMutex.unlock();
-    if(m_matSamples.size() >= m_iMultiArraySize)
+    //Store - only the reference, the block is shared with all observers
+    m_qListPendingBlocks.append(pBlock);
+
+    //Publish: the previous multi sample array is released here, unless an observer still holds its blocks
+    bool bPublish = m_qListPendingBlocks.size() >= m_iMultiArraySize;
+    if(bPublish)
     {
-        emit notify();
-        m_qMutex.lock();
+        m_qListBlocks = m_qListPendingBlocks;
+        m_qListPendingBlocks.clear();
         m_matSamples.clear();
-        m_qMutex.unlock();
+        m_qListTriggerEvents = m_qListPendingTriggerEvents;
+        m_qListPendingTriggerEvents.clear();
+        m_iFirstSample = m_iPendingFirstSample;
+        m_iPendingFirstSample = m_triggerDetector.samplesProcessed();
     }
+    m_qMutex.unlock();
+
+    if(bPublish)
+        emit notify();
 }
 
 
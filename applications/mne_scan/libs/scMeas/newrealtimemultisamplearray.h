@@ -44,10 +44,13 @@
 
 #include "scmeas_global.h"
 #include "newmeasurement.h"
+#include "measurementblock.h"
 #include "realtimesamplearraychinfo.h"
 
 #include <fiff/fiff_info.h>
 
+#include <utils/streamtriggerdetector.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -223,20 +226,83 @@ public:
 
     //=========================================================================================================
     /**
-    * Returns the gathered multi sample array.
+    * Returns the gathered multi sample array as double precision copies. The copies are created once per
+    * multi sample array on first request. Prefer getMultiSampleBlocks, which shares the data without copying.
     *
     * @return the current multi sample array.
     */
-    inline const QList< MatrixXd >& getMultiSampleArray();
+    const QList< MatrixXd >& getMultiSampleArray();
+
+    //=========================================================================================================
+    /**
+    * Returns the blocks of the current multi sample array. The blocks are immutable and shared by all
+    * observers; an observer may keep them beyond the notification, they stay valid as long as they are held.
+    *
+    * @return the blocks of the current multi sample array.
+    */
+    inline QList<MeasurementBlock::ConstSPtr> getMultiSampleBlocks() const;
+
+    //=========================================================================================================
+    /**
+    * Returns a writable block from the pool of this measurement. Fill it and pass it to setValue, blocks of
+    * released multi sample arrays are reused so that a producer does not allocate in steady state.
+    *
+    * @param[in] precision  the storage precision.
+    * @param[in] iRows      number of channels.
+    * @param[in] iCols      number of samples.
+    *
+    * @return the block.
+    */
+    MeasurementBlock::SPtr acquireBlock(MeasurementBlock::Precision precision, int iRows, int iCols);
 
     //=========================================================================================================
     /**
-    * Attaches a value to the sample array list.
+    * Returns the trigger events found in the stimulus channels of the current multi sample array. The
+    * detection runs once when the data is attached, so that all observers share the same events instead of
+    * scanning the stimulus channels themselves. A copy is returned since the events are replaced by the
+    * producer thread.
+    *
+    * @return the trigger events of the current multi sample array.
+    */
+    inline QList<UTILSLIB::TriggerEvent> getTriggerEvents() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the absolute sample index of the first sample of the current multi sample array. The sample
+    * indices of the trigger events refer to the same origin.
+    *
+    * @return the absolute index of the first sample of the current multi sample array.
+    */
+    inline qint64 getFirstSample() const;
+
+    //=========================================================================================================
+    /**
+    * Configures the decoding of the stimulus channels, e.g. to report the bits of STI101 style composite
+    * channels separately or to suppress glitches. See UTILSLIB::StreamTriggerDetector.
+    *
+    * @param[in] iMask          The bit mask applied to the stimulus channel values.
+    * @param[in] bDecodeBits    Whether newly set bits are reported as separate events.
+    * @param[in] iMinDuration   Minimal number of samples a code has to persist.
+    */
+    void setTriggerDecoding(int iMask, bool bDecodeBits, int iMinDuration = 1);
+
+    //=========================================================================================================
+    /**
+    * Attaches a value to the sample array list. The value is copied into a pooled block, producers which
+    * can fill a block directly should use acquireBlock and the block overload instead.
     *
     * @param [in] mat   the value which is attached to the sample array list.
     */
     virtual void setValue(const MatrixXd& mat);
 
+    //=========================================================================================================
+    /**
+    * Attaches a block to the sample array list without copying. The block must not be modified afterwards.
+    *
+    * @param [in] pBlock    the block which is attached to the sample array list.
+    */
+    void setValue(const MeasurementBlock::ConstSPtr& pBlock);
+
     //=========================================================================================================
     /**
     * Attaches a value to the sample array vector.
@@ -255,7 +321,15 @@ private:
     double                      m_dSamplingRate;    /**< Sampling rate of the RealTimeSampleArray.*/
 //    MatrixXd                    m_vecValue;         /**< The current attached sample vector.*/
     qint32                      m_iMultiArraySize; /**< Sample size of the multi sample array.*/
-    QList< MatrixXd >           m_matSamples;       /**< The multi sample array.*/
+    MeasurementBlockPool::SPtr  m_pBlockPool;       /**< Pool of the blocks.*/
+    QList<MeasurementBlock::ConstSPtr> m_qListPendingBlocks;    /**< Blocks gathered for the next multi sample array.*/
+    QList<MeasurementBlock::ConstSPtr> m_qListBlocks;           /**< The blocks of the current multi sample array.*/
+    QList< MatrixXd >           m_matSamples;       /**< Double precision copies of the current multi sample array, only created on request.*/
+    UTILSLIB::StreamTriggerDetector m_triggerDetector;  /**< Detects the trigger events of the stimulus channels across block boundaries.*/
+    QList<UTILSLIB::TriggerEvent> m_qListPendingTriggerEvents;  /**< The trigger events of the pending blocks.*/
+    QList<UTILSLIB::TriggerEvent> m_qListTriggerEvents; /**< The trigger events of the multi sample array.*/
+    qint64                      m_iPendingFirstSample;  /**< Absolute index of the first sample of the pending blocks.*/
+    qint64                      m_iFirstSample;     /**< Absolute index of the first sample of the multi sample array.*/
     QList<RealTimeSampleArrayChInfo> m_qListChInfo; /**< Channel info list.*/
     bool                        m_bChInfoIsInit;    /**< If channel info is initialized.*/
 };
@@ -269,7 +343,13 @@ private:
 inline void NewRealTimeMultiSampleArray::clear()
 {
     QMutexLocker locker(&m_qMutex);
+    m_qListPendingBlocks.clear();
+    m_qListBlocks.clear();
     m_matSamples.clear();
+    m_qListPendingTriggerEvents.clear();
+    m_qListTriggerEvents.clear();
+    m_iPendingFirstSample = m_triggerDetector.samplesProcessed();
+    m_iFirstSample = m_iPendingFirstSample;
 }
 
 
@@ -387,9 +467,28 @@ qint32 NewRealTimeMultiSampleArray::getMultiArraySize() const
 
 //*************************************************************************************************************
 
-inline const QList< MatrixXd >& NewRealTimeMultiSampleArray::getMultiSampleArray()
+inline QList<MeasurementBlock::ConstSPtr> NewRealTimeMultiSampleArray::getMultiSampleBlocks() const
 {
-    return m_matSamples;
+    QMutexLocker locker(&m_qMutex);
+    return m_qListBlocks;
+}
+
+
+//*************************************************************************************************************
+
+inline QList<UTILSLIB::TriggerEvent> NewRealTimeMultiSampleArray::getTriggerEvents() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_qListTriggerEvents;
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 NewRealTimeMultiSampleArray::getFirstSample() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_iFirstSample;
 }
 
 } // NAMESPACE
@@ -86,7 +86,9 @@ SOURCES += \
     measurementtypes.cpp \
     realtimeevoked.cpp \
     realtimecov.cpp \
-    frequencyspectrum.cpp
+    frequencyspectrum.cpp \
+    measurementblock.cpp \
+    blockcoalescer.cpp
 
 
 HEADERS += \
@@ -100,7 +102,9 @@ HEADERS += \
     measurementtypes.h \
     realtimeevoked.h \
     realtimecov.h \
-    frequencyspectrum.h
+    frequencyspectrum.h \
+    measurementblock.h \
+    blockcoalescer.h
 
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
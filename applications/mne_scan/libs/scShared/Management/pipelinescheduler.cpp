@@ -0,0 +1,328 @@
+//=============================================================================================================
+/**
+* @file     pipelinescheduler.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     PipelineScheduler class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "pipelinescheduler.h"
+#include "pipelinetracer.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QThread>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCSHAREDLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCSHAREDLIB
+//=============================================================================================================
+
+namespace SCSHAREDLIB
+{
+
+//=============================================================================================================
+/**
+* Worker thread of the PipelineScheduler.
+*/
+class PipelineSchedulerWorker : public QThread
+{
+public:
+    PipelineSchedulerWorker(PipelineScheduler* pScheduler, int iWorker)
+    : m_pScheduler(pScheduler)
+    , m_iWorker(iWorker)
+    {
+    }
+
+protected:
+    virtual void run()
+    {
+        m_pScheduler->workerLoop(m_iWorker);
+    }
+
+private:
+    PipelineScheduler*  m_pScheduler;   /**< The pool the worker belongs to. */
+    int                 m_iWorker;      /**< Index of the worker and its deque. */
+};
+
+} // NAMESPACE
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DATA
+//=============================================================================================================
+
+namespace
+{
+    QAtomicInt s_iEnabled(-1);  /**< -1 until the environment was read, 0 or 1 afterwards. */
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+PipelineScheduler::PipelineScheduler(int iNumThreads)
+: m_iNextQueue(0)
+, m_iNumPending(0)
+, m_iStop(0)
+{
+    for(int i = 0; i < iNumThreads; ++i) {
+        m_qVecQueues.append(new WorkerQueue);
+    }
+
+    for(int i = 0; i < iNumThreads; ++i) {
+        QThread* pWorker = new PipelineSchedulerWorker(this, i);
+        PipelineTracer::instance()->watchThread(pWorker, QString("Scheduler Worker %1").arg(i));
+        m_qVecWorkers.append(pWorker);
+    }
+
+    //Start after all workers are known, the workers look themselves up in m_qVecWorkers
+    for(int i = 0; i < m_qVecWorkers.size(); ++i) {
+        m_qVecWorkers[i]->start();
+    }
+}
+
+
+//*************************************************************************************************************
+
+PipelineScheduler::~PipelineScheduler()
+{
+    m_iStop.store(1);
+
+    m_qSleepMutex.lock();
+    m_qWakeCondition.wakeAll();
+    m_qSleepMutex.unlock();
+
+    for(int i = 0; i < m_qVecWorkers.size(); ++i) {
+        m_qVecWorkers[i]->wait();
+    }
+
+    qDeleteAll(m_qVecWorkers);
+    qDeleteAll(m_qVecQueues);
+}
+
+
+//*************************************************************************************************************
+
+PipelineScheduler* PipelineScheduler::instance()
+{
+    static PipelineScheduler s_scheduler(qMax(2, QThread::idealThreadCount()));
+    return &s_scheduler;
+}
+
+
+//*************************************************************************************************************
+
+bool PipelineScheduler::isEnabled()
+{
+    int iEnabled = s_iEnabled.load();
+
+    if(iEnabled < 0) {
+        iEnabled = qgetenv("MNE_SCAN_SCHEDULER").isEmpty() ? 0 : 1;
+        s_iEnabled.store(iEnabled);
+    }
+
+    return iEnabled == 1;
+}
+
+
+//*************************************************************************************************************
+
+void PipelineScheduler::setEnabled(bool bEnabled)
+{
+    s_iEnabled.store(bEnabled ? 1 : 0);
+}
+
+
+//*************************************************************************************************************
+
+bool PipelineScheduler::isWorkerThread() const
+{
+    return m_qVecWorkers.contains(QThread::currentThread());
+}
+
+
+//*************************************************************************************************************
+
+void PipelineScheduler::submit(const Task& task)
+{
+    int iWorker = m_qVecWorkers.indexOf(QThread::currentThread());
+
+    if(iWorker < 0) {
+        iWorker = (m_iNextQueue.fetchAndAddRelaxed(1) & 0x7fffffff) % m_qVecQueues.size();
+    }
+
+    WorkerQueue* pQueue = m_qVecQueues[iWorker];
+    pQueue->mutex.lock();
+    pQueue->deque.push_back(task);
+    pQueue->mutex.unlock();
+
+    m_iNumPending.ref();
+
+    m_qSleepMutex.lock();
+    m_qWakeCondition.wakeOne();
+    m_qSleepMutex.unlock();
+}
+
+
+//*************************************************************************************************************
+
+void PipelineScheduler::parallelFor(int iBegin, int iEnd, int iGrainSize, const RangeTask& func)
+{
+    if(iEnd <= iBegin) {
+        return;
+    }
+
+    if(iGrainSize < 1) {
+        iGrainSize = qMax(1, (iEnd - iBegin) / (4 * numThreads()));
+    }
+
+    int iNumChunks = (iEnd - iBegin + iGrainSize - 1) / iGrainSize;
+
+    if(iNumChunks == 1) {
+        func(iBegin, iEnd);
+        return;
+    }
+
+    //The chunk tasks only reference the caller's stack, which stays valid since the caller waits for all chunks
+    QAtomicInt iRemaining(iNumChunks - 1);
+
+    for(int i = 1; i < iNumChunks; ++i) {
+        int iChunkBegin = iBegin + i * iGrainSize;
+        int iChunkEnd = qMin(iEnd, iChunkBegin + iGrainSize);
+
+        submit([&func, &iRemaining, iChunkBegin, iChunkEnd]() {
+            func(iChunkBegin, iChunkEnd);
+            iRemaining.deref();
+        });
+    }
+
+    func(iBegin, qMin(iEnd, iBegin + iGrainSize));
+
+    //Help with the remaining chunks (or any other work) instead of blocking a worker
+    int iWorker = m_qVecWorkers.indexOf(QThread::currentThread());
+    Task task;
+
+    while(iRemaining.load() > 0) {
+        if(takeTask(iWorker, task)) {
+            task();
+            task = Task();
+        } else {
+            QThread::yieldCurrentThread();
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void PipelineScheduler::workerLoop(int iWorker)
+{
+    Task task;
+
+    while(!m_iStop.load()) {
+        if(takeTask(iWorker, task)) {
+            task();
+            task = Task();
+            continue;
+        }
+
+        m_qSleepMutex.lock();
+        if(m_iNumPending.load() == 0 && !m_iStop.load()) {
+            //Timed wait guards against missed wake-ups between the check and the wait
+            m_qWakeCondition.wait(&m_qSleepMutex, 50);
+        }
+        m_qSleepMutex.unlock();
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool PipelineScheduler::takeTask(int iWorker, Task& task)
+{
+    if(m_iNumPending.load() == 0) {
+        return false;
+    }
+
+    //Own deque first, newest task first to keep the data in the cache
+    if(iWorker >= 0) {
+        WorkerQueue* pQueue = m_qVecQueues[iWorker];
+        QMutexLocker locker(&pQueue->mutex);
+
+        if(!pQueue->deque.empty()) {
+            task = pQueue->deque.back();
+            pQueue->deque.pop_back();
+            m_iNumPending.deref();
+            return true;
+        }
+    }
+
+    //Steal the oldest task of another worker
+    int iNumQueues = m_qVecQueues.size();
+    int iStart = iWorker >= 0 ? iWorker + 1 : 0;
+
+    for(int i = 0; i < iNumQueues; ++i) {
+        WorkerQueue* pQueue = m_qVecQueues[(iStart + i) % iNumQueues];
+        QMutexLocker locker(&pQueue->mutex);
+
+        if(!pQueue->deque.empty()) {
+            task = pQueue->deque.front();
+            pQueue->deque.pop_front();
+            m_iNumPending.deref();
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,231 @@
+//=============================================================================================================
+/**
+* @file     pipelinescheduler.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     PipelineScheduler class declaration.
+*
+*/
+
+#ifndef PIPELINESCHEDULER_H
+#define PIPELINESCHEDULER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../scshared_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <functional>
+#include <deque>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class QThread;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCSHAREDLIB
+//=============================================================================================================
+
+namespace SCSHAREDLIB
+{
+
+
+//=============================================================================================================
+/**
+* Shared work-stealing thread pool of the plugin graph. Each worker owns a task deque: tasks submitted from a
+* worker are pushed to and popped from the back of its own deque, idle workers steal from the front of the
+* others. Tasks submitted from other threads are distributed round-robin. Plugins do not use the pool directly
+* for their blocks but post them to a PipelineStage, which keeps the blocks of one stage in order while
+* different stages run in parallel. Within a task, parallelFor splits the work of a stage, e.g. per channel.
+*
+* The task based execution is optional. Plugins which support it check isEnabled() on start, which is true if
+* the environment variable MNE_SCAN_SCHEDULER is set.
+*
+* @brief Work-stealing pool for the task based execution of plugins
+*/
+class SCSHAREDSHARED_EXPORT PipelineScheduler
+{
+public:
+    typedef std::function<void()> Task;                 /**< A unit of work. */
+    typedef std::function<void(int, int)> RangeTask;    /**< Work on the index range [begin, end). */
+
+    //=========================================================================================================
+    /**
+    * Returns the process wide pool. The pool is created on first use with one worker per core.
+    *
+    * @return the pool.
+    */
+    static PipelineScheduler* instance();
+
+    //=========================================================================================================
+    /**
+    * Returns whether plugins should use the task based execution instead of their own threads.
+    *
+    * @return true if enabled.
+    */
+    static bool isEnabled();
+
+    //=========================================================================================================
+    /**
+    * Enables or disables the task based execution. Only affects plugins started afterwards.
+    *
+    * @param[in] bEnabled   whether to use the task based execution.
+    */
+    static void setEnabled(bool bEnabled);
+
+    //=========================================================================================================
+    /**
+    * Stops and joins all workers. Tasks which were not started yet are discarded.
+    */
+    ~PipelineScheduler();
+
+    //=========================================================================================================
+    /**
+    * Returns the number of workers.
+    *
+    * @return the number of workers.
+    */
+    inline int numThreads() const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether the calling thread is one of the workers, i.e. whether the caller runs inside a task.
+    *
+    * @return true if called from a worker.
+    */
+    bool isWorkerThread() const;
+
+    //=========================================================================================================
+    /**
+    * Schedules a task. The task runs on one of the workers.
+    *
+    * @param[in] task   the task.
+    */
+    void submit(const Task& task);
+
+    //=========================================================================================================
+    /**
+    * Splits [iBegin, iEnd) into chunks of iGrainSize indices and runs func on all chunks in parallel. The
+    * calling thread works on the chunks as well and returns when all chunks are done.
+    *
+    * @param[in] iBegin         first index.
+    * @param[in] iEnd           one past the last index.
+    * @param[in] iGrainSize     number of indices per chunk, values < 1 select a size which yields a few chunks per worker.
+    * @param[in] func           called with the bounds of each chunk.
+    */
+    void parallelFor(int iBegin, int iEnd, int iGrainSize, const RangeTask& func);
+
+private:
+    friend class PipelineSchedulerWorker;
+
+    /**
+    * Task deque of one worker.
+    */
+    struct WorkerQueue
+    {
+        QMutex          mutex;      /**< Guards the deque. */
+        std::deque<Task> deque;     /**< Tasks of the worker, the owner works at the back, thieves at the front. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Creates the pool.
+    *
+    * @param[in] iNumThreads    number of workers.
+    */
+    explicit PipelineScheduler(int iNumThreads);
+
+    //=========================================================================================================
+    /**
+    * Main loop of a worker.
+    *
+    * @param[in] iWorker    index of the worker.
+    */
+    void workerLoop(int iWorker);
+
+    //=========================================================================================================
+    /**
+    * Takes the next task, from the own deque first and stolen from the other deques otherwise.
+    *
+    * @param[in] iWorker    index of the calling worker, -1 for threads which are not part of the pool.
+    * @param[out] task      the task.
+    *
+    * @return true if a task was found.
+    */
+    bool takeTask(int iWorker, Task& task);
+
+    QVector<WorkerQueue*>   m_qVecQueues;       /**< One deque per worker. */
+    QVector<QThread*>       m_qVecWorkers;      /**< The workers. */
+    QAtomicInt              m_iNextQueue;       /**< Round-robin position for tasks submitted from outside. */
+    QAtomicInt              m_iNumPending;      /**< Number of queued tasks. */
+    QAtomicInt              m_iStop;            /**< Set to stop the workers. */
+    QMutex                  m_qSleepMutex;      /**< Guards the sleeping of idle workers. */
+    QWaitCondition          m_qWakeCondition;   /**< Wakes idle workers when tasks are submitted. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int PipelineScheduler::numThreads() const
+{
+    return m_qVecWorkers.size();
+}
+
+} // NAMESPACE
+
+#endif // PIPELINESCHEDULER_H
@@ -0,0 +1,192 @@
+//=============================================================================================================
+/**
+* @file     pipelinestage.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     PipelineStage class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "pipelinestage.h"
+#include "pipelinetracer.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCSHAREDLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+PipelineStage::PipelineStage(const QString& sName, int iMaxQueuedTasks)
+: m_sName(sName)
+, m_iMaxQueuedTasks(qMax(1, iMaxQueuedTasks))
+, m_iNumDropped(0)
+, m_bScheduled(false)
+{
+    PipelineTracer::instance()->registerQueue(m_sName + " Stage",
+                                              [this]() { return static_cast<qint32>(numQueuedTasks()); },
+                                              m_iMaxQueuedTasks);
+}
+
+
+//*************************************************************************************************************
+
+PipelineStage::~PipelineStage()
+{
+    PipelineTracer::instance()->unregisterQueue(m_sName + " Stage");
+
+    waitForIdle();
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStage::post(const PipelineScheduler::Task& task)
+{
+    //A worker waiting for space could hold the very worker the stage needs to drain its queue
+    Q_ASSERT_X(!PipelineScheduler::instance()->isWorkerThread(), "PipelineStage::post", "called from a task, use tryPost");
+
+    QMutexLocker locker(&m_qMutex);
+
+    //Backpressure: the producer waits for the stage instead of losing blocks
+    while(static_cast<int>(m_queTasks.size()) >= m_iMaxQueuedTasks) {
+        m_qNotFullCondition.wait(&m_qMutex);
+    }
+
+    enqueue(task);
+}
+
+
+//*************************************************************************************************************
+
+bool PipelineStage::tryPost(const PipelineScheduler::Task& task)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    if(static_cast<int>(m_queTasks.size()) >= m_iMaxQueuedTasks) {
+        ++m_iNumDropped;
+        return false;
+    }
+
+    enqueue(task);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStage::waitForIdle()
+{
+    QMutexLocker locker(&m_qMutex);
+
+    while(m_bScheduled) {
+        m_qIdleCondition.wait(&m_qMutex);
+    }
+}
+
+
+//*************************************************************************************************************
+
+int PipelineStage::numQueuedTasks() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return static_cast<int>(m_queTasks.size());
+}
+
+
+//*************************************************************************************************************
+
+int PipelineStage::numDroppedTasks() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_iNumDropped;
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStage::runBatch()
+{
+    PipelineTracer* pTracer = PipelineTracer::instance();
+
+    //Give the worker back to the pool after a few tasks, so that one busy stage cannot starve the others
+    for(int i = 0; i < 16; ++i) {
+        m_qMutex.lock();
+        PipelineScheduler::Task task = m_queTasks.front();
+        m_qMutex.unlock();
+
+        qint64 iStart = pTracer->isEnabled() ? PipelineTracer::now() : 0;
+
+        task();
+
+        if(iStart) {
+            pTracer->recordSlice(m_sName, QStringLiteral("stage"), iStart, PipelineTracer::now());
+        }
+
+        QMutexLocker locker(&m_qMutex);
+        m_queTasks.pop_front();
+        m_qNotFullCondition.wakeAll();
+
+        if(m_queTasks.empty()) {
+            m_bScheduled = false;
+            m_qIdleCondition.wakeAll();
+            return;
+        }
+    }
+
+    PipelineScheduler::instance()->submit([this]() { runBatch(); });
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStage::enqueue(const PipelineScheduler::Task& task)
+{
+    m_queTasks.push_back(task);
+
+    if(!m_bScheduled) {
+        m_bScheduled = true;
+        PipelineScheduler::instance()->submit([this]() { runBatch(); });
+    }
+}
@@ -0,0 +1,196 @@
+//=============================================================================================================
+/**
+* @file     pipelinestage.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     PipelineStage class declaration.
+*
+*/
+
+#ifndef PIPELINESTAGE_H
+#define PIPELINESTAGE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../scshared_global.h"
+#include "pipelinescheduler.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QString>
+#include <QMutex>
+#include <QWaitCondition>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <deque>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCSHAREDLIB
+//=============================================================================================================
+
+namespace SCSHAREDLIB
+{
+
+
+//=============================================================================================================
+/**
+* Serial task queue of one plugin on the PipelineScheduler. The tasks of a stage run one after the other and in
+* the order they were posted, but not on a dedicated thread: while the stage has work it occupies one worker of
+* the pool, so the stages of a pipeline process consecutive blocks in parallel. The number of queued tasks is
+* bounded; when a stage falls behind, post blocks the producing thread until a task is done, so that no block is
+* lost. Therefore post may only be called from producer threads outside of the pool. tryPost drops and counts the
+* task instead, for producers which must not wait, e.g. tasks which feed the next stage.
+*
+* @brief In-order task queue of a plugin on the shared pool
+*/
+class SCSHAREDSHARED_EXPORT PipelineStage
+{
+public:
+    typedef QSharedPointer<PipelineStage> SPtr;             /**< Shared pointer type for PipelineStage. */
+    typedef QSharedPointer<const PipelineStage> ConstSPtr;  /**< Const shared pointer type for PipelineStage. */
+
+    //=========================================================================================================
+    /**
+    * Creates the stage and registers its queue with the PipelineTracer.
+    *
+    * @param[in] sName              name of the stage, usually the plugin name.
+    * @param[in] iMaxQueuedTasks    number of tasks which can be queued before post blocks.
+    */
+    explicit PipelineStage(const QString& sName, int iMaxQueuedTasks = 64);
+
+    //=========================================================================================================
+    /**
+    * Waits for the queued tasks and unregisters the stage.
+    */
+    ~PipelineStage();
+
+    //=========================================================================================================
+    /**
+    * Appends a task to the stage, blocks while the queue is full. May only be called from threads which are not
+    * workers of the PipelineScheduler, since a blocked worker can deadlock the pool. Use tryPost inside tasks.
+    *
+    * @param[in] task   the task.
+    */
+    void post(const PipelineScheduler::Task& task);
+
+    //=========================================================================================================
+    /**
+    * Appends a task to the stage if the queue is not full. Never blocks, so it can be called from inside a task.
+    *
+    * @param[in] task   the task.
+    *
+    * @return false if the queue was full and the task was dropped.
+    */
+    bool tryPost(const PipelineScheduler::Task& task);
+
+    //=========================================================================================================
+    /**
+    * Blocks until all queued tasks are done.
+    */
+    void waitForIdle();
+
+    //=========================================================================================================
+    /**
+    * Returns the number of queued tasks, including the running one.
+    *
+    * @return the number of queued tasks.
+    */
+    int numQueuedTasks() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of tasks dropped by tryPost because the queue was full.
+    *
+    * @return the number of dropped tasks.
+    */
+    int numDroppedTasks() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the name of the stage.
+    *
+    * @return the name.
+    */
+    inline QString name() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Runs a batch of queued tasks on the pool and resubmits itself if more tasks are queued.
+    */
+    void runBatch();
+
+    //=========================================================================================================
+    /**
+    * Appends a task and submits a batch if none is scheduled. m_qMutex has to be locked.
+    *
+    * @param[in] task   the task.
+    */
+    void enqueue(const PipelineScheduler::Task& task);
+
+    QString                             m_sName;            /**< Name of the stage. */
+    int                                 m_iMaxQueuedTasks;  /**< Maximum number of queued tasks. */
+    int                                 m_iNumDropped;      /**< Number of dropped tasks. */
+    bool                                m_bScheduled;       /**< Whether a batch is submitted to or running on the pool. */
+    std::deque<PipelineScheduler::Task> m_queTasks;         /**< The queued tasks, the running task stays at the front. */
+    mutable QMutex                      m_qMutex;           /**< Guards the queue. */
+    QWaitCondition                      m_qIdleCondition;   /**< Signaled when the queue runs empty. */
+    QWaitCondition                      m_qNotFullCondition;/**< Signaled when a task is done and the queue has space again. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline QString PipelineStage::name() const
+{
+    return m_sName;
+}
+
+} // NAMESPACE
+
+#endif // PIPELINESTAGE_H
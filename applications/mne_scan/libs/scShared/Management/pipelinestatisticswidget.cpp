@@ -0,0 +1,195 @@
+//=============================================================================================================
+/**
+* @file     pipelinestatisticswidget.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Definition of the PipelineStatisticsWidget class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "pipelinestatisticswidget.h"
+#include "pipelinetracer.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QGridLayout>
+#include <QLabel>
+#include <QTimer>
+#include <QFileDialog>
+#include <QMessageBox>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCSHAREDLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+PipelineStatisticsWidget::PipelineStatisticsWidget(QWidget *parent)
+: QWidget(parent)
+{
+    m_pCheckBoxRecord = new QCheckBox(tr("Record"), this);
+    m_pCheckBoxRecord->setChecked(PipelineTracer::instance()->isEnabled());
+    m_pButtonClear = new QPushButton(tr("Clear"), this);
+    m_pButtonExport = new QPushButton(tr("Export Trace..."), this);
+
+    m_pTableLatency = new QTableWidget(0, 6, this);
+    m_pTableLatency->setHorizontalHeaderLabels(QStringList() << tr("Input") << tr("Last [ms]") << tr("Mean [ms]") << tr("P95 [ms]") << tr("Max [ms]") << tr("Count"));
+    m_pTableLatency->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_pTableLatency->verticalHeader()->hide();
+    m_pTableLatency->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    m_pTableLoad = new QTableWidget(0, 3, this);
+    m_pTableLoad->setHorizontalHeaderLabels(QStringList() << tr("Thread / Buffer") << tr("Load / Depth") << tr("Total"));
+    m_pTableLoad->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_pTableLoad->verticalHeader()->hide();
+    m_pTableLoad->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    QGridLayout *layout = new QGridLayout;
+    layout->setMargin(5);
+    layout->addWidget(m_pCheckBoxRecord, 0, 0);
+    layout->addWidget(m_pButtonClear, 0, 1);
+    layout->addWidget(m_pButtonExport, 0, 2);
+    layout->addWidget(new QLabel(tr("End-to-end latency since acquisition"), this), 1, 0, 1, 3);
+    layout->addWidget(m_pTableLatency, 2, 0, 1, 3);
+    layout->addWidget(new QLabel(tr("Plugin threads and buffers"), this), 3, 0, 1, 3);
+    layout->addWidget(m_pTableLoad, 4, 0, 1, 3);
+    this->setLayout(layout);
+
+    m_pTimer = new QTimer(this);
+
+    connect(m_pTimer, &QTimer::timeout, this, &PipelineStatisticsWidget::updateStatistics);
+    connect(m_pCheckBoxRecord, &QCheckBox::toggled, this, &PipelineStatisticsWidget::onRecordToggled);
+    connect(m_pButtonClear, &QPushButton::clicked, this, [this]() {
+        PipelineTracer::instance()->clear();
+        updateStatistics();
+    });
+    connect(m_pButtonExport, &QPushButton::clicked, this, &PipelineStatisticsWidget::onExportTrace);
+
+    m_pTimer->start(500);
+}
+
+
+//*************************************************************************************************************
+
+PipelineStatisticsWidget::~PipelineStatisticsWidget()
+{
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatisticsWidget::updateStatistics()
+{
+    if(!isVisible())
+        return;
+
+    PipelineTracer* pTracer = PipelineTracer::instance();
+
+    QMap<QString, PipelineLatencyHistogram> qMapLatencies = pTracer->latencies();
+    m_pTableLatency->setRowCount(qMapLatencies.size());
+
+    qint32 iRow = 0;
+    QMap<QString, PipelineLatencyHistogram>::const_iterator itLatency;
+    for(itLatency = qMapLatencies.constBegin(); itLatency != qMapLatencies.constEnd(); ++itLatency, ++iRow) {
+        const PipelineLatencyHistogram& histogram = itLatency.value();
+
+        m_pTableLatency->setItem(iRow, 0, new QTableWidgetItem(itLatency.key()));
+        m_pTableLatency->setItem(iRow, 1, new QTableWidgetItem(QString::number(histogram.dLastMs, 'f', 2)));
+        m_pTableLatency->setItem(iRow, 2, new QTableWidgetItem(QString::number(histogram.mean(), 'f', 2)));
+        m_pTableLatency->setItem(iRow, 3, new QTableWidgetItem(QString::number(histogram.percentile(0.95), 'f', 2)));
+        m_pTableLatency->setItem(iRow, 4, new QTableWidgetItem(QString::number(histogram.dMaxMs, 'f', 2)));
+        m_pTableLatency->setItem(iRow, 5, new QTableWidgetItem(QString::number(histogram.iCount)));
+    }
+
+    QMap<QString, PipelineThreadLoad> qMapLoads = pTracer->threadLoads();
+    QMap<QString, PipelineQueueDepth> qMapDepths = pTracer->queueDepths();
+    m_pTableLoad->setRowCount(qMapLoads.size() + qMapDepths.size());
+
+    iRow = 0;
+    QMap<QString, PipelineThreadLoad>::const_iterator itLoad;
+    for(itLoad = qMapLoads.constBegin(); itLoad != qMapLoads.constEnd(); ++itLoad, ++iRow) {
+        bool bSupported = itLoad.value().dCpuMs >= 0;
+
+        m_pTableLoad->setItem(iRow, 0, new QTableWidgetItem(itLoad.key()));
+        m_pTableLoad->setItem(iRow, 1, new QTableWidgetItem(bSupported ? QString("%1 %").arg(100.0 * itLoad.value().dLoad, 0, 'f', 1) : tr("n/a")));
+        m_pTableLoad->setItem(iRow, 2, new QTableWidgetItem(bSupported ? QString("%1 s CPU").arg(itLoad.value().dCpuMs / 1000.0, 0, 'f', 2) : tr("n/a")));
+    }
+
+    QMap<QString, PipelineQueueDepth>::const_iterator itDepth;
+    for(itDepth = qMapDepths.constBegin(); itDepth != qMapDepths.constEnd(); ++itDepth, ++iRow) {
+        m_pTableLoad->setItem(iRow, 0, new QTableWidgetItem(itDepth.key()));
+        m_pTableLoad->setItem(iRow, 1, new QTableWidgetItem(QString("%1 / %2").arg(itDepth.value().iDepth).arg(itDepth.value().iCapacity)));
+        m_pTableLoad->setItem(iRow, 2, new QTableWidgetItem(tr("max %1").arg(itDepth.value().iMaxDepth)));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatisticsWidget::onRecordToggled(bool bChecked)
+{
+    PipelineTracer::instance()->setEnabled(bChecked);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatisticsWidget::onExportTrace()
+{
+    QString sFileName = QFileDialog::getSaveFileName(this, tr("Export Trace"), "mne_scan_trace.json", tr("Chrome Trace (*.json)"));
+
+    if(sFileName.isEmpty())
+        return;
+
+    if(!PipelineTracer::instance()->writeChromeTrace(sFileName))
+        QMessageBox::warning(this, tr("Export Trace"), tr("Could not write %1.").arg(sFileName));
+}
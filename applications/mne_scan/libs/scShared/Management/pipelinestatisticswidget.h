@@ -0,0 +1,134 @@
+//=============================================================================================================
+/**
+* @file     pipelinestatisticswidget.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     PipelineStatisticsWidget class declaration.
+*
+*/
+
+#ifndef PIPELINESTATISTICSWIDGET_H
+#define PIPELINESTATISTICSWIDGET_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../scshared_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QWidget>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class QTableWidget;
+class QCheckBox;
+class QPushButton;
+class QTimer;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCSHAREDLIB
+//=============================================================================================================
+
+namespace SCSHAREDLIB
+{
+
+
+//=============================================================================================================
+/**
+* Shows the statistics gathered by the PipelineTracer: the end-to-end latency of each input connector, the CPU
+* load of each plugin thread and the fill level of each registered buffer. Allows to toggle the recording and to
+* export the trace.
+*
+* @brief The PipelineStatisticsWidget class provides the overlay of the pipeline instrumentation
+*/
+class SCSHAREDSHARED_EXPORT PipelineStatisticsWidget : public QWidget
+{
+    Q_OBJECT
+public:
+
+    //=========================================================================================================
+    /**
+    * Constructs a PipelineStatisticsWidget which is a child of parent.
+    *
+    * @param [in] parent    pointer to parent widget.
+    */
+    PipelineStatisticsWidget(QWidget *parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Destructor
+    */
+    ~PipelineStatisticsWidget();
+
+private:
+    //=========================================================================================================
+    /**
+    * Refreshes the tables from the current statistics of the tracer.
+    */
+    void updateStatistics();
+
+    //=========================================================================================================
+    /**
+    * Enables or disables the recording of the tracer.
+    *
+    * @param [in] bChecked  whether to record.
+    */
+    void onRecordToggled(bool bChecked);
+
+    //=========================================================================================================
+    /**
+    * Asks for a file name and writes the Chrome trace JSON.
+    */
+    void onExportTrace();
+
+    QCheckBox*      m_pCheckBoxRecord;      /**< Toggles the recording. */
+    QPushButton*    m_pButtonClear;         /**< Clears the recorded events and statistics. */
+    QPushButton*    m_pButtonExport;        /**< Exports the trace. */
+    QTableWidget*   m_pTableLatency;        /**< Latency per input connector. */
+    QTableWidget*   m_pTableLoad;           /**< CPU load per plugin thread and fill level per buffer. */
+    QTimer*         m_pTimer;               /**< Refresh timer. */
+};
+
+} // NAMESPACE
+
+#endif // PIPELINESTATISTICSWIDGET_H
@@ -0,0 +1,639 @@
+//=============================================================================================================
+/**
+* @file     pipelinetracer.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Definition of the PipelineTracer class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "pipelinetracer.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QElapsedTimer>
+#include <QCoreApplication>
+#include <QThread>
+#include <QTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QMutexLocker>
+
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// SYSTEM INCLUDES
+//=============================================================================================================
+
+#if defined(Q_OS_LINUX)
+    #include <pthread.h>
+    #include <time.h>
+#elif defined(Q_OS_WIN)
+    #include <windows.h>
+#endif
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCSHAREDLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+const int NUM_LATENCY_BINS = 32;
+
+qint64 currentThreadId()
+{
+    return static_cast<qint64>(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+}
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+PipelineLatencyHistogram::PipelineLatencyHistogram()
+: qVecBins(NUM_LATENCY_BINS, 0)
+, iCount(0)
+, dSumMs(0.0)
+, dMaxMs(0.0)
+, dLastMs(0.0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void PipelineLatencyHistogram::add(qint64 iLatencyNs)
+{
+    qint64 iLatencyUs = iLatencyNs > 0 ? iLatencyNs / 1000 : 0;
+
+    int iBin = 0;
+    while(iLatencyUs > 1 && iBin < NUM_LATENCY_BINS - 1) {
+        iLatencyUs >>= 1;
+        ++iBin;
+    }
+
+    ++qVecBins[iBin];
+    ++iCount;
+
+    dLastMs = iLatencyNs / 1.0e6;
+    dSumMs += dLastMs;
+    if(dLastMs > dMaxMs)
+        dMaxMs = dLastMs;
+}
+
+
+//*************************************************************************************************************
+
+double PipelineLatencyHistogram::mean() const
+{
+    return iCount > 0 ? dSumMs / iCount : 0.0;
+}
+
+
+//*************************************************************************************************************
+
+double PipelineLatencyHistogram::percentile(double dFraction) const
+{
+    if(iCount == 0)
+        return 0.0;
+
+    quint64 iTarget = static_cast<quint64>(std::ceil(dFraction * iCount));
+    quint64 iSum = 0;
+
+    for(int i = 0; i < qVecBins.size(); ++i) {
+        iSum += qVecBins[i];
+        if(iSum >= iTarget)
+            return qMin(std::ldexp(1.0, i + 1) / 1000.0, dMaxMs);
+    }
+
+    return dMaxMs;
+}
+
+
+//*************************************************************************************************************
+
+PipelineTracer::PipelineTracer()
+: m_iEnabled(0)
+, m_pTimer(Q_NULLPTR)
+, m_iMaxEvents(1 << 18)
+, m_iEventPos(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+PipelineTracer::~PipelineTracer()
+{
+    delete m_pTimer;
+
+#if defined(Q_OS_WIN)
+    QHash<qint64, RegisteredThread>::const_iterator it;
+    for(it = m_qHashThreads.constBegin(); it != m_qHashThreads.constEnd(); ++it)
+        CloseHandle(reinterpret_cast<HANDLE>(it.value().uiCpuClock));
+#endif
+}
+
+
+//*************************************************************************************************************
+
+PipelineTracer* PipelineTracer::instance()
+{
+    static PipelineTracer s_tracer;
+    return &s_tracer;
+}
+
+
+//*************************************************************************************************************
+
+qint64 PipelineTracer::now()
+{
+    static QElapsedTimer s_timer;
+    static bool s_bStarted = (s_timer.start(), true);
+    Q_UNUSED(s_bStarted);
+
+    return s_timer.nsecsElapsed();
+}
+
+
+//*************************************************************************************************************
+
+void PipelineTracer::setEnabled(bool bEnabled, qint32 iSamplingMs)
+{
+    if(!m_pTimer) {
+        m_pTimer = new QTimer();
+        QObject::connect(m_pTimer, &QTimer::timeout, [this]() {
+            sample();
+        });
+    }
+
+    if(bEnabled) {
+        QMutexLocker locker(&m_qMutex);
+        m_qVecEvents.reserve(m_iMaxEvents);
+        m_qMapThreadNames.insert(currentThreadId(), QCoreApplication::applicationName());
+    }
+
+    m_iEnabled.store(bEnabled ? 1 : 0);
+
+    if(bEnabled)
+        m_pTimer->start(iSamplingMs);
+    else
+        m_pTimer->stop();
+}
+
+
+//*************************************************************************************************************
+
+void PipelineTracer::clear()
+{
+    QMutexLocker locker(&m_qMutex);
+
+    m_qVecEvents.clear();
+    m_iEventPos = 0;
+    m_qMapLatencies.clear();
+    m_qHashPluginInputTimes.clear();
+
+    QMap<QString, RegisteredQueue>::iterator it;
+    for(it = m_qMapQueues.begin(); it != m_qMapQueues.end(); ++it)
+        it.value().depth.iMaxDepth = 0;
+}
+
+
+//*************************************************************************************************************
+
+void PipelineTracer::recordSlice(const QString& sName, const QString& sCategory, qint64 iStartNs, qint64 iEndNs)
+{
+    if(!isEnabled())
+        return;
+
+    PipelineTraceEvent event;
+    event.cPhase = 'X';
+    event.sName = sName;
+    event.sCategory = sCategory;
+    event.iTimeNs = iStartNs;
+    event.iDurationNs = iEndNs - iStartNs;
+    event.iThreadId = currentThreadId();
+    event.dValue = 0.0;
+
+    QMutexLocker locker(&m_qMutex);
+    appendEvent(event);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineTracer::recordLatency(const QString& sConnection, qint64 iLatencyNs)
+{
+    if(!isEnabled())
+        return;
+
+    QMutexLocker locker(&m_qMutex);
+    m_qMapLatencies[sConnection].add(iLatencyNs);
+
+    PipelineTraceEvent event;
+    event.cPhase = 'C';
+    event.sName = sConnection;
+    event.sCategory = QStringLiteral("latency_ms");
+    event.iTimeNs = now();
+    event.iDurationNs = 0;
+    event.iThreadId = currentThreadId();
+    event.dValue = iLatencyNs / 1.0e6;
+    appendEvent(event);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineTracer::recordCounter(const QString& sName, const QString& sArgument, double dValue)
+{
+    if(!isEnabled())
+        return;
+
+    PipelineTraceEvent event;
+    event.cPhase = 'C';
+    event.sName = sName;
+    event.sCategory = sArgument;
+    event.iTimeNs = now();
+    event.iDurationNs = 0;
+    event.iThreadId = currentThreadId();
+    event.dValue = dValue;
+
+    QMutexLocker locker(&m_qMutex);
+    appendEvent(event);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineTracer::setPluginInputTime(const IPlugin* pPlugin, qint64 iTimeNs)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_qHashPluginInputTimes.insert(pPlugin, iTimeNs);
+}
+
+
+//*************************************************************************************************************
+
+qint64 PipelineTracer::pluginInputTime(const IPlugin* pPlugin) const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_qHashPluginInputTimes.value(pPlugin, 0);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineTracer::watchThread(QThread* pThread, const QString& sName)
+{
+    //The started and finished signals are emitted from within the thread itself
+    QObject::connect(pThread, &QThread::started, pThread, [this, sName]() {
+        registerCurrentThread(sName);
+    }, Qt::DirectConnection);
+
+    QObject::connect(pThread, &QThread::finished, pThread, [this]() {
+        unregisterCurrentThread();
+    }, Qt::DirectConnection);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineTracer::registerCurrentThread(const QString& sName)
+{
+    RegisteredThread thread;
+    thread.sName = sName;
+    thread.uiCpuClock = 0;
+
+#if defined(Q_OS_LINUX)
+    clockid_t clockId;
+    if(pthread_getcpuclockid(pthread_self(), &clockId) == 0)
+        thread.uiCpuClock = static_cast<quintptr>(clockId);
+#elif defined(Q_OS_WIN)
+    HANDLE hThread = NULL;
+    DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &hThread, THREAD_QUERY_INFORMATION, FALSE, 0);
+    thread.uiCpuClock = reinterpret_cast<quintptr>(hThread);
+#endif
+
+    thread.iStartCpuNs = threadCpuTime(thread.uiCpuClock);
+    thread.iLastCpuNs = thread.iStartCpuNs;
+    thread.iLastNs = now();
+    thread.load.dCpuMs = thread.iStartCpuNs < 0 ? -1.0 : 0.0;
+    thread.load.dLoad = 0.0;
+
+    qint64 iThreadId = currentThreadId();
+
+    QMutexLocker locker(&m_qMutex);
+
+#if defined(Q_OS_WIN)
+    if(m_qHashThreads.contains(iThreadId))
+        CloseHandle(reinterpret_cast<HANDLE>(m_qHashThreads.value(iThreadId).uiCpuClock));
+#endif
+
+    m_qHashThreads.insert(iThreadId, thread);
+    m_qMapThreadNames.insert(iThreadId, sName);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineTracer::unregisterCurrentThread()
+{
+    QMutexLocker locker(&m_qMutex);
+
+    QHash<qint64, RegisteredThread>::iterator it = m_qHashThreads.find(currentThreadId());
+    if(it == m_qHashThreads.end())
+        return;
+
+#if defined(Q_OS_WIN)
+    CloseHandle(reinterpret_cast<HANDLE>(it.value().uiCpuClock));
+#endif
+
+    m_qHashThreads.erase(it);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineTracer::registerQueue(const QString& sName, std::function<qint32()> funcDepth, qint32 iCapacity)
+{
+    RegisteredQueue queue;
+    queue.funcDepth = funcDepth;
+    queue.depth.iDepth = 0;
+    queue.depth.iMaxDepth = 0;
+    queue.depth.iCapacity = iCapacity;
+
+    QMutexLocker locker(&m_qMutex);
+    m_qMapQueues.insert(sName, queue);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineTracer::unregisterQueue(const QString& sName)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_qMapQueues.remove(sName);
+}
+
+
+//*************************************************************************************************************
+
+QMap<QString, PipelineLatencyHistogram> PipelineTracer::latencies() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_qMapLatencies;
+}
+
+
+//*************************************************************************************************************
+
+QMap<QString, PipelineThreadLoad> PipelineTracer::threadLoads() const
+{
+    QMutexLocker locker(&m_qMutex);
+
+    QMap<QString, PipelineThreadLoad> qMapLoads;
+    QHash<qint64, RegisteredThread>::const_iterator it;
+    for(it = m_qHashThreads.constBegin(); it != m_qHashThreads.constEnd(); ++it)
+        qMapLoads.insert(it.value().sName, it.value().load);
+
+    return qMapLoads;
+}
+
+
+//*************************************************************************************************************
+
+QMap<QString, PipelineQueueDepth> PipelineTracer::queueDepths() const
+{
+    QMutexLocker locker(&m_qMutex);
+
+    QMap<QString, PipelineQueueDepth> qMapDepths;
+    QMap<QString, RegisteredQueue>::const_iterator it;
+    for(it = m_qMapQueues.constBegin(); it != m_qMapQueues.constEnd(); ++it)
+        qMapDepths.insert(it.key(), it.value().depth);
+
+    return qMapDepths;
+}
+
+
+//*************************************************************************************************************
+
+bool PipelineTracer::writeChromeTrace(const QString& sFileName) const
+{
+    QFile file(sFileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "PipelineTracer::writeChromeTrace - Could not open" << sFileName;
+        return false;
+    }
+
+    QJsonArray jsonEvents;
+
+    QMutexLocker locker(&m_qMutex);
+
+    QMap<qint64, QString>::const_iterator itName;
+    for(itName = m_qMapThreadNames.constBegin(); itName != m_qMapThreadNames.constEnd(); ++itName) {
+        QJsonObject jsonArgs;
+        jsonArgs.insert("name", itName.value());
+
+        QJsonObject jsonEvent;
+        jsonEvent.insert("name", QStringLiteral("thread_name"));
+        jsonEvent.insert("ph", QStringLiteral("M"));
+        jsonEvent.insert("pid", 1);
+        jsonEvent.insert("tid", static_cast<double>(itName.key()));
+        jsonEvent.insert("args", jsonArgs);
+        jsonEvents.append(jsonEvent);
+    }
+
+    //Oldest event first - once the ring wrapped around it is located at the write position
+    qint32 iNumEvents = m_qVecEvents.size();
+    qint32 iFirst = iNumEvents < m_iMaxEvents ? 0 : m_iEventPos;
+
+    for(qint32 i = 0; i < iNumEvents; ++i) {
+        const PipelineTraceEvent& event = m_qVecEvents[(iFirst + i) % iNumEvents];
+
+        QJsonObject jsonEvent;
+        jsonEvent.insert("name", event.sName);
+        jsonEvent.insert("ph", QString(QChar(event.cPhase)));
+        jsonEvent.insert("ts", event.iTimeNs / 1000.0);
+        jsonEvent.insert("pid", 1);
+        jsonEvent.insert("tid", static_cast<double>(event.iThreadId));
+
+        if(event.cPhase == 'X') {
+            jsonEvent.insert("cat", event.sCategory);
+            jsonEvent.insert("dur", event.iDurationNs / 1000.0);
+        } else {
+            QJsonObject jsonArgs;
+            jsonArgs.insert(event.sCategory, event.dValue);
+            jsonEvent.insert("args", jsonArgs);
+        }
+
+        jsonEvents.append(jsonEvent);
+    }
+
+    locker.unlock();
+
+    QJsonObject jsonTrace;
+    jsonTrace.insert("traceEvents", jsonEvents);
+    jsonTrace.insert("displayTimeUnit", QStringLiteral("ms"));
+
+    return file.write(QJsonDocument(jsonTrace).toJson(QJsonDocument::Compact)) > 0;
+}
+
+
+//*************************************************************************************************************
+
+void PipelineTracer::sample()
+{
+    if(!isEnabled())
+        return;
+
+    //Query the queues outside of the lock, their callbacks may lock the buffers
+    QMap<QString, std::function<qint32()> > qMapFuncs;
+    {
+        QMutexLocker locker(&m_qMutex);
+        QMap<QString, RegisteredQueue>::const_iterator it;
+        for(it = m_qMapQueues.constBegin(); it != m_qMapQueues.constEnd(); ++it)
+            qMapFuncs.insert(it.key(), it.value().funcDepth);
+    }
+
+    QMap<QString, qint32> qMapDepths;
+    QMap<QString, std::function<qint32()> >::const_iterator itFunc;
+    for(itFunc = qMapFuncs.constBegin(); itFunc != qMapFuncs.constEnd(); ++itFunc)
+        qMapDepths.insert(itFunc.key(), itFunc.value()());
+
+    qint64 iNow = now();
+    qint64 iThreadId = currentThreadId();
+
+    QMutexLocker locker(&m_qMutex);
+
+    QMap<QString, qint32>::const_iterator itDepth;
+    for(itDepth = qMapDepths.constBegin(); itDepth != qMapDepths.constEnd(); ++itDepth) {
+        QMap<QString, RegisteredQueue>::iterator itQueue = m_qMapQueues.find(itDepth.key());
+        if(itQueue == m_qMapQueues.end())
+            continue;
+
+        PipelineQueueDepth& depth = itQueue.value().depth;
+        depth.iDepth = itDepth.value();
+        depth.iMaxDepth = qMax(depth.iMaxDepth, depth.iDepth);
+
+        PipelineTraceEvent event = {'C', itDepth.key(), QStringLiteral("depth"), iNow, 0, iThreadId, static_cast<double>(depth.iDepth)};
+        appendEvent(event);
+    }
+
+    QHash<qint64, RegisteredThread>::iterator itThread;
+    for(itThread = m_qHashThreads.begin(); itThread != m_qHashThreads.end(); ++itThread) {
+        RegisteredThread& thread = itThread.value();
+
+        qint64 iCpuNs = threadCpuTime(thread.uiCpuClock);
+        if(iCpuNs < 0)
+            continue;
+
+        qint64 iElapsedNs = iNow - thread.iLastNs;
+        thread.load.dLoad = iElapsedNs > 0 ? static_cast<double>(iCpuNs - thread.iLastCpuNs) / iElapsedNs : 0.0;
+        thread.load.dCpuMs = (iCpuNs - thread.iStartCpuNs) / 1.0e6;
+        thread.iLastCpuNs = iCpuNs;
+        thread.iLastNs = iNow;
+
+        PipelineTraceEvent event = {'C', thread.sName + QStringLiteral(" CPU"), QStringLiteral("load_percent"), iNow, 0, itThread.key(), 100.0 * thread.load.dLoad};
+        appendEvent(event);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void PipelineTracer::appendEvent(const PipelineTraceEvent& event)
+{
+    if(m_qVecEvents.size() < m_iMaxEvents) {
+        m_qVecEvents.append(event);
+    } else {
+        m_qVecEvents[m_iEventPos] = event;
+    }
+
+    m_iEventPos = (m_iEventPos + 1) % m_iMaxEvents;
+}
+
+
+//*************************************************************************************************************
+
+qint64 PipelineTracer::threadCpuTime(quintptr uiCpuClock)
+{
+#if defined(Q_OS_LINUX)
+    struct timespec ts;
+    if(!uiCpuClock || clock_gettime(static_cast<clockid_t>(uiCpuClock), &ts) != 0)
+        return -1;
+    return static_cast<qint64>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+#elif defined(Q_OS_WIN)
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if(!uiCpuClock || !GetThreadTimes(reinterpret_cast<HANDLE>(uiCpuClock), &creationTime, &exitTime, &kernelTime, &userTime))
+        return -1;
+    quint64 iKernel = (static_cast<quint64>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+    quint64 iUser = (static_cast<quint64>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+    return static_cast<qint64>(iKernel + iUser) * 100;
+#else
+    Q_UNUSED(uiCpuClock);
+    return -1;
+#endif
+}
@@ -0,0 +1,476 @@
+//=============================================================================================================
+/**
+* @file     pipelinetracer.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     PipelineTracer class declaration.
+*
+*/
+
+#ifndef PIPELINETRACER_H
+#define PIPELINETRACER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../scshared_global.h"
+
+#include <generics/circularmatrixbuffer.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QWeakPointer>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <functional>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class QTimer;
+class QThread;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCSHAREDLIB
+//=============================================================================================================
+
+namespace SCSHAREDLIB
+{
+
+class IPlugin;
+
+
+//=============================================================================================================
+/**
+* Logarithmic latency histogram. Bin i counts the latencies between 2^i and 2^(i+1) microseconds.
+*
+* @brief Latency histogram of one connector
+*/
+struct SCSHAREDSHARED_EXPORT PipelineLatencyHistogram
+{
+    //=========================================================================================================
+    /**
+    * Constructs an empty histogram.
+    */
+    PipelineLatencyHistogram();
+
+    //=========================================================================================================
+    /**
+    * Adds a latency to the histogram.
+    *
+    * @param[in] iLatencyNs     the latency in ns.
+    */
+    void add(qint64 iLatencyNs);
+
+    //=========================================================================================================
+    /**
+    * Returns the mean latency.
+    *
+    * @return the mean latency in ms.
+    */
+    double mean() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the upper edge of the bin which contains the requested percentile.
+    *
+    * @param[in] dFraction      the percentile as fraction, e.g. 0.95.
+    *
+    * @return the percentile in ms.
+    */
+    double percentile(double dFraction) const;
+
+    QVector<quint64>    qVecBins;   /**< Number of latencies per logarithmic bin. */
+    quint64             iCount;     /**< Number of latencies added. */
+    double              dSumMs;     /**< Sum of all latencies in ms. */
+    double              dMaxMs;     /**< Maximal latency in ms. */
+    double              dLastMs;    /**< Most recent latency in ms. */
+};
+
+
+//=============================================================================================================
+/**
+* CPU time consumed by a registered plugin thread.
+*
+* @brief CPU load of one thread
+*/
+struct SCSHAREDSHARED_EXPORT PipelineThreadLoad
+{
+    double  dCpuMs;     /**< CPU time consumed since registration in ms, -1 if not supported on this platform. */
+    double  dLoad;      /**< Fraction of one core used during the last sampling interval. */
+};
+
+
+//=============================================================================================================
+/**
+* Fill level of a registered buffer.
+*
+* @brief Depth of one queue
+*/
+struct SCSHAREDSHARED_EXPORT PipelineQueueDepth
+{
+    qint32  iDepth;     /**< Number of queued elements at the last sampling. */
+    qint32  iMaxDepth;  /**< Maximal number of queued elements seen so far. */
+    qint32  iCapacity;  /**< Capacity of the queue. */
+};
+
+
+//=============================================================================================================
+/**
+* One entry of the trace. Slices ('X') carry a duration, counters ('C') a value.
+*
+* @brief Trace event in Chrome trace format terms
+*/
+struct SCSHAREDSHARED_EXPORT PipelineTraceEvent
+{
+    char    cPhase;         /**< Chrome trace phase, 'X' for complete slices and 'C' for counters. */
+    QString sName;          /**< Name of the slice or the counter. */
+    QString sCategory;      /**< Category of the slice or the counter argument name. */
+    qint64  iTimeNs;        /**< Start time in ns. */
+    qint64  iDurationNs;    /**< Duration of a slice in ns. */
+    qint64  iThreadId;      /**< Id of the thread the event was recorded in. */
+    double  dValue;         /**< Value of a counter. */
+};
+
+
+//=============================================================================================================
+/**
+* Process wide tracer of the plugin graph. The connectors stamp the acquisition time into the measurements and
+* record the dispatch slices and the end-to-end latencies, the plugin threads and buffers are sampled
+* periodically for their CPU time and fill level. The recorded events can be exported as Chrome trace JSON,
+* which is readable by chrome://tracing and Perfetto. Recording is off by default and costs one atomic load per
+* connector notification while disabled.
+*
+* @brief Latency and throughput instrumentation of the plugin graph
+*/
+class SCSHAREDSHARED_EXPORT PipelineTracer
+{
+public:
+    //=========================================================================================================
+    /**
+    * Returns the process wide tracer.
+    *
+    * @return the tracer.
+    */
+    static PipelineTracer* instance();
+
+    //=========================================================================================================
+    /**
+    * Returns the monotonic time used for all stamps.
+    *
+    * @return the time in ns.
+    */
+    static qint64 now();
+
+    //=========================================================================================================
+    /**
+    * Enables or disables the recording. Has to be called from the GUI thread, since the sampling timer is
+    * started here.
+    *
+    * @param[in] bEnabled       whether to record.
+    * @param[in] iSamplingMs    sampling interval of the thread and queue statistics in ms.
+    */
+    void setEnabled(bool bEnabled, qint32 iSamplingMs = 100);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the recording is enabled.
+    *
+    * @return true if enabled.
+    */
+    inline bool isEnabled() const;
+
+    //=========================================================================================================
+    /**
+    * Discards all recorded events and statistics. Registered threads and queues are kept.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Records a complete slice.
+    *
+    * @param[in] sName      name of the slice.
+    * @param[in] sCategory  category of the slice.
+    * @param[in] iStartNs   start time in ns.
+    * @param[in] iEndNs     end time in ns.
+    */
+    void recordSlice(const QString& sName, const QString& sCategory, qint64 iStartNs, qint64 iEndNs);
+
+    //=========================================================================================================
+    /**
+    * Adds an end-to-end latency to the histogram of the given connection.
+    *
+    * @param[in] sConnection    name of the connection.
+    * @param[in] iLatencyNs     latency in ns.
+    */
+    void recordLatency(const QString& sConnection, qint64 iLatencyNs);
+
+    //=========================================================================================================
+    /**
+    * Records a counter value.
+    *
+    * @param[in] sName      name of the counter.
+    * @param[in] sArgument  name of the counter argument.
+    * @param[in] dValue     value.
+    */
+    void recordCounter(const QString& sName, const QString& sArgument, double dValue);
+
+    //=========================================================================================================
+    /**
+    * Stores the acquisition time of the data a plugin received last. Output connectors of non-sensor plugins
+    * hand this time on, so that latencies are measured from acquisition across algorithm plugins.
+    *
+    * @param[in] pPlugin        the receiving plugin.
+    * @param[in] iTimeNs        acquisition time in ns.
+    */
+    void setPluginInputTime(const IPlugin* pPlugin, qint64 iTimeNs);
+
+    //=========================================================================================================
+    /**
+    * Returns the acquisition time of the data a plugin received last.
+    *
+    * @param[in] pPlugin        the plugin.
+    *
+    * @return the acquisition time in ns, 0 if the plugin did not receive data yet.
+    */
+    qint64 pluginInputTime(const IPlugin* pPlugin) const;
+
+    //=========================================================================================================
+    /**
+    * Registers and unregisters the given thread automatically whenever it is started and finished.
+    *
+    * @param[in] pThread    the thread, e.g. a plugin.
+    * @param[in] sName      name under which the thread is reported.
+    */
+    void watchThread(QThread* pThread, const QString& sName);
+
+    //=========================================================================================================
+    /**
+    * Registers the calling thread for CPU time sampling.
+    *
+    * @param[in] sName      name under which the thread is reported.
+    */
+    void registerCurrentThread(const QString& sName);
+
+    //=========================================================================================================
+    /**
+    * Unregisters the calling thread. Has to be called before the thread exits.
+    */
+    void unregisterCurrentThread();
+
+    //=========================================================================================================
+    /**
+    * Registers a queue for fill level sampling. A queue with the same name is replaced.
+    *
+    * @param[in] sName      name of the queue.
+    * @param[in] funcDepth  returns the current number of queued elements, called from the GUI thread.
+    * @param[in] iCapacity  capacity of the queue.
+    */
+    void registerQueue(const QString& sName, std::function<qint32()> funcDepth, qint32 iCapacity);
+
+    //=========================================================================================================
+    /**
+    * Registers a CircularMatrixBuffer for fill level sampling. The buffer is only weakly referenced.
+    *
+    * @param[in] sName      name of the queue.
+    * @param[in] pBuffer    the buffer.
+    */
+    template<typename T>
+    inline void registerBuffer(const QString& sName, const QSharedPointer<IOBuffer::CircularMatrixBuffer<T> >& pBuffer);
+
+    //=========================================================================================================
+    /**
+    * Unregisters a queue.
+    *
+    * @param[in] sName      name of the queue.
+    */
+    void unregisterQueue(const QString& sName);
+
+    //=========================================================================================================
+    /**
+    * Returns the latency histograms of all connections.
+    *
+    * @return the histograms.
+    */
+    QMap<QString, PipelineLatencyHistogram> latencies() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the CPU load of all registered threads.
+    *
+    * @return the loads.
+    */
+    QMap<QString, PipelineThreadLoad> threadLoads() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the fill levels of all registered queues.
+    *
+    * @return the fill levels.
+    */
+    QMap<QString, PipelineQueueDepth> queueDepths() const;
+
+    //=========================================================================================================
+    /**
+    * Writes the recorded events in Chrome trace JSON format.
+    *
+    * @param[in] sFileName  the file to write.
+    *
+    * @return true if successful.
+    */
+    bool writeChromeTrace(const QString& sFileName) const;
+
+private:
+    /**
+    * A thread sampled for its CPU time.
+    */
+    struct RegisteredThread
+    {
+        QString             sName;          /**< Reported name. */
+        quintptr            uiCpuClock;     /**< Platform specific handle of the thread CPU clock, 0 if not available. */
+        qint64              iStartCpuNs;    /**< CPU time at registration in ns. */
+        qint64              iLastCpuNs;     /**< CPU time at the last sampling in ns. */
+        qint64              iLastNs;        /**< Time of the last sampling in ns. */
+        PipelineThreadLoad  load;           /**< Current statistics. */
+    };
+
+    /**
+    * A queue sampled for its fill level.
+    */
+    struct RegisteredQueue
+    {
+        std::function<qint32()> funcDepth;  /**< Returns the current fill level. */
+        PipelineQueueDepth      depth;      /**< Current statistics. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs the tracer.
+    */
+    PipelineTracer();
+
+    //=========================================================================================================
+    /**
+    * Destroys the tracer.
+    */
+    ~PipelineTracer();
+
+    //=========================================================================================================
+    /**
+    * Samples the CPU time of the registered threads and the fill level of the registered queues.
+    */
+    void sample();
+
+    //=========================================================================================================
+    /**
+    * Appends an event to the ring of recorded events. The mutex has to be locked.
+    *
+    * @param[in] event      the event.
+    */
+    void appendEvent(const PipelineTraceEvent& event);
+
+    //=========================================================================================================
+    /**
+    * Returns the CPU time of a thread.
+    *
+    * @param[in] uiCpuClock     platform specific handle of the thread CPU clock.
+    *
+    * @return the CPU time in ns, -1 if not supported.
+    */
+    static qint64 threadCpuTime(quintptr uiCpuClock);
+
+    Q_DISABLE_COPY(PipelineTracer)
+
+    QAtomicInt                          m_iEnabled;             /**< Whether the recording is enabled. */
+    mutable QMutex                      m_qMutex;               /**< Guards all members below. */
+    QTimer*                             m_pTimer;               /**< Sampling timer, lives in the GUI thread. */
+
+    QVector<PipelineTraceEvent>         m_qVecEvents;           /**< Ring of recorded events. */
+    qint32                              m_iMaxEvents;           /**< Capacity of the ring, the oldest events are overwritten. */
+    qint32                              m_iEventPos;            /**< Next position to write in the ring. */
+
+    QMap<QString, PipelineLatencyHistogram> m_qMapLatencies;    /**< Latency histogram per connection. */
+    QHash<const IPlugin*, qint64>       m_qHashPluginInputTimes;/**< Acquisition time of the data each plugin received last. */
+    QHash<qint64, RegisteredThread>     m_qHashThreads;         /**< Registered threads by thread id. */
+    QMap<qint64, QString>               m_qMapThreadNames;      /**< Names of all threads which were ever registered, for the trace metadata. */
+    QMap<QString, RegisteredQueue>      m_qMapQueues;           /**< Registered queues by name. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool PipelineTracer::isEnabled() const
+{
+    return m_iEnabled.load() != 0;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+inline void PipelineTracer::registerBuffer(const QString& sName, const QSharedPointer<IOBuffer::CircularMatrixBuffer<T> >& pBuffer)
+{
+    QWeakPointer<IOBuffer::CircularMatrixBuffer<T> > pWeakBuffer(pBuffer);
+
+    registerQueue(sName, [pWeakBuffer]() -> qint32 {
+        QSharedPointer<IOBuffer::CircularMatrixBuffer<T> > pLocked = pWeakBuffer.toStrongRef();
+        return pLocked ? static_cast<qint32>(pLocked->numMatrices()) : 0;
+    }, pBuffer ? static_cast<qint32>(pBuffer->size()) : 0);
+}
+
+} // NAMESPACE
+
+#endif // PIPELINETRACER_H
@@ -39,6 +39,7 @@
 //=============================================================================================================
 
 #include "plugininputconnector.h"
+#include "pipelinetracer.h"
 #include "../Interfaces/IPlugin.h"
 
 
@@ -81,5 +82,23 @@ bool PluginInputConnector::isOutputConnector() const
 
 void PluginInputConnector::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 {
+    PipelineTracer* pTracer = PipelineTracer::instance();
+
+    if(!pTracer->isEnabled() || !pMeasurement) {
+        emit notify(pMeasurement);
+        return;
+    }
+
+    qint64 iStart = PipelineTracer::now();
+    qint64 iAcquisitionTime = pMeasurement->acquisitionTime();
+    QString sName = m_pPlugin->getName() + "::" + getName();
+
+    if(iAcquisitionTime > 0) {
+        pTracer->recordLatency(sName, iStart - iAcquisitionTime);
+        pTracer->setPluginInputTime(m_pPlugin, iAcquisitionTime);
+    }
+
     emit notify(pMeasurement);
+
+    pTracer->recordSlice(sName, QStringLiteral("input"), iStart, PipelineTracer::now());
 }
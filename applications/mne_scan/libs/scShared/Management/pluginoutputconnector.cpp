@@ -39,6 +39,7 @@
 //=============================================================================================================
 
 #include "pluginoutputconnector.h"
+#include "pipelinetracer.h"
 #include "../Interfaces/IPlugin.h"
 
 
@@ -76,3 +77,29 @@ bool PluginOutputConnector::isOutputConnector() const
     return true;
 }
 
+
+//*************************************************************************************************************
+
+void PluginOutputConnector::dispatch(const SCMEASLIB::NewMeasurement::SPtr& pMeasurement)
+{
+    PipelineTracer* pTracer = PipelineTracer::instance();
+
+    if(!pTracer->isEnabled() || !pMeasurement) {
+        emit notify(pMeasurement);
+        return;
+    }
+
+    qint64 iStart = PipelineTracer::now();
+
+    //Sensors stamp the acquisition, all other plugins hand on the acquisition time of the data they received last
+    qint64 iAcquisitionTime = 0;
+    if(m_pPlugin->getType() != IPlugin::_ISensor)
+        iAcquisitionTime = pTracer->pluginInputTime(m_pPlugin);
+
+    pMeasurement->setAcquisitionTime(iAcquisitionTime > 0 ? iAcquisitionTime : iStart);
+
+    emit notify(pMeasurement);
+
+    pTracer->recordSlice(m_pPlugin->getName() + "::" + getName(), QStringLiteral("dispatch"), iStart, PipelineTracer::now());
+}
+
@@ -99,6 +99,16 @@ public:
      */
     virtual bool isOutputConnector() const;
 
+protected:
+    //=========================================================================================================
+    /**
+    * Emits notify for the given measurement. When the PipelineTracer is enabled, the acquisition time is
+    * stamped into the measurement first and the dispatch is recorded as trace slice.
+    *
+    * @param[in] pMeasurement   the measurement which holds new data.
+    */
+    void dispatch(const SCMEASLIB::NewMeasurement::SPtr& pMeasurement);
+
 signals:
     void notify(SCMEASLIB::NewMeasurement::SPtr);
 
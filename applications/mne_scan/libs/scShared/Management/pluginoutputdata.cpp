@@ -90,7 +90,7 @@ PluginOutputData<T>::PluginOutputData(IPlugin *parent, const QString &name, cons
 template <class T>
 void PluginOutputData<T>::update()
 {
-    emit notify(qSharedPointerDynamicCast<SCMEASLIB::NewMeasurement>(m_pMeasurement));
+    dispatch(qSharedPointerDynamicCast<SCMEASLIB::NewMeasurement>(m_pMeasurement));
 }
 
 }//Namespace
@@ -39,6 +39,7 @@
 //=============================================================================================================
 
 #include "pluginscenemanager.h"
+#include "pipelinetracer.h"
 
 
 //*************************************************************************************************************
@@ -77,6 +78,7 @@ bool PluginSceneManager::addPlugin(const IPlugin* pPlugin, IPlugin::SPtr &pAdded
         pAddedPlugin = pPlugin->clone();
         m_pluginList.append(pAddedPlugin);
         m_pluginList.last()->init();
+        PipelineTracer::instance()->watchThread(pAddedPlugin.data(), pAddedPlugin->getName());
         return true;
     }
     else
@@ -100,6 +102,7 @@ bool PluginSceneManager::addPlugin(const IPlugin* pPlugin, IPlugin::SPtr &pAdded
             pAddedPlugin = pPlugin->clone();
             m_pluginList.append(pAddedPlugin);
             m_pluginList.last()->init();
+            PipelineTracer::instance()->watchThread(pAddedPlugin.data(), pAddedPlugin->getName());
             return true;
         }
     }
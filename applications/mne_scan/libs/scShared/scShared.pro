@@ -92,7 +92,11 @@ SOURCES += \
     Management/pluginconnectorconnection.cpp \
     Management/pluginconnectorconnectionwidget.cpp \
     Management/pluginscenemanager.cpp \
-    Management/displaymanager.cpp
+    Management/displaymanager.cpp \
+    Management/pipelinetracer.cpp \
+    Management/pipelinestatisticswidget.cpp \
+    Management/pipelinescheduler.cpp \
+    Management/pipelinestage.cpp
 
 HEADERS += \
     scshared_global.h \
@@ -109,7 +113,11 @@ HEADERS += \
     Management/pluginconnectorconnection.h \
     Management/pluginconnectorconnectionwidget.h \
     Management/pluginscenemanager.h \
-    Management/displaymanager.h
+    Management/displaymanager.h \
+    Management/pipelinetracer.h \
+    Management/pipelinestatisticswidget.h \
+    Management/pipelinescheduler.h \
+    Management/pipelinestage.h
 
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
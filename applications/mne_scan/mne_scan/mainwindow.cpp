@@ -41,6 +41,8 @@
 #include <scShared/Management/pluginmanager.h>
 #include <scShared/Management/pluginscenemanager.h>
 #include <scShared/Management/displaymanager.h>
+#include <scShared/Management/pipelinetracer.h>
+#include <scShared/Management/pipelinestatisticswidget.h>
 
 //GUI
 #include "mainwindow.h"
@@ -123,6 +125,7 @@ MainWindow::MainWindow(QWidget *parent)
     createToolBars();
     createPluginDockWindow();
     createLogDockWindow();
+    createPipelineStatisticsDockWindow();
 
 //    //ToDo Debug Startup
 //    writeToLog(tr("Test normal message, Max"), _LogKndMessage, _LogLvMax);
@@ -585,6 +588,27 @@ void MainWindow::createLogDockWindow()
 }
 
 
+//*************************************************************************************************************
+
+void MainWindow::createPipelineStatisticsDockWindow()
+{
+    //Recording can be switched on from the start, e.g. to trace the very first buffers
+    if(qEnvironmentVariableIsSet("MNE_SCAN_TRACE"))
+        SCSHAREDLIB::PipelineTracer::instance()->setEnabled(true);
+
+    m_pDockWidget_PipelineStatistics = new QDockWidget(tr("Pipeline Statistics"), this);
+
+    m_pDockWidget_PipelineStatistics->setWidget(new SCSHAREDLIB::PipelineStatisticsWidget(m_pDockWidget_PipelineStatistics));
+
+    m_pDockWidget_PipelineStatistics->setAllowedAreas(Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea | Qt::BottomDockWidgetArea);
+    addDockWidget(Qt::RightDockWidgetArea, m_pDockWidget_PipelineStatistics);
+
+    m_pDockWidget_PipelineStatistics->hide();
+
+    m_pMenuView->addAction(m_pDockWidget_PipelineStatistics->toggleViewAction());
+}
+
+
 //*************************************************************************************************************
 //Plugin stuff
 void MainWindow::updatePluginWidget(SCSHAREDLIB::IPlugin::SPtr pPlugin)
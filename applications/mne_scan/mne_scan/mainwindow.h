@@ -245,6 +245,7 @@ private:
 
     void createPluginDockWindow();                          /**< Creates plugin dock widget.*/
     void createLogDockWindow();                             /**< Creates log dock widget.*/
+    void createPipelineStatisticsDockWindow();              /**< Creates pipeline statistics dock widget.*/
 
     //Plugin Management
     QDockWidget*                        m_pPluginGuiDockWidget;         /**< Dock widget which holds the plugin gui. */
@@ -256,6 +257,9 @@ private:
     QDockWidget*                        m_pDockWidget_Log;              /**< Holds the dock widget containing the log.*/
     QTextBrowser*                       m_pTextBrowser_Log;             /**< Holds the text browser for the log.*/
 
+    //Pipeline Statistics
+    QDockWidget*                        m_pDockWidget_PipelineStatistics;   /**< Holds the dock widget containing the latency and load statistics of the plugin graph.*/
+
     LogLevel                            m_eLogLevelCurrent;             /**< Holds the current log level.*/
 
     QSharedPointer<QWidget>             m_pAboutWindow;                 /**< Holds the widget containing the about information.*/
@@ -0,0 +1,169 @@
+//=============================================================================================================
+/**
+* @file     main.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Implements the headless mne_scan pipeline runner.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "pipelinerunner.h"
+
+#include <scMeas/measurementtypes.h>
+#include <scShared/Management/pipelinetracer.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNESCAN;
+using namespace SCSHAREDLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+//=============================================================================================================
+/**
+* The function main marks the entry point of the program.
+* By default, main has the storage class extern.
+*
+* @param [in] argc (argument count) is an integer that indicates how many arguments were entered on the command line when the program was started.
+* @param [in] argv (argument vector) is an array of pointers to arrays of character objects. The array objects are null-terminated strings, representing the arguments that were entered on the command line when the program was started.
+* @return the value that was set to exit() (which is 0 if exit() is called via quit()).
+*/
+int main(int argc, char *argv[])
+{
+    //The plugins create their widgets on load, so a QApplication is needed - render it off screen
+    if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    //Same application info as MNE Scan, so that the plugins find their settings
+    QCoreApplication::setOrganizationName("MNE-CPP");
+    QCoreApplication::setOrganizationDomain("www.tu-ilmenau.de/mne-cpp");
+    QCoreApplication::setApplicationName("MNE Scan");
+
+    SCMEASLIB::MeasurementTypes::registerTypes();
+
+    // Command Line Parser
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs a saved MNE Scan pipeline without the GUI and reports its throughput and latencies.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("scene", "Plugin scene saved by MNE Scan.");
+
+    QCommandLineOption pluginDirOption("plugins", "Directory of the MNE Scan <plugins>.", "plugins", QCoreApplication::applicationDirPath() + "/mne_scan_plugins");
+    QCommandLineOption hostOption("host", "Host name of mne_rt_server.", "host", "127.0.0.1");
+    QCommandLineOption simFileOption("simfile", "Raw <file> to be simulated by mne_rt_server, it has to be accessible by the server.", "file");
+    QCommandLineOption speedOption("speed", "Simulation speed as multiple of real time, or 'max' to feed the data as fast as the server can.", "speed", "1");
+    QCommandLineOption warmUpOption("warmup", "Warm-up time in <seconds> which is excluded from the results.", "seconds", "2");
+    QCommandLineOption durationOption("duration", "Measurement time in <seconds>.", "seconds", "30");
+    QCommandLineOption jsonOption("json", "Write the results as JSON to <file>.", "file");
+    QCommandLineOption traceOption("trace", "Write a Chrome trace of the measurement to <file>.", "file");
+
+    parser.addOption(pluginDirOption);
+    parser.addOption(hostOption);
+    parser.addOption(simFileOption);
+    parser.addOption(speedOption);
+    parser.addOption(warmUpOption);
+    parser.addOption(durationOption);
+    parser.addOption(jsonOption);
+    parser.addOption(traceOption);
+
+    parser.process(app);
+
+    if(parser.positionalArguments().size() != 1)
+        parser.showHelp(1);
+
+    //With 'max' the simulator replays without pause between two buffers
+    bool bMaxSpeed = parser.value(speedOption) == "max";
+    double dSpeed = bMaxSpeed ? 0.0 : parser.value(speedOption).toDouble();
+    if(!bMaxSpeed && dSpeed <= 0) {
+        qCritical() << "Invalid speed" << parser.value(speedOption);
+        return 1;
+    }
+
+    qint32 iWarmUpMs = static_cast<qint32>(parser.value(warmUpOption).toDouble() * 1000);
+    qint32 iDurationMs = static_cast<qint32>(parser.value(durationOption).toDouble() * 1000);
+
+    PipelineRunner runner(parser.value(pluginDirOption));
+
+    if(!runner.configureSimulator(parser.value(hostOption), parser.value(simFileOption), dSpeed)) {
+        qCritical() << "The fiff simulator of mne_rt_server could not be configured";
+        return 1;
+    }
+
+    if(!runner.loadScene(parser.positionalArguments().first())) {
+        qCritical() << "The scene" << parser.positionalArguments().first() << "could not be loaded";
+        return 1;
+    }
+
+    QObject::connect(&runner, &PipelineRunner::finished, &app, &QCoreApplication::quit);
+
+    if(!runner.start(iWarmUpMs, iDurationMs))
+        return 1;
+
+    int iReturn = app.exec();
+
+    QTextStream out(stdout);
+    runner.writeReport(out);
+
+    if(parser.isSet(jsonOption))
+        runner.writeJsonReport(parser.value(jsonOption));
+
+    if(parser.isSet(traceOption))
+        PipelineTracer::instance()->writeChromeTrace(parser.value(traceOption));
+
+    //Leave the server in real time for the next client
+    runner.configureSimulator(parser.value(hostOption), QString(), 1.0);
+
+    return iReturn;
+}
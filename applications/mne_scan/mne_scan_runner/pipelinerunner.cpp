@@ -0,0 +1,476 @@
+//=============================================================================================================
+/**
+* @file     pipelinerunner.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     PipelineRunner class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "pipelinerunner.h"
+
+#include <scShared/Interfaces/IPlugin.h>
+#include <scShared/Management/pluginoutputconnector.h>
+#include <scShared/Management/pipelinetracer.h>
+
+#include <scMeas/newrealtimemultisamplearray.h>
+
+#include <rtClient/rtcmdclient.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDomDocument>
+#include <QFile>
+#include <QTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNESCAN;
+using namespace SCSHAREDLIB;
+using namespace SCMEASLIB;
+using namespace RTCLIENTLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+PipelineRunner::PipelineRunner(const QString& sPluginDir, QObject* parent)
+: QObject(parent)
+, m_pPluginManager(new PluginManager)
+, m_pPluginSceneManager(new PluginSceneManager)
+, m_bIsRunning(false)
+, m_dSpeed(1.0)
+, m_iElapsedMs(0)
+, m_iMeasuring(0)
+{
+    m_pPluginManager->loadPlugins(sPluginDir);
+}
+
+
+//*************************************************************************************************************
+
+PipelineRunner::~PipelineRunner()
+{
+    stop();
+}
+
+
+//*************************************************************************************************************
+
+bool PipelineRunner::configureSimulator(const QString& sHost, const QString& sSimFile, double dSpeed)
+{
+    RtCmdClient t_cmdClient;
+    QString t_sHost = sHost;
+
+    t_cmdClient.connectToHost(t_sHost);
+    if(!t_cmdClient.waitForConnected(1000)) {
+        qWarning() << "PipelineRunner::configureSimulator - Could not connect to mne_rt_server at" << sHost;
+        return false;
+    }
+
+    t_cmdClient.requestCommands();
+
+    bool bSuccess = true;
+
+    if(!sSimFile.isEmpty()) {
+        if(t_cmdClient.hasCommand("simfile")) {
+            t_cmdClient["simfile"].pValues()[0].setValue(sSimFile);
+            t_cmdClient["simfile"].send();
+
+            if(t_cmdClient.readAvailableData().contains("not set")) {
+                qWarning() << "PipelineRunner::configureSimulator - The server did not accept the simulation file" << sSimFile;
+                bSuccess = false;
+            }
+        } else {
+            qWarning() << "PipelineRunner::configureSimulator - The active connector of mne_rt_server does not support simfile";
+            bSuccess = false;
+        }
+    }
+
+    //The acceleration factor scales the announced sampling rate, which would distort every plugin downstream.
+    //Keep it at 1 and only shorten the pause between the buffers.
+    if(t_cmdClient.hasCommand("accel")) {
+        t_cmdClient["accel"].pValues()[0].setValue(1.0);
+        t_cmdClient["accel"].send();
+    }
+
+    if(t_cmdClient.hasCommand("pace")) {
+        t_cmdClient["pace"].pValues()[0].setValue(dSpeed);
+        t_cmdClient["pace"].send();
+        m_dSpeed = dSpeed;
+    } else {
+        qWarning() << "PipelineRunner::configureSimulator - The active connector of mne_rt_server does not support pace";
+        bSuccess = false;
+    }
+
+    t_cmdClient.disconnectFromHost();
+    if(t_cmdClient.state() != QTcpSocket::UnconnectedState)
+        t_cmdClient.waitForDisconnected();
+
+    return bSuccess;
+}
+
+
+//*************************************************************************************************************
+
+bool PipelineRunner::loadScene(const QString& sFileName)
+{
+    QDomDocument doc("PluginConfig");
+    QFile file(sFileName);
+    if(!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "PipelineRunner::loadScene - Could not open" << sFileName;
+        return false;
+    }
+    if(!doc.setContent(&file)) {
+        qWarning() << "PipelineRunner::loadScene - Could not parse" << sFileName;
+        return false;
+    }
+    file.close();
+
+    QDomElement docElem = doc.documentElement();
+    if(docElem.tagName() != "PluginTree") {
+        qWarning() << "PipelineRunner::loadScene -" << sFileName << "is not a plugin scene";
+        return false;
+    }
+
+    //Plugins have to be created before the connections, so they are read in two passes
+    QDomElement elementPlugins = docElem.firstChildElement("Plugins");
+    for(QDomElement e = elementPlugins.firstChildElement(); !e.isNull(); e = e.nextSiblingElement()) {
+        int iPlugin = m_pPluginManager->findByName(e.attribute("name"));
+
+        if(iPlugin < 0) {
+            qWarning() << "PipelineRunner::loadScene - Plugin" << e.attribute("name") << "not found";
+            continue;
+        }
+
+        IPlugin::SPtr pAddedPlugin;
+        if(!m_pPluginSceneManager->addPlugin(m_pPluginManager->getPlugins()[iPlugin], pAddedPlugin))
+            qWarning() << "PipelineRunner::loadScene - Plugin" << e.attribute("name") << "could not be added";
+    }
+
+    const PluginSceneManager::PluginList& lPlugins = m_pPluginSceneManager->getPlugins();
+
+    QDomElement elementConnections = docElem.firstChildElement("Connections");
+    for(QDomElement e = elementConnections.firstChildElement(); !e.isNull(); e = e.nextSiblingElement()) {
+        IPlugin::SPtr pSender, pReceiver;
+
+        for(qint32 i = 0; i < lPlugins.size(); ++i) {
+            if(lPlugins[i]->getName() == e.attribute("sender"))
+                pSender = lPlugins[i];
+            if(lPlugins[i]->getName() == e.attribute("receiver"))
+                pReceiver = lPlugins[i];
+        }
+
+        if(!pSender || !pReceiver)
+            continue;
+
+        PluginConnectorConnection::SPtr pConnection = PluginConnectorConnection::create(pSender, pReceiver);
+
+        if(pConnection->isConnected())
+            m_qListConnections.append(pConnection);
+        else
+            qWarning() << "PipelineRunner::loadScene - Could not connect" << pSender->getName() << "to" << pReceiver->getName();
+    }
+
+    return !lPlugins.isEmpty();
+}
+
+
+//*************************************************************************************************************
+
+bool PipelineRunner::start(qint32 iWarmUpMs, qint32 iDurationMs)
+{
+    connectOutputs();
+
+    PipelineTracer::instance()->setEnabled(true);
+
+    if(!m_pPluginSceneManager->startPlugins()) {
+        qWarning() << "PipelineRunner::start - No sensor plugin could be started";
+        m_pPluginSceneManager->stopPlugins();
+        return false;
+    }
+
+    m_bIsRunning = true;
+
+    QTimer::singleShot(iWarmUpMs, this, &PipelineRunner::onWarmUpFinished);
+    QTimer::singleShot(iWarmUpMs + iDurationMs, this, &PipelineRunner::onMeasurementFinished);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void PipelineRunner::stop()
+{
+    if(!m_bIsRunning)
+        return;
+
+    m_iMeasuring.store(0);
+    m_pPluginSceneManager->stopPlugins();
+    m_bIsRunning = false;
+}
+
+
+//*************************************************************************************************************
+
+void PipelineRunner::writeReport(QTextStream& out) const
+{
+    PipelineTracer* pTracer = PipelineTracer::instance();
+    double dSeconds = m_iElapsedMs / 1000.0;
+
+    out << QString("Measured %1 s at %2\n\n").arg(dSeconds, 0, 'f', 1).arg(m_dSpeed > 0 ? QString("%1 x real time").arg(m_dSpeed) : QString("maximal speed"));
+
+    out << "Throughput\n";
+    out << QString("  %1 %2 %3 %4\n").arg("Output", -48).arg("Blocks", 10).arg("Samples/s", 14).arg("x Real time", 12);
+
+    m_qMutex.lock();
+    QMap<QString, PipelineRunnerThroughput>::const_iterator itThroughput;
+    for(itThroughput = m_qMapThroughput.constBegin(); itThroughput != m_qMapThroughput.constEnd(); ++itThroughput) {
+        const PipelineRunnerThroughput& throughput = itThroughput.value();
+        double dRate = dSeconds > 0 ? throughput.iNumSamples / dSeconds : 0.0;
+
+        //The simulator announces the true sampling rate of the file, also when it replays faster
+        double dRealTime = throughput.dSamplingRate > 0 ? dRate / throughput.dSamplingRate : 0.0;
+
+        out << QString("  %1 %2 %3 %4\n").arg(itThroughput.key(), -48)
+                                         .arg(throughput.iNumBlocks, 10)
+                                         .arg(dRate, 14, 'f', 1)
+                                         .arg(dRealTime, 12, 'f', 2);
+    }
+    m_qMutex.unlock();
+
+    out << "\nLatency since acquisition (ms)\n";
+    out << QString("  %1 %2 %3 %4 %5 %6 %7\n").arg("Connection", -48).arg("Count", 10).arg("Mean", 9).arg("P50", 9).arg("P95", 9).arg("P99", 9).arg("Max", 9);
+
+    QMap<QString, PipelineLatencyHistogram> qMapLatencies = pTracer->latencies();
+    QMap<QString, PipelineLatencyHistogram>::const_iterator itLatency;
+    for(itLatency = qMapLatencies.constBegin(); itLatency != qMapLatencies.constEnd(); ++itLatency) {
+        const PipelineLatencyHistogram& histogram = itLatency.value();
+
+        out << QString("  %1 %2 %3 %4 %5 %6 %7\n").arg(itLatency.key(), -48)
+                                                  .arg(histogram.iCount, 10)
+                                                  .arg(histogram.mean(), 9, 'f', 2)
+                                                  .arg(histogram.percentile(0.5), 9, 'f', 2)
+                                                  .arg(histogram.percentile(0.95), 9, 'f', 2)
+                                                  .arg(histogram.percentile(0.99), 9, 'f', 2)
+                                                  .arg(histogram.dMaxMs, 9, 'f', 2);
+    }
+
+    out << "\nThreads\n";
+    out << QString("  %1 %2 %3\n").arg("Thread", -48).arg("CPU (ms)", 10).arg("Load", 9);
+
+    QMap<QString, PipelineThreadLoad> qMapLoads = pTracer->threadLoads();
+    QMap<QString, PipelineThreadLoad>::const_iterator itLoad;
+    for(itLoad = qMapLoads.constBegin(); itLoad != qMapLoads.constEnd(); ++itLoad) {
+        out << QString("  %1 %2 %3\n").arg(itLoad.key(), -48)
+                                      .arg(itLoad.value().dCpuMs, 10, 'f', 0)
+                                      .arg(itLoad.value().dLoad, 9, 'f', 2);
+    }
+
+    out << "\nBuffers\n";
+    out << QString("  %1 %2 %3\n").arg("Buffer", -48).arg("Max depth", 10).arg("Capacity", 9);
+
+    QMap<QString, PipelineQueueDepth> qMapDepths = pTracer->queueDepths();
+    QMap<QString, PipelineQueueDepth>::const_iterator itDepth;
+    for(itDepth = qMapDepths.constBegin(); itDepth != qMapDepths.constEnd(); ++itDepth) {
+        out << QString("  %1 %2 %3\n").arg(itDepth.key(), -48)
+                                      .arg(itDepth.value().iMaxDepth, 10)
+                                      .arg(itDepth.value().iCapacity, 9);
+    }
+
+    out.flush();
+}
+
+
+//*************************************************************************************************************
+
+bool PipelineRunner::writeJsonReport(const QString& sFileName) const
+{
+    PipelineTracer* pTracer = PipelineTracer::instance();
+    double dSeconds = m_iElapsedMs / 1000.0;
+
+    QJsonObject jsonRoot;
+    jsonRoot.insert("duration_s", dSeconds);
+    jsonRoot.insert("speed", m_dSpeed);
+
+    QJsonArray jsonThroughput;
+    m_qMutex.lock();
+    QMap<QString, PipelineRunnerThroughput>::const_iterator itThroughput;
+    for(itThroughput = m_qMapThroughput.constBegin(); itThroughput != m_qMapThroughput.constEnd(); ++itThroughput) {
+        const PipelineRunnerThroughput& throughput = itThroughput.value();
+        double dRate = dSeconds > 0 ? throughput.iNumSamples / dSeconds : 0.0;
+
+        QJsonObject jsonOutput;
+        jsonOutput.insert("output", itThroughput.key());
+        jsonOutput.insert("blocks", static_cast<double>(throughput.iNumBlocks));
+        jsonOutput.insert("samples_per_s", dRate);
+        jsonOutput.insert("real_time_factor", throughput.dSamplingRate > 0 ? dRate / throughput.dSamplingRate : 0.0);
+        jsonThroughput.append(jsonOutput);
+    }
+    m_qMutex.unlock();
+    jsonRoot.insert("throughput", jsonThroughput);
+
+    QJsonArray jsonLatencies;
+    QMap<QString, PipelineLatencyHistogram> qMapLatencies = pTracer->latencies();
+    QMap<QString, PipelineLatencyHistogram>::const_iterator itLatency;
+    for(itLatency = qMapLatencies.constBegin(); itLatency != qMapLatencies.constEnd(); ++itLatency) {
+        const PipelineLatencyHistogram& histogram = itLatency.value();
+
+        QJsonObject jsonLatency;
+        jsonLatency.insert("connection", itLatency.key());
+        jsonLatency.insert("count", static_cast<double>(histogram.iCount));
+        jsonLatency.insert("mean_ms", histogram.mean());
+        jsonLatency.insert("p50_ms", histogram.percentile(0.5));
+        jsonLatency.insert("p95_ms", histogram.percentile(0.95));
+        jsonLatency.insert("p99_ms", histogram.percentile(0.99));
+        jsonLatency.insert("max_ms", histogram.dMaxMs);
+        jsonLatencies.append(jsonLatency);
+    }
+    jsonRoot.insert("latencies", jsonLatencies);
+
+    QJsonArray jsonThreads;
+    QMap<QString, PipelineThreadLoad> qMapLoads = pTracer->threadLoads();
+    QMap<QString, PipelineThreadLoad>::const_iterator itLoad;
+    for(itLoad = qMapLoads.constBegin(); itLoad != qMapLoads.constEnd(); ++itLoad) {
+        QJsonObject jsonThread;
+        jsonThread.insert("thread", itLoad.key());
+        jsonThread.insert("cpu_ms", itLoad.value().dCpuMs);
+        jsonThread.insert("load", itLoad.value().dLoad);
+        jsonThreads.append(jsonThread);
+    }
+    jsonRoot.insert("threads", jsonThreads);
+
+    QJsonArray jsonBuffers;
+    QMap<QString, PipelineQueueDepth> qMapDepths = pTracer->queueDepths();
+    QMap<QString, PipelineQueueDepth>::const_iterator itDepth;
+    for(itDepth = qMapDepths.constBegin(); itDepth != qMapDepths.constEnd(); ++itDepth) {
+        QJsonObject jsonBuffer;
+        jsonBuffer.insert("buffer", itDepth.key());
+        jsonBuffer.insert("max_depth", itDepth.value().iMaxDepth);
+        jsonBuffer.insert("capacity", itDepth.value().iCapacity);
+        jsonBuffers.append(jsonBuffer);
+    }
+    jsonRoot.insert("buffers", jsonBuffers);
+
+    QFile file(sFileName);
+    if(!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "PipelineRunner::writeJsonReport - Could not open" << sFileName;
+        return false;
+    }
+
+    file.write(QJsonDocument(jsonRoot).toJson());
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void PipelineRunner::connectOutputs()
+{
+    const PluginSceneManager::PluginList& lPlugins = m_pPluginSceneManager->getPlugins();
+
+    for(qint32 i = 0; i < lPlugins.size(); ++i) {
+        IPlugin::OutputConnectorList& lOutputs = lPlugins[i]->getOutputConnectors();
+
+        for(qint32 j = 0; j < lOutputs.size(); ++j) {
+            QString sName = QString("%1::%2").arg(lPlugins[i]->getName()).arg(lOutputs[j]->getName());
+
+            //Direct connection, the counting happens in the sending thread
+            connect(lOutputs[j].data(), &PluginOutputConnector::notify, this, [this, sName](NewMeasurement::SPtr pMeasurement) {
+                if(!m_iMeasuring.load())
+                    return;
+
+                qint64 iNumSamples = 0;
+                double dSamplingRate = 0.0;
+
+                if(QSharedPointer<NewRealTimeMultiSampleArray> pRTMSA = pMeasurement.dynamicCast<NewRealTimeMultiSampleArray>()) {
+                    QList<MeasurementBlock::ConstSPtr> qListBlocks = pRTMSA->getMultiSampleBlocks();
+                    for(qint32 k = 0; k < qListBlocks.size(); ++k)
+                        iNumSamples += qListBlocks[k]->cols();
+                    dSamplingRate = pRTMSA->getSamplingRate();
+                }
+
+                QMutexLocker locker(&m_qMutex);
+                PipelineRunnerThroughput& throughput = m_qMapThroughput[sName];
+                ++throughput.iNumBlocks;
+                throughput.iNumSamples += iNumSamples;
+                throughput.dSamplingRate = dSamplingRate;
+            }, Qt::DirectConnection);
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void PipelineRunner::onWarmUpFinished()
+{
+    PipelineTracer::instance()->clear();
+
+    m_qMutex.lock();
+    m_qMapThroughput.clear();
+    m_qMutex.unlock();
+
+    m_qTimer.start();
+    m_iMeasuring.store(1);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineRunner::onMeasurementFinished()
+{
+    m_iElapsedMs = m_qTimer.elapsed();
+
+    stop();
+
+    emit finished();
+}
@@ -0,0 +1,219 @@
+//=============================================================================================================
+/**
+* @file     pipelinerunner.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     PipelineRunner class declaration.
+*
+*/
+
+#ifndef PIPELINERUNNER_H
+#define PIPELINERUNNER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <scShared/Management/pluginmanager.h>
+#include <scShared/Management/pluginscenemanager.h>
+#include <scShared/Management/pluginconnectorconnection.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMap>
+#include <QAtomicInt>
+#include <QTextStream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNESCAN
+//=============================================================================================================
+
+namespace MNESCAN
+{
+
+//=============================================================================================================
+/**
+* Number of samples and blocks which passed one output connector.
+*
+* @brief Throughput of one output connector
+*/
+struct PipelineRunnerThroughput
+{
+    qint64  iNumBlocks;     /**< Number of measurements sent. */
+    qint64  iNumSamples;    /**< Number of samples sent, only counted for real-time multi sample arrays. */
+    double  dSamplingRate;  /**< Sampling rate announced by the measurement, 0 if unknown. */
+};
+
+
+//=============================================================================================================
+/**
+* Runs a saved plugin scene without the GUI. The scene is loaded from the XML file written by MNE Scan, the
+* fiff simulator of mne_rt_server can be pointed to a file and sped up beforehand. After a warm-up phase
+* the pipeline is measured for a fixed time; the sustained throughput of every output connector and the
+* latencies, thread loads and buffer fill levels recorded by the PipelineTracer are reported afterwards.
+*
+* @brief Headless runner and benchmark of MNE Scan pipelines
+*/
+class PipelineRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef QSharedPointer<PipelineRunner> SPtr;              /**< Shared pointer type for PipelineRunner. */
+    typedef QSharedPointer<const PipelineRunner> ConstSPtr;   /**< Const shared pointer type for PipelineRunner. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a PipelineRunner and loads the plugins.
+    *
+    * @param[in] sPluginDir     directory of the plugin libraries.
+    * @param[in] parent         parent of this object.
+    */
+    explicit PipelineRunner(const QString& sPluginDir, QObject* parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Stops the pipeline if it is still running.
+    */
+    ~PipelineRunner();
+
+    //=========================================================================================================
+    /**
+    * Sets the simulation file and the replay speed of the fiff simulator connector of mne_rt_server. The replay
+    * speed only shortens the pause between the buffers, the plugins see the true sampling rate of the file.
+    * Has to be called before the scene is loaded, since the plugins request the measurement info on load.
+    *
+    * @param[in] sHost          host name of mne_rt_server.
+    * @param[in] sSimFile       raw file to simulate, the current file of the server is kept if empty.
+    * @param[in] dSpeed         replay speed as multiple of real time, 0 replays as fast as possible.
+    *
+    * @return true if the server accepted the settings.
+    */
+    bool configureSimulator(const QString& sHost, const QString& sSimFile, double dSpeed);
+
+    //=========================================================================================================
+    /**
+    * Creates the plugins and connections of a scene saved by MNE Scan.
+    *
+    * @param[in] sFileName      the scene file.
+    *
+    * @return true if at least one plugin was created.
+    */
+    bool loadScene(const QString& sFileName);
+
+    //=========================================================================================================
+    /**
+    * Starts the pipeline. The measurement starts after the warm-up and lasts for the given time, afterwards the
+    * pipeline is stopped and finished() is emitted.
+    *
+    * @param[in] iWarmUpMs      warm-up time in ms, which is excluded from the results.
+    * @param[in] iDurationMs    measurement time in ms.
+    *
+    * @return true if the pipeline was started.
+    */
+    bool start(qint32 iWarmUpMs, qint32 iDurationMs);
+
+    //=========================================================================================================
+    /**
+    * Stops the pipeline.
+    */
+    void stop();
+
+    //=========================================================================================================
+    /**
+    * Writes the results as text.
+    *
+    * @param[in] out            the stream to write to.
+    */
+    void writeReport(QTextStream& out) const;
+
+    //=========================================================================================================
+    /**
+    * Writes the results as JSON.
+    *
+    * @param[in] sFileName      the file to write to.
+    *
+    * @return true if the file was written.
+    */
+    bool writeJsonReport(const QString& sFileName) const;
+
+signals:
+    //=========================================================================================================
+    /**
+    * Emitted when the measurement time is over and the pipeline was stopped.
+    */
+    void finished();
+
+private:
+    //=========================================================================================================
+    /**
+    * Counts the samples of all output connectors of the loaded plugins.
+    */
+    void connectOutputs();
+
+    //=========================================================================================================
+    /**
+    * Discards everything recorded during the warm-up and starts the measurement.
+    */
+    void onWarmUpFinished();
+
+    //=========================================================================================================
+    /**
+    * Stops the pipeline at the end of the measurement.
+    */
+    void onMeasurementFinished();
+
+    SCSHAREDLIB::PluginManager::SPtr        m_pPluginManager;       /**< Loads the plugin libraries. */
+    SCSHAREDLIB::PluginSceneManager::SPtr   m_pPluginSceneManager;  /**< Holds the plugins of the scene. */
+    QList<SCSHAREDLIB::PluginConnectorConnection::SPtr> m_qListConnections;   /**< The connections of the scene. */
+
+    bool                m_bIsRunning;       /**< Whether the pipeline is running. */
+    double              m_dSpeed;           /**< Replay speed of the simulator, 0 if unthrottled. */
+    qint64              m_iElapsedMs;       /**< Duration of the finished measurement in ms. */
+    QElapsedTimer       m_qTimer;           /**< Measures the measurement time. */
+    QAtomicInt          m_iMeasuring;       /**< Set while the outputs are counted, i.e. after the warm-up. */
+
+    mutable QMutex                              m_qMutex;           /**< Guards the throughput counters. */
+    QMap<QString, PipelineRunnerThroughput>     m_qMapThroughput;   /**< Throughput per output connector. */
+};
+
+} // NAMESPACE
+
+#endif // PIPELINERUNNER_H
@@ -48,6 +48,8 @@
 #include <scMeas/realtimeevoked.h>
 #include <scMeas/newrealtimemultisamplearray.h>
 
+#include <scShared/Management/pipelinetracer.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -265,6 +267,7 @@ void Averaging::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
         //Check if buffer initialized
         if(!m_pAveragingBuffer) {
             m_pAveragingBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            PipelineTracer::instance()->registerBuffer(this->getName() + " Input Buffer", m_pAveragingBuffer);
         }
 
         //Fiff information
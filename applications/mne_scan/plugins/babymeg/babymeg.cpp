@@ -57,6 +57,8 @@
 #include <rtClient/rtcmdclient.h>
 #include <scMeas/newrealtimemultisamplearray.h>
 
+#include <scShared/Management/pipelinetracer.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -529,8 +531,10 @@ void BabyMEG::setFiffData(QByteArray DATA)
 
     if(m_bIsRunning)
     {
-        if(!m_pRawMatrixBuffer)
+        if(!m_pRawMatrixBuffer) {
             m_pRawMatrixBuffer = CircularMatrixBuffer<float>::SPtr(new CircularMatrixBuffer<float>(40, rows, cols));
+            PipelineTracer::instance()->registerBuffer(this->getName() + " Input Buffer", m_pRawMatrixBuffer);
+        }
 
         m_pRawMatrixBuffer->push(&rawData);
     }
@@ -41,6 +41,8 @@
 
 #include "bci.h"
 
+#include <scShared/Management/pipelinetracer.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -60,6 +62,7 @@
 using namespace BCIPlugin;
 using namespace std;
 using namespace UTILSLIB;
+using namespace SCSHAREDLIB;
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -100,6 +103,8 @@ void BCI::init()
 {
     m_bIsRunning = false;
     m_bTriggerActivated = false;
+    m_bTriggerReceived = false;
+    m_bTriggerOnsetPending = false;
 
     // Inputs - Source estimates and sensor level
     m_pRTSEInput = PluginInputData<RealTimeSourceEstimate>::create(this, "BCIInSource", "BCI source input data");
@@ -303,6 +308,8 @@ bool BCI::stop()
 
     // Reset trigger
     m_bTriggerActivated = false;
+    m_bTriggerReceived = false;
+    m_bTriggerOnsetPending = false;
 
     // Clear stream
     m_outStreamDebug.close();
@@ -357,8 +364,10 @@ void BCI::updateSensor(XMEASLIB::NewMeasurement::SPtr pMeasurement)
     if(pRTMSA)
     {
         //Check if buffer initialized
-        if(!m_pBCIBuffer_Sensor)
+        if(!m_pBCIBuffer_Sensor) {
             m_pBCIBuffer_Sensor = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiArraySize()));
+            PipelineTracer::instance()->registerBuffer(this->getName() + " Sensor Buffer", m_pBCIBuffer_Sensor);
+        }
 
         // Load Fiff information on sensor level
         if(!m_pFiffInfo_Sensor)
@@ -413,6 +422,13 @@ void BCI::updateSensor(XMEASLIB::NewMeasurement::SPtr pMeasurement)
             for(unsigned char i = 0; i < pRTMSA->getMultiArraySize(); ++i)
                 t_mat.col(i) = pRTMSA->getMultiSampleArray()[i];
 
+            if(lookForTrigger(pRTMSA->getTriggerEvents(), t_mat, pRTMSA->getFirstSample()))
+            {
+                m_qMutex.lock();
+                    m_bTriggerReceived = true;
+                m_qMutex.unlock();
+            }
+
             m_pBCIBuffer_Sensor->push(&t_mat);
         }
     }
@@ -428,8 +444,10 @@ void BCI::updateSource(XMEASLIB::NewMeasurement::SPtr pMeasurement)
     if(pRTSE)
     {
         //Check if buffer initialized
-        if(!m_pBCIBuffer_Source)
+        if(!m_pBCIBuffer_Source) {
             m_pBCIBuffer_Source = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTSE->getValue().size(), pRTSE->getArraySize()));
+            PipelineTracer::instance()->registerBuffer(this->getName() + " Source Buffer", m_pBCIBuffer_Source);
+        }
 
         if(m_bProcessData)
         {
@@ -568,16 +586,34 @@ bool BCI::hasThresholdArtefact(const QList< QPair<int,RowVectorXd> > &data)
 
 //*************************************************************************************************************
 
-bool BCI::lookForTrigger(const MatrixXd &data)
+bool BCI::lookForTrigger(const QList<TriggerEvent> &lEvents, const MatrixXd &data, qint64 iFirstSample)
 {
-    // Check if capacitive touch trigger signal was received - Note that there can also be "beep" triggers in the received data, which are only 1 sample wide -> therefore look for 2 samples with a value of 254 each
-    for(int i = 0; i<data.cols()-1; i++)
+    // Check if capacitive touch trigger signal was received - Note that there can also be "beep" triggers in the received data, which are only 1 sample wide -> a touch has to hold the code 254 for 2 samples
+    bool bTriggerFound = false;
+
+    // An onset in the last sample of the previous block is confirmed by the first sample of this block
+    if(m_bTriggerOnsetPending && data.cols() > 0 && data(136, 0) == 254)
+        bTriggerFound = true;
+    m_bTriggerOnsetPending = false;
+
+    for(int i = 0; i < lEvents.size(); i++)
     {
-        if(data(0,i) == 254 && data(0,i+1) == 254) // data - corresponds with channel 136 which is the trigger channel
-            return true;
+        // Channel 136 is the trigger channel
+        if(lEvents.at(i).iChannel != 136 || lEvents.at(i).iCode != 254)
+            continue;
+
+        qint64 iCol = lEvents.at(i).iSample - iFirstSample;
+
+        if(iCol < 0 || iCol >= data.cols())
+            continue;
+
+        if(iCol == data.cols() - 1)
+            m_bTriggerOnsetPending = true;
+        else if(data(136, iCol + 1) == 254)
+            bTriggerFound = true;
     }
 
-    return false;
+    return bTriggerFound;
 }
 
 
@@ -701,8 +737,14 @@ void BCI::BCIOnSensorLevel()
             if(hasThresholdArtefact(qlMatrixRows) == false)
             {
                 // Look for trigger flag
-                if(lookForTrigger(m_matStimChannelSensor) && !m_bTriggerActivated)
+                m_qMutex.lock();
+                    bool bTriggerReceived = m_bTriggerReceived;
+                    m_bTriggerReceived = false;
+                m_qMutex.unlock();
+
+                if(bTriggerReceived && !m_bTriggerActivated)
                 {
+
                     // cout << "Trigger activated" << endl;
                     //QFuture<void> future = QtConcurrent::run(Beep, 450, 700);
                     m_bTriggerActivated = true;
@@ -53,6 +53,7 @@
 #include <xMeas/realtimesourceestimate.h>
 
 #include <utils/filterdata.h>
+#include <utils/streamtriggerdetector.h>
 
 #include <fstream>
 
@@ -240,10 +241,16 @@ protected:
 
     //=========================================================================================================
     /**
-    * Look for trigger in stim channel
+    * Look for a capacitive touch trigger in the trigger events of the measurement. An onset of the code 254
+    * only counts if the code is still present in the next sample, which is checked against the published data.
     *
+    * @param[in] lEvents        The trigger events of the measurement's current block
+    * @param[in] data           The current block of the measurement (channels x samples)
+    * @param[in] iFirstSample   The absolute sample index of the first column of data
+    *
+    * @return whether a capacitive touch trigger starts in this block
     */
-    bool lookForTrigger(const MatrixXd &data);
+    bool lookForTrigger(const QList<TriggerEvent> &lEvents, const MatrixXd &data, qint64 iFirstSample);
 
     //=========================================================================================================
     /**
@@ -293,6 +300,8 @@ private:
     QString                 m_qStringResourcePath;              /**< The path to the BCI resource directory.*/
     bool                    m_bProcessData;                     /**< Whether BCI is to get data out of the continous input data stream, i.e. the EEG data from sensor level.*/
     bool                    m_bTriggerActivated;                /**< Whether the trigger was activated.*/
+    bool                    m_bTriggerReceived;                 /**< Whether a trigger was found in the stim channel since the last classification.*/
+    bool                    m_bTriggerOnsetPending;             /**< Whether a trigger onset in the last sample of the previous block still needs to be confirmed.*/
     QMutex                  m_qMutex;                           /**< QMutex to guarantee thread safety.*/
 
     // Sensor level
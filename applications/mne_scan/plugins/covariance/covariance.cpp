@@ -42,6 +42,8 @@
 #include "FormFiles/covariancesetupwidget.h"
 #include "FormFiles/covariancesettingswidget.h"
 
+#include <scShared/Management/pipelinetracer.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -218,8 +220,10 @@ void Covariance::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
     if(pRTMSA)
     {
         //Check if buffer initialized
-        if(!m_pCovarianceBuffer)
+        if(!m_pCovarianceBuffer) {
             m_pCovarianceBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            PipelineTracer::instance()->registerBuffer(this->getName() + " Input Buffer", m_pCovarianceBuffer);
+        }
 
         //Fiff information
         if(!m_pFiffInfo)
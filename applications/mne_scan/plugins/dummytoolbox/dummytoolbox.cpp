@@ -40,6 +40,8 @@
 
 #include "dummytoolbox.h"
 
+#include <scShared/Management/pipelinetracer.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -185,7 +187,8 @@ void DummyToolbox::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
     if(pRTMSA) {
         //Check if buffer initialized
         if(!m_pDummyBuffer) {
-            m_pDummyBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pDummyBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlocks().first()->cols()));
+            PipelineTracer::instance()->registerBuffer(this->getName() + " Input Buffer", m_pDummyBuffer);
         }
 
         //Fiff information
@@ -198,12 +201,10 @@ void DummyToolbox::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
             m_pDummyOutput->data()->setVisibility(true);
         }
 
-        MatrixXd t_mat;
+        QList<MeasurementBlock::ConstSPtr> qListBlocks = pRTMSA->getMultiSampleBlocks();
 
-        for(unsigned char i = 0; i < pRTMSA->getMultiArraySize(); ++i) {
-            t_mat = pRTMSA->getMultiSampleArray()[i];
-            m_pDummyBuffer->push(&t_mat);
-        }
+        for(qint32 i = 0; i < qListBlocks.size(); ++i)
+            m_pDummyBuffer->push(&qListBlocks[i]->toDouble());
     }
 }
 
@@ -42,6 +42,8 @@
 #include "eegosports.h"
 #include "eegosportsproducer.h"
 
+#include <scShared/Management/pipelinetracer.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -108,6 +110,7 @@ EEGoSports::~EEGoSports()
     QSettings settings;
     settings.setValue(QString("EEGOSPORTS/sFreq"), m_iSamplingFreq);
     settings.setValue(QString("EEGOSPORTS/samplesPerBlock"), m_iSamplesPerBlock);
+    settings.setValue(QString("EEGOSPORTS/latencyBudget"), m_blockCoalescer.latencyBudget());
     settings.setValue(QString("EEGOSPORTS/LPAShift"), m_dLPAShift);
     settings.setValue(QString("EEGOSPORTS/RPAShift"), m_dRPAShift);
     settings.setValue(QString("EEGOSPORTS/NasionShift"), m_dNasionShift);
@@ -145,6 +148,7 @@ void EEGoSports::init()
     m_iSamplingFreq = settings.value(QString("EEGOSPORTS/sFreq"), 1024).toInt();
     m_iNumberOfChannels = 90;
     m_iSamplesPerBlock = settings.value(QString("EEGOSPORTS/samplesPerBlock"), 1024).toInt();
+    m_blockCoalescer.setLatencyBudget(settings.value(QString("EEGOSPORTS/latencyBudget"), 20.0).toDouble());
     m_bWriteToFile = false;
     m_bWriteDriverDebugToFile = false;
     m_bIsRunning = false;
@@ -528,7 +532,12 @@ bool EEGoSports::start()
 
     //Buffer
     m_pRawMatrixBuffer_In = QSharedPointer<RawMatrixBuffer>(new RawMatrixBuffer(8, m_iNumberOfChannels, m_iSamplesPerBlock));
+
+    PipelineTracer::instance()->registerBuffer(this->getName() + " Input Buffer", m_pRawMatrixBuffer_In);
+
     m_qListReceivedSamples.clear();
+    m_blockCoalescer.setSamplingFrequency(m_iSamplingFreq);
+    m_blockCoalescer.clear();
 
     m_pEEGoSportsProducer->start(m_iNumberOfChannels,
                        m_iSamplesPerBlock,
@@ -570,6 +579,8 @@ bool EEGoSports::stop()
 
     m_qListReceivedSamples.clear();
 
+    PipelineTracer::instance()->unregisterQueue(this->getName() + " Input Buffer");
+
     return true;
 }
 
@@ -635,14 +646,20 @@ void EEGoSports::run()
     {
         if(m_pEEGoSportsProducer->isRunning())
         {
+            //Take all received blocks at once, so that the producer is not held up while the data is emitted
+            QList<MatrixXd> qListReceivedSamples;
+
             m_mutex.lock();
+            qListReceivedSamples.swap(m_qListReceivedSamples);
+            m_mutex.unlock();
 
-            if(m_qListReceivedSamples.isEmpty() == false)
-            {
-                MatrixXd matValue;
-                matValue = m_qListReceivedSamples.first();
-                m_qListReceivedSamples.removeFirst();
+            for(qint32 i = 0; i < qListReceivedSamples.size(); ++i)
+                m_blockCoalescer.append(qListReceivedSamples.at(i));
+
+            MatrixXd matValue;
 
+            if(m_blockCoalescer.isReady() && m_blockCoalescer.takeBlock(matValue))
+            {
                 //Write raw data to fif file
                 if(m_bWriteToFile) {
                     m_pOutfid->write_raw_buffer(matValue, m_cals);
@@ -652,11 +669,14 @@ void EEGoSports::run()
                 //qDebug()<<"EEGoSports::run() - mat size"<<matValue.rows()<<"x"<<matValue.cols();
                 m_pRMTSA_EEGoSports->data()->setValue(matValue);
             }
-
-            m_mutex.unlock();            
         }
     }
 
+    //Write the samples which are still held back by the coalescer
+    MatrixXd matValue;
+    if(m_blockCoalescer.takeBlock(matValue) && m_bWriteToFile)
+        m_pOutfid->write_raw_buffer(matValue, m_cals);
+
     //Close the fif output stream
     if(m_bWriteToFile)
     {
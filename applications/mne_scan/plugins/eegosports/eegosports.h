@@ -51,6 +51,7 @@
 #include <scShared/Interfaces/ISensor.h>
 #include <generics/circularmatrixbuffer.h>
 #include <scMeas/newrealtimemultisamplearray.h>
+#include <scMeas/blockcoalescer.h>
 
 #include <utils/layoutloader.h>
 #include <utils/layoutmaker.h>
@@ -285,6 +286,7 @@ private:
     qint16                              m_iBlinkStatus;                     /**< flag for recording icon blinking */
 
     QList<MatrixXd>                     m_qListReceivedSamples;             /**< list with alle the received samples in form of differentley sized matrices. */
+    BlockCoalescer                      m_blockCoalescer;                   /**< collects the small driver blocks into larger blocks before they are emitted. */
 
     QMutex                              m_mutex;
 
@@ -45,6 +45,8 @@
 
 #include <utils/ioutils.h>
 
+#include <scShared/Management/pipelinetracer.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -316,6 +318,8 @@ bool FiffSimulator::start()
         m_bIsRunning = true;
         m_qMutex.unlock();
 
+        PipelineTracer::instance()->registerBuffer(this->getName() + " Input Buffer", m_pRawMatrixBuffer_In);
+
         // Start threads
         QThread::start();
 
@@ -358,6 +362,8 @@ bool FiffSimulator::stop()
         m_pRTMSA_FiffSimulator->data()->clear();
     }
 
+    PipelineTracer::instance()->unregisterQueue(this->getName() + " Input Buffer");
+
     return true;
 }
 
@@ -403,7 +409,9 @@ void FiffSimulator::run()
         //pop matrix
         matValue = m_pRawMatrixBuffer_In->pop();
 
-        //emit values
-        m_pRTMSA_FiffSimulator->data()->setValue(matValue.cast<double>());
+        //emit values - the samples are handed over to a pooled block without copying or converting them
+        MeasurementBlock::SPtr pBlock = m_pRTMSA_FiffSimulator->data()->acquireBlock(MeasurementBlock::Float32, matValue.rows(), matValue.cols());
+        pBlock->dataFloat().swap(matValue);
+        m_pRTMSA_FiffSimulator->data()->setValue(MeasurementBlock::ConstSPtr(pBlock));
     }
 }
@@ -42,6 +42,8 @@
 
 #include "FormFiles/mnesetupwidget.h"
 
+#include <scShared/Management/pipelinetracer.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -59,6 +61,7 @@
 //=============================================================================================================
 
 using namespace MNEPlugin;
+using namespace SCSHAREDLIB;
 using namespace FIFFLIB;
 using namespace SCMEASLIB;
 
@@ -363,8 +366,10 @@ void MNE::updateRTMSA(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 
     if(pRTMSA && m_bReceiveData) {
         //Check if buffer initialized
-        if(!m_pMatrixDataBuffer)
-            m_pMatrixDataBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+        if(!m_pMatrixDataBuffer) {
+            m_pMatrixDataBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlocks().first()->cols()));
+            PipelineTracer::instance()->registerBuffer(this->getName() + " Input Buffer", m_pMatrixDataBuffer);
+        }
 
         //Fiff Information of the evoked
         if(!m_pFiffInfoInput) {
@@ -375,12 +380,10 @@ void MNE::updateRTMSA(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 
         if(m_bProcessData)
         {
-            for(qint32 i = 0; i < pRTMSA->getMultiSampleArray().size(); ++i)
-            {
-                MatrixXd t_mat = pRTMSA->getMultiSampleArray()[i];
+            QList<MeasurementBlock::ConstSPtr> qListBlocks = pRTMSA->getMultiSampleBlocks();
 
-                m_pMatrixDataBuffer->push(&t_mat);
-            }
+            for(qint32 i = 0; i < qListBlocks.size(); ++i)
+                m_pMatrixDataBuffer->push(&qListBlocks[i]->toDouble());
         }
     }
 }
@@ -46,6 +46,8 @@
 #include <utils/ioutils.h>
 #include <fiff/fiff_dir_tree.h>
 
+#include <scShared/Management/pipelinetracer.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -318,6 +320,8 @@ bool Neuromag::start()
         // Buffer
         m_pRawMatrixBuffer_In = QSharedPointer<RawMatrixBuffer>(new RawMatrixBuffer(8,m_pFiffInfo->nchan,m_iBufferSize));
 
+        PipelineTracer::instance()->registerBuffer(this->getName() + " Input Buffer", m_pRawMatrixBuffer_In);
+
         m_bIsRunning = true;
 
         // Start threads
@@ -360,6 +364,8 @@ bool Neuromag::stop()
         m_pRTMSA_Neuromag->data()->clear();
     }
 
+    PipelineTracer::instance()->unregisterQueue(this->getName() + " Input Buffer");
+
     return true;
 }
 
@@ -444,7 +450,9 @@ void Neuromag::run()
         //pop matrix
         matValue = m_pRawMatrixBuffer_In->pop();
 
-        //emit values
-        m_pRTMSA_Neuromag->data()->setValue(matValue.cast<double>());
+        //emit values - the samples are handed over to a pooled block without copying or converting them
+        MeasurementBlock::SPtr pBlock = m_pRTMSA_Neuromag->data()->acquireBlock(MeasurementBlock::Float32, matValue.rows(), matValue.cols());
+        pBlock->dataFloat().swap(matValue);
+        m_pRTMSA_Neuromag->data()->setValue(MeasurementBlock::ConstSPtr(pBlock));
     }
 }
@@ -59,6 +59,8 @@ using namespace NoiseEstimatePlugin;
 using namespace SCSHAREDLIB;
 using namespace SCMEASLIB;
 
+#include <scShared/Management/pipelinetracer.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -254,7 +256,8 @@ void NoiseEstimate::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
         m_qMutex.lock();
         if(!m_pBuffer)
         {
-            m_pBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(8, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(8, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlocks().first()->cols()));
+            PipelineTracer::instance()->registerBuffer(this->getName() + " Input Buffer", m_pBuffer);
         }
 
         //Fiff information
@@ -267,13 +270,10 @@ void NoiseEstimate::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 
         if(m_bProcessData)
         {
-            MatrixXd t_mat;
+            QList<MeasurementBlock::ConstSPtr> qListBlocks = pRTMSA->getMultiSampleBlocks();
 
-            for(qint32 i = 0; i < pRTMSA->getMultiArraySize(); ++i)
-            {
-                t_mat = pRTMSA->getMultiSampleArray()[i];
-                m_pBuffer->push(&t_mat);
-            }
+            for(qint32 i = 0; i < qListBlocks.size(); ++i)
+                m_pBuffer->push(&qListBlocks[i]->toDouble());
         }
     }
 }
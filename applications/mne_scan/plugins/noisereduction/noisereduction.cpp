@@ -40,6 +40,8 @@
 
 #include "noisereduction.h"
 
+#include <scShared/Management/pipelinetracer.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -63,6 +65,7 @@ using namespace RTPROCESSINGLIB;
 
 NoiseReduction::NoiseReduction()
 : m_bIsRunning(false)
+, m_bStageInitialized(false)
 , m_pNoiseReductionInput(NULL)
 , m_pNoiseReductionOutput(NULL)
 , m_pNoiseReductionBuffer(CircularMatrixBuffer<double>::SPtr())
@@ -192,6 +195,14 @@ bool NoiseReduction::start()
 
     m_bIsRunning = true;
 
+    //In the task based mode the blocks are processed on the pipeline scheduler instead of this thread
+    if(PipelineScheduler::isEnabled()) {
+        m_bStageInitialized = false;
+        QMutexLocker locker(&m_qStageMutex);
+        m_pStage = PipelineStage::SPtr(new PipelineStage(getName()));
+        return true;
+    }
+
     //Start thread
     QThread::start();
 
@@ -205,6 +216,16 @@ bool NoiseReduction::stop()
 {
     m_bIsRunning = false;
 
+    m_qStageMutex.lock();
+    PipelineStage::SPtr pStage = m_pStage;
+    m_pStage.clear();
+    m_qStageMutex.unlock();
+
+    //Tasks which are posted to the local copy of the producer meanwhile are done before the stage is deleted
+    if(pStage) {
+        pStage->waitForIdle();
+    }
+
     m_pNoiseReductionBuffer->releaseFromPop();
     m_pNoiseReductionBuffer->clear();
 
@@ -250,7 +271,8 @@ void NoiseReduction::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
     if(m_pRTMSA) {
         //Check if buffer initialized
         if(!m_pNoiseReductionBuffer) {
-            m_pNoiseReductionBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, m_pRTMSA->getNumChannels(), m_pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pNoiseReductionBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, m_pRTMSA->getNumChannels(), m_pRTMSA->getMultiSampleBlocks().first()->cols()));
+            PipelineTracer::instance()->registerBuffer(this->getName() + " Input Buffer", m_pNoiseReductionBuffer);
         }
 
         //Fiff information
@@ -278,16 +300,47 @@ void NoiseReduction::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
             m_pNoiseReductionOutput->data()->setVisibility(true);            
 
             //Init the filter
-            m_iMaxFilterTapSize = m_pRTMSA->getMultiSampleArray().at(m_pRTMSA->getMultiSampleArray().size()-1).cols();
+            m_iMaxFilterTapSize = m_pRTMSA->getMultiSampleBlocks().last()->cols();
             initFilter();
         }
 
-        MatrixXd t_mat;
+        QList<MeasurementBlock::ConstSPtr> qListBlocks = m_pRTMSA->getMultiSampleBlocks();
+
+        //stop() clears m_pStage from the GUI thread, so post to a local copy
+        m_qStageMutex.lock();
+        PipelineStage::SPtr pStage = m_pStage;
+        m_qStageMutex.unlock();
 
-        for(unsigned char i = 0; i < m_pRTMSA->getMultiArraySize(); ++i) {
-            t_mat = m_pRTMSA->getMultiSampleArray()[i];
-            m_pNoiseReductionBuffer->push(&t_mat);
+        if(pStage) {
+            //The blocks are immutable and shared, so the task only holds references to them. post blocks while the
+            //stage is behind, so that no block is dropped and the filter state stays continuous.
+            PipelineScheduler::Task task = [this, qListBlocks]() {
+                if(!m_bStageInitialized) {
+                    QMetaObject::invokeMethod(m_pActionShowOptionsWidget, "setVisible", Qt::QueuedConnection, Q_ARG(bool, true));
+
+                    initSphara();
+                    createSpharaOperator();
+                    m_bStageInitialized = true;
+                }
+
+                for(qint32 i = 0; i < qListBlocks.size(); ++i) {
+                    MatrixXd t_mat = qListBlocks[i]->toDouble();
+                    processBlock(t_mat);
+                }
+            };
+
+            //If the upstream plugin publishes from a task, waiting here could deadlock the pool -> drop instead
+            if(PipelineScheduler::instance()->isWorkerThread()) {
+                pStage->tryPost(task);
+            } else {
+                pStage->post(task);
+            }
+
+            return;
         }
+
+        for(qint32 i = 0; i < qListBlocks.size(); ++i)
+            m_pNoiseReductionBuffer->push(&qListBlocks[i]->toDouble());
     }
 }
 
@@ -735,70 +788,101 @@ void NoiseReduction::run()
         //Dispatch the inputs
         MatrixXd t_mat = m_pNoiseReductionBuffer->pop();
 
-        m_mutex.lock();
+        processBlock(t_mat);
+    }
+}
 
-        //Do SSP's and compensators here
-        if(m_bCompActivated) {
-            if(m_bProjActivated) {
-                //Comp + Proj
-                t_mat = m_matSparseProjCompMult * t_mat;
-            } else {
-                //Comp
-                t_mat = m_matSparseCompMult * t_mat;
-            }
+
+//*************************************************************************************************************
+
+void NoiseReduction::processBlock(MatrixXd& t_mat)
+{
+    m_mutex.lock();
+
+    //Do SSP's and compensators here
+    if(m_bCompActivated) {
+        if(m_bProjActivated) {
+            //Comp + Proj
+            applyOperator(m_matSparseProjCompMult, t_mat);
         } else {
-            if(m_bProjActivated) {
-                //Proj
-                t_mat = m_matSparseProjMult * t_mat;
-            } else {
-                //None - Raw
-            }
+            //Comp
+            applyOperator(m_matSparseCompMult, t_mat);
         }
-
-        //Do temporal filtering here
-        if(m_bFilterActivated) {
-            t_mat = m_pRtFilter->filterChannelsConcurrently(t_mat, m_iMaxFilterLength, m_lFilterChannelList, m_filterData);
+    } else {
+        if(m_bProjActivated) {
+            //Proj
+            applyOperator(m_matSparseProjMult, t_mat);
+        } else {
+            //None - Raw
         }
+    }
 
-//        qDebug()<<"t_mat dim:"<<t_mat.rows()<<"x"<<t_mat.cols();
-//        qDebug()<<"m_lFilterChannelList.size():"<<m_lFilterChannelList.size();
-//        qDebug()<<"m_filterData.size():"<<m_filterData.size();
+    //Do temporal filtering here
+    if(m_bFilterActivated) {
+        t_mat = m_pRtFilter->filterChannelsConcurrently(t_mat, m_iMaxFilterLength, m_lFilterChannelList, m_filterData);
+    }
 
-        //Do SPHARA here
-        if(m_bSpharaActive) {
-            //Set bad channels to zero so they do not get smeared into
-            for(int i = 0; i < m_pFiffInfo->bads.size(); ++i) {
-                t_mat.row(m_pFiffInfo->ch_names.indexOf(m_pFiffInfo->bads.at(i))).setZero();
-            }
+//    qDebug()<<"t_mat dim:"<<t_mat.rows()<<"x"<<t_mat.cols();
+//    qDebug()<<"m_lFilterChannelList.size():"<<m_lFilterChannelList.size();
+//    qDebug()<<"m_filterData.size():"<<m_filterData.size();
 
-            t_mat = m_matSparseSpharaMult * t_mat;
+    //Do SPHARA here
+    if(m_bSpharaActive) {
+        //Set bad channels to zero so they do not get smeared into
+        for(int i = 0; i < m_pFiffInfo->bads.size(); ++i) {
+            t_mat.row(m_pFiffInfo->ch_names.indexOf(m_pFiffInfo->bads.at(i))).setZero();
         }
 
-//        //Common average
-//        MatrixXd commonAvr = MatrixXd(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
-//        commonAvr.setZero();
+        applyOperator(m_matSparseSpharaMult, t_mat);
+    }
 
-//        int nEEGCh = 0;
+//    //Common average
+//    MatrixXd commonAvr = MatrixXd(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
+//    commonAvr.setZero();
 
-//        for(int i = 0; i <m_pFiffInfo->chs.size(); ++i) {
-//            if(m_pFiffInfo->chs.at(i).ch_name.contains("EEG") && !m_pFiffInfo->bads.contains(m_pFiffInfo->chs.at(i).ch_name)) {
-//                nEEGCh++;
-//            }
+//    int nEEGCh = 0;
+
+//    for(int i = 0; i <m_pFiffInfo->chs.size(); ++i) {
+//        if(m_pFiffInfo->chs.at(i).ch_name.contains("EEG") && !m_pFiffInfo->bads.contains(m_pFiffInfo->chs.at(i).ch_name)) {
+//            nEEGCh++;
 //        }
+//    }
 
-//        for(int i = 0; i <m_pFiffInfo->chs.size(); ++i) {
-//            for(int j = 0; j < m_pFiffInfo->chs.size(); ++j) {
-//                if(m_pFiffInfo->chs.at(j).ch_name.contains("EEG") && !m_pFiffInfo->bads.contains(m_pFiffInfo->chs.at(j).ch_name)) {
-//                    commonAvr(i,j) = 1/nEEGCh;
-//                }
+//    for(int i = 0; i <m_pFiffInfo->chs.size(); ++i) {
+//        for(int j = 0; j < m_pFiffInfo->chs.size(); ++j) {
+//            if(m_pFiffInfo->chs.at(j).ch_name.contains("EEG") && !m_pFiffInfo->bads.contains(m_pFiffInfo->chs.at(j).ch_name)) {
+//                commonAvr(i,j) = 1/nEEGCh;
 //            }
 //        }
+//    }
 
-//        UTILSLIB::IOUtils::write_eigen_matrix(commonAvr, "commonAvr.txt", "common vaergae matrix");
+//    UTILSLIB::IOUtils::write_eigen_matrix(commonAvr, "commonAvr.txt", "common vaergae matrix");
 
-        m_mutex.unlock();
+    m_mutex.unlock();
+
+    //Send the data to the connected plugins and the online display
+    m_pNoiseReductionOutput->data()->setValue(t_mat);
+}
+
+
+//*************************************************************************************************************
+
+void NoiseReduction::applyOperator(const SparseMatrix<double>& matOperator, MatrixXd& t_mat)
+{
+    m_qStageMutex.lock();
+    bool bUseScheduler = !m_pStage.isNull();
+    m_qStageMutex.unlock();
 
-        //Send the data to the connected plugins and the online display
-        m_pNoiseReductionOutput->data()->setValue(t_mat);
+    if(!bUseScheduler) {
+        t_mat = matOperator * t_mat;
+        return;
     }
+
+    MatrixXd matResult(matOperator.rows(), t_mat.cols());
+
+    PipelineScheduler::instance()->parallelFor(0, t_mat.cols(), 0, [&](int iBegin, int iEnd) {
+        matResult.middleCols(iBegin, iEnd - iBegin) = matOperator * t_mat.middleCols(iBegin, iEnd - iBegin);
+    });
+
+    t_mat.swap(matResult);
 }
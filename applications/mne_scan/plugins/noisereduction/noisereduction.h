@@ -50,6 +50,7 @@
 #include "disp/filterwindow.h"
 
 #include <scShared/Interfaces/IAlgorithm.h>
+#include <scShared/Management/pipelinestage.h>
 
 #include <rtProcessing/rtfilter.h>
 
@@ -249,6 +250,25 @@ protected:
     */
     void createSpharaOperator();
 
+    //=========================================================================================================
+    /**
+    * Applies the compensators, projectors, temporal filters and SPHARA to one block of data and sends it to
+    * the output.
+    *
+    * @param[in] t_mat    the block, which is modified in place.
+    */
+    void processBlock(Eigen::MatrixXd& t_mat);
+
+    //=========================================================================================================
+    /**
+    * Multiplies the block with a sparse operator. In the task based mode the columns are split into chunks
+    * which are processed in parallel on the pipeline scheduler.
+    *
+    * @param[in] matOperator    the operator.
+    * @param[in] t_mat          the block, which is replaced by the product.
+    */
+    void applyOperator(const Eigen::SparseMatrix<double>& matOperator, Eigen::MatrixXd& t_mat);
+
     //=========================================================================================================
     /**
     * IAlgorithm function
@@ -257,9 +277,11 @@ protected:
 
 private:
     QMutex                          m_mutex;                                    /**< The threads mutex.*/
+    QMutex                          m_qStageMutex;                              /**< Guards m_pStage, which is set and cleared by start/stop while the producer thread posts to it.*/
 
     bool                            m_bCompActivated;                           /**< Compensator activated */
     bool                            m_bIsRunning;                               /**< Flag whether thread is running.*/
+    bool                            m_bStageInitialized;                        /**< Flag whether SPHARA was initialized by the first task of m_pStage.*/
     bool                            m_bSpharaActive;                            /**< Flag whether thread is running.*/
     bool                            m_bProjActivated;                           /**< Projections activated */
     bool                            m_bFilterActivated;                         /**< Projections activated */
@@ -298,6 +320,7 @@ private:
     FIFFLIB::FiffInfo::SPtr                         m_pFiffInfo;                /**< Fiff measurement info.*/
 
     IOBuffer::CircularMatrixBuffer<double>::SPtr    m_pNoiseReductionBuffer;    /**< Holds incoming data.*/
+    SCSHAREDLIB::PipelineStage::SPtr                m_pStage;                   /**< Processes the incoming data on the pipeline scheduler instead of run(), only set in the task based mode.*/
 
     NoiseReductionOptionsWidget::SPtr               m_pOptionsWidget;           /**< The noise reduction option widget object.*/
     QAction*                                        m_pActionShowOptionsWidget; /**< The noise reduction option widget action.*/
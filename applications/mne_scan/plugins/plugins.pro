@@ -71,6 +71,10 @@ contains(MNECPP_CONFIG, BuildBasicMNESCANVersion) {
         rthpi \
         noisereduction
 
+    #IO
+    SUBDIRS += \
+        recorder
+
     win32 { #Only compile the TMSI plugin if a windows system is used - TMSi driver is not available for linux yet
         contains(QMAKE_HOST.arch, x86_64) { #Compiling MNE-X FOR a 64bit system
             exists(C:/Windows/System32/TMSiSDK.dll) {
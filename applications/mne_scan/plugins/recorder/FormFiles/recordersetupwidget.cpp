@@ -0,0 +1,146 @@
+//=============================================================================================================
+/**
+* @file     FormFiles/recordersetupwidget.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Contains the implementation of the RecorderSetupWidget class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "recordersetupwidget.h"
+#include "../recorder.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RecorderPlugin;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RecorderSetupWidget::RecorderSetupWidget(Recorder* recorder, QWidget *parent)
+: QWidget(parent)
+, m_pRecorder(recorder)
+{
+    QGroupBox* pGroupBox = new QGroupBox("Recording", this);
+    QGridLayout* pGridLayout = new QGridLayout(pGroupBox);
+
+    m_pLineEditFile = new QLineEdit(m_pRecorder->fileName(), pGroupBox);
+    QPushButton* pButtonBrowse = new QPushButton("...", pGroupBox);
+    pGridLayout->addWidget(new QLabel("File:", pGroupBox), 0, 0);
+    pGridLayout->addWidget(m_pLineEditFile, 0, 1);
+    pGridLayout->addWidget(pButtonBrowse, 0, 2);
+
+    m_pSpinBoxSplit = new QSpinBox(pGroupBox);
+    m_pSpinBoxSplit->setRange(1, 2048);
+    m_pSpinBoxSplit->setSuffix(" MB");
+    m_pSpinBoxSplit->setValue(m_pRecorder->splitSize());
+    pGridLayout->addWidget(new QLabel("Split size:", pGroupBox), 1, 0);
+    pGridLayout->addWidget(m_pSpinBoxSplit, 1, 1, 1, 2);
+
+    m_pLabelStatus = new QLabel(pGroupBox);
+    pGridLayout->addWidget(m_pLabelStatus, 2, 0, 1, 3);
+
+    QVBoxLayout* pLayout = new QVBoxLayout(this);
+    pLayout->addWidget(pGroupBox);
+    pLayout->addStretch();
+
+    connect(pButtonBrowse, &QPushButton::released, this, &RecorderSetupWidget::browseFile);
+    connect(m_pLineEditFile, &QLineEdit::editingFinished, this, &RecorderSetupWidget::fileNameChanged);
+    connect(m_pSpinBoxSplit, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &RecorderSetupWidget::splitSizeChanged);
+
+    m_pTimerStatus = new QTimer(this);
+    connect(m_pTimerStatus, &QTimer::timeout, this, &RecorderSetupWidget::updateStatus);
+    m_pTimerStatus->start(500);
+
+    updateStatus();
+}
+
+
+//*************************************************************************************************************
+
+RecorderSetupWidget::~RecorderSetupWidget()
+{
+}
+
+
+//*************************************************************************************************************
+
+void RecorderSetupWidget::browseFile()
+{
+    QString sFileName = QFileDialog::getSaveFileName(this, "Record to", m_pLineEditFile->text(), "Fif files (*.fif)");
+
+    if(sFileName.isEmpty())
+        return;
+
+    m_pLineEditFile->setText(sFileName);
+    fileNameChanged();
+}
+
+
+//*************************************************************************************************************
+
+void RecorderSetupWidget::fileNameChanged()
+{
+    m_pRecorder->setFileName(m_pLineEditFile->text());
+}
+
+
+//*************************************************************************************************************
+
+void RecorderSetupWidget::splitSizeChanged(int value)
+{
+    m_pRecorder->setSplitSize(value);
+}
+
+
+//*************************************************************************************************************
+
+void RecorderSetupWidget::updateStatus()
+{
+    qint64 iBytesWritten, iBytesQueued, iBlocksDropped;
+    m_pRecorder->statistics(iBytesWritten, iBytesQueued, iBlocksDropped);
+
+    m_pLabelStatus->setText(QString("Written: %1 MB, queued: %2 MB, dropped blocks: %3")
+                            .arg(iBytesWritten / (1024.0 * 1024.0), 0, 'f', 1)
+                            .arg(iBytesQueued / (1024.0 * 1024.0), 0, 'f', 1)
+                            .arg(iBlocksDropped));
+}
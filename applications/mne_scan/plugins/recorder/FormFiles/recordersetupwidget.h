@@ -0,0 +1,131 @@
+//=============================================================================================================
+/**
+* @file     FormFiles/recordersetupwidget.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Contains the declaration of the RecorderSetupWidget class.
+*
+*/
+
+#ifndef RECORDERSETUPWIDGET_H
+#define RECORDERSETUPWIDGET_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtWidgets>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RecorderPlugin
+//=============================================================================================================
+
+namespace RecorderPlugin
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class Recorder;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS RecorderSetupWidget
+*
+* @brief The RecorderSetupWidget class provides the Recorder configuration window.
+*/
+class RecorderSetupWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+
+    //=========================================================================================================
+    /**
+    * Constructs a RecorderSetupWidget which is a child of parent.
+    *
+    * @param [in] recorder a pointer to the corresponding Recorder.
+    * @param [in] parent pointer to parent widget; If parent is 0, the new RecorderSetupWidget becomes a window. If parent is another widget, RecorderSetupWidget becomes a child window inside parent. RecorderSetupWidget is deleted when its parent is deleted.
+    */
+    RecorderSetupWidget(Recorder* recorder, QWidget *parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Destroys the RecorderSetupWidget.
+    * All RecorderSetupWidget's children are deleted first. The application exits if RecorderSetupWidget is the main widget.
+    */
+    ~RecorderSetupWidget();
+
+private slots:
+    //=========================================================================================================
+    /**
+    * Opens a file dialog to select the recording file.
+    */
+    void browseFile();
+
+    //=========================================================================================================
+    /**
+    * Applies the edited file name to the recorder.
+    */
+    void fileNameChanged();
+
+    //=========================================================================================================
+    /**
+    * Applies the new split size to the recorder.
+    *
+    * @param [in] value the split size in MB.
+    */
+    void splitSizeChanged(int value);
+
+    //=========================================================================================================
+    /**
+    * Refreshes the recording statistics.
+    */
+    void updateStatus();
+
+private:
+    Recorder*   m_pRecorder;        /**< Holds a pointer to corresponding Recorder.*/
+
+    QLineEdit*  m_pLineEditFile;    /**< The recording file.*/
+    QSpinBox*   m_pSpinBoxSplit;    /**< The split size in MB.*/
+    QLabel*     m_pLabelStatus;     /**< Written, queued and dropped data.*/
+    QTimer*     m_pTimerStatus;     /**< Triggers the status refresh.*/
+};
+
+} // NAMESPACE
+
+#endif // RECORDERSETUPWIDGET_H
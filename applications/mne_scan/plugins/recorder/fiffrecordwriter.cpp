@@ -0,0 +1,344 @@
+//=============================================================================================================
+/**
+* @file     fiffrecordwriter.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     FiffRecordWriter class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiffrecordwriter.h"
+
+#include <fiff/fiff_stream.h>
+#include <fiff/fiff_constants.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QBuffer>
+#include <QFileInfo>
+#include <QtEndian>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cstring>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RecorderPlugin;
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER CONSTANTS
+//=============================================================================================================
+
+const qint64 FiffRecordWriter::MaxSplitSize = Q_INT64_C(2147483647);
+
+namespace
+{
+    const int ChunkSize = 4 * 1024 * 1024;          /**< Size of the writes to disk. */
+    const int TrailerSize = 64 * 1024;              /**< Space kept free at the end of each file for the closing blocks. */
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffRecordWriter::FiffRecordWriter()
+: m_iSplitSize(MaxSplitSize)
+, m_iFileSize(0)
+, m_iNumBytesWritten(0)
+, m_iNumSamples(0)
+, m_iNumSkip(0)
+, m_iPart(-1)
+, m_bIsOpen(false)
+{
+}
+
+
+//*************************************************************************************************************
+
+FiffRecordWriter::~FiffRecordWriter()
+{
+    close();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRecordWriter::open(const QString& sFileName, const FiffInfo& info, qint64 iSplitSize)
+{
+    close();
+
+    m_sFileName = sFileName;
+    m_info = info;
+    m_iSplitSize = qBound(Q_INT64_C(2) * TrailerSize + ChunkSize, iSplitSize, MaxSplitSize);
+    m_iNumBytesWritten = 0;
+    m_iNumSamples = 0;
+    m_iNumSkip = 0;
+    m_iPart = 0;
+
+    m_baPending.reserve(2 * ChunkSize);
+
+    return startFile();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRecordWriter::write(const MatrixXf& matData)
+{
+    if(!m_bIsOpen)
+        return false;
+
+    if(matData.rows() != m_vecInvCals.size()) {
+        qWarning() << "FiffRecordWriter::write - Buffer has" << matData.rows() << "channels instead of" << m_vecInvCals.size();
+        return false;
+    }
+
+    qint32 iDataSize = static_cast<qint32>(matData.size() * sizeof(float));
+    qint64 iSkipSize = m_iNumSkip > 0 ? 5 * sizeof(qint32) : 0;
+    qint64 iTagSize = 4 * sizeof(qint32) + iDataSize + iSkipSize;
+
+    if(m_iFileSize + iTagSize + TrailerSize > m_iSplitSize) {
+        finishFile(true);
+        ++m_iPart;
+        if(!startFile())
+            return false;
+    }
+
+    //Serialize the tag in place - FiffStream::write_float streams every value separately
+    int iOffset = m_baPending.size();
+    m_baPending.resize(iOffset + static_cast<int>(iTagSize));
+    uchar* pDest = reinterpret_cast<uchar*>(m_baPending.data()) + iOffset;
+
+    //The skip is written in the same file as the buffer it refers to
+    if(m_iNumSkip > 0) {
+        qToBigEndian<qint32>(FIFF_DATA_SKIP, pDest);
+        qToBigEndian<qint32>(FIFFT_INT, pDest + 4);
+        qToBigEndian<qint32>(sizeof(qint32), pDest + 8);
+        qToBigEndian<qint32>(FIFFV_NEXT_SEQ, pDest + 12);
+        qToBigEndian<qint32>(m_iNumSkip, pDest + 16);
+        pDest += 20;
+
+        m_iNumSamples += static_cast<qint64>(m_iNumSkip) * matData.cols();
+        m_iNumSkip = 0;
+    }
+
+    qToBigEndian<qint32>(FIFF_DATA_BUFFER, pDest);
+    qToBigEndian<qint32>(FIFFT_FLOAT, pDest + 4);
+    qToBigEndian<qint32>(iDataSize, pDest + 8);
+    qToBigEndian<qint32>(FIFFV_NEXT_SEQ, pDest + 12);
+    pDest += 16;
+
+    //Column major storage already has the FIFF sample order: all channels of one sample after another
+    const float* pData = matData.data();
+    const float* pInvCals = m_vecInvCals.data();
+    const int iRows = static_cast<int>(matData.rows());
+
+    for(int j = 0; j < matData.cols(); ++j) {
+        for(int i = 0; i < iRows; ++i, ++pData, pDest += 4) {
+            float fValue = *pData * pInvCals[i];
+            quint32 uiBits;
+            std::memcpy(&uiBits, &fValue, sizeof(float));
+            qToBigEndian<quint32>(uiBits, pDest);
+        }
+    }
+
+    m_iFileSize += iTagSize;
+    m_iNumSamples += matData.cols();
+
+    if(m_baPending.size() >= ChunkSize)
+        return flush(false);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRecordWriter::skip()
+{
+    if(m_bIsOpen)
+        ++m_iNumSkip;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRecordWriter::close()
+{
+    if(!m_bIsOpen)
+        return;
+
+    finishFile(false);
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRecordWriter::startFile()
+{
+    //The measurement info and the start of the raw data block are produced by FiffStream in memory
+    QByteArray baHeader;
+    QBuffer qBuffer(&baHeader);
+    RowVectorXd vecCals;
+
+    FiffStream::SPtr pStream = FiffStream::start_writing_raw(qBuffer, m_info, vecCals);
+    if(!pStream)
+        return false;
+
+    if(m_iPart > 0) {
+        fiff_int_t iFirstSample = static_cast<fiff_int_t>(m_iNumSamples);
+        pStream->write_int(FIFF_FIRST_SAMPLE, &iFirstSample);
+
+        fiff_int_t iRole = FIFFV_ROLE_PREV_FILE;
+        fiff_int_t iPrevPart = m_iPart - 1;
+
+        pStream->start_block(FIFFB_REF);
+        pStream->write_int(FIFF_REF_ROLE, &iRole);
+        pStream->write_string(FIFF_REF_FILE_NAME, QFileInfo(fileName(iPrevPart)).fileName());
+        if(m_info.meas_id.version != -1)
+            pStream->write_id(FIFF_REF_FILE_ID, m_info.meas_id);
+        pStream->write_int(FIFF_REF_FILE_NUM, &iPrevPart);
+        pStream->end_block(FIFFB_REF);
+    }
+
+    pStream.clear();
+
+    m_vecInvCals = vecCals.transpose().array().inverse().cast<float>();
+
+    m_qFile.setFileName(fileName(m_iPart));
+    if(!m_qFile.open(QIODevice::WriteOnly | QIODevice::Unbuffered)) {
+        qWarning() << "FiffRecordWriter::startFile - Could not open" << m_qFile.fileName();
+        m_bIsOpen = false;
+        return false;
+    }
+
+    m_baPending.append(baHeader);
+    m_iFileSize = m_baPending.size();
+    m_bIsOpen = true;
+
+    return flush(false);
+}
+
+
+//*************************************************************************************************************
+
+void FiffRecordWriter::finishFile(bool bHasNext)
+{
+    QByteArray baTrailer;
+    FiffStream stream(&baTrailer, QIODevice::WriteOnly);
+
+    stream.end_block(FIFFB_RAW_DATA);
+
+    if(bHasNext) {
+        fiff_int_t iRole = FIFFV_ROLE_NEXT_FILE;
+        fiff_int_t iNextPart = m_iPart + 1;
+
+        stream.start_block(FIFFB_REF);
+        stream.write_int(FIFF_REF_ROLE, &iRole);
+        stream.write_string(FIFF_REF_FILE_NAME, QFileInfo(fileName(iNextPart)).fileName());
+        if(m_info.meas_id.version != -1)
+            stream.write_id(FIFF_REF_FILE_ID, m_info.meas_id);
+        stream.write_int(FIFF_REF_FILE_NUM, &iNextPart);
+        stream.end_block(FIFFB_REF);
+    }
+
+    stream.end_block(FIFFB_MEAS);
+    stream.end_file();
+
+    m_baPending.append(baTrailer);
+    flush(true);
+
+    m_qFile.close();
+    m_iFileSize = 0;
+    m_bIsOpen = false;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRecordWriter::flush(bool bAll)
+{
+    int iSize = bAll ? m_baPending.size() : (m_baPending.size() / ChunkSize) * ChunkSize;
+
+    if(iSize == 0)
+        return true;
+
+    if(m_qFile.write(m_baPending.constData(), iSize) != iSize) {
+        qWarning() << "FiffRecordWriter::flush - Could not write to" << m_qFile.fileName() << m_qFile.errorString();
+        m_baPending.clear();
+        m_qFile.close();
+        m_bIsOpen = false;
+        return false;
+    }
+
+    //Only the incomplete chunk remains, which is small compared to the chunk that was written
+    m_baPending.remove(0, iSize);
+    m_iNumBytesWritten += iSize;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+QString FiffRecordWriter::fileName(int iPart) const
+{
+    if(iPart == 0)
+        return m_sFileName;
+
+    //Same naming as MNE-Python: name_raw.fif, name_raw-1.fif, name_raw-2.fif, ...
+    QFileInfo fileInfo(m_sFileName);
+    return QString("%1/%2-%3.%4").arg(fileInfo.path()).arg(fileInfo.completeBaseName()).arg(iPart).arg(fileInfo.suffix());
+}
@@ -0,0 +1,245 @@
+//=============================================================================================================
+/**
+* @file     fiffrecordwriter.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     FiffRecordWriter class declaration.
+*
+*/
+
+#ifndef FIFFRECORDWRITER_H
+#define FIFFRECORDWRITER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "recorder_global.h"
+
+#include <fiff/fiff_info.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QFile>
+#include <QByteArray>
+#include <QString>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RecorderPlugin
+//=============================================================================================================
+
+namespace RecorderPlugin
+{
+
+
+//=============================================================================================================
+/**
+* Writes raw data to FIFF files. The data buffers are serialized directly into a pending byte array, which is
+* written to disk in large chunks of a fixed size, so that the file is written with few, large and aligned
+* writes. When a file would exceed the split size, it is finished and the recording continues in a new file.
+* Consecutive files reference each other with FIFFB_REF blocks, as done by MNE-C and MNE-Python, and the
+* continuation files start with the correct FIFF_FIRST_SAMPLE.
+*
+* @brief Chunked FIFF raw writer with automatic file splitting
+*/
+class RECORDERSHARED_EXPORT FiffRecordWriter
+{
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a FiffRecordWriter.
+    */
+    FiffRecordWriter();
+
+    //=========================================================================================================
+    /**
+    * Finishes the current file if still open.
+    */
+    ~FiffRecordWriter();
+
+    //=========================================================================================================
+    /**
+    * Creates the first file and writes the measurement info.
+    *
+    * @param[in] sFileName      name of the first file. The following files get the suffix -1, -2, ...
+    * @param[in] info           the measurement info.
+    * @param[in] iSplitSize     maximal size of a file in bytes, limited to 2 GB.
+    *
+    * @return true if the file could be created.
+    */
+    bool open(const QString& sFileName, const FIFFLIB::FiffInfo& info, qint64 iSplitSize = MaxSplitSize);
+
+    //=========================================================================================================
+    /**
+    * Appends a data buffer.
+    *
+    * @param[in] matData        calibrated data, channels x samples.
+    *
+    * @return false if the data could not be written.
+    */
+    bool write(const Eigen::MatrixXf& matData);
+
+    //=========================================================================================================
+    /**
+    * Marks a data buffer as missing, e.g. because it was dropped. A FIFF_DATA_SKIP tag is written in front of the
+    * next buffer, so that the following samples keep their time. The size of a skipped buffer is the size of the
+    * next buffer, as defined by FIFF.
+    */
+    void skip();
+
+    //=========================================================================================================
+    /**
+    * Writes the pending data and finishes the current file.
+    */
+    void close();
+
+    //=========================================================================================================
+    /**
+    * Returns whether a file is open.
+    *
+    * @return true if open.
+    */
+    inline bool isOpen() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of bytes written to disk so far, over all files.
+    *
+    * @return the number of bytes.
+    */
+    inline qint64 numBytesWritten() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of files started so far.
+    *
+    * @return the number of files.
+    */
+    inline int numFiles() const;
+
+    static const qint64 MaxSplitSize;   /**< Largest file size FIFF can address with its 32 bit tag positions. */
+
+private:
+    //=========================================================================================================
+    /**
+    * Creates the file of the current part and writes the measurement info and the reference to the previous file.
+    *
+    * @return true if the file could be created.
+    */
+    bool startFile();
+
+    //=========================================================================================================
+    /**
+    * Closes the raw data and measurement blocks, optionally with a reference to the next file, and closes the file.
+    *
+    * @param[in] bHasNext       whether the recording continues in a next file.
+    */
+    void finishFile(bool bHasNext);
+
+    //=========================================================================================================
+    /**
+    * Writes the pending bytes to the file.
+    *
+    * @param[in] bAll           write all pending bytes, otherwise only whole chunks are written.
+    *
+    * @return false if the file could not be written.
+    */
+    bool flush(bool bAll);
+
+    //=========================================================================================================
+    /**
+    * Returns the name of the given part of the recording.
+    *
+    * @param[in] iPart          the part, starting at 0.
+    *
+    * @return the file name.
+    */
+    QString fileName(int iPart) const;
+
+    QString                 m_sFileName;            /**< Name of the first file. */
+    FIFFLIB::FiffInfo       m_info;                 /**< The measurement info, repeated in every file. */
+    Eigen::ArrayXf          m_vecInvCals;           /**< Inverse calibration factors of the channels. */
+
+    QFile                   m_qFile;                /**< The current file. */
+    QByteArray              m_baPending;            /**< Serialized data which was not written yet. */
+
+    qint64                  m_iSplitSize;           /**< Maximal size of a file. */
+    qint64                  m_iFileSize;            /**< Size of the current file including the pending bytes. */
+    qint64                  m_iNumBytesWritten;     /**< Bytes written to disk, over all files. */
+    qint64                  m_iNumSamples;          /**< Samples written so far, first sample of the next file. */
+    qint32                  m_iNumSkip;             /**< Number of skipped buffers which precede the next buffer. */
+    int                     m_iPart;                /**< Index of the current file, -1 before the first file was opened. */
+    bool                    m_bIsOpen;              /**< Whether a file is open. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool FiffRecordWriter::isOpen() const
+{
+    return m_bIsOpen;
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 FiffRecordWriter::numBytesWritten() const
+{
+    return m_iNumBytesWritten;
+}
+
+
+//*************************************************************************************************************
+
+inline int FiffRecordWriter::numFiles() const
+{
+    return m_iPart + 1;
+}
+
+} // NAMESPACE
+
+#endif // FIFFRECORDWRITER_H
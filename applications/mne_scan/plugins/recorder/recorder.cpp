@@ -0,0 +1,376 @@
+//=============================================================================================================
+/**
+* @file     recorder.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Contains the implementation of the Recorder class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "recorder.h"
+#include "FormFiles/recordersetupwidget.h"
+
+#include <scShared/Management/pipelinetracer.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSettings>
+#include <QDateTime>
+#include <QDir>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RecorderPlugin;
+using namespace SCSHAREDLIB;
+using namespace SCMEASLIB;
+using namespace FIFFLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+Recorder::Recorder()
+: m_bIsRunning(false)
+, m_iSplitSizeMB(2048)
+, m_iMaxQueuedBytes(Q_INT64_C(512) * 1024 * 1024)
+, m_iQueuedBytes(0)
+, m_iBytesWritten(0)
+, m_iBlocksDropped(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+Recorder::~Recorder()
+{
+    if(this->isRunning())
+        stop();
+}
+
+
+//*************************************************************************************************************
+
+QSharedPointer<IPlugin> Recorder::clone() const
+{
+    QSharedPointer<Recorder> pRecorderClone(new Recorder);
+    return pRecorderClone;
+}
+
+
+//*************************************************************************************************************
+
+void Recorder::init()
+{
+    // Input
+    m_pRecorderInput = PluginInputData<NewRealTimeMultiSampleArray>::create(this, "RecorderIn", "Recorder input data");
+    connect(m_pRecorderInput.data(), &PluginInputConnector::notify, this, &Recorder::update, Qt::DirectConnection);
+    m_inputConnectors.append(m_pRecorderInput);
+
+    QSettings settings;
+    m_sFileName = settings.value(QString("MNESCAN/%1/fileName").arg(getName()), QDir::homePath() + "/mne_scan_recording_raw.fif").toString();
+    m_iSplitSizeMB = settings.value(QString("MNESCAN/%1/splitSize").arg(getName()), 2048).toInt();
+}
+
+
+//*************************************************************************************************************
+
+void Recorder::unload()
+{
+    QSettings settings;
+    settings.setValue(QString("MNESCAN/%1/fileName").arg(getName()), m_sFileName);
+    settings.setValue(QString("MNESCAN/%1/splitSize").arg(getName()), m_iSplitSizeMB);
+}
+
+
+//*************************************************************************************************************
+
+bool Recorder::start()
+{
+    //Check if the thread is already or still running. This can happen if the start button is pressed immediately after the stop button was pressed. In this case the stopping process is not finished yet but the start process is initiated.
+    if(this->isRunning())
+        QThread::wait();
+
+    m_qMutex.lock();
+    //The info is taken from the first block of this recording, it may have changed since the last one
+    m_pFiffInfo.clear();
+    m_qQueueBlocks.clear();
+    m_iQueuedBytes = 0;
+    m_iBytesWritten = 0;
+    m_iBlocksDropped = 0;
+    m_bIsRunning = true;
+    m_qMutex.unlock();
+
+    PipelineTracer::instance()->registerQueue(getName() + " Record Queue (MB)", [this]() {
+        QMutexLocker locker(&m_qMutex);
+        return static_cast<qint32>(m_iQueuedBytes >> 20);
+    }, static_cast<qint32>(m_iMaxQueuedBytes >> 20));
+
+    //Start thread
+    QThread::start();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool Recorder::stop()
+{
+    m_qMutex.lock();
+    m_bIsRunning = false;
+    m_qQueueNotEmpty.wakeAll();
+    m_qMutex.unlock();
+
+    //The thread writes the remaining queued blocks before it finishes the file
+    QThread::wait();
+
+    PipelineTracer::instance()->unregisterQueue(getName() + " Record Queue (MB)");
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+IPlugin::PluginType Recorder::getType() const
+{
+    return _IIO;
+}
+
+
+//*************************************************************************************************************
+
+QString Recorder::getName() const
+{
+    return "Recorder";
+}
+
+
+//*************************************************************************************************************
+
+QWidget* Recorder::setupWidget()
+{
+    RecorderSetupWidget* setupWidget = new RecorderSetupWidget(this);//widget is later distroyed by CentralWidget - so it has to be created everytime new
+    return setupWidget;
+}
+
+
+//*************************************************************************************************************
+
+void Recorder::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
+{
+    QSharedPointer<NewRealTimeMultiSampleArray> pRTMSA = pMeasurement.dynamicCast<NewRealTimeMultiSampleArray>();
+
+    if(!pRTMSA)
+        return;
+
+    //Only the shared blocks are queued, the acquisition never waits for the disk
+    QList<MeasurementBlock::ConstSPtr> qListBlocks = pRTMSA->getMultiSampleBlocks();
+
+    QMutexLocker locker(&m_qMutex);
+
+    //Fiff information
+    if(!m_pFiffInfo)
+        m_pFiffInfo = pRTMSA->info();
+
+    if(!m_bIsRunning)
+        return;
+
+    for(qint32 i = 0; i < qListBlocks.size(); ++i) {
+        qint64 iBytes = static_cast<qint64>(qListBlocks[i]->rows()) * qListBlocks[i]->cols() * sizeof(float);
+
+        //The dropped block is recorded as skip, so that the following samples keep their time
+        if(m_iQueuedBytes + iBytes > m_iMaxQueuedBytes) {
+            ++m_iBlocksDropped;
+            m_qQueueBlocks.enqueue(MeasurementBlock::ConstSPtr());
+            continue;
+        }
+
+        m_qQueueBlocks.enqueue(qListBlocks[i]);
+        m_iQueuedBytes += iBytes;
+    }
+
+    m_qQueueNotEmpty.wakeOne();
+}
+
+
+//*************************************************************************************************************
+
+QString Recorder::fileName() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_sFileName;
+}
+
+
+//*************************************************************************************************************
+
+void Recorder::setFileName(const QString& sFileName)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_sFileName = sFileName;
+}
+
+
+//*************************************************************************************************************
+
+int Recorder::splitSize() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_iSplitSizeMB;
+}
+
+
+//*************************************************************************************************************
+
+void Recorder::setSplitSize(int iSplitSizeMB)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_iSplitSizeMB = qBound(1, iSplitSizeMB, 2048);
+}
+
+
+//*************************************************************************************************************
+
+void Recorder::statistics(qint64& iBytesWritten, qint64& iBytesQueued, qint64& iBlocksDropped) const
+{
+    QMutexLocker locker(&m_qMutex);
+
+    iBytesWritten = m_iBytesWritten;
+    iBytesQueued = m_iQueuedBytes;
+    iBlocksDropped = m_iBlocksDropped;
+}
+
+
+//*************************************************************************************************************
+
+void Recorder::run()
+{
+    //
+    // Wait for Fiff Info
+    //
+    FiffInfo::SPtr pFiffInfo;
+    QString sFileName;
+    qint64 iSplitSize = 0;
+
+    while(!pFiffInfo) {
+        m_qMutex.lock();
+        pFiffInfo = m_pFiffInfo;
+        sFileName = m_sFileName;
+        iSplitSize = static_cast<qint64>(m_iSplitSizeMB) * 1024 * 1024;
+        bool bIsRunning = m_bIsRunning;
+        m_qMutex.unlock();
+
+        if(!bIsRunning)
+            return;
+
+        if(!pFiffInfo)
+            msleep(10);
+    }
+
+    FiffRecordWriter writer;
+    bool bWriting = writer.open(recordingFileName(sFileName), *pFiffInfo, iSplitSize);
+
+    QList<MeasurementBlock::ConstSPtr> qListBlocks;
+
+    forever {
+        m_qMutex.lock();
+
+        while(m_qQueueBlocks.isEmpty() && m_bIsRunning)
+            m_qQueueNotEmpty.wait(&m_qMutex);
+
+        //Stopped and all blocks written
+        if(m_qQueueBlocks.isEmpty()) {
+            m_qMutex.unlock();
+            break;
+        }
+
+        qListBlocks.swap(m_qQueueBlocks);
+        m_qMutex.unlock();
+
+        for(qint32 i = 0; i < qListBlocks.size(); ++i) {
+            if(!qListBlocks[i]) {
+                writer.skip();
+                continue;
+            }
+
+            if(bWriting)
+                bWriting = writer.write(qListBlocks[i]->toFloat());
+
+            QMutexLocker locker(&m_qMutex);
+            m_iQueuedBytes -= static_cast<qint64>(qListBlocks[i]->rows()) * qListBlocks[i]->cols() * sizeof(float);
+            m_iBytesWritten = writer.numBytesWritten();
+        }
+
+        qListBlocks.clear();
+    }
+
+    writer.close();
+
+    QMutexLocker locker(&m_qMutex);
+    m_iBytesWritten = writer.numBytesWritten();
+}
+
+
+//*************************************************************************************************************
+
+QString Recorder::recordingFileName(const QString& sFileName) const
+{
+    if(!QFile::exists(sFileName))
+        return sFileName;
+
+    //Keep earlier recordings - name_raw.fif becomes name_<date>_<time>_raw.fif
+    QFileInfo fileInfo(sFileName);
+    QString sBaseName = fileInfo.completeBaseName();
+    QString sTime = QDateTime::currentDateTime().toString("yyMMdd_hhmmss");
+
+    if(sBaseName.endsWith("_raw"))
+        sBaseName.insert(sBaseName.size() - 4, "_" + sTime);
+    else
+        sBaseName += "_" + sTime;
+
+    return QString("%1/%2.%3").arg(fileInfo.path()).arg(sBaseName).arg(fileInfo.suffix());
+}
@@ -0,0 +1,214 @@
+//=============================================================================================================
+/**
+* @file     recorder.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Contains the declaration of the Recorder class.
+*
+*/
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "recorder_global.h"
+#include "fiffrecordwriter.h"
+
+#include <scShared/Interfaces/IIO.h>
+#include <scMeas/newrealtimemultisamplearray.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtWidgets>
+#include <QtCore/QtPlugin>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RecorderPlugin
+//=============================================================================================================
+
+namespace RecorderPlugin
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCSHAREDLIB;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS Recorder
+*
+* Records the incoming raw data to FIFF files. The acquisition never waits for the disk: update() only appends
+* the shared data blocks to a queue, which is bounded by its size in bytes. If the disk cannot keep up and the
+* queue is full, blocks are dropped and counted; a FIFF_DATA_SKIP is recorded in their place, so that the
+* following samples keep their time. The plugin thread serializes the queued blocks and writes them with a
+* FiffRecordWriter in large chunks; files are split at the configured size (at most 2 GB).
+*
+* @brief The Recorder class provides a record-to-disk plugin.
+*/
+class RECORDERSHARED_EXPORT Recorder : public IIO
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "scsharedlib/1.0" FILE "recorder.json") //NEw Qt5 Plugin system replaces Q_EXPORT_PLUGIN2 macro
+    // Use the Q_INTERFACES() macro to tell Qt's meta-object system about the interfaces
+    Q_INTERFACES(SCSHAREDLIB::IIO)
+
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a Recorder.
+    */
+    Recorder();
+
+    //=========================================================================================================
+    /**
+    * Destroys the Recorder.
+    */
+    ~Recorder();
+
+    //=========================================================================================================
+    /**
+    * IIO functions
+    */
+    virtual QSharedPointer<IPlugin> clone() const;
+    virtual void init();
+    virtual void unload();
+    virtual bool start();
+    virtual bool stop();
+    virtual IPlugin::PluginType getType() const;
+    virtual QString getName() const;
+    virtual QWidget* setupWidget();
+
+    //=========================================================================================================
+    /**
+    * Udates the pugin with new (incoming) data.
+    *
+    * @param[in] pMeasurement    The incoming data in form of a generalized NewMeasurement.
+    */
+    void update(SCMEASLIB::NewMeasurement::SPtr pMeasurement);
+
+    //=========================================================================================================
+    /**
+    * Returns the name of the file to record to. If the file exists, the recording start time is added to the name.
+    *
+    * @return the file name.
+    */
+    QString fileName() const;
+
+    //=========================================================================================================
+    /**
+    * Sets the name of the file to record to.
+    *
+    * @param[in] sFileName      the file name.
+    */
+    void setFileName(const QString& sFileName);
+
+    //=========================================================================================================
+    /**
+    * Returns the size in MB at which the recording is continued in a new file.
+    *
+    * @return the split size in MB.
+    */
+    int splitSize() const;
+
+    //=========================================================================================================
+    /**
+    * Sets the size at which the recording is continued in a new file.
+    *
+    * @param[in] iSplitSizeMB   the split size in MB, limited to 2 GB.
+    */
+    void setSplitSize(int iSplitSizeMB);
+
+    //=========================================================================================================
+    /**
+    * Returns the state of the current or last recording.
+    *
+    * @param[out] iBytesWritten     number of bytes written to disk.
+    * @param[out] iBytesQueued      number of bytes waiting to be written.
+    * @param[out] iBlocksDropped    number of blocks dropped because the queue was full.
+    */
+    void statistics(qint64& iBytesWritten, qint64& iBytesQueued, qint64& iBlocksDropped) const;
+
+protected:
+    //=========================================================================================================
+    /**
+    * IIO function. Writes the queued blocks.
+    */
+    virtual void run();
+
+private:
+    //=========================================================================================================
+    /**
+    * Returns the file name of a new recording, which does not overwrite earlier recordings.
+    *
+    * @param[in] sFileName  the configured file name.
+    *
+    * @return the file name.
+    */
+    QString recordingFileName(const QString& sFileName) const;
+
+    bool                                    m_bIsRunning;       /**< Flag whether thread is running.*/
+
+    QString                                 m_sFileName;        /**< The file to record to. */
+    qint32                                  m_iSplitSizeMB;     /**< Split size in MB. */
+    qint64                                  m_iMaxQueuedBytes;  /**< Maximal size of the queued data. */
+
+    FIFFLIB::FiffInfo::SPtr                 m_pFiffInfo;        /**< Fiff measurement info.*/
+
+    mutable QMutex                                  m_qMutex;           /**< Guards the queue, the settings and the statistics. */
+    QWaitCondition                                  m_qQueueNotEmpty;   /**< Wakes the plugin thread. */
+    QQueue<SCMEASLIB::MeasurementBlock::ConstSPtr>  m_qQueueBlocks;     /**< Blocks waiting to be written, a null block marks a dropped block. */
+    qint64                                          m_iQueuedBytes;     /**< Size of the queued blocks. */
+    qint64                                          m_iBytesWritten;    /**< Bytes written by the current or last recording. */
+    qint64                                          m_iBlocksDropped;   /**< Blocks dropped by the current or last recording. */
+
+    PluginInputData<SCMEASLIB::NewRealTimeMultiSampleArray>::SPtr   m_pRecorderInput;   /**< The NewRealTimeMultiSampleArray of the Recorder input.*/
+};
+
+} // NAMESPACE
+
+#endif // RECORDER_H
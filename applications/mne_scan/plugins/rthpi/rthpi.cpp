@@ -56,6 +56,8 @@
 #include <QtCore/QtPlugin>
 #include <QDebug>
 
+#include <scShared/Management/pipelinetracer.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -224,8 +226,10 @@ void RtHpi::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
     {
         m_qMutex.lock();
         //Check if buffer initialized
-        if(!m_pRtHpiBuffer)
-            m_pRtHpiBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(8, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+        if(!m_pRtHpiBuffer) {
+            m_pRtHpiBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(8, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlocks().first()->cols()));
+            PipelineTracer::instance()->registerBuffer(this->getName() + " Input Buffer", m_pRtHpiBuffer);
+        }
 
         //Fiff information
         if(!m_pFiffInfo)
@@ -237,13 +241,10 @@ void RtHpi::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
         m_qMutex.unlock();
         if(m_bProcessData)
         {
-            MatrixXd t_mat;
+            QList<MeasurementBlock::ConstSPtr> qListBlocks = pRTMSA->getMultiSampleBlocks();
 
-            for(qint32 i = 0; i < pRTMSA->getMultiArraySize(); ++i)
-            {
-                t_mat = pRTMSA->getMultiSampleArray()[i];
-                m_pRtHpiBuffer->push(&t_mat);
-            }
+            for(qint32 i = 0; i < qListBlocks.size(); ++i)
+                m_pRtHpiBuffer->push(&qListBlocks[i]->toDouble());
         }
     }
 }
@@ -65,6 +65,8 @@ using namespace FIFFLIB;
 using namespace SCSHAREDLIB;
 using namespace SCMEASLIB;
 
+#include <scShared/Management/pipelinetracer.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -79,6 +81,10 @@ RtSss::RtSss()
 , LoutRR(0)
 , Lin(0)
 , Lout(0)
+, m_bRobustSSS(true)
+, m_bTSSS(false)
+, m_dTSSSBufferSec(10.0)
+, m_dTSSSCorrLimit(0.98)
 {
 }
 
@@ -127,8 +133,11 @@ void RtSss::init()
     //
     // Load Settings
     //
-//    QSettings settings;
-//    yourValue = settings.value(QString("Plugin/%1/yourValue").arg(this->getName()), 400).toInt();
+    QSettings settings;
+    m_bRobustSSS = settings.value(QString("Plugin/%1/robustSSS").arg(this->getName()), true).toBool();
+    m_bTSSS = settings.value(QString("Plugin/%1/tSSS").arg(this->getName()), false).toBool();
+    m_dTSSSBufferSec = settings.value(QString("Plugin/%1/tSSSBufferSec").arg(this->getName()), 10.0).toDouble();
+    m_dTSSSCorrLimit = settings.value(QString("Plugin/%1/tSSSCorrLimit").arg(this->getName()), 0.98).toDouble();
 }
 
 
@@ -139,8 +148,11 @@ void RtSss::unload()
     //
     // Store Settings
     //
-//    QSettings settings;
-//    settings.setValue(QString("Plugin/%1/yourValue").arg(this->getName()), yourValue);
+    QSettings settings;
+    settings.setValue(QString("Plugin/%1/robustSSS").arg(this->getName()), m_bRobustSSS);
+    settings.setValue(QString("Plugin/%1/tSSS").arg(this->getName()), m_bTSSS);
+    settings.setValue(QString("Plugin/%1/tSSSBufferSec").arg(this->getName()), m_dTSSSBufferSec);
+    settings.setValue(QString("Plugin/%1/tSSSCorrLimit").arg(this->getName()), m_dTSSSCorrLimit);
 
 }
 
@@ -273,8 +285,10 @@ void RtSss::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
     if(pRTMSA && m_bReceiveData)
     {
         //Check if buffer initialized
-        if(!m_pRtSssBuffer)
+        if(!m_pRtSssBuffer) {
             m_pRtSssBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(32, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            PipelineTracer::instance()->registerBuffer(this->getName() + " Input Buffer", m_pRtSssBuffer);
+        }
 
         //Fiff information
         if(!m_pFiffInfo)
@@ -328,12 +342,12 @@ void RtSss::run()
             exclude<<m_pFiffInfo->chs.at(i).ch_name;
     }
 
-    exclude<<m_pFiffInfo->bads;
+    QStringList usedBads = m_pFiffInfo->bads;
 
 //    qDebug()<< exclude ;
 
     QString chType("mag");
-    RowVectorXi pickedChannels = m_pFiffInfo->pick_types(chType,false, false, QStringList(),exclude);
+    RowVectorXi pickedChannels = m_pFiffInfo->pick_types(chType,false, false, QStringList(),exclude + usedBads);
     qDebug()<< "finished pickedChannels";
     qint32 nmegchanused = pickedChannels.cols();
 
@@ -403,6 +417,10 @@ void RtSss::run()
 
     //qDebug() << "..finished !!";
 
+    // Temporal SSS buffers the data, the raw blocks are kept to put the delayed SSS signal back in place
+    rsss.setTSSSParameter(m_bTSSS, qRound(m_dTSSSBufferSec * m_pFiffInfo->sfreq), m_dTSSSCorrLimit);
+    QList<MatrixXd> lRawBlocks;
+
     // start processing data
     m_bProcessData = true;
     qint32 HEADMOV_COR_cnt = 15 ;
@@ -432,6 +450,14 @@ void RtSss::run()
             MatrixXd in_mat = m_pRtSssBuffer->pop();
 //            qDebug() << "size of in_mat (run): " << in_mat.rows() << " x " << in_mat.cols();
 
+            // Bad channels changed -> new channel selection, the cached linear equation is rebuilt on the next block
+            if(m_pFiffInfo->bads != usedBads) {
+                usedBads = m_pFiffInfo->bads;
+                pickedChannels = m_pFiffInfo->pick_types(chType,false, false, QStringList(),exclude + usedBads);
+                rsss.setMEGInfo(m_pFiffInfo, pickedChannels);
+                lRawBlocks.clear();
+            }
+
             //Generate new matrix from picked channels
             MatrixXd in_mat_used(pickedChannels.cols(), in_mat.cols());
 
@@ -449,7 +475,23 @@ void RtSss::run()
 //                }
 //            in_mat_used = in_mat.block(0,0,nmegchanused,in_mat.cols());
 
-           in_mat_used = rt_sss(in_mat_used);
+            if(rsss.isTSSSActive()) {
+                lRawBlocks.append(in_mat);
+
+                QList<MatrixXd> lSSSBlocks = rsss.getTSSS(in_mat_used);
+
+                for(qint32 k = 0; k < lSSSBlocks.size() && !lRawBlocks.isEmpty(); ++k) {
+                    MatrixXd out_mat = lRawBlocks.takeFirst();
+                    for(qint32 i = 0; i < lSSSBlocks[k].rows(); ++i)
+                        out_mat.row(pickedChannels(i)) = lSSSBlocks[k].row(i);
+
+                    m_pRTMSAOutput->data()->setValue(0.01* out_mat);
+                }
+
+                continue;
+            }
+
+            in_mat_used = m_bRobustSSS ? rt_sss(in_mat_used) : rsss.getSSSOLS(in_mat_used);
 
             // Implement Concurrent mapreduced for parallel processing
             // divide the in_mat_used into 2 or 4 matrices, which renders 50ms or 25ms data
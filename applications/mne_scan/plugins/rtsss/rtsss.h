@@ -175,6 +175,11 @@ private:
 
     int LinRR, LoutRR, Lin, Lout;
 
+    bool m_bRobustSSS;          /**< Use the robust regression (per sample) instead of the cached OLS projector. */
+    bool m_bTSSS;               /**< Apply temporal SSS, which delays the output by one buffer length. */
+    double m_dTSSSBufferSec;    /**< Length of the tSSS buffer in seconds. */
+    double m_dTSSSCorrLimit;    /**< Subspace correlation limit of the tSSS. */
+
     QMutex m_qMutex;
 
     //    dBuffer::SPtr   m_pRtSssBuffer;      /**< Holds incoming data.*/
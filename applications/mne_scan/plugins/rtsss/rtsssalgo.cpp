@@ -50,8 +50,15 @@ RtSssAlgo::RtSssAlgo()
 , LOutRR(0)
 , LInOLS(0)
 , LOutOLS(0)
+, EqnValid(false)
+, RegTol(1e-10)
+, TSSSActive(false)
+, TSSSBufLen(0)
+, TSSSFill(0)
+, TSSSCorrLimit(0.98)
 {
-
+    // Set origin of head(?) coordinate
+    Origin << 0.0, 0.0, 0.04;
 }
 
 RtSssAlgo::~RtSssAlgo()
@@ -132,7 +139,6 @@ MatrixXd RtSssAlgo::buildLinearEqn()
     if ((0 < CoilGrad.sum()) && (CoilGrad.sum() < NumCoil))  MagScale = 100;
     else MagScale = 1;
 
-    VectorXd CoilScale;
     CoilScale.setOnes(NumCoil);
     for(int i=0; i<NumCoil; i++)
     {
@@ -173,10 +179,50 @@ MatrixXd RtSssAlgo::buildLinearEqn()
 
     //qDebug() << "buildLinearEqn END";
 
+    // The inverses, the pseudo-inverse and the projector only depend on the coil geometry and the expansion orders.
+    // They are computed once here and reused for every data block until they are invalidated.
+    EqnRRInv = (EqnARR.transpose() * EqnARR).inverse();
+    EqnInv = (EqnA.transpose() * EqnA).inverse();
+    computeProjector(CoilScale);
+
+    EqnValid = true;
+    resetTSSS();
+
 //    return LinEqn;
     return CoilScale.asDiagonal();
 }
 
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+//% regularized pseudo-inverse and reconstruction projector
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+//% EqnPinv(j,i):     pinv(diag(CoilScale) * [EqnIn EqnOut]) * diag(CoilScale)
+//%                   singular values below RegTol * max are truncated
+//% ProjIn(i,k):      EqnIn * EqnPinv(1:NumBIn,:), maps a raw block onto its
+//%                   internal reconstruction with one matrix product
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+void RtSssAlgo::computeProjector(const VectorXd &CoilScale)
+{
+    JacobiSVD<MatrixXd> svd(EqnA, ComputeThinU | ComputeThinV);
+    const VectorXd &sv = svd.singularValues();
+
+    VectorXd svInv = VectorXd::Zero(sv.size());
+    int numTrunc = 0;
+    for(int i=0; i<sv.size(); i++)
+    {
+        if (sv(i) > RegTol * sv(0))
+            svInv(i) = 1.0 / sv(i);
+        else
+            numTrunc++;
+    }
+
+    if (numTrunc > 0)
+        qDebug() << "RtSssAlgo: truncated" << numTrunc << "of" << sv.size() << "singular values of the SSS basis";
+
+    EqnPinv = svd.matrixV() * svInv.asDiagonal() * svd.matrixU().transpose() * CoilScale.asDiagonal();
+    ProjIn = EqnIn * EqnPinv.topRows(EqnIn.cols());
+}
+
 void RtSssAlgo::setSSSParameter(QList<int> expansionOrder)
 {
 //    LInRR = 5;
@@ -184,19 +230,55 @@ void RtSssAlgo::setSSSParameter(QList<int> expansionOrder)
 //    LInOLS = 8;
 //    LOutOLS = 4;
 
+    if (LInRR != expansionOrder[0] || LOutRR != expansionOrder[1] || LInOLS != expansionOrder[2] || LOutOLS != expansionOrder[3])
+        EqnValid = false;
+
     LInRR = expansionOrder[0];
     LOutRR = expansionOrder[1];
     LInOLS = expansionOrder[2];
     LOutOLS = expansionOrder[3];
 }
 
+void RtSssAlgo::setOrigin(const Vector3d &origin)
+{
+    if (origin != Origin)
+    {
+        Origin = origin;
+        EqnValid = false;
+    }
+}
+
+bool RtSssAlgo::isLinearEqnValid() const
+{
+    return EqnValid;
+}
+
 void RtSssAlgo::setMEGInfo(FiffInfo::SPtr fiffInfo, RowVectorXi pickedChannels)
 {
     //qDebug() << "setMEGInfo START";
 
-    // Set origin of head(?) coordinate
-    Origin.resize(3);
-    Origin << 0.0, 0.0, 0.04;
+    // Keep the cached linear equation if neither the channel selection (bad channels) nor the coil locations
+    // (head position) changed
+    if (EqnValid && pickedChannels.cols() == PickedChannels.cols() && pickedChannels == PickedChannels)
+    {
+        bool sameGeometry = true;
+        for (qint32 i=0; i<pickedChannels.cols(); ++i)
+            if (fiffInfo->chs[pickedChannels(i)].coil_trans != CoilT[i])
+            {
+                sameGeometry = false;
+                break;
+            }
+
+        if (sameGeometry)
+            return;
+    }
+
+    EqnValid = false;
+    PickedChannels = pickedChannels;
+    CoilT.clear();
+    CoilName.clear();
+    CoilRk.clear();
+    CoilWk.clear();
 
 //    // Find the number of MEG channels
 //    qint32 nmegchan = 0;
@@ -428,6 +510,29 @@ QList<MatrixXd> RtSssAlgo::getSSSEqn(qint32 LIn, qint32 LOut)
 
     RScale = exp(coil_distance.array().log().mean());
 
+//% collect the integration points of all coils and evaluate the basis for all of them at once
+    VectorXi CoilOffset(NumCoil);
+    qint32 NumPts = 0;
+    for(int i = 0; i<NumCoil; i++)
+    {
+        CoilOffset(i) = NumPts;
+        NumPts += CoilNk(i);
+    }
+
+    MatrixXd CoilPts(NumPts,3);
+    MatrixXd tmpmat;
+
+    for(int i = 0; i<NumCoil; i++)
+    {
+        tmpmat.setOnes(4,CoilNk(i));
+        tmpmat.topRows(3) = CoilRk[i];
+        coil_location = (CoilT[i] * tmpmat).topRows(3);
+        coil_location = (coil_location - Origin.replicate(1,CoilNk(i))) / RScale;
+        CoilPts.middleRows(CoilOffset(i),CoilNk(i)) = coil_location.transpose();
+    }
+
+    getSSSBasis(CoilPts.col(0), CoilPts.col(1), CoilPts.col(2), LIn, LOut);
+
 //% build linear equation for internal/external basis functions
     EqnIn.setZero(NumCoil,NumBIn);
     EqnOut.setZero(NumCoil,NumBOut);
@@ -447,28 +552,13 @@ QList<MatrixXd> RtSssAlgo::getSSSEqn(qint32 LIn, qint32 LOut)
 //    % calculate coil orientation
         coil_vector = CoilT[i].block(0,2,3,1);
 
-//    % calculate coil locations (multiple points)
-//        int NumCoilPts = CoilNk(coil_index);
+//    % pick the basis vectors of the coil points
+        qint32 offset = CoilOffset(i);
         qint32 NumCoilPts = CoilNk(i);
-        MatrixXd tmpmat; tmpmat.setOnes(4,NumCoilPts);
-//qDebug() << "pass 2";
-//        tmpmat.topRows(3) = CoilRk[coil_index];
-//        std::cout << "CoilRk: " << CoilRk[i].rows() << " x " << CoilRk[i].cols()  << std::endl;
-        tmpmat.topRows(3) = CoilRk[i];
-//qDebug() << "pass 3";
-        coil_location = CoilT[i] * tmpmat;
-        tmpmat = coil_location.topRows(3);   coil_location.resize(3,NumCoilPts);   coil_location = tmpmat;
-        coil_location = coil_location - Origin.replicate(1,NumCoilPts);
-        coil_location = coil_location / RScale;
-
-//    % build linear equation
-        getSSSBasis(coil_location.row(0).transpose(), coil_location.row(1).transpose(), coil_location.row(2).transpose(), LIn, LOut);
-//        std::cout << "NumCoilPts: " << NumCoilPts  << ",    NumBIn: " << NumBIn << ",    NumBOut: " << NumBOut << endl;
-//        std::cout << "BInX: " << BInX.rows()  << " x " << BInX.cols() << endl;
 
         MatrixXd b_in, b_out;
-        b_in = coil_vector(0)*BInX + coil_vector(1)*BInY + coil_vector(2)*BInZ;
-        b_out = coil_vector(0)*BOutX + coil_vector(1)*BOutY + coil_vector(2)*BOutZ;
+        b_in = coil_vector(0)*BInX.middleRows(offset,NumCoilPts) + coil_vector(1)*BInY.middleRows(offset,NumCoilPts) + coil_vector(2)*BInZ.middleRows(offset,NumCoilPts);
+        b_out = coil_vector(0)*BOutX.middleRows(offset,NumCoilPts) + coil_vector(1)*BOutY.middleRows(offset,NumCoilPts) + coil_vector(2)*BOutZ.middleRows(offset,NumCoilPts);
 //        std::cout << "b_in: Coil= " << i+1 << endl << b_in << endl;
 //        std::cout << "b_out: Coil= " << i+1 << endl << b_out << endl;
 
@@ -506,7 +596,7 @@ QList<MatrixXd> RtSssAlgo::getSSSEqn(qint32 LIn, qint32 LOut)
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 //      function [BInX,BInY,BInZ,BOutX,BOutY,BOutZ] = get_SSS_Basis(X,Y,Z,LIn,LOut)
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-void RtSssAlgo::getSSSBasis(VectorXd X, VectorXd Y, VectorXd Z, qint32 LIn, qint32 LOut)
+void RtSssAlgo::getSSSBasis(const VectorXd &X, const VectorXd &Y, const VectorXd &Z, qint32 LIn, qint32 LOut)
 {
     //qDebug() << "getSSSBasis START";
 
@@ -721,7 +811,7 @@ void RtSssAlgo::getSSSBasis(VectorXd X, VectorXd Y, VectorXd Z, qint32 LIn, qint
 //          THETA = atan2(hypotxy,Z);
 //      return;
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-void RtSssAlgo::getCartesianToSpherCoordinate(VectorXd X, VectorXd Y, VectorXd Z)
+void RtSssAlgo::getCartesianToSpherCoordinate(const VectorXd &X, const VectorXd &Y, const VectorXd &Z)
 {
     //qDebug() << "getCartesianToSpherCoordinate START";
 
@@ -816,12 +906,18 @@ void RtSssAlgo::getSphereToCartesianVector()
 
 //QList<MatrixXd> RtSssAlgo::getSSSRR(MatrixXd EqnIn, MatrixXd EqnOut, MatrixXd EqnARR, MatrixXd EqnA, MatrixXd EqnB)
 //QList<MatrixXd> RtSssAlgo::getSSSRR(MatrixXd EqnB)
-MatrixXd RtSssAlgo::getSSSRR(MatrixXd EqnB)
+MatrixXd RtSssAlgo::getSSSRR(const MatrixXd &MEGData)
 {
     //qDebug() << "getSSSRR START";
 
+    if (!EqnValid)
+        buildLinearEqn();
+
+//  % the LHS is scaled by the coil scaling, so the RHS has to be scaled the same way (as in getSSSOLS)
+    const MatrixXd EqnB = CoilScale.asDiagonal() * MEGData;
+
     int NumBIn, NumBOut, NumCoil, NumExp;
-    MatrixXd EqnRRInv, EqnInv, SSSIn, SSSOut, Weight; //, ErrRel;
+    MatrixXd SSSIn, SSSOut, Weight; //, ErrRel;
     VectorXd ErrRel;
     double RR_K1, RR_K2, RR_K3;
     double eqn_scale0, eqn_scale;
@@ -842,9 +938,6 @@ MatrixXd RtSssAlgo::getSSSRR(MatrixXd EqnB)
     NumCoil = EqnB.rows();
     NumExp = EqnB.cols();
 
-    EqnRRInv = (EqnARR.transpose() * EqnARR).inverse();
-    EqnInv = (EqnA.transpose() * EqnA).inverse();
-
     SSSIn.setZero(NumCoil,NumExp);
     SSSOut.setZero(NumCoil,NumExp);
     Weight.setZero(NumCoil,NumExp);
@@ -985,51 +1078,147 @@ MatrixXd RtSssAlgo::getSSSRR(MatrixXd EqnB)
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 //QList<MatrixXd> RtSssAlgo::getSSSOLS(MatrixXd EqnIn, MatrixXd EqnOut, MatrixXd EqnA, MatrixXd EqnB)
 //QList<MatrixXd> RtSssAlgo::getSSSOLS(MatrixXd EqnB)
-MatrixXd RtSssAlgo::getSSSOLS(MatrixXd EqnB)
+MatrixXd RtSssAlgo::getSSSOLS(const MatrixXd &EqnB)
 {
     //qDebug() << "getSSSOLS START";
 
-    int NumBIn, NumBOut, NumCoil, NumExp;
-    MatrixXd EqnRRInv, EqnInv, SSSIn, SSSOut;
-    MatrixXd sol_X, sol_in, sol_out;
-    VectorXd ErrRel;
-    QList<MatrixXd> OLSsss;
+    if (!EqnValid)
+        buildLinearEqn();
 
-//  % initialization
-    NumBIn = EqnIn.cols();
-    NumBOut = EqnOut.cols();
-    NumCoil = EqnB.rows();
-    NumExp = EqnB.cols();
+    if (EqnB.rows() != ProjIn.cols())
+    {
+        qWarning() << "RtSssAlgo::getSSSOLS - number of channels" << EqnB.rows() << "does not match the SSS basis" << ProjIn.cols();
+        return EqnB;
+    }
 
-    EqnRRInv = (EqnA.transpose() * EqnA).inverse();
-    SSSIn.setZero(NumCoil,NumExp);
-    SSSOut.setZero(NumCoil,NumExp);
-    ErrRel.setZero(NumExp);
+//  % the OLS solution of all samples and the internal reconstruction reduce to one matrix product with the cached projector
+    return ProjIn * EqnB;
+}
+
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+//% temporal SSS (Taulu & Simola, Phys. Med. Biol. 51, 2006)
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+//% The incoming blocks are collected in TSSSBuffer. Once TSSSBufLen samples
+//% are available the temporal subspace of the internal signal which
+//% intersects (correlation > TSSSCorrLimit) with the temporal subspace of the
+//% residual (external + noise) is projected out and the cleaned internal
+//% reconstruction is returned split into the original blocks.
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+QList<MatrixXd> RtSssAlgo::getTSSS(const MatrixXd &EqnB)
+{
+    QList<MatrixXd> SSSBlocks;
 
-    for (int i=0; i<NumExp; i++)
+    if (!EqnValid)
+        buildLinearEqn();
+
+    if (EqnB.rows() != ProjIn.cols())
     {
-//      % solve OLS solution
-        sol_X = EqnRRInv * (EqnA.transpose() * EqnB.col(i));
+        qWarning() << "RtSssAlgo::getTSSS - number of channels" << EqnB.rows() << "does not match the SSS basis" << ProjIn.cols();
+        return SSSBlocks;
+    }
 
-        ErrRel(i) = (EqnA * sol_X - EqnB.col(i)).norm() / EqnB.col(i).norm();
+    if (!TSSSActive || TSSSBufLen <= 0)
+    {
+        SSSBlocks.append(ProjIn * EqnB);
+        return SSSBlocks;
+    }
 
-        sol_in = sol_X.block(0,0,NumBIn,1);
+    if (TSSSBuffer.rows() != EqnB.rows() || TSSSFill + EqnB.cols() > TSSSBuffer.cols())
+        TSSSBuffer.conservativeResize(EqnB.rows(), qMax(TSSSBufLen, TSSSFill + (qint32)EqnB.cols()) + EqnB.cols());
 
-        sol_out = sol_X.block(NumBIn,0, NumBOut,1);    // probably NumBIn+0 is correct.  Please debug !!!!
+    TSSSBuffer.block(0, TSSSFill, EqnB.rows(), EqnB.cols()) = EqnB;
+    TSSSFill += EqnB.cols();
+    TSSSBlockSizes.append(EqnB.cols());
 
-//      % recover internal/external MEG siganl
-        SSSIn.col(i) = EqnIn * sol_in;
-        SSSOut.col(i) = EqnOut * sol_out;
+    if (TSSSFill < TSSSBufLen)
+        return SSSBlocks;
+
+    MatrixXd SSSIn = applyTSSS(TSSSBuffer.leftCols(TSSSFill));
+
+    qint32 offset = 0;
+    for (int i=0; i<TSSSBlockSizes.size(); i++)
+    {
+        SSSBlocks.append(SSSIn.middleCols(offset, TSSSBlockSizes[i]));
+        offset += TSSSBlockSizes[i];
     }
 
-    OLSsss.append(SSSIn);
-    OLSsss.append(SSSOut);
-    OLSsss.append(ErrRel);
+    TSSSFill = 0;
+    TSSSBlockSizes.clear();
 
-    //qDebug() << "getSSSOLS END";
+    return SSSBlocks;
+}
 
-//    return OLSsss;
-    return SSSIn;
+MatrixXd RtSssAlgo::applyTSSS(const MatrixXd &EqnB)
+{
+    // expansion coefficients of all samples with one matrix product
+    MatrixXd sol_X = EqnPinv * EqnB;
+    MatrixXd sol_in = sol_X.topRows(EqnIn.cols());
+    MatrixXd Res = EqnB - EqnIn * sol_in;
+
+    // orthonormal temporal bases (samples x rank); the internal one is derived from the coefficients,
+    // which span the same temporal subspace as the reconstructed internal signal
+    MatrixXd EIn = getTemporalBasis(sol_in);
+    MatrixXd ERes = getTemporalBasis(Res);
+
+    if (EIn.cols() > 0 && ERes.cols() > 0)
+    {
+        // principal angles between the two subspaces
+        JacobiSVD<MatrixXd> svd(EIn.transpose() * ERes, ComputeThinU);
+        const VectorXd &corr = svd.singularValues();
+
+        int NumInter = 0;
+        while (NumInter < corr.size() && corr(NumInter) > TSSSCorrLimit)
+            NumInter++;
+
+        if (NumInter > 0)
+        {
+            MatrixXd Inter = EIn * svd.matrixU().leftCols(NumInter);
+            sol_in -= (sol_in * Inter) * Inter.transpose();
+        }
+    }
+
+    return EqnIn * sol_in;
+}
+
+MatrixXd RtSssAlgo::getTemporalBasis(const MatrixXd &M)
+{
+    // M = U S V' -> V = M' U S^-1, obtained from the small rows x rows Gram matrix instead of a samples x samples SVD
+    SelfAdjointEigenSolver<MatrixXd> eig(M * M.transpose());
+    const VectorXd &ev = eig.eigenvalues();
+
+    if (ev.size() == 0 || ev(ev.size()-1) <= 0)
+        return MatrixXd(M.cols(), 0);
+
+    double tol = ev(ev.size()-1) * 1e-12;
+    int rank = 0;
+    while (rank < ev.size() && ev(ev.size()-1-rank) > tol)
+        rank++;
+
+    MatrixXd U = eig.eigenvectors().rightCols(rank);
+    VectorXd scale = ev.tail(rank).cwiseSqrt().cwiseInverse();
+
+    return M.transpose() * (U * scale.asDiagonal());
+}
+
+void RtSssAlgo::setTSSSParameter(bool active, qint32 bufferLength, double corrLimit)
+{
+    TSSSActive = active;
+    TSSSBufLen = bufferLength;
+    TSSSCorrLimit = corrLimit;
+
+    resetTSSS();
+}
+
+bool RtSssAlgo::isTSSSActive() const
+{
+    return TSSSActive;
+}
+
+void RtSssAlgo::resetTSSS()
+{
+    TSSSFill = 0;
+    TSSSBlockSizes.clear();
 }
 
 // Return number of meg channels
@@ -1138,7 +1327,7 @@ float plgndr(int l, int m, float x)
  Robust computation of the square root of the sum of squares.
  C = hypot(A,B) returns SQRT(ABS(A).^2+ABS(B).^2) carefully computed to
  avoid underflow and overflow.*/
-VectorXd hypot(VectorXd X, VectorXd Y)
+VectorXd hypot(const VectorXd &X, const VectorXd &Y)
 {
     VectorXd rst;
     rst = (X.array().abs().pow(2) + Y.array().abs().pow(2)).sqrt();
@@ -1148,7 +1337,7 @@ VectorXd hypot(VectorXd X, VectorXd Y)
 //---------------------------------------------------------------------
 // atan2() for vector
 // since no
-VectorXd atan2vec(VectorXd a, VectorXd b)
+VectorXd atan2vec(const VectorXd &a, const VectorXd &b)
 {
     int n = a.size();
     VectorXd at2(n);
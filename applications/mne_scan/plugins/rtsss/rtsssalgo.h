@@ -79,8 +79,8 @@ MatrixXd legendre(int, VectorXd);
 float plgndr(int l, int m, float x);
 double factorial(int);
 //QList<MatrixXd> getSSSRR(MatrixXd, MatrixXd, MatrixXd, MatrixXd, MatrixXd);
-VectorXd hypot(VectorXd, VectorXd);
-VectorXd atan2vec(VectorXd, VectorXd);
+VectorXd hypot(const VectorXd&, const VectorXd&);
+VectorXd atan2vec(const VectorXd&, const VectorXd&);
 VectorXd find(MatrixXd, int);
 
 double stdev(VectorXd);
@@ -101,16 +101,25 @@ public:
 
 //    QList<MatrixXd> getSSSRR(MatrixXd EqnIn, MatrixXd EqnOut, MatrixXd EqnARR, MatrixXd EqnA, MatrixXd EqnB);
 //    QList<MatrixXd> getSSSRR(MatrixXd EqnB);
-    MatrixXd getSSSRR(MatrixXd EqnB);
+    MatrixXd getSSSRR(const MatrixXd &MEGData);
 
 //    QList<MatrixXd> getSSSOLS(MatrixXd EqnIn, MatrixXd EqnOut, MatrixXd EqnA, MatrixXd EqnB);
 //    QList<MatrixXd> getSSSOLS(MatrixXd EqnB);
-    MatrixXd getSSSOLS(MatrixXd EqnB);
+    MatrixXd getSSSOLS(const MatrixXd &EqnB);
+
+    // Temporal SSS: the blocks are buffered until the buffer length is reached. The cleaned blocks are returned in
+    // the order and with the sizes they were appended, an empty list is returned while the buffer is filling up.
+    QList<MatrixXd> getTSSS(const MatrixXd &EqnB);
+    void setTSSSParameter(bool active, qint32 bufferLength, double corrLimit);
+    bool isTSSSActive() const;
+    void resetTSSS();
 
     QList<MatrixXd> getLinEqn();
 
     void setMEGInfo(FiffInfo::SPtr fiffinfo, RowVectorXi);
     void setSSSParameter(QList<int>);
+    void setOrigin(const Vector3d &origin);
+    bool isLinearEqnValid() const;
     qint32 getNumMEGChan();
     qint32 getNumMEGChanUsed();
     qint32 getNumMEGBadChan();
@@ -122,8 +131,11 @@ private:
     void getCoilInfoBabyMEG4Sim();
     QList<MatrixXd> getSSSEqn(qint32, qint32);
 //    QList<MatrixXd> getSSSEqn(VectorXi Lexp);
-    void getSSSBasis(VectorXd, VectorXd, VectorXd, qint32, qint32);
-    void getCartesianToSpherCoordinate(VectorXd, VectorXd, VectorXd);
+    void getSSSBasis(const VectorXd&, const VectorXd&, const VectorXd&, qint32, qint32);
+    void getCartesianToSpherCoordinate(const VectorXd&, const VectorXd&, const VectorXd&);
+    void computeProjector(const VectorXd &CoilScale);
+    MatrixXd getTemporalBasis(const MatrixXd &M);
+    MatrixXd applyTSSS(const MatrixXd &EqnB);
     void getSphereToCartesianVector();
     int strmatch(char, char);
 
@@ -141,6 +153,22 @@ private:
     MatrixXd BInX, BInY, BInZ, BOutX, BOutY, BOutZ;
     MatrixXd EqnInRR, EqnOutRR, EqnIn, EqnOut, EqnARR, EqnA, EqnB;
 
+    // Cached solution of the linear equation, valid until the coil geometry, the origin or the expansion orders change
+    bool EqnValid;
+    RowVectorXi PickedChannels;
+    MatrixXd EqnRRInv, EqnInv;      // inverses of the normal equations used by the robust regression
+    VectorXd CoilScale;             // scaling of the coils (magnetometers vs. gradiometers), applied to LHS and RHS
+    MatrixXd EqnPinv;               // regularized pseudo-inverse of EqnA including the coil scaling
+    MatrixXd ProjIn;                // reconstruction projector EqnIn * EqnPinv(internal rows)
+    double RegTol;                  // relative singular value threshold of the pseudo-inverse
+
+    // Temporal SSS buffer
+    bool TSSSActive;
+    qint32 TSSSBufLen, TSSSFill;
+    double TSSSCorrLimit;
+    MatrixXd TSSSBuffer;
+    QList<qint32> TSSSBlockSizes;
+
     VectorXd R, PHI, THETA;
     VectorXd R_X, R_Y, R_Z;
     VectorXd PHI_X, PHI_Y, PHI_Z;
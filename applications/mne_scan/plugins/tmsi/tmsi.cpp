@@ -42,6 +42,8 @@
 #include "tmsi.h"
 #include "tmsiproducer.h"
 
+#include <scShared/Management/pipelinetracer.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -59,6 +61,7 @@
 //=============================================================================================================
 
 using namespace TMSIPlugin;
+using namespace SCSHAREDLIB;
 
 
 //*************************************************************************************************************
@@ -101,6 +104,10 @@ TMSI::~TMSI()
     //If the program is closed while the sampling is in process
     if(this->isRunning())
         this->stop();
+
+    //Store settings for next use
+    QSettings settings;
+    settings.setValue(QString("TMSI/latencyBudget"), m_blockCoalescer.latencyBudget());
 }
 
 
@@ -126,6 +133,10 @@ void TMSI::init()
     m_iNumberOfChannels = 138;
     m_iSamplesPerBlock = 16;
     m_iTriggerInterval = 5000;
+
+    //The driver delivers 16 samples per block - the default budget keeps the former notify rate of 16 blocks per multi sample array
+    QSettings settings;
+    m_blockCoalescer.setLatencyBudget(settings.value(QString("TMSI/latencyBudget"), 250.0).toDouble());
     m_iSplitFileSizeMs = 10;
     m_iSplitCount = 0;
 
@@ -509,12 +520,18 @@ bool TMSI::start()
 
     //Set the channel size of the RMTSA - this needs to be done here and NOT in the init() function because the user can change the number of channels during runtime
     m_pRMTSA_TMSI->data()->initFromFiffInfo(m_pFiffInfo);
-    m_pRMTSA_TMSI->data()->setMultiArraySize(m_iSamplesPerBlock);
+    m_pRMTSA_TMSI->data()->setMultiArraySize(1);
     m_pRMTSA_TMSI->data()->setSamplingRate(m_iSamplingFreq);
 
+    //The driver blocks are coalesced before they are emitted
+    m_blockCoalescer.setSamplingFrequency(m_iSamplingFreq);
+    m_blockCoalescer.clear();
+
     //Buffer
     m_pRawMatrixBuffer_In = QSharedPointer<RawMatrixBuffer>(new RawMatrixBuffer(8, m_iNumberOfChannels, m_iSamplesPerBlock));
 
+    PipelineTracer::instance()->registerBuffer(this->getName() + " Input Buffer", m_pRawMatrixBuffer_In);
+
     m_pTMSIProducer->start(m_iNumberOfChannels,
                        m_iSamplingFreq,
                        m_iSamplesPerBlock,
@@ -568,6 +585,8 @@ bool TMSI::stop()
 
     m_tmsiManualAnnotationWidget->hide();
 
+    PipelineTracer::instance()->unregisterQueue(this->getName() + " Input Buffer");
+
     return true;
 }
 
@@ -768,8 +787,10 @@ void TMSI::run()
                 }
             }
 
-            //emit values to real time multi sample array
-            m_pRMTSA_TMSI->data()->setValue(matValue.cast<double>());
+            //emit values to real time multi sample array once enough driver blocks were collected
+            MatrixXd matCoalesced;
+            if(m_blockCoalescer.append(matValue) && m_blockCoalescer.takeBlock(matCoalesced))
+                m_pRMTSA_TMSI->data()->setValue(matCoalesced);
 
             // Reset keyboard trigger
             m_iTriggerType = 0;
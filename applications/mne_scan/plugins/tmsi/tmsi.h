@@ -51,6 +51,7 @@
 #include <scShared/Interfaces/ISensor.h>
 #include <generics/circularmatrixbuffer.h>
 #include <scMeas/newrealtimemultisamplearray.h>
+#include <scMeas/blockcoalescer.h>
 
 #include <utils/layoutloader.h>
 
@@ -274,6 +275,7 @@ private:
     QSharedPointer<TMSIProducer>        m_pTMSIProducer;                    /**< the TMSIProducer.*/
 
     MatrixXf                            m_matOldMatrix;                     /**< Last received sample matrix by the tmsiproducer/tmsidriver class. Used for simple HP filtering.*/
+    BlockCoalescer                      m_blockCoalescer;                   /**< Collects the small driver blocks into larger blocks before they are emitted.*/
 
     QMutex                              m_qMutex;                           /**< Holds the threads mutex.*/
 
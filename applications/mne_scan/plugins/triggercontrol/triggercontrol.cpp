@@ -44,6 +44,8 @@
 
 #include "serialport.h"
 
+#include <scShared/Management/pipelinetracer.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -338,8 +340,10 @@ void TriggerControl::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
     if(pRTMSA)
     {
         //Check if buffer initialized
-        if(!m_pDataMatrixBuffer)
+        if(!m_pDataMatrixBuffer) {
             m_pDataMatrixBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            PipelineTracer::instance()->registerBuffer(this->getName() + " Input Buffer", m_pDataMatrixBuffer);
+        }
 
 //        MatrixXd t_mat;
 
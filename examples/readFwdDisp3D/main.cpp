@@ -80,15 +80,16 @@ int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
 
-    QFile t_File("./MNE-sample-data/MEG/sample/sample_audvis-meg-eeg-oct-6-fwd.fif");
-    MNEForwardSolution t_forwardSolution(t_File);
+    QString t_sFileFwd("./MNE-sample-data/MEG/sample/sample_audvis-meg-eeg-oct-6-fwd.fif");
 
     View3D::SPtr testWindow = View3D::SPtr(new View3D());
 
-    //Option 1 - Visualize full source space
-    testWindow->addBrainData("Subject01", "ForwardSolution", t_forwardSolution);
+    //Option 1 - Visualize full source space, the forward solution is read in the background while the window is shown
+    testWindow->getData3DTreeModel()->loadSourceSpaceData("Subject01", "ForwardSolution", t_sFileFwd);
 
     //Option 2 - Visualize clustered source space
+//    QFile t_File(t_sFileFwd);
+//    MNEForwardSolution t_forwardSolution(t_File);
 //    AnnotationSet t_annotationSet ("sample", 2, "aparc.a2009s", "./MNE-sample-data/subjects");
 //    MNEForwardSolution t_clusteredFwd = t_forwardSolution.cluster_forward_solution(t_annotationSet, 40);
 //    testWindow->addBrainData("Subject01", "ForwardSolution", t_clusteredFwd);
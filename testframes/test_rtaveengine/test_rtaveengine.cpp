@@ -0,0 +1,226 @@
+//=============================================================================================================
+/**
+* @file     test_rtaveengine.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2016
+*
+* @section  LICENSE
+*
+* Copyright (C) 2016, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Unit tests of the incremental real-time averaging engine
+*
+*/
+
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <rtProcessing/rtaveengine.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtAveEngine
+*
+* @brief The TestRtAveEngine class compares the incremental averages against averages computed from scratch
+*
+*/
+class TestRtAveEngine: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtAveEngine();
+
+private slots:
+    void initTestCase();
+    void compareMovingWindow();
+    void compareCumulative();
+    void compareStandardError();
+    void compareConditions();
+    void cleanupTestCase();
+
+private:
+    double epsilon;
+
+    QList<MatrixXd> m_qListEpochs;
+};
+
+
+//*************************************************************************************************************
+
+TestRtAveEngine::TestRtAveEngine()
+: epsilon(0.000001)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAveEngine::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    for(int i = 0; i < 200; ++i)
+        m_qListEpochs.append(MatrixXd::Random(8, 50));
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAveEngine::compareMovingWindow()
+{
+    int iWindow = 7;
+    RtAveEngine engine(8, 50, iWindow);
+
+    MatrixXd matAverage;
+    for(int i = 0; i < m_qListEpochs.size(); ++i) {
+        QVERIFY(engine.addEpoch(m_qListEpochs[i]));
+
+        int iFirst = qMax(0, i - iWindow + 1);
+        MatrixXd matReference = MatrixXd::Zero(8, 50);
+        for(int j = iFirst; j <= i; ++j)
+            matReference += m_qListEpochs[j];
+        matReference /= (i - iFirst + 1);
+
+        QVERIFY(engine.average(matAverage));
+        QCOMPARE(engine.count(), i - iFirst + 1);
+        QVERIFY((matAverage - matReference).cwiseAbs().maxCoeff() < epsilon);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAveEngine::compareCumulative()
+{
+    RtAveEngine engine(8, 50, 0);
+
+    MatrixXd matReference = MatrixXd::Zero(8, 50);
+    for(int i = 0; i < m_qListEpochs.size(); ++i) {
+        engine.addEpoch(m_qListEpochs[i]);
+        matReference += m_qListEpochs[i];
+    }
+    matReference /= m_qListEpochs.size();
+
+    MatrixXd matAverage;
+    QVERIFY(engine.average(matAverage));
+    QCOMPARE(engine.count(), m_qListEpochs.size());
+    QVERIFY((matAverage - matReference).cwiseAbs().maxCoeff() < epsilon);
+
+    //Wrong dimensions are rejected
+    QVERIFY(!engine.addEpoch(MatrixXd::Zero(3, 50)));
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAveEngine::compareStandardError()
+{
+    int iWindow = 20;
+    RtAveEngine engine(8, 50, iWindow);
+
+    MatrixXd matStdErr;
+    QVERIFY(!engine.standardError(matStdErr));
+
+    for(int i = 0; i < m_qListEpochs.size(); ++i)
+        engine.addEpoch(m_qListEpochs[i]);
+
+    MatrixXd matMean = MatrixXd::Zero(8, 50);
+    for(int i = m_qListEpochs.size() - iWindow; i < m_qListEpochs.size(); ++i)
+        matMean += m_qListEpochs[i];
+    matMean /= iWindow;
+
+    MatrixXd matVar = MatrixXd::Zero(8, 50);
+    for(int i = m_qListEpochs.size() - iWindow; i < m_qListEpochs.size(); ++i)
+        matVar += (m_qListEpochs[i] - matMean).cwiseAbs2();
+    matVar /= (iWindow - 1);
+
+    MatrixXd matReference = (matVar / iWindow).cwiseSqrt();
+
+    QVERIFY(engine.standardError(matStdErr));
+    QVERIFY((matStdErr - matReference).cwiseAbs().maxCoeff() < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAveEngine::compareConditions()
+{
+    RtAveEngine engine(8, 50, 4);
+
+    engine.addEpoch(m_qListEpochs[0], 1);
+    engine.addEpoch(m_qListEpochs[1], 2);
+    engine.addEpoch(m_qListEpochs[2], 1);
+
+    QCOMPARE(engine.conditions().size(), 2);
+    QCOMPARE(engine.count(1), 2);
+    QCOMPARE(engine.count(2), 1);
+    QCOMPARE(engine.count(3), 0);
+
+    MatrixXd matAverage;
+    QVERIFY(engine.average(matAverage, 2));
+    QVERIFY((matAverage - m_qListEpochs[1]).cwiseAbs().maxCoeff() < epsilon);
+
+    engine.clear();
+    QCOMPARE(engine.count(1), 0);
+    QVERIFY(!engine.average(matAverage, 1));
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAveEngine::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestRtAveEngine)
+#include "test_rtaveengine.moc"